@@ -48,6 +48,7 @@ AnimChannelMatrixXfmTable(AnimGroup *parent, const AnimChannelMatrixXfmTable &co
   for (int i = 0; i < num_matrix_components; i++) {
     _tables[i] = copy._tables[i];
   }
+  _quantized = copy._quantized;
 }
 
 /**
@@ -80,9 +81,8 @@ has_changed(int last_frame, double last_frac,
             int this_frame, double this_frac) {
   if (last_frame != this_frame) {
     for (int i = 0; i < num_matrix_components; i++) {
-      if (_tables[i].size() > 1) {
-        if (_tables[i][last_frame % _tables[i].size()] !=
-            _tables[i][this_frame % _tables[i].size()]) {
+      if (get_table_size(i) > 1) {
+        if (get_table_value(i, last_frame) != get_table_value(i, this_frame)) {
           return true;
         }
       }
@@ -93,9 +93,8 @@ has_changed(int last_frame, double last_frac,
     // If we have some fractional changes, also check the next subsequent
     // frame (since we'll be blending with that).
     for (int i = 0; i < num_matrix_components; i++) {
-      if (_tables[i].size() > 1) {
-        if (_tables[i][last_frame % _tables[i].size()] !=
-            _tables[i][(this_frame + 1) % _tables[i].size()]) {
+      if (get_table_size(i) > 1) {
+        if (get_table_value(i, last_frame) != get_table_value(i, this_frame + 1)) {
           return true;
         }
       }
@@ -113,11 +112,7 @@ get_value(int frame, LMatrix4 &mat) {
   PN_stdfloat components[num_matrix_components];
 
   for (int i = 0; i < num_matrix_components; i++) {
-    if (_tables[i].empty()) {
-      components[i] = get_default_value(i);
-    } else {
-      components[i] = _tables[i][frame % _tables[i].size()];
-    }
+    components[i] = get_table_value(i, frame);
   }
 
   compose_matrix(mat, components);
@@ -138,11 +133,7 @@ get_value_no_scale_shear(int frame, LMatrix4 &mat) {
   components[5] = 0.0f;
 
   for (int i = 6; i < num_matrix_components; i++) {
-    if (_tables[i].empty()) {
-      components[i] = get_default_value(i);
-    } else {
-      components[i] = _tables[i][frame % _tables[i].size()];
-    }
+    components[i] = get_table_value(i, frame);
   }
 
   compose_matrix(mat, components);
@@ -154,11 +145,7 @@ get_value_no_scale_shear(int frame, LMatrix4 &mat) {
 void AnimChannelMatrixXfmTable::
 get_scale(int frame, LVecBase3 &scale) {
   for (int i = 0; i < 3; i++) {
-    if (_tables[i].empty()) {
-      scale[i] = 1.0f;
-    } else {
-      scale[i] = _tables[i][frame % _tables[i].size()];
-    }
+    scale[i] = get_table_value(i, frame);
   }
 }
 
@@ -169,11 +156,7 @@ get_scale(int frame, LVecBase3 &scale) {
 void AnimChannelMatrixXfmTable::
 get_hpr(int frame, LVecBase3 &hpr) {
   for (int i = 0; i < 3; i++) {
-    if (_tables[i + 6].empty()) {
-      hpr[i] = 0.0f;
-    } else {
-      hpr[i] = _tables[i + 6][frame % _tables[i + 6].size()];
-    }
+    hpr[i] = get_table_value(i + 6, frame);
   }
 }
 
@@ -186,11 +169,7 @@ void AnimChannelMatrixXfmTable::
 get_quat(int frame, LQuaternion &quat) {
   LVecBase3 hpr;
   for (int i = 0; i < 3; i++) {
-    if (_tables[i + 6].empty()) {
-      hpr[i] = 0.0f;
-    } else {
-      hpr[i] = _tables[i + 6][frame % _tables[i + 6].size()];
-    }
+    hpr[i] = get_table_value(i + 6, frame);
   }
 
   quat.set_hpr(hpr);
@@ -203,11 +182,7 @@ get_quat(int frame, LQuaternion &quat) {
 void AnimChannelMatrixXfmTable::
 get_pos(int frame, LVecBase3 &pos) {
   for (int i = 0; i < 3; i++) {
-    if (_tables[i + 9].empty()) {
-      pos[i] = 0.0f;
-    } else {
-      pos[i] = _tables[i + 9][frame % _tables[i + 9].size()];
-    }
+    pos[i] = get_table_value(i + 9, frame);
   }
 }
 
@@ -218,11 +193,7 @@ get_pos(int frame, LVecBase3 &pos) {
 void AnimChannelMatrixXfmTable::
 get_shear(int frame, LVecBase3 &shear) {
   for (int i = 0; i < 3; i++) {
-    if (_tables[i + 3].empty()) {
-      shear[i] = 0.0f;
-    } else {
-      shear[i] = _tables[i + 3][frame % _tables[i + 3].size()];
-    }
+    shear[i] = get_table_value(i + 3, frame);
   }
 }
 
@@ -248,6 +219,7 @@ set_table(char table_id, const CPTA_stdfloat &table) {
     return;
   }
 
+  dequantize();
   _tables[i] = table;
 }
 
@@ -261,6 +233,106 @@ clear_all_tables() {
   for (int i = 0; i < num_matrix_components; i++) {
     _tables[i] = CPTA_stdfloat(get_class_type());
   }
+  _quantized.clear();
+}
+
+/**
+ * Removes the indicated table from the definition.
+ */
+void AnimChannelMatrixXfmTable::
+clear_table(char table_id) {
+  int table_index = get_table_index(table_id);
+  if (table_index >= 0) {
+    dequantize();
+    _tables[table_index] = nullptr;
+  }
+}
+
+/**
+ * Replaces the tables with a compact representation that stores each value
+ * in 16 bits, as a fraction of the range between the smallest and largest
+ * value in its table.  This roughly halves the memory used by the animation
+ * (or better, with double-precision builds), at the cost of a small loss of
+ * precision: the error is at most 1/131070 of the range of each table.
+ * Tables whose values are all the same are reduced to a single value, which
+ * is lossless.
+ *
+ * The values are decoded on the fly by get_value() and friends.  Modifying
+ * any of the tables undoes the quantization; see dequantize().
+ */
+void AnimChannelMatrixXfmTable::
+quantize() {
+  if (_quantized != nullptr) {
+    return;
+  }
+
+  PT(QuantizedTables) quantized = new QuantizedTables;
+  bool any_quantized = false;
+
+  for (int i = 0; i < num_matrix_components; i++) {
+    QuantizedTables::Table &qtable = quantized->_tables[i];
+    qtable._base = 0.0f;
+    qtable._scale = 0.0f;
+    qtable._start = 0;
+    qtable._size = 0;
+
+    const CPTA_stdfloat &table = _tables[i];
+    size_t size = table.size();
+    if (size <= 1) {
+      continue;
+    }
+
+    PN_stdfloat min_value = table[0];
+    PN_stdfloat max_value = table[0];
+    for (size_t j = 1; j < size; ++j) {
+      min_value = std::min(min_value, table[j]);
+      max_value = std::max(max_value, table[j]);
+    }
+
+    if (min_value == max_value) {
+      // A constant table only needs one value.
+      PTA_stdfloat new_table(get_class_type());
+      new_table.push_back(min_value);
+      _tables[i] = new_table;
+      continue;
+    }
+
+    qtable._base = min_value;
+    qtable._scale = (max_value - min_value) / (PN_stdfloat)0xffff;
+    qtable._start = (unsigned int)quantized->_values.size();
+    qtable._size = (unsigned int)size;
+
+    for (size_t j = 0; j < size; ++j) {
+      PN_stdfloat value = (table[j] - min_value) / qtable._scale;
+      quantized->_values.push_back((uint16_t)std::min(value + 0.5f, (PN_stdfloat)0xffff));
+    }
+    _tables[i] = CPTA_stdfloat(get_class_type());
+    any_quantized = true;
+  }
+
+  if (any_quantized) {
+    quantized->_values.shrink_to_fit();
+    _quantized = quantized;
+  }
+}
+
+/**
+ * Undoes the effect of a previous call to quantize(), restoring the tables to
+ * full-precision floats (though the precision lost in quantization can't be
+ * recovered).
+ */
+void AnimChannelMatrixXfmTable::
+dequantize() {
+  if (_quantized == nullptr) {
+    return;
+  }
+
+  for (int i = 0; i < num_matrix_components; i++) {
+    if (_quantized->_tables[i]._size != 0) {
+      _tables[i] = get_decoded_table(i);
+    }
+  }
+  _quantized.clear();
 }
 
 /**
@@ -274,14 +346,16 @@ write(std::ostream &out, int indent_level) const {
   // Write a list of all the sub-tables that have data.
   bool found_any = false;
   for (int i = 0; i < num_matrix_components; i++) {
-    if (!_tables[i].empty()) {
-      out << get_table_id(i) << _tables[i].size();
+    if (get_table_size(i) != 0) {
+      out << get_table_id(i) << get_table_size(i);
       found_any = true;
     }
   }
 
   if (!found_any) {
     out << "(no data)";
+  } else if (_quantized != nullptr) {
+    out << " (quantized)";
   }
 
   if (!_children.empty()) {
@@ -319,6 +393,25 @@ get_table_index(char table_id) {
   return -1;
 }
 
+/**
+ * Returns the indicated table as full-precision floats, decoding it if it has
+ * been quantized.
+ */
+CPTA_stdfloat AnimChannelMatrixXfmTable::
+get_decoded_table(int table_index) const {
+  if (_quantized != nullptr) {
+    size_t size = _quantized->_tables[table_index]._size;
+    if (size != 0) {
+      PTA_stdfloat table = PTA_stdfloat::empty_array(size, get_class_type());
+      for (size_t j = 0; j < size; ++j) {
+        table[j] = get_table_value(table_index, (int)j);
+      }
+      return table;
+    }
+  }
+  return _tables[table_index];
+}
+
 /**
  * Function to write the important information in the particular object to a
  * Datagram
@@ -344,12 +437,19 @@ write_datagram(BamWriter *manager, Datagram &me) {
   // We now always use the new HPR conventions.
   me.add_bool(true);
 
+  // Quantization is an in-memory representation only; we always write the
+  // full tables.
+  CPTA_stdfloat tables[num_matrix_components];
+  for (int i = 0; i < num_matrix_components; i++) {
+    tables[i] = get_decoded_table(i);
+  }
+
   if (!compress_channels) {
     // Write out everything uncompressed, as a stream of floats.
     for (int i = 0; i < num_matrix_components; i++) {
-      me.add_uint16(_tables[i].size());
-      for(int j = 0; j < (int)_tables[i].size(); j++) {
-        me.add_stdfloat(_tables[i][j]);
+      me.add_uint16(tables[i].size());
+      for(int j = 0; j < (int)tables[i].size(); j++) {
+        me.add_stdfloat(tables[i][j]);
       }
     }
 
@@ -363,18 +463,18 @@ write_datagram(BamWriter *manager, Datagram &me) {
     // First, write out the scales and shears.
     int i;
     for (i = 0; i < 6; i++) {
-      compressor.write_reals(me, _tables[i], _tables[i].size());
+      compressor.write_reals(me, tables[i], tables[i].size());
     }
 
     // Now, write out the joint angles.  For these we need to build up a HPR
     // array.
     pvector<LVecBase3> hprs;
-    int hprs_length = std::max(std::max(_tables[6].size(), _tables[7].size()), _tables[8].size());
+    int hprs_length = std::max(std::max(tables[6].size(), tables[7].size()), tables[8].size());
     hprs.reserve(hprs_length);
     for (i = 0; i < hprs_length; i++) {
-      PN_stdfloat h = _tables[6].empty() ? 0.0f : _tables[6][i % _tables[6].size()];
-      PN_stdfloat p = _tables[7].empty() ? 0.0f : _tables[7][i % _tables[7].size()];
-      PN_stdfloat r = _tables[8].empty() ? 0.0f : _tables[8][i % _tables[8].size()];
+      PN_stdfloat h = tables[6].empty() ? 0.0f : tables[6][i % tables[6].size()];
+      PN_stdfloat p = tables[7].empty() ? 0.0f : tables[7][i % tables[7].size()];
+      PN_stdfloat r = tables[8].empty() ? 0.0f : tables[8][i % tables[8].size()];
       hprs.push_back(LVecBase3(h, p, r));
     }
     const LVecBase3 *hprs_array = nullptr;
@@ -385,7 +485,7 @@ write_datagram(BamWriter *manager, Datagram &me) {
 
     // And now the translations.
     for(i = 9; i < num_matrix_components; i++) {
-      compressor.write_reals(me, _tables[i], _tables[i].size());
+      compressor.write_reals(me, tables[i], tables[i].size());
     }
   }
 }
@@ -505,6 +605,10 @@ fillin(DatagramIterator &scan, BamReader *manager) {
       _tables[i] = ind_table;
     }
   }
+
+  if (quantize_anim_channels) {
+    quantize();
+  }
 }
 
 /**
@@ -21,12 +21,17 @@
 #include "pointerToArray.h"
 #include "pta_stdfloat.h"
 #include "compose_matrix.h"
+#include "referenceCount.h"
+#include "pvector.h"
 
 /**
  * An animation channel that issues a matrix each frame, read from a table
  * such as might have been read from an egg file.  The table actually consists
  * of nine sub-tables, each representing one component of the transform:
  * scale, rotate, translate.
+ *
+ * To save memory, the tables may be quantized to 16 bits per value with
+ * quantize(), in which case the values are decoded on the fly.
  */
 class EXPCL_PANDA_CHAN AnimChannelMatrixXfmTable : public AnimChannelMatrix {
 protected:
@@ -57,9 +62,14 @@ PUBLISHED:
 
   void clear_all_tables();
   INLINE bool has_table(char table_id) const;
-  INLINE void clear_table(char table_id);
+  void clear_table(char table_id);
+
+  void quantize();
+  void dequantize();
+  INLINE bool is_quantized() const;
 
   MAKE_MAP_PROPERTY(tables, has_table, get_table, set_table, clear_table);
+  MAKE_PROPERTY(quantized, is_quantized);
 
 public:
   virtual void write(std::ostream &out, int indent_level) const;
@@ -71,8 +81,30 @@ protected:
   static int get_table_index(char table_id);
   INLINE static PN_stdfloat get_default_value(int table_index);
 
+  INLINE size_t get_table_size(int table_index) const;
+  INLINE PN_stdfloat get_table_value(int table_index, int frame) const;
+  CPTA_stdfloat get_decoded_table(int table_index) const;
+
   CPTA_stdfloat _tables[num_matrix_components];
 
+  // The quantized form of the tables.  Each quantized table stores its
+  // values as 16-bit fractions of the range between its minimum and maximum
+  // value.  All of the values are packed into a single array, which is
+  // shared between copies of the channel.
+  class QuantizedTables : public ReferenceCount {
+  public:
+    class Table {
+    public:
+      PN_stdfloat _base;
+      PN_stdfloat _scale;
+      unsigned int _start;
+      unsigned int _size;
+    };
+    Table _tables[num_matrix_components];
+    pvector<uint16_t> _values;
+  };
+  CPT(QuantizedTables) _quantized;
+
 public:
   static void register_with_read_factory();
   virtual void write_datagram(BamWriter* manager, Datagram &me);
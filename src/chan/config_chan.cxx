@@ -101,6 +101,22 @@ PRC_DESC("This specifies the priority assign to an asynchronous bind "
          "model loads).  A higher number here makes the animations "
          "load sooner."));
 
+ConfigVariableBool quantize_anim_channels
+("quantize-anim-channels", false,
+PRC_DESC("Set this true to store the tables of animation channels in memory "
+         "in a quantized form, using 16 bits per value, as they are loaded.  "
+         "This roughly halves the memory used by loaded animations, at the "
+         "cost of a small loss of precision.  It does not affect the files "
+         "written.  See AnimChannelMatrixXfmTable::quantize()."));
+
+ConfigVariableInt anim_update_num_threads
+("anim-update-num-threads", 3,
+PRC_DESC("The number of worker threads that will be started to evaluate "
+         "PartBundles in parallel, when a batch of them is updated at once "
+         "via PartBundle::update_bundles() or Character::update_all().  "
+         "The calling thread also participates.  Set this to 0 to evaluate "
+         "the batch on the calling thread only."));
+
 ConfigureFn(config_chan) {
   AnimBundle::init_type();
   AnimBundleNode::init_type();
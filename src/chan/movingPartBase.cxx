@@ -28,7 +28,8 @@ TypeHandle MovingPartBase::_type_handle;
 MovingPartBase::
 MovingPartBase(PartGroup *parent, const std::string &name) :
   PartGroup(parent, name),
-  _effective_control(nullptr)
+  _effective_control(nullptr),
+  _lod_frozen(false)
 {
 }
 
@@ -37,7 +38,8 @@ MovingPartBase(PartGroup *parent, const std::string &name) :
  */
 MovingPartBase::
 MovingPartBase() :
-  _effective_control(nullptr)
+  _effective_control(nullptr),
+  _lod_frozen(false)
 {
 }
 
@@ -110,11 +112,13 @@ do_update(PartBundle *root, const CycleData *root_cdata, PartGroup *parent,
           bool parent_changed, bool anim_changed,
           Thread *current_thread) {
   bool any_changed = false;
-  bool needs_update = anim_changed;
+  bool needs_update = anim_changed && !_lod_frozen;
 
-  // See if any of the channel values have changed since last time.
+  // See if any of the channel values have changed since last time.  If the
+  // current level of detail excludes this part, we don't bother; it keeps
+  // its last value, though it still follows its parent.
 
-  if (!needs_update) {
+  if (!needs_update && !_lod_frozen) {
     if (_forced_channel != nullptr) {
       needs_update = _forced_channel->has_changed(0, 0.0, 0, 0.0);
 
@@ -295,6 +299,23 @@ find_bound_joints(int &joint_index, bool is_included, BitArray &bound_joints,
   PartGroup::find_bound_joints(joint_index, is_included, bound_joints, subset);
 }
 
+/**
+ * Called by PartBundle::set_lod_level() to mark each of the parts that is not
+ * included in the indicated subset as frozen.
+ */
+void MovingPartBase::
+apply_lod_subset(bool is_included, const PartSubset &subset) {
+  if (subset.matches_include(get_name())) {
+    is_included = true;
+  } else if (subset.matches_exclude(get_name())) {
+    is_included = false;
+  }
+
+  _lod_frozen = !is_included;
+
+  PartGroup::apply_lod_subset(is_included, subset);
+}
+
 /**
  * Should be called whenever the ChannelBlend values have changed, this
  * recursively updates the _effective_channel member in each part.
@@ -72,6 +72,7 @@ protected:
   virtual void find_bound_joints(int &joint_index, bool is_included,
                                  BitArray &bound_joints,
                                  const PartSubset &subset);
+  virtual void apply_lod_subset(bool is_included, const PartSubset &subset);
   virtual void determine_effective_channels(const CycleData *root_cdata);
 
   // This is the vector of all channels bound to this part.
@@ -89,6 +90,11 @@ protected:
   // set_forced_channel().  It overrides all of the above if set.
   PT(AnimChannelBase) _forced_channel;
 
+  // This is set by PartBundle::set_lod_level() when the current level of
+  // detail excludes this part.  It is then left at its last computed value.
+  // It is only accessed while holding the lod lock of the PartBundle.
+  bool _lod_frozen;
+
 public:
   virtual void write_datagram(BamWriter *manager, Datagram &dg);
   virtual int complete_pointers(TypedWritable **plist, BamReader *manager);
@@ -28,6 +28,11 @@
 #include "configVariableEnum.h"
 #include "loaderOptions.h"
 #include "bindAnimRequest.h"
+#include "clockObject.h"
+#include "asyncTaskManager.h"
+#include "atomicAdjust.h"
+#include "pStatTimer.h"
+#include "lightMutexHolder.h"
 
 #include <algorithm>
 
@@ -37,6 +42,81 @@ using std::string;
 
 TypeHandle PartBundle::_type_handle;
 
+PStatCollector PartBundle::_update_bundles_pcollector("App:Animation:Batch");
+PStatCollector PartBundle::_bundle_pcollector("*:Animation:Bundles");
+
+/**
+ * A batch of PartBundles that are being evaluated by update_bundles().  Each
+ * thread claims the next bundle in the list until there are none left.
+ */
+class PartBundle::BatchUpdate {
+public:
+  BatchUpdate(double now, bool force);
+
+  void run();
+  static void run_func(void *data);
+
+  double _now;
+  bool _force;
+
+  pvector<PartBundle *> _bundles;
+  AtomicAdjust::Integer _next_bundle;
+  AtomicAdjust::Integer _num_changed;
+};
+
+/**
+ *
+ */
+PartBundle::BatchUpdate::
+BatchUpdate(double now, bool force) :
+  _now(now),
+  _force(force),
+  _next_bundle(0),
+  _num_changed(0)
+{
+}
+
+/**
+ * Evaluates bundles until there are none left to claim.  This is run by the
+ * calling thread as well as by each of the worker threads.
+ */
+void PartBundle::BatchUpdate::
+run() {
+  Thread *current_thread = Thread::get_current_thread();
+
+  AtomicAdjust::Integer num_bundles = (AtomicAdjust::Integer)_bundles.size();
+  AtomicAdjust::Integer i = AtomicAdjust::add(_next_bundle, 1) - 1;
+  while (i < num_bundles) {
+    PartBundle *bundle = _bundles[i];
+
+    // Only look up the collector for this particular bundle if someone is
+    // actually listening.
+    PStatCollector collector(_bundle_pcollector);
+    if (_bundle_pcollector.is_active()) {
+      collector = PStatCollector(_bundle_pcollector, bundle->get_name());
+    }
+
+    bool any_changed;
+    {
+      PStatTimer timer(collector, current_thread);
+      any_changed = bundle->do_update_bundle(_now, _force, current_thread);
+    }
+    if (any_changed) {
+      AtomicAdjust::inc(_num_changed);
+    }
+
+    i = AtomicAdjust::add(_next_bundle, 1) - 1;
+  }
+}
+
+/**
+ * The function passed to AsyncTaskManager::run_parallel().
+ */
+void PartBundle::BatchUpdate::
+run_func(void *data) {
+  ((BatchUpdate *)data)->run();
+}
+
 
 static ConfigVariableEnum<PartBundle::BlendType> anim_blend_type
 ("anim-blend-type", PartBundle::BT_normalized_linear,
@@ -55,6 +135,10 @@ PartBundle(const PartBundle &copy) :
 {
   _anim_preload = copy._anim_preload;
   _update_delay = 0.0;
+  _lod_levels = copy._lod_levels;
+  _lod_level = 0;
+  _lod_update_delay = 0.0;
+  _lod_changed = false;
 
   CDWriter cdata(_cycler, true);
   CDReader cdata_from(copy._cycler);
@@ -73,6 +157,9 @@ PartBundle(const string &name) :
   PartGroup(name)
 {
   _update_delay = 0.0;
+  _lod_level = 0;
+  _lod_update_delay = 0.0;
+  _lod_changed = false;
 }
 
 /**
@@ -475,29 +562,8 @@ release_joint(const string &joint_name) {
 bool PartBundle::
 update() {
   Thread *current_thread = Thread::get_current_thread();
-  CDWriter cdata(_cycler, false, current_thread);
-  bool any_changed = false;
-
   double now = ClockObject::get_global_clock()->get_frame_time(current_thread);
-  if (now > cdata->_last_update + _update_delay || cdata->_anim_changed) {
-    bool anim_changed = cdata->_anim_changed;
-    bool frame_blend_flag = cdata->_frame_blend_flag;
-
-    any_changed = do_update(this, cdata, nullptr, false, anim_changed,
-                            current_thread);
-
-    // Now update all the controls for next time.
-    ChannelBlend::const_iterator cbi;
-    for (cbi = cdata->_blend.begin(); cbi != cdata->_blend.end(); ++cbi) {
-      AnimControl *control = (*cbi).first;
-      control->mark_channels(frame_blend_flag);
-    }
-
-    cdata->_anim_changed = false;
-    cdata->_last_update = now;
-  }
-
-  return any_changed;
+  return do_update_bundle(now, false, current_thread);
 }
 
 /**
@@ -507,21 +573,147 @@ update() {
 bool PartBundle::
 force_update() {
   Thread *current_thread = Thread::get_current_thread();
-  CDWriter cdata(_cycler, false, current_thread);
-  bool any_changed = do_update(this, cdata, nullptr, true, true, current_thread);
+  return do_update_bundle(0.0, true, current_thread);
+}
 
-  // Now update all the controls for next time.
-  ChannelBlend::const_iterator cbi;
-  for (cbi = cdata->_blend.begin(); cbi != cdata->_blend.end(); ++cbi) {
-    AnimControl *control = (*cbi).first;
-    control->mark_channels(cdata->_frame_blend_flag);
+/**
+ * Defines a reduced level of detail for the animation of this bundle, which
+ * takes effect when the bundle is at least the indicated distance from the
+ * camera.  While it is in effect, only the joints and sliders in the
+ * indicated subset are animated; the rest are left in their last computed
+ * pose, though they still follow their parent joints.  The subset is
+ * interpreted as for bind_anim(): an empty include list means all parts
+ * except those excluded.
+ *
+ * If update_delay is nonzero, the bundle is also updated no more often than
+ * once every update_delay seconds while the level is in effect.
+ *
+ * Levels are numbered from 1, in order of increasing distance; level 0 is the
+ * full level of detail.  Character::cull_callback() chooses the level
+ * according to the distance of the character from the camera each frame, as
+ * measured from the center given to Character::set_lod_animation() (or the
+ * character's origin).  Alternatively, the level may be chosen directly with
+ * set_lod_level().
+ */
+void PartBundle::
+add_lod_level(PN_stdfloat distance, const PartSubset &subset,
+              double update_delay) {
+  nassertv(distance >= 0.0f && update_delay >= 0.0);
+  LODLevel level;
+  level._distance = distance;
+  level._subset = subset;
+  level._update_delay = update_delay;
+
+  LightMutexHolder holder(_lod_lock);
+  LODLevels::iterator li = _lod_levels.begin();
+  while (li != _lod_levels.end() && (*li)._distance <= distance) {
+    ++li;
   }
+  _lod_levels.insert(li, level);
 
-  cdata->_anim_changed = false;
+  // The level numbers may have shifted; start again from full detail.
+  do_set_lod_level(0);
+}
 
-  return any_changed;
+/**
+ * Removes all of the levels of detail added by add_lod_level(), so that the
+ * bundle is once again always animated in full.
+ */
+void PartBundle::
+clear_lod_levels() {
+  LightMutexHolder holder(_lod_lock);
+  do_set_lod_level(0);
+  _lod_levels.clear();
+}
+
+/**
+ * Selects the level of detail that should be used to animate the bundle.  0
+ * is the full level of detail; higher levels are those defined by
+ * add_lod_level().
+ */
+void PartBundle::
+set_lod_level(int level) {
+  LightMutexHolder holder(_lod_lock);
+  do_set_lod_level(level);
+}
+
+/**
+ * Selects the level of detail appropriate for the indicated distance from
+ * the camera: the highest level whose distance is no greater than this.
+ */
+void PartBundle::
+set_lod_distance(PN_stdfloat distance) {
+  LightMutexHolder holder(_lod_lock);
+  int level = 0;
+  while (level < (int)_lod_levels.size() &&
+         _lod_levels[level]._distance <= distance) {
+    ++level;
+  }
+  do_set_lod_level(level);
+}
+
+/**
+ * The implementation of set_lod_level().  Assumes the lod lock is held.
+ */
+void PartBundle::
+do_set_lod_level(int level) {
+  level = std::max(0, std::min(level, (int)_lod_levels.size()));
+  if (level == _lod_level) {
+    return;
+  }
+
+  // The lod lock keeps update() from seeing the parts half frozen.
+  _lod_level = level;
+  if (level == 0) {
+    apply_lod_subset(true, PartSubset());
+    _lod_update_delay = 0.0;
+  } else {
+    const LODLevel &lod = _lod_levels[level - 1];
+    apply_lod_subset(lod._subset.is_include_empty(), lod._subset);
+    _lod_update_delay = lod._update_delay;
+  }
+
+  // The parts that are no longer frozen need to catch up.
+  _lod_changed = true;
 }
 
+/**
+ * Updates each of the indicated bundles, as if update() (or force_update(),
+ * if force is true) were called on each one.  Bundles that don't need to be
+ * updated this frame are skipped, and the rest are evaluated in parallel by
+ * the threads of the "animation" task chain; see anim-update-num-threads.
+ *
+ * Each bundle is evaluated entirely by one thread, so the blending of its
+ * controls is the same as in the serial case.  The same bundle may appear
+ * more than once in the list; it is only updated once.  Returns the number of
+ * bundles that changed as a result.
+ */
+int PartBundle::
+update_bundles(PartBundle *const *bundles, size_t num_bundles, bool force) {
+  PStatTimer timer(_update_bundles_pcollector);
+  Thread *current_thread = Thread::get_current_thread();
+  double now = ClockObject::get_global_clock()->get_frame_time(current_thread);
+
+  BatchUpdate batch(now, force);
+  batch._bundles.reserve(num_bundles);
+  for (size_t i = 0; i < num_bundles; ++i) {
+    PartBundle *bundle = bundles[i];
+    if (bundle != nullptr && (force || bundle->needs_update(now, current_thread))) {
+      batch._bundles.push_back(bundle);
+    }
+  }
+
+  // Two threads mustn't evaluate the same bundle at once.
+  std::sort(batch._bundles.begin(), batch._bundles.end());
+  batch._bundles.erase(std::unique(batch._bundles.begin(), batch._bundles.end()),
+                       batch._bundles.end());
+
+  AsyncTaskManager::get_global_ptr()->run_parallel("animation",
+    anim_update_num_threads, (int)batch._bundles.size(),
+    &BatchUpdate::run_func, &batch);
+
+  return (int)AtomicAdjust::get(batch._num_changed);
+}
 
 /**
  * Called by the AnimControl whenever it starts an animation.  This is just a
@@ -728,6 +920,63 @@ clear_and_stop_intersecting(AnimControl *control, CData *cdata) {
   }
 }
 
+/**
+ * Returns true if update() would have anything to do at the indicated frame
+ * time.
+ */
+bool PartBundle::
+needs_update(double now, Thread *current_thread) const {
+  double delay;
+  {
+    LightMutexHolder holder(_lod_lock);
+    if (_lod_changed) {
+      return true;
+    }
+    delay = std::max(_update_delay, _lod_update_delay);
+  }
+  CDReader cdata(_cycler, current_thread);
+  return now > cdata->_last_update + delay || cdata->_anim_changed;
+}
+
+/**
+ * The implementation of update() and force_update().  If force is false, the
+ * bundle is only updated if it hasn't been since the indicated frame time
+ * (allowing for the update delay), or if its animations have changed.
+ */
+bool PartBundle::
+do_update_bundle(double now, bool force, Thread *current_thread) {
+  // Hold the lod lock for the whole update, so that the level of detail
+  // can't change while the parts are being evaluated.
+  LightMutexHolder holder(_lod_lock);
+  CDWriter cdata(_cycler, false, current_thread);
+  double delay = std::max(_update_delay, _lod_update_delay);
+  if (!force && !_lod_changed &&
+      !(now > cdata->_last_update + delay || cdata->_anim_changed)) {
+    return false;
+  }
+
+  bool anim_changed = force || cdata->_anim_changed || _lod_changed;
+  bool frame_blend_flag = cdata->_frame_blend_flag;
+
+  bool any_changed = do_update(this, cdata, nullptr, force, anim_changed,
+                               current_thread);
+
+  // Now update all the controls for next time.
+  ChannelBlend::const_iterator cbi;
+  for (cbi = cdata->_blend.begin(); cbi != cdata->_blend.end(); ++cbi) {
+    AnimControl *control = (*cbi).first;
+    control->mark_channels(frame_blend_flag);
+  }
+
+  cdata->_anim_changed = false;
+  _lod_changed = false;
+  if (!force) {
+    cdata->_last_update = now;
+  }
+
+  return any_changed;
+}
+
 /**
  * Called by the BamReader to perform any final actions needed for setting up
  * the object after all objects have been read and all pointers have been
@@ -736,6 +985,7 @@ clear_and_stop_intersecting(AnimControl *control, CData *cdata) {
 void PartBundle::
 finalize(BamReader *) {
   Thread *current_thread = Thread::get_current_thread();
+  LightMutexHolder holder(_lod_lock);
   CDWriter cdata(_cycler, true);
   do_update(this, cdata, nullptr, true, true, current_thread);
 }
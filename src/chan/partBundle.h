@@ -31,6 +31,9 @@
 #include "transformState.h"
 #include "weakPointerTo.h"
 #include "copyOnWritePointer.h"
+#include "pStatCollector.h"
+#include "lightMutex.h"
+#include "lightMutexHolder.h"
 
 class Loader;
 class AnimBundle;
@@ -145,6 +148,17 @@ PUBLISHED:
   bool update();
   bool force_update();
 
+  void add_lod_level(PN_stdfloat distance, const PartSubset &subset,
+                     double update_delay = 0.0);
+  void clear_lod_levels();
+  INLINE int get_num_lod_levels() const;
+  INLINE PN_stdfloat get_lod_distance(int level) const;
+  void set_lod_level(int level);
+  INLINE int get_lod_level() const;
+  void set_lod_distance(PN_stdfloat distance);
+
+  MAKE_PROPERTY(lod_level, get_lod_level, set_lod_level);
+
 public:
   // The following functions aren't really part of the public interface;
   // they're just public so we don't have to declare a bunch of friends.
@@ -155,6 +169,9 @@ public:
   bool do_bind_anim(AnimControl *control, AnimBundle *anim,
                     int hierarchy_match_flags, const PartSubset &subset);
 
+  static int update_bundles(PartBundle *const *bundles, size_t num_bundles,
+                            bool force = false);
+
 protected:
   virtual void add_node(PartBundleNode *node);
   virtual void remove_node(PartBundleNode *node);
@@ -166,6 +183,12 @@ private:
   PN_stdfloat do_get_control_effect(AnimControl *control, const CData *cdata) const;
   void clear_and_stop_intersecting(AnimControl *control, CData *cdata);
 
+  bool needs_update(double now, Thread *current_thread) const;
+  bool do_update_bundle(double now, bool force, Thread *current_thread);
+  void do_set_lod_level(int level);
+
+  class BatchUpdate;
+
   COWPT(AnimPreloadTable) _anim_preload;
 
   typedef pvector<PartBundleNode *> Nodes;
@@ -174,8 +197,32 @@ private:
   typedef pmap<WCPT(TransformState), WPT(PartBundle), std::owner_less<WCPT(TransformState)> > AppliedTransforms;
   AppliedTransforms _applied_transforms;
 
+  // This protects _update_delay and the level-of-detail members below, as
+  // well as the _lod_frozen flags of the parts.  The cull thread changes the
+  // level of detail while the app thread may be updating the bundle.
+  mutable LightMutex _lod_lock;
+
   double _update_delay;
 
+  // The levels of detail added by add_lod_level(), sorted by distance.
+  // Level 0, full detail, is implicit and is not stored here.
+  class LODLevel {
+  public:
+    PN_stdfloat _distance;
+    PartSubset _subset;
+    double _update_delay;
+  };
+  typedef pvector<LODLevel> LODLevels;
+  LODLevels _lod_levels;
+  int _lod_level;
+  double _lod_update_delay;
+
+  // Set when the level of detail changes, so that the next update
+  // re-evaluates the parts that have just been unfrozen.  This isn't cycled,
+  // since the level of detail is usually changed from the cull thread, and
+  // the update happens on the app thread.
+  bool _lod_changed;
+
   // This is the data that must be cycled between pipeline stages.
   class CData : public CycleData {
   public:
@@ -205,6 +252,9 @@ private:
   typedef CycleDataWriter<CData> CDWriter;
   typedef CycleDataStageWriter<CData> CDStageWriter;
 
+  static PStatCollector _update_bundles_pcollector;
+  static PStatCollector _bundle_pcollector;
+
 public:
   static void register_with_read_factory();
   virtual void finalize(BamReader *manager);
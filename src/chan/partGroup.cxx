@@ -621,6 +621,27 @@ find_bound_joints(int &joint_index, bool is_included, BitArray &bound_joints,
   }
 }
 
+/**
+ * Called by PartBundle::set_lod_level() to mark each of the parts that is not
+ * included in the indicated subset as frozen, so that it is not animated
+ * while that level is in effect.  The subset is interpreted in the same way
+ * as for bind_hierarchy().
+ */
+void PartGroup::
+apply_lod_subset(bool is_included, const PartSubset &subset) {
+  if (subset.matches_include(get_name())) {
+    is_included = true;
+  } else if (subset.matches_exclude(get_name())) {
+    is_included = false;
+  }
+
+  int part_num_children = get_num_children();
+  for (int i = 0; i < part_num_children; ++i) {
+    PartGroup *pc = get_child(i);
+    pc->apply_lod_subset(is_included, subset);
+  }
+}
+
 /**
  * Function to write the important information in the particular object to a
  * Datagram
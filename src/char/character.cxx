@@ -15,6 +15,7 @@
 #include "characterJoint.h"
 #include "config_char.h"
 #include "nodePath.h"
+#include "nodePathCollection.h"
 #include "geomNode.h"
 #include "datagram.h"
 #include "datagramIterator.h"
@@ -28,6 +29,8 @@
 #include "cullTraverser.h"
 #include "cullTraverserData.h"
 
+#include <algorithm>
+
 TypeHandle Character::_type_handle;
 
 PStatCollector Character::_animation_pcollector("*:Animation");
@@ -168,7 +171,8 @@ cull_callback(CullTraverser *trav, CullTraverserData &data) {
   // We may need a better way to do this optimization later, to handle
   // characters that might animate themselves in front of the view frustum.
 
-  if (_do_lod_animation) {
+  bool do_bundle_lod = has_bundle_lod_levels();
+  if (_do_lod_animation || do_bundle_lod) {
     int this_frame = ClockObject::get_global_clock()->get_frame_count();
 
     CPT(TransformState) rel_transform = get_rel_transform(trav, data);
@@ -182,12 +186,17 @@ cull_callback(CullTraverser *trav, CullTraverserData &data) {
       // Now compute the lod delay.
       PN_stdfloat dist = sqrt(dist2);
       double delay = 0.0;
-      if (dist > _lod_near_distance) {
+      if (_do_lod_animation && dist > _lod_near_distance) {
         delay = _lod_delay_factor * (dist - _lod_near_distance) / (_lod_far_distance - _lod_near_distance);
         nassertr(delay > 0.0, false);
       }
       set_lod_current_delay(delay);
 
+      // Also let the bundles choose their level of detail.
+      if (do_bundle_lod) {
+        set_lod_current_distance(dist);
+      }
+
       if (char_cat.is_spam()) {
         char_cat.spam()
           << "Distance to " << NodePath::any_path(this) << " in frame "
@@ -434,6 +443,63 @@ force_update() {
   }
 }
 
+/**
+ * Recalculates the joints and sliders of all of the indicated Characters for
+ * the current frame, as if update() were called on each one.  Rather than
+ * evaluating them one at a time, the bundles of all of the Characters that
+ * haven't yet been updated this frame are handed to
+ * PartBundle::update_bundles(), which spreads them across several threads.
+ * Paths that don't refer to a Character are ignored.
+ *
+ * Calling this once per frame, before rendering, with all of the animated
+ * Characters in the scene allows the animation cost to scale with the number
+ * of CPU cores.  The cull traversal will then find them already up-to-date.
+ */
+void Character::
+update_all(const NodePathCollection &characters) {
+  pvector<Character *> chars;
+  chars.reserve(characters.get_num_paths());
+  for (int i = 0; i < characters.get_num_paths(); ++i) {
+    const NodePath &path = characters.get_path(i);
+    if (!path.is_empty() && path.node()->is_of_type(Character::get_class_type())) {
+      chars.push_back(DCAST(Character, path.node()));
+    }
+  }
+
+  // We hold the lock of each Character while its bundles are being updated,
+  // so that another thread calling update() waits for the result.  Sort them
+  // so that the locks are always acquired in the same order.
+  std::sort(chars.begin(), chars.end());
+  chars.erase(std::unique(chars.begin(), chars.end()), chars.end());
+
+  double now = ClockObject::get_global_clock()->get_frame_time();
+  pvector<PartBundle *> bundles;
+  for (Character *character : chars) {
+    character->_lock.acquire();
+    if (character->_last_auto_update != now) {
+      character->_last_auto_update = now;
+
+      if (char_cat.is_spam()) {
+        char_cat.spam()
+          << "Animating " << NodePath::any_path(character)
+          << " at time " << now << "\n";
+      }
+
+      for (PartBundleHandle *handle : character->_bundles) {
+        bundles.push_back(handle->get_bundle());
+      }
+    }
+  }
+
+  if (!bundles.empty()) {
+    PartBundle::update_bundles(&bundles[0], bundles.size(), even_animation);
+  }
+
+  for (Character *character : chars) {
+    character->_lock.release();
+  }
+}
+
 /**
  * This is called by r_copy_subgraph(); the copy has already been made of this
  * particular node (and this is the copy); this function's job is to copy all
@@ -565,6 +631,33 @@ set_lod_current_delay(double delay) {
   }
 }
 
+/**
+ * Returns true if any of the bundles has levels of detail defined via
+ * PartBundle::add_lod_level().
+ */
+bool Character::
+has_bundle_lod_levels() const {
+  LightMutexHolder holder(_lock);
+  for (PartBundleHandle *handle : _bundles) {
+    if (handle->get_bundle()->get_num_lod_levels() > 1) {
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * Tells each of the bundles the current distance of the character from the
+ * camera, so that it may choose the appropriate level of detail.
+ */
+void Character::
+set_lod_current_distance(PN_stdfloat distance) {
+  LightMutexHolder holder(_lock);
+  for (PartBundleHandle *handle : _bundles) {
+    handle->get_bundle()->set_lod_distance(distance);
+  }
+}
+
 /**
  * After the joint hierarchy has already been copied from the indicated
  * hierarchy, this recursively walks through the joints and builds up a
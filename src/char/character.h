@@ -30,6 +30,7 @@
 #include "sliderTable.h"
 
 class CharacterJointBundle;
+class NodePathCollection;
 
 /**
  * An animated character, with skeleton-morph animation and either soft-
@@ -77,6 +78,8 @@ PUBLISHED:
   void update();
   void force_update();
 
+  static void update_all(const NodePathCollection &characters);
+
 protected:
   virtual void r_copy_children(const PandaNode *from, InstanceMap &inst_map,
                                Thread *current_thread);
@@ -87,6 +90,8 @@ protected:
 private:
   void do_update();
   void set_lod_current_delay(double delay);
+  bool has_bundle_lod_levels() const;
+  void set_lod_current_distance(PN_stdfloat distance);
 
   typedef pmap<const PandaNode *, PandaNode *> NodeMap;
   typedef pmap<const PartGroup *, PartGroup *> JointMap;
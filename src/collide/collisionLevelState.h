@@ -46,7 +46,8 @@ public:
   INLINE void prepare_collider(const ColliderDef &def, const NodePath &root);
 
   bool any_in_bounds();
-  MaskType get_child_mask(const PandaNode::DownConnection &child) const;
+  MaskType get_child_mask(const PandaNode::DownConnection &child,
+                          int *node_volume_level = nullptr) const;
   bool apply_transform();
 
   INLINE static bool has_max_colliders();
@@ -35,6 +35,8 @@
 #include "nodePath.h"
 #include "pStatTimer.h"
 #include "indent.h"
+#include "asyncTaskManager.h"
+#include "atomicAdjust.h"
 
 #include <algorithm>
 
@@ -46,8 +48,73 @@ PStatCollector CollisionTraverser::_cnode_volume_pcollector("Collision Volumes:C
 PStatCollector CollisionTraverser::_gnode_volume_pcollector("Collision Volumes:GeomNode");
 PStatCollector CollisionTraverser::_geom_volume_pcollector("Collision Volumes:Geom");
 
+PStatCollector CollisionTraverser::_parallel_pcollector("App:Collisions:Parallel");
+PStatCollector CollisionTraverser::_dispatch_pcollector("App:Collisions:Parallel:Dispatch");
+
 TypeHandle CollisionTraverser::_type_handle;
 
+/**
+ * One unit of work of a parallel traversal.  This is either a subtree that is
+ * to be traversed by a worker thread, or a single node above the split depth
+ * that has already been visited by the calling thread.  Either way, the
+ * detected collisions are stored in _deferred.
+ */
+template<class LevelState>
+class CollisionTraverser::TraverseJob {
+public:
+  TraverseJob(const LevelState &level_state, size_t pass, bool has_subtree) :
+    _level_state(level_state),
+    _pass(pass),
+    _has_subtree(has_subtree)
+  {
+  }
+
+  LevelState _level_state;
+  size_t _pass;
+  bool _has_subtree;
+  DeferredEntries _deferred;
+};
+
+/**
+ * The list of subtree jobs shared between the threads taking part in a
+ * parallel traversal.  Each thread repeatedly claims the next unclaimed job
+ * until none are left.
+ */
+template<class LevelState>
+class CollisionTraverser::JobQueue {
+public:
+  typedef void (CollisionTraverser::*TraverseFunc)
+    (LevelState &, size_t, DeferredEntries *,
+     pdeque<TraverseJob<LevelState> > *, int);
+
+  JobQueue(CollisionTraverser *trav, TraverseFunc traverse_func) :
+    _trav(trav),
+    _traverse_func(traverse_func),
+    _next_job(0)
+  {
+  }
+
+  void run() {
+    AtomicAdjust::Integer num_jobs = (AtomicAdjust::Integer)_jobs.size();
+    AtomicAdjust::Integer i = AtomicAdjust::add(_next_job, 1) - 1;
+    while (i < num_jobs) {
+      TraverseJob<LevelState> *job = _jobs[i];
+      (_trav->*_traverse_func)(job->_level_state, job->_pass, &job->_deferred,
+                               nullptr, 0);
+      i = AtomicAdjust::add(_next_job, 1) - 1;
+    }
+  }
+
+  static void run_func(void *data) {
+    ((JobQueue<LevelState> *)data)->run();
+  }
+
+  CollisionTraverser *_trav;
+  TraverseFunc _traverse_func;
+  pvector<TraverseJob<LevelState> *> _jobs;
+  AtomicAdjust::Integer _next_job;
+};
+
 // This function object class is used in prepare_colliders(), below.
 class SortByColliderSort {
 public:
@@ -74,6 +141,7 @@ CollisionTraverser(const std::string &name) :
   _this_pcollector(_collisions_pcollector, name)
 {
   _respect_prev_transform = respect_prev_transform;
+  _parallel = parallel_collision_traversal;
   #ifdef DO_COLLISION_RECORDING
   _recorder = nullptr;
   #endif
@@ -271,6 +339,9 @@ traverse(const NodePath &root) {
     (*hi).first->begin_group();
   }
 
+  bool parallel = can_traverse_parallel();
+  int split_depth = std::max((int)collide_parallel_split_depth, 0);
+
   bool traversal_done = false;
   if ((int)_colliders.size() <= CollisionLevelStateSingle::get_max_colliders() ||
       !allow_collider_multiple) {
@@ -284,14 +355,22 @@ traverse(const NodePath &root) {
 
       // Make a number of passes, one for each group of 32 Colliders (or
       // whatever number of bits we have available in CurrentMask).
+      JobsSingle jobs;
       for (size_t pass = 0; pass < level_states.size(); ++pass) {
 #ifdef DO_PSTATS
         PStatTimer pass_timer(get_pass_collector(pass));
 #endif
         if (level_states[pass].any_in_bounds()) {
-          r_traverse_single(level_states[pass], pass);
+          if (parallel) {
+            r_traverse_single(level_states[pass], pass, nullptr, &jobs, split_depth);
+          } else {
+            r_traverse_single(level_states[pass], pass);
+          }
         }
       }
+      if (parallel) {
+        run_jobs(jobs, &CollisionTraverser::r_traverse_single);
+      }
     }
   }
 
@@ -304,11 +383,19 @@ traverse(const NodePath &root) {
     if (level_states.size() == 1) {
       traversal_done = true;
 
+      JobsDouble jobs;
       for (size_t pass = 0; pass < level_states.size(); ++pass) {
 #ifdef DO_PSTATS
         PStatTimer pass_timer(get_pass_collector(pass));
 #endif
-        r_traverse_double(level_states[pass], pass);
+        if (parallel) {
+          r_traverse_double(level_states[pass], pass, nullptr, &jobs, split_depth);
+        } else {
+          r_traverse_double(level_states[pass], pass);
+        }
+      }
+      if (parallel) {
+        run_jobs(jobs, &CollisionTraverser::r_traverse_double);
       }
     }
   }
@@ -320,11 +407,19 @@ traverse(const NodePath &root) {
 
     traversal_done = true;
 
+    JobsQuad jobs;
     for (size_t pass = 0; pass < level_states.size(); ++pass) {
 #ifdef DO_PSTATS
       PStatTimer pass_timer(get_pass_collector(pass));
 #endif
-      r_traverse_quad(level_states[pass], pass);
+      if (parallel) {
+        r_traverse_quad(level_states[pass], pass, nullptr, &jobs, split_depth);
+      } else {
+        r_traverse_quad(level_states[pass], pass);
+      }
+    }
+    if (parallel) {
+      run_jobs(jobs, &CollisionTraverser::r_traverse_quad);
     }
   }
 
@@ -560,10 +655,28 @@ prepare_colliders_single(CollisionTraverser::LevelStatesSingle &level_states,
 }
 
 /**
- *
+ * Recursively traverses the scene graph below the indicated level.  If jobs
+ * is non-NULL, this is the first stage of a parallel traversal: nodes above
+ * split_depth are visited directly (with their results stored in a job of
+ * their own, to preserve the traversal order), and each subtree rooted at
+ * split_depth is added to the jobs list to be traversed later.
  */
 void CollisionTraverser::
-r_traverse_single(CollisionLevelStateSingle &level_state, size_t pass) {
+r_traverse_single(CollisionLevelStateSingle &level_state, size_t pass,
+                  DeferredEntries *deferred, JobsSingle *jobs, int split_depth) {
+  if (jobs != nullptr) {
+    if (split_depth <= 0) {
+      // This subtree will be traversed by one of the worker threads.  Its
+      // WorkingNodePath refers to our stack frame, so it has to be rebuilt
+      // from a full NodePath first.
+      jobs->push_back(TraverseJob<CollisionLevelStateSingle>(level_state, pass, true));
+      jobs->back()._level_state._node_path = WorkingNodePath(level_state.get_node_path());
+      return;
+    }
+    jobs->push_back(TraverseJob<CollisionLevelStateSingle>(level_state, pass, false));
+    deferred = &jobs->back()._deferred;
+  }
+
   if (!level_state.apply_transform()) {
     return;
   }
@@ -597,7 +710,8 @@ r_traverse_single(CollisionLevelStateSingle &level_state, size_t pass) {
               entry,
               level_state.get_parent_bound(c),
               level_state.get_local_bound(c),
-              level_state.get_node_bound());
+              level_state.get_node_bound(),
+              deferred);
         }
       }
     }
@@ -636,7 +750,8 @@ r_traverse_single(CollisionLevelStateSingle &level_state, size_t pass) {
               entry,
               level_state.get_parent_bound(c),
               level_state.get_local_bound(c),
-              level_state.get_node_bound());
+              level_state.get_node_bound(),
+              deferred);
         }
       }
     }
@@ -649,10 +764,11 @@ r_traverse_single(CollisionLevelStateSingle &level_state, size_t pass) {
     PandaNode::Children children = node->get_children();
     if (index >= 0 && index < children.get_num_children()) {
       const PandaNode::DownConnection &child = children.get_child_connection(index);
-      CollisionLevelStateSingle::CurrentMask mask = level_state.get_child_mask(child);
+      CollisionLevelStateSingle::CurrentMask mask =
+        level_state.get_child_mask(child, get_node_volume_level(deferred));
       if (!mask.is_zero()) {
         CollisionLevelStateSingle next_state(level_state, child, mask);
-        r_traverse_single(next_state, pass);
+        r_traverse_single(next_state, pass, deferred, jobs, split_depth - 1);
       }
     }
 
@@ -667,14 +783,15 @@ r_traverse_single(CollisionLevelStateSingle &level_state, size_t pass) {
     int num_children = children.get_num_children();
     for (int i = 0; i < num_children; ++i) {
       const PandaNode::DownConnection &child = children.get_child_connection(i);
-      CollisionLevelStateSingle::CurrentMask mask = level_state.get_child_mask(child);
+      CollisionLevelStateSingle::CurrentMask mask =
+        level_state.get_child_mask(child, get_node_volume_level(deferred));
       if (!mask.is_zero()) {
         CollisionLevelStateSingle next_state(level_state, child, mask);
         if (i != index) {
           next_state.set_include_mask(next_state.get_include_mask() &
             ~GeomNode::get_default_collide_mask());
         }
-        r_traverse_single(next_state, pass);
+        r_traverse_single(next_state, pass, deferred, jobs, split_depth - 1);
       }
     }
 
@@ -684,10 +801,11 @@ r_traverse_single(CollisionLevelStateSingle &level_state, size_t pass) {
     int num_children = children.get_num_children();
     for (int i = 0; i < num_children; ++i) {
       const PandaNode::DownConnection &child = children.get_child_connection(i);
-      CollisionLevelStateSingle::CurrentMask mask = level_state.get_child_mask(child);
+      CollisionLevelStateSingle::CurrentMask mask =
+        level_state.get_child_mask(child, get_node_volume_level(deferred));
       if (!mask.is_zero()) {
         CollisionLevelStateSingle next_state(level_state, child, mask);
-        r_traverse_single(next_state, pass);
+        r_traverse_single(next_state, pass, deferred, jobs, split_depth - 1);
       }
     }
   }
@@ -770,10 +888,28 @@ prepare_colliders_double(CollisionTraverser::LevelStatesDouble &level_states,
 }
 
 /**
- *
+ * Recursively traverses the scene graph below the indicated level.  If jobs
+ * is non-NULL, this is the first stage of a parallel traversal: nodes above
+ * split_depth are visited directly (with their results stored in a job of
+ * their own, to preserve the traversal order), and each subtree rooted at
+ * split_depth is added to the jobs list to be traversed later.
  */
 void CollisionTraverser::
-r_traverse_double(CollisionLevelStateDouble &level_state, size_t pass) {
+r_traverse_double(CollisionLevelStateDouble &level_state, size_t pass,
+                  DeferredEntries *deferred, JobsDouble *jobs, int split_depth) {
+  if (jobs != nullptr) {
+    if (split_depth <= 0) {
+      // This subtree will be traversed by one of the worker threads.  Its
+      // WorkingNodePath refers to our stack frame, so it has to be rebuilt
+      // from a full NodePath first.
+      jobs->push_back(TraverseJob<CollisionLevelStateDouble>(level_state, pass, true));
+      jobs->back()._level_state._node_path = WorkingNodePath(level_state.get_node_path());
+      return;
+    }
+    jobs->push_back(TraverseJob<CollisionLevelStateDouble>(level_state, pass, false));
+    deferred = &jobs->back()._deferred;
+  }
+
   if (!level_state.apply_transform()) {
     return;
   }
@@ -806,7 +942,8 @@ r_traverse_double(CollisionLevelStateDouble &level_state, size_t pass) {
               entry,
               level_state.get_parent_bound(c),
               level_state.get_local_bound(c),
-              level_state.get_node_bound());
+              level_state.get_node_bound(),
+              deferred);
         }
       }
     }
@@ -845,7 +982,8 @@ r_traverse_double(CollisionLevelStateDouble &level_state, size_t pass) {
               entry,
               level_state.get_parent_bound(c),
               level_state.get_local_bound(c),
-              level_state.get_node_bound());
+              level_state.get_node_bound(),
+              deferred);
         }
       }
     }
@@ -858,10 +996,11 @@ r_traverse_double(CollisionLevelStateDouble &level_state, size_t pass) {
     PandaNode::Children children = node->get_children();
     if (index >= 0 && index < children.get_num_children()) {
       const PandaNode::DownConnection &child = children.get_child_connection(index);
-      CollisionLevelStateDouble::CurrentMask mask = level_state.get_child_mask(child);
+      CollisionLevelStateDouble::CurrentMask mask =
+        level_state.get_child_mask(child, get_node_volume_level(deferred));
       if (!mask.is_zero()) {
         CollisionLevelStateDouble next_state(level_state, child, mask);
-        r_traverse_double(next_state, pass);
+        r_traverse_double(next_state, pass, deferred, jobs, split_depth - 1);
       }
     }
 
@@ -876,14 +1015,15 @@ r_traverse_double(CollisionLevelStateDouble &level_state, size_t pass) {
     int num_children = children.get_num_children();
     for (int i = 0; i < num_children; ++i) {
       const PandaNode::DownConnection &child = children.get_child_connection(i);
-      CollisionLevelStateDouble::CurrentMask mask = level_state.get_child_mask(child);
+      CollisionLevelStateDouble::CurrentMask mask =
+        level_state.get_child_mask(child, get_node_volume_level(deferred));
       if (!mask.is_zero()) {
         CollisionLevelStateDouble next_state(level_state, child, mask);
         if (i != index) {
           next_state.set_include_mask(next_state.get_include_mask() &
             ~GeomNode::get_default_collide_mask());
         }
-        r_traverse_double(next_state, pass);
+        r_traverse_double(next_state, pass, deferred, jobs, split_depth - 1);
       }
     }
 
@@ -893,10 +1033,11 @@ r_traverse_double(CollisionLevelStateDouble &level_state, size_t pass) {
     int num_children = children.get_num_children();
     for (int i = 0; i < num_children; ++i) {
       const PandaNode::DownConnection &child = children.get_child_connection(i);
-      CollisionLevelStateDouble::CurrentMask mask = level_state.get_child_mask(child);
+      CollisionLevelStateDouble::CurrentMask mask =
+        level_state.get_child_mask(child, get_node_volume_level(deferred));
       if (!mask.is_zero()) {
         CollisionLevelStateDouble next_state(level_state, child, mask);
-        r_traverse_double(next_state, pass);
+        r_traverse_double(next_state, pass, deferred, jobs, split_depth - 1);
       }
     }
   }
@@ -979,10 +1120,28 @@ prepare_colliders_quad(CollisionTraverser::LevelStatesQuad &level_states,
 }
 
 /**
- *
+ * Recursively traverses the scene graph below the indicated level.  If jobs
+ * is non-NULL, this is the first stage of a parallel traversal: nodes above
+ * split_depth are visited directly (with their results stored in a job of
+ * their own, to preserve the traversal order), and each subtree rooted at
+ * split_depth is added to the jobs list to be traversed later.
  */
 void CollisionTraverser::
-r_traverse_quad(CollisionLevelStateQuad &level_state, size_t pass) {
+r_traverse_quad(CollisionLevelStateQuad &level_state, size_t pass,
+                DeferredEntries *deferred, JobsQuad *jobs, int split_depth) {
+  if (jobs != nullptr) {
+    if (split_depth <= 0) {
+      // This subtree will be traversed by one of the worker threads.  Its
+      // WorkingNodePath refers to our stack frame, so it has to be rebuilt
+      // from a full NodePath first.
+      jobs->push_back(TraverseJob<CollisionLevelStateQuad>(level_state, pass, true));
+      jobs->back()._level_state._node_path = WorkingNodePath(level_state.get_node_path());
+      return;
+    }
+    jobs->push_back(TraverseJob<CollisionLevelStateQuad>(level_state, pass, false));
+    deferred = &jobs->back()._deferred;
+  }
+
   if (!level_state.apply_transform()) {
     return;
   }
@@ -1015,7 +1174,8 @@ r_traverse_quad(CollisionLevelStateQuad &level_state, size_t pass) {
               entry,
               level_state.get_parent_bound(c),
               level_state.get_local_bound(c),
-              level_state.get_node_bound());
+              level_state.get_node_bound(),
+              deferred);
         }
       }
     }
@@ -1054,7 +1214,8 @@ r_traverse_quad(CollisionLevelStateQuad &level_state, size_t pass) {
               entry,
               level_state.get_parent_bound(c),
               level_state.get_local_bound(c),
-              level_state.get_node_bound());
+              level_state.get_node_bound(),
+              deferred);
         }
       }
     }
@@ -1067,10 +1228,11 @@ r_traverse_quad(CollisionLevelStateQuad &level_state, size_t pass) {
     PandaNode::Children children = node->get_children();
     if (index >= 0 && index < children.get_num_children()) {
       const PandaNode::DownConnection &child = children.get_child_connection(index);
-      CollisionLevelStateQuad::CurrentMask mask = level_state.get_child_mask(child);
+      CollisionLevelStateQuad::CurrentMask mask =
+        level_state.get_child_mask(child, get_node_volume_level(deferred));
       if (!mask.is_zero()) {
         CollisionLevelStateQuad next_state(level_state, child, mask);
-        r_traverse_quad(next_state, pass);
+        r_traverse_quad(next_state, pass, deferred, jobs, split_depth - 1);
       }
     }
 
@@ -1085,14 +1247,15 @@ r_traverse_quad(CollisionLevelStateQuad &level_state, size_t pass) {
     int num_children = children.get_num_children();
     for (int i = 0; i < num_children; ++i) {
       const PandaNode::DownConnection &child = children.get_child_connection(i);
-      CollisionLevelStateQuad::CurrentMask mask = level_state.get_child_mask(child);
+      CollisionLevelStateQuad::CurrentMask mask =
+        level_state.get_child_mask(child, get_node_volume_level(deferred));
       if (!mask.is_zero()) {
         CollisionLevelStateQuad next_state(level_state, child, mask);
         if (i != index) {
           next_state.set_include_mask(next_state.get_include_mask() &
             ~GeomNode::get_default_collide_mask());
         }
-        r_traverse_quad(next_state, pass);
+        r_traverse_quad(next_state, pass, deferred, jobs, split_depth - 1);
       }
     }
 
@@ -1102,10 +1265,11 @@ r_traverse_quad(CollisionLevelStateQuad &level_state, size_t pass) {
     int num_children = children.get_num_children();
     for (int i = 0; i < num_children; ++i) {
       const PandaNode::DownConnection &child = children.get_child_connection(i);
-      CollisionLevelStateQuad::CurrentMask mask = level_state.get_child_mask(child);
+      CollisionLevelStateQuad::CurrentMask mask =
+        level_state.get_child_mask(child, get_node_volume_level(deferred));
       if (!mask.is_zero()) {
         CollisionLevelStateQuad next_state(level_state, child, mask);
-        r_traverse_quad(next_state, pass);
+        r_traverse_quad(next_state, pass, deferred, jobs, split_depth - 1);
       }
     }
   }
@@ -1118,12 +1282,13 @@ void CollisionTraverser::
 compare_collider_to_node(CollisionEntry &entry,
                          const GeometricBoundingVolume *from_parent_gbv,
                          const GeometricBoundingVolume *from_node_gbv,
-                         const GeometricBoundingVolume *into_node_gbv) {
+                         const GeometricBoundingVolume *into_node_gbv,
+                         DeferredEntries *deferred) {
   bool within_node_bounds = true;
   if (from_parent_gbv != nullptr &&
       into_node_gbv != nullptr) {
     within_node_bounds = (into_node_gbv->contains(from_parent_gbv) != 0);
-    _cnode_volume_pcollector.add_level(1);
+    add_level(_cnode_volume_pcollector, deferred);
   }
 
   if (within_node_bounds) {
@@ -1148,7 +1313,7 @@ compare_collider_to_node(CollisionEntry &entry,
       Colliders::const_iterator ci;
       ci = _colliders.find(entry.get_from_node_path());
       nassertv(ci != _colliders.end());
-      entry.test_intersection((*ci).second, this);
+      test_intersection(entry, (*ci).second, deferred);
     } else {
       CollisionNode::Solids::const_iterator si;
       for (si = cnode->_solids.begin(); si != cnode->_solids.end(); ++si) {
@@ -1161,7 +1326,7 @@ compare_collider_to_node(CollisionEntry &entry,
         CPT(BoundingVolume) solid_bv = entry._into->get_bounds();
         const GeometricBoundingVolume *solid_gbv = solid_bv->as_geometric_bounding_volume();
 
-        compare_collider_to_solid(entry, from_node_gbv, solid_gbv);
+        compare_collider_to_solid(entry, from_node_gbv, solid_gbv, deferred);
       }
     }
   }
@@ -1174,12 +1339,13 @@ void CollisionTraverser::
 compare_collider_to_geom_node(CollisionEntry &entry,
                               const GeometricBoundingVolume *from_parent_gbv,
                               const GeometricBoundingVolume *from_node_gbv,
-                              const GeometricBoundingVolume *into_node_gbv) {
+                              const GeometricBoundingVolume *into_node_gbv,
+                         DeferredEntries *deferred) {
   bool within_node_bounds = true;
   if (from_parent_gbv != nullptr &&
       into_node_gbv != nullptr) {
     within_node_bounds = (into_node_gbv->contains(from_parent_gbv) != 0);
-    _gnode_volume_pcollector.add_level(1);
+    add_level(_gnode_volume_pcollector, deferred);
   }
 
   if (within_node_bounds) {
@@ -1201,7 +1367,7 @@ compare_collider_to_geom_node(CollisionEntry &entry,
           geom_gbv = geom_bv->as_geometric_bounding_volume();
         }
 
-        compare_collider_to_geom(entry, geom, from_node_gbv, geom_gbv);
+        compare_collider_to_geom(entry, geom, from_node_gbv, geom_gbv, deferred);
       }
     }
   }
@@ -1213,13 +1379,14 @@ compare_collider_to_geom_node(CollisionEntry &entry,
 void CollisionTraverser::
 compare_collider_to_solid(CollisionEntry &entry,
                           const GeometricBoundingVolume *from_node_gbv,
-                          const GeometricBoundingVolume *solid_gbv) {
+                          const GeometricBoundingVolume *solid_gbv,
+                          DeferredEntries *deferred) {
   bool within_solid_bounds = true;
   if (from_node_gbv != nullptr &&
       solid_gbv != nullptr) {
     within_solid_bounds = (solid_gbv->contains(from_node_gbv) != 0);
     #ifdef DO_PSTATS
-    ((CollisionSolid *)entry.get_into())->get_volume_pcollector().add_level(1);
+    add_level(((CollisionSolid *)entry.get_into())->get_volume_pcollector(), deferred);
     #endif  // DO_PSTATS
 #ifndef NDEBUG
     if (collide_cat.is_spam()) {
@@ -1234,7 +1401,7 @@ compare_collider_to_solid(CollisionEntry &entry,
     Colliders::const_iterator ci;
     ci = _colliders.find(entry.get_from_node_path());
     nassertv(ci != _colliders.end());
-    entry.test_intersection((*ci).second, this);
+    test_intersection(entry, (*ci).second, deferred);
   }
 }
 
@@ -1244,12 +1411,13 @@ compare_collider_to_solid(CollisionEntry &entry,
 void CollisionTraverser::
 compare_collider_to_geom(CollisionEntry &entry, const Geom *geom,
                          const GeometricBoundingVolume *from_node_gbv,
-                         const GeometricBoundingVolume *geom_gbv) {
+                         const GeometricBoundingVolume *geom_gbv,
+                         DeferredEntries *deferred) {
   bool within_geom_bounds = true;
   if (from_node_gbv != nullptr &&
       geom_gbv != nullptr) {
     within_geom_bounds = (geom_gbv->contains(from_node_gbv) != 0);
-    _geom_volume_pcollector.add_level(1);
+    add_level(_geom_volume_pcollector, deferred);
   }
   if (within_geom_bounds) {
     Colliders::const_iterator ci;
@@ -1289,13 +1457,13 @@ compare_collider_to_geom(CollisionEntry &entry, const Geom *geom,
                 sphere.around(v, v + 3);
                 within_solid_bounds = (sphere.contains(from_node_gbv) != 0);
 #ifdef DO_PSTATS
-                CollisionGeom::_volume_pcollector.add_level(1);
+                add_level(CollisionGeom::_volume_pcollector, deferred);
 #endif  // DO_PSTATS
               }
               if (within_solid_bounds) {
                 PT(CollisionGeom) cgeom = new CollisionGeom(v[0], v[1], v[2]);
                 entry._into = cgeom;
-                entry.test_intersection((*ci).second, this);
+                test_intersection(entry, (*ci).second, deferred);
               }
             }
           }
@@ -1319,13 +1487,13 @@ compare_collider_to_geom(CollisionEntry &entry, const Geom *geom,
                 sphere.around(v, v + 3);
                 within_solid_bounds = (sphere.contains(from_node_gbv) != 0);
 #ifdef DO_PSTATS
-                CollisionGeom::_volume_pcollector.add_level(1);
+                add_level(CollisionGeom::_volume_pcollector, deferred);
 #endif  // DO_PSTATS
               }
               if (within_solid_bounds) {
                 PT(CollisionGeom) cgeom = new CollisionGeom(v[0], v[1], v[2]);
                 entry._into = cgeom;
-                entry.test_intersection((*ci).second, this);
+                test_intersection(entry, (*ci).second, deferred);
               }
             }
           }
@@ -1388,6 +1556,150 @@ remove_handler(CollisionTraverser::Handlers::iterator hi) {
   return hi;
 }
 
+/**
+ * Returns true if the next call to traverse() may be performed in parallel.
+ */
+bool CollisionTraverser::
+can_traverse_parallel() const {
+  if (!_parallel || collide_num_threads <= 0 ||
+      !Thread::is_threading_supported()) {
+    return false;
+  }
+#ifdef DO_COLLISION_RECORDING
+  // The recorder is not prepared to be called from multiple threads.
+  if (has_recorder()) {
+    return false;
+  }
+#endif
+  return true;
+}
+
+/**
+ * Traverses all of the subtrees in the indicated list of jobs, spread across
+ * the calling thread and the threads of the "collide" task chain, and then
+ * passes the collected entries on to the handlers in the order in which they
+ * appear in the list, which is the order the serial traversal would have
+ * produced them in.
+ */
+template<class LevelState>
+void CollisionTraverser::
+run_jobs(pdeque<TraverseJob<LevelState> > &jobs,
+         void (CollisionTraverser::*traverse_func)
+           (LevelState &, size_t, DeferredEntries *,
+            pdeque<TraverseJob<LevelState> > *, int)) {
+  {
+    PStatTimer timer(_parallel_pcollector);
+
+    JobQueue<LevelState> queue(this, traverse_func);
+    typename pdeque<TraverseJob<LevelState> >::iterator ji;
+    for (ji = jobs.begin(); ji != jobs.end(); ++ji) {
+      if ((*ji)._has_subtree) {
+        queue._jobs.push_back(&(*ji));
+      }
+    }
+
+    AsyncTaskManager::get_global_ptr()->run_parallel
+      ("collide", collide_num_threads, (int)queue._jobs.size(),
+       &JobQueue<LevelState>::run_func, &queue);
+  }
+
+  PStatTimer timer(_dispatch_pcollector);
+  typename pdeque<TraverseJob<LevelState> >::const_iterator ji;
+  for (ji = jobs.begin(); ji != jobs.end(); ++ji) {
+    for (const DeferredEntry &def : (*ji)._deferred._entries) {
+      def._handler->add_entry(def._entry);
+    }
+    (*ji)._deferred.flush_levels();
+  }
+}
+
+/**
+ * Performs the intersection test for the indicated entry.  If deferred is
+ * NULL, the result is passed to the handler immediately; otherwise it is
+ * appended to the deferred list, to be passed on after the parallel
+ * traversal has completed.
+ */
+void CollisionTraverser::
+test_intersection(const CollisionEntry &entry, CollisionHandler *handler,
+                  DeferredEntries *deferred) const {
+  if (deferred == nullptr) {
+    entry.test_intersection(handler, this);
+  } else {
+    PT(CollisionEntry) result = entry.compute_intersection(handler, this);
+#ifdef DO_PSTATS
+    deferred->add_level(((CollisionSolid *)entry.get_into())->get_test_pcollector());
+#endif  // DO_PSTATS
+    if (result != nullptr) {
+      DeferredEntry def;
+      def._handler = handler;
+      def._entry = std::move(result);
+      deferred->_entries.push_back(std::move(def));
+    }
+  }
+}
+
+/**
+ * Counts one bounding volume test against the indicated collector.  If
+ * deferred is not NULL, the count is tallied there instead, to be added to
+ * the collector by the calling thread once the parallel traversal is done.
+ */
+void CollisionTraverser::
+add_level(PStatCollector &collector, DeferredEntries *deferred) {
+  if (deferred == nullptr) {
+    collector.add_level(1);
+  } else {
+    deferred->add_level(collector);
+  }
+}
+
+/**
+ * Returns the counter that get_child_mask() should tally its bounding volume
+ * tests in, or NULL if it should count them directly.
+ */
+int *CollisionTraverser::
+get_node_volume_level(DeferredEntries *deferred) {
+#ifdef DO_PSTATS
+  if (deferred != nullptr) {
+    return &deferred->_node_volume_level;
+  }
+#endif  // DO_PSTATS
+  return nullptr;
+}
+
+/**
+ * Counts one test against the indicated collector.  Each unit of work only
+ * ever touches a handful of different collectors, so a linear search is
+ * fine.
+ */
+void CollisionTraverser::DeferredEntries::
+add_level(PStatCollector &collector) {
+#ifdef DO_PSTATS
+  for (std::pair<PStatCollector *, int> &level : _levels) {
+    if (level.first == &collector) {
+      ++level.second;
+      return;
+    }
+  }
+  _levels.push_back(std::pair<PStatCollector *, int>(&collector, 1));
+#endif  // DO_PSTATS
+}
+
+/**
+ * Adds the tests tallied by this unit of work to their PStatCollectors.  This
+ * must be called by the thread that started the traversal.
+ */
+void CollisionTraverser::DeferredEntries::
+flush_levels() const {
+#ifdef DO_PSTATS
+  if (_node_volume_level != 0) {
+    CollisionLevelStateBase::_node_volume_pcollector.add_level(_node_volume_level);
+  }
+  for (const std::pair<PStatCollector *, int> &level : _levels) {
+    level.first->add_level(level.second);
+  }
+#endif  // DO_PSTATS
+}
+
 /**
  * Returns the PStatCollector suitable for timing the nth pass.
  */
@@ -23,6 +23,7 @@
 #include "pStatCollector.h"
 
 #include "pset.h"
+#include "pdeque.h"
 #include "register_type.h"
 
 class CollisionNode;
@@ -52,6 +53,10 @@ PUBLISHED:
   MAKE_PROPERTY(respect_prev_transform, get_respect_prev_transform,
                                         set_respect_prev_transform);
 
+  INLINE void set_parallel(bool flag);
+  INLINE bool get_parallel() const;
+  MAKE_PROPERTY(parallel, get_parallel, set_parallel);
+
   void add_collider(const NodePath &collider, CollisionHandler *handler);
   bool remove_collider(const NodePath &collider);
   bool has_collider(const NodePath &collider) const;
@@ -80,32 +85,84 @@ PUBLISHED:
   void write(std::ostream &out, int indent_level) const;
 
 private:
+  // These are used by the parallel traversal to hold the entries detected by
+  // one unit of work until they can be passed on to the handlers.  The
+  // bounding volume tests it made are tallied here too, since the shared
+  // PStatCollectors may only be incremented by the calling thread.
+  class DeferredEntry {
+  public:
+    CollisionHandler *_handler;
+    PT(CollisionEntry) _entry;
+  };
+  class DeferredEntries {
+  public:
+    DeferredEntries() : _node_volume_level(0) {}
+    void add_level(PStatCollector &collector);
+    void flush_levels() const;
+
+    pvector<DeferredEntry> _entries;
+    int _node_volume_level;
+    typedef pvector<std::pair<PStatCollector *, int> > Levels;
+    Levels _levels;
+  };
+
+  template<class LevelState>
+  class TraverseJob;
+  template<class LevelState>
+  class JobQueue;
+
+  typedef pdeque<TraverseJob<CollisionLevelStateSingle> > JobsSingle;
+  typedef pdeque<TraverseJob<CollisionLevelStateDouble> > JobsDouble;
+  typedef pdeque<TraverseJob<CollisionLevelStateQuad> > JobsQuad;
+
+  bool can_traverse_parallel() const;
+  template<class LevelState>
+  void run_jobs(pdeque<TraverseJob<LevelState> > &jobs,
+                void (CollisionTraverser::*traverse_func)
+                  (LevelState &, size_t, DeferredEntries *,
+                   pdeque<TraverseJob<LevelState> > *, int));
+
   typedef pvector<CollisionLevelStateSingle> LevelStatesSingle;
   void prepare_colliders_single(LevelStatesSingle &level_states, const NodePath &root);
-  void r_traverse_single(CollisionLevelStateSingle &level_state, size_t pass);
+  void r_traverse_single(CollisionLevelStateSingle &level_state, size_t pass,
+                         DeferredEntries *deferred = nullptr,
+                         JobsSingle *jobs = nullptr, int split_depth = 0);
 
   typedef pvector<CollisionLevelStateDouble> LevelStatesDouble;
   void prepare_colliders_double(LevelStatesDouble &level_states, const NodePath &root);
-  void r_traverse_double(CollisionLevelStateDouble &level_state, size_t pass);
+  void r_traverse_double(CollisionLevelStateDouble &level_state, size_t pass,
+                         DeferredEntries *deferred = nullptr,
+                         JobsDouble *jobs = nullptr, int split_depth = 0);
 
   typedef pvector<CollisionLevelStateQuad> LevelStatesQuad;
   void prepare_colliders_quad(LevelStatesQuad &level_states, const NodePath &root);
-  void r_traverse_quad(CollisionLevelStateQuad &level_state, size_t pass);
+  void r_traverse_quad(CollisionLevelStateQuad &level_state, size_t pass,
+                       DeferredEntries *deferred = nullptr,
+                       JobsQuad *jobs = nullptr, int split_depth = 0);
 
   void compare_collider_to_node(CollisionEntry &entry,
                                 const GeometricBoundingVolume *from_parent_gbv,
                                 const GeometricBoundingVolume *from_node_gbv,
-                                const GeometricBoundingVolume *into_node_gbv);
+                                const GeometricBoundingVolume *into_node_gbv,
+                                DeferredEntries *deferred);
   void compare_collider_to_geom_node(CollisionEntry &entry,
                                      const GeometricBoundingVolume *from_parent_gbv,
                                      const GeometricBoundingVolume *from_node_gbv,
-                                     const GeometricBoundingVolume *into_node_gbv);
+                                     const GeometricBoundingVolume *into_node_gbv,
+                                     DeferredEntries *deferred);
   void compare_collider_to_solid(CollisionEntry &entry,
                                  const GeometricBoundingVolume *from_node_gbv,
-                                 const GeometricBoundingVolume *solid_gbv);
+                                 const GeometricBoundingVolume *solid_gbv,
+                                 DeferredEntries *deferred);
   void compare_collider_to_geom(CollisionEntry &entry, const Geom *geom,
                                 const GeometricBoundingVolume *from_node_gbv,
-                                const GeometricBoundingVolume *solid_gbv);
+                                const GeometricBoundingVolume *solid_gbv,
+                                DeferredEntries *deferred);
+  void test_intersection(const CollisionEntry &entry,
+                         CollisionHandler *handler,
+                         DeferredEntries *deferred) const;
+  static void add_level(PStatCollector &collector, DeferredEntries *deferred);
+  static int *get_node_volume_level(DeferredEntries *deferred);
 
   PStatCollector &get_pass_collector(int pass);
 
@@ -129,6 +186,7 @@ private:
   Handlers::iterator remove_handler(Handlers::iterator hi);
 
   bool _respect_prev_transform;
+  bool _parallel;
 #ifdef DO_COLLISION_RECORDING
   CollisionRecorder *_recorder;
   NodePath _collision_visualizer_np;
@@ -144,6 +202,9 @@ private:
   static PStatCollector _gnode_volume_pcollector;
   static PStatCollector _geom_volume_pcollector;
 
+  static PStatCollector _parallel_pcollector;
+  static PStatCollector _dispatch_pcollector;
+
   PStatCollector _this_pcollector;
   typedef pvector<PStatCollector> PassCollectors;
   PassCollectors _pass_collectors;
@@ -111,6 +111,32 @@ ConfigVariableBool pushers_horizontal
           "set_horizontal() flag by default, false to let the move "
           "in three dimensions by default."));
 
+ConfigVariableBool parallel_collision_traversal
+("parallel-collision-traversal", false,
+ PRC_DESC("Set this true to have new CollisionTraversers split their "
+          "traversal across the worker threads of the \"collide\" task "
+          "chain by default.  The results are buffered per subtree and "
+          "handed to the CollisionHandlers in the same order as the serial "
+          "traversal would produce them.  See also "
+          "CollisionTraverser::set_parallel()."));
+
+ConfigVariableInt collide_num_threads
+("collide-num-threads", 3,
+ PRC_DESC("The number of worker threads that will be started to perform "
+          "parallel collision traversals.  The thread that calls traverse() "
+          "also participates, so the default of 3 keeps four cores busy.  "
+          "These threads are only started if a parallel traversal is "
+          "actually performed."));
+
+ConfigVariableInt collide_parallel_split_depth
+("collide-parallel-split-depth", 2,
+ PRC_DESC("The depth below the traversal root at which a parallel "
+          "collision traversal splits the scene graph into independent "
+          "units of work.  Nodes above this depth are visited on the "
+          "calling thread; each subtree rooted at this depth becomes one "
+          "unit of work.  Increase this if your scene graph is shallow at "
+          "the top but wide further down."));
+
 /**
  * Initializes the library.  This must be called at least once before any of
  * the functions or classes in this library can be used.  Normally it will be
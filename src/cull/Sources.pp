@@ -15,7 +15,8 @@
     cullBinFrontToBack.h cullBinFrontToBack.I \
     cullBinStateSorted.h cullBinStateSorted.I \
     cullBinUnsorted.h cullBinUnsorted.I \
-    drawCullHandler.h drawCullHandler.I
+    drawCullHandler.h drawCullHandler.I \
+    radixSort.h radixSort.I
 
   #define COMPOSITE_SOURCES \
     binCullHandler.cxx \
@@ -35,8 +36,18 @@
     cullBinFrontToBack.h cullBinFrontToBack.I \
     cullBinStateSorted.h cullBinStateSorted.I \
     cullBinUnsorted.h cullBinUnsorted.I \
-    drawCullHandler.h drawCullHandler.I
+    drawCullHandler.h drawCullHandler.I \
+    radixSort.h radixSort.I
 
   #define IGATESCAN all
 
 #end lib_target
+
+#begin test_bin_target
+  #define TARGET test_cullbin_sort
+  #define LOCAL_LIBS $[LOCAL_LIBS] cull
+
+  #define SOURCES \
+    test_cullbin_sort.cxx
+
+#end test_bin_target
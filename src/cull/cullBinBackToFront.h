@@ -21,6 +21,7 @@
 #include "transformState.h"
 #include "renderState.h"
 #include "pointerTo.h"
+#include "radixSort.h"
 
 /**
  * A specific kind of CullBin that sorts geometry in order from furthest to
@@ -29,6 +30,8 @@
  * be sorted from back to front.
  */
 class EXPCL_PANDA_CULL CullBinBackToFront : public CullBin {
+protected:
+  INLINE CullBinBackToFront(const CullBinBackToFront &copy);
 public:
   INLINE CullBinBackToFront(const std::string &name,
                             GraphicsStateGuardianBase *gsg,
@@ -40,6 +43,8 @@ public:
                            const PStatCollector &draw_region_pcollector);
 
 
+  virtual PT(CullBin) make_next() const;
+
   virtual void add_object(CullableObject *object, Thread *current_thread);
   virtual void finish_cull(SceneSetup *scene_setup, Thread *current_thread);
   virtual void draw(bool force, Thread *current_thread);
@@ -51,15 +56,18 @@ private:
   class ObjectData {
   public:
     INLINE ObjectData(CullableObject *object, PN_stdfloat dist);
-    INLINE bool operator < (const ObjectData &other) const;
 
     CullableObject *_object;
-    PN_stdfloat _dist;
+    uint64_t _sort_key;
   };
 
   typedef pvector<ObjectData> Objects;
   Objects _objects;
 
+  // The temporary storage for the radix sort.  This is handed on to next
+  // frame's bin by make_next(), so that it need not be reallocated.
+  mutable Objects _scratch;
+
 public:
   static TypeHandle get_class_type() {
     return _type_handle;
@@ -44,6 +44,16 @@ make_bin(const std::string &name, GraphicsStateGuardianBase *gsg,
   return new CullBinFrontToBack(name, gsg, draw_region_pcollector);
 }
 
+/**
+ * Returns a newly-allocated CullBin object that contains a copy of just the
+ * subset of the data from this CullBin object that is worth keeping around
+ * for next frame.  For this bin, that is the scratch storage for the sort.
+ */
+PT(CullBin) CullBinFrontToBack::
+make_next() const {
+  return new CullBinFrontToBack(*this);
+}
+
 /**
  * Adds a geom, along with its associated state, to the bin for rendering.
  */
@@ -75,7 +85,8 @@ add_object(CullableObject *object, Thread *current_thread) {
 void CullBinFrontToBack::
 finish_cull(SceneSetup *, Thread *current_thread) {
   PStatTimer timer(_cull_this_pcollector, current_thread);
-  sort(_objects.begin(), _objects.end());
+  radix_sort(_objects, _scratch, &ObjectData::_sort_key);
+  _scratch.clear();
 }
 
 /**
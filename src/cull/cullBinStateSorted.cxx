@@ -16,9 +16,27 @@
 #include "cullableObject.h"
 #include "cullHandler.h"
 #include "pStatTimer.h"
+#include "shaderAttrib.h"
+#include "textureAttrib.h"
 
 #include <algorithm>
 
+// The layout of the sort key, from the most significant bits down.  This
+// follows the grouping of operator <, from the heaviest state change to the
+// lightest; the internal transform is not included, but the radix sort is
+// stable, so objects that differ only in transform stay in the order they
+// were added.
+static const int shader_bits = 10;
+static const int texture_bits = 14;
+static const int state_bits = 14;
+static const int format_bits = 6;
+static const int data_bits = 20;
+
+static const int data_shift = 0;
+static const int format_shift = data_shift + data_bits;
+static const int state_shift = format_shift + format_bits;
+static const int texture_shift = state_shift + state_bits;
+static const int shader_shift = texture_shift + texture_bits;
 
 TypeHandle CullBinStateSorted::_type_handle;
 
@@ -43,12 +61,24 @@ make_bin(const std::string &name, GraphicsStateGuardianBase *gsg,
   return new CullBinStateSorted(name, gsg, draw_region_pcollector);
 }
 
+/**
+ * Returns a newly-allocated CullBin object that contains a copy of just the
+ * subset of the data from this CullBin object that is worth keeping around
+ * for next frame.  For this bin, that is the scratch storage for the sort.
+ */
+PT(CullBin) CullBinStateSorted::
+make_next() const {
+  return new CullBinStateSorted(*this);
+}
+
 /**
  * Adds a geom, along with its associated state, to the bin for rendering.
  */
 void CullBinStateSorted::
 add_object(CullableObject *object, Thread *current_thread) {
   _objects.push_back(ObjectData(object));
+  ObjectData &data = _objects.back();
+  data._sort_key = get_sort_key(data);
 }
 
 /**
@@ -59,7 +89,13 @@ add_object(CullableObject *object, Thread *current_thread) {
 void CullBinStateSorted::
 finish_cull(SceneSetup *, Thread *current_thread) {
   PStatTimer timer(_cull_this_pcollector, current_thread);
-  sort(_objects.begin(), _objects.end());
+  if (_keys_overflowed) {
+    // There were too many distinct states to fit in the sort key.
+    sort(_objects.begin(), _objects.end());
+  } else {
+    radix_sort(_objects, _scratch, &ObjectData::_sort_key);
+    _scratch.clear();
+  }
 }
 
 
@@ -87,3 +123,55 @@ fill_result_graph(CullBin::ResultGraphBuilder &builder) {
     builder.add_object(object);
   }
 }
+
+/**
+ * Returns the key by which the indicated object should be sorted.  This is
+ * computed once, when the object is added, so that the sort does not need to
+ * look inside the RenderState for every comparison.
+ */
+uint64_t CullBinStateSorted::
+get_sort_key(const ObjectData &data) {
+  const RenderState *state = data._object->_state;
+
+  uint64_t state_key;
+  int si = _state_keys.find(state);
+  if (si >= 0) {
+    state_key = _state_keys.get_data(si);
+  } else {
+    // This is the first time we've seen this state this frame.  The shader
+    // and textures change most expensively, so they go in the upper bits.
+    const ShaderAttrib *sha = (const ShaderAttrib *)
+      state->get_attrib(ShaderAttrib::get_class_slot());
+    const TextureAttrib *ta = (const TextureAttrib *)
+      state->get_attrib(TextureAttrib::get_class_slot());
+
+    state_key =
+      (get_id(_shader_ids, sha, shader_bits) << shader_shift) |
+      (get_id(_texture_ids, ta, texture_bits) << texture_shift) |
+      (get_id(_state_ids, state, state_bits) << state_shift);
+    _state_keys.store(state, state_key);
+  }
+
+  return state_key |
+    (get_id(_format_ids, data._format, format_bits) << format_shift) |
+    (get_id(_data_ids, data._object->_munged_data.p(), data_bits) << data_shift);
+}
+
+/**
+ * Returns the small integer that identifies the indicated pointer within the
+ * given table, assigning a new one if necessary.
+ */
+uint64_t CullBinStateSorted::
+get_id(Ids &ids, const void *pointer, int num_bits) {
+  int index = ids.find(pointer);
+  if (index < 0) {
+    index = ids.store(pointer, nullptr);
+  }
+
+  uint64_t max_id = ((uint64_t)1 << num_bits) - 1;
+  if ((uint64_t)index > max_id) {
+    _keys_overflowed = true;
+    return max_id;
+  }
+  return (uint64_t)index;
+}
@@ -22,6 +22,8 @@
 #include "transformState.h"
 #include "renderState.h"
 #include "pointerTo.h"
+#include "simpleHashMap.h"
+#include "radixSort.h"
 
 /**
  * A specific kind of CullBin that sorts geometry to collect items of the same
@@ -33,6 +35,8 @@
  * object appears behind another one.
  */
 class EXPCL_PANDA_CULL CullBinStateSorted : public CullBin {
+protected:
+  INLINE CullBinStateSorted(const CullBinStateSorted &copy);
 public:
   INLINE CullBinStateSorted(const std::string &name,
                             GraphicsStateGuardianBase *gsg,
@@ -43,6 +47,8 @@ public:
                            GraphicsStateGuardianBase *gsg,
                            const PStatCollector &draw_region_pcollector);
 
+  virtual PT(CullBin) make_next() const;
+
   virtual void add_object(CullableObject *object, Thread *current_thread);
   virtual void finish_cull(SceneSetup *scene_setup, Thread *current_thread);
   virtual void draw(bool force, Thread *current_thread);
@@ -58,11 +64,34 @@ private:
 
     CullableObject *_object;
     const GeomVertexFormat *_format;
+    uint64_t _sort_key;
   };
 
+  typedef SimpleHashMap<const void *, std::nullptr_t, pointer_hash> Ids;
+  typedef SimpleHashMap<const RenderState *, uint64_t, pointer_hash> StateKeys;
+
+  uint64_t get_sort_key(const ObjectData &data);
+  uint64_t get_id(Ids &ids, const void *pointer, int num_bits);
+
   typedef pvector<ObjectData> Objects;
   Objects _objects;
 
+  // The temporary storage for the radix sort.  This is handed on to next
+  // frame's bin by make_next(), so that it need not be reallocated.
+  mutable Objects _scratch;
+
+  // These assign a small integer to each distinct shader, texture, state,
+  // vertex format and vertex data seen this frame, which are packed together
+  // into the sort key.  If we run out of bits for any of these, we fall back
+  // to sorting with operator <.
+  Ids _shader_ids;
+  Ids _texture_ids;
+  Ids _state_ids;
+  Ids _format_ids;
+  Ids _data_ids;
+  StateKeys _state_keys;
+  bool _keys_overflowed;
+
 public:
   static TypeHandle get_class_type() {
     return _type_handle;
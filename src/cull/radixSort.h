@@ -0,0 +1,38 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file radixSort.h
+ * @author lachbr
+ * @date 2026-10-18
+ */
+
+#ifndef RADIXSORT_H
+#define RADIXSORT_H
+
+#include "pandabase.h"
+#include "pvector.h"
+
+/**
+ * Sorts the indicated vector of elements into ascending order by the 64-bit
+ * key stored in each element, using a least-significant-digit radix sort.
+ * The sort is stable.  The scratch vector is used as temporary storage; its
+ * contents are undefined on return.
+ *
+ * This is intended for sorting the objects in a CullBin, for which the sort
+ * key can be computed once when the object is added, rather than chasing
+ * pointers every time two objects are compared.
+ */
+template<class Element>
+void radix_sort(pvector<Element> &elements, pvector<Element> &scratch,
+                uint64_t Element::*key);
+
+INLINE uint32_t float_sort_key(float value);
+
+#include "radixSort.I"
+
+#endif
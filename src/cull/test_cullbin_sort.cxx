@@ -0,0 +1,320 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file test_cullbin_sort.cxx
+ * @author lachbr
+ * @date 2026-10-18
+ */
+
+#include "config_cull.h"
+#include "cullBinStateSorted.h"
+#include "cullableObject.h"
+#include "radixSort.h"
+#include "colorAttrib.h"
+#include "textureAttrib.h"
+#include "texture.h"
+#include "geom.h"
+#include "geomTriangles.h"
+#include "geomVertexWriter.h"
+#include "geomNode.h"
+#include "clockObject.h"
+#include "pStatCollector.h"
+#include "pmap.h"
+#include "pset.h"
+
+#include <algorithm>
+#include <stdlib.h>
+
+using std::cerr;
+
+class DepthData {
+public:
+  PN_stdfloat _dist;
+  uint64_t _sort_key;
+};
+
+/**
+ * A state-sorted bin that sorts with a comparator that walks the
+ * RenderStates, the way CullBinStateSorted did before it computed a radix
+ * sort key for each object.  This is the baseline for the state sort.
+ */
+class CompareSortedBin : public CullBin {
+public:
+  CompareSortedBin(const PStatCollector &draw_region_pcollector) :
+    CullBin("compare", BT_state_sorted, nullptr, draw_region_pcollector) {}
+
+  virtual ~CompareSortedBin() {
+    for (const ObjectData &data : _objects) {
+      delete data._object;
+    }
+  }
+
+  virtual void add_object(CullableObject *object, Thread *current_thread) {
+    _objects.push_back(ObjectData(object));
+  }
+
+  virtual void finish_cull(SceneSetup *, Thread *current_thread) {
+    std::sort(_objects.begin(), _objects.end());
+  }
+
+  virtual void draw(bool force, Thread *current_thread) {
+  }
+
+protected:
+  virtual void fill_result_graph(ResultGraphBuilder &builder) {
+    for (const ObjectData &data : _objects) {
+      builder.add_object(data._object);
+    }
+  }
+
+private:
+  class ObjectData {
+  public:
+    ObjectData(CullableObject *object) :
+      _object(object),
+      _format(object->_munged_data->get_format()) {}
+
+    bool operator < (const ObjectData &other) const {
+      int compare = _object->_state->compare_sort(*other._object->_state);
+      if (compare != 0) {
+        return compare < 0;
+      }
+      if (_format != other._format) {
+        return _format < other._format;
+      }
+      if (_object->_munged_data != other._object->_munged_data) {
+        return _object->_munged_data < other._object->_munged_data;
+      }
+      return _object->_internal_transform < other._object->_internal_transform;
+    }
+
+    CullableObject *_object;
+    const GeomVertexFormat *_format;
+  };
+
+  pvector<ObjectData> _objects;
+};
+
+typedef pvector<std::pair<const RenderState *, int> > StateRuns;
+
+static float
+random_float(float lo, float hi) {
+  return lo + (hi - lo) * ((float)rand() / (float)RAND_MAX);
+}
+
+/**
+ * Returns a single triangle, for the objects to share.
+ */
+static PT(Geom)
+make_triangle() {
+  PT(GeomVertexData) vdata = new GeomVertexData
+    ("triangle", GeomVertexFormat::get_v3(), Geom::UH_static);
+  GeomVertexWriter vertex(vdata, InternalName::get_vertex());
+  vertex.add_data3(0.0f, 0.0f, 0.0f);
+  vertex.add_data3(1.0f, 0.0f, 0.0f);
+  vertex.add_data3(0.0f, 0.0f, 1.0f);
+
+  PT(GeomTriangles) tris = new GeomTriangles(Geom::UH_static);
+  tris->add_vertices(0, 1, 2);
+
+  PT(Geom) geom = new Geom(vdata);
+  geom->add_primitive(tris);
+  return geom;
+}
+
+/**
+ * Allocates one CullableObject per entry in the states list.  This is done
+ * outside of the timed region, since it is the same for both bins.
+ */
+static void
+make_objects(pvector<CullableObject *> &objects, const Geom *geom,
+             const pvector<CPT(RenderState)> &object_states) {
+  CPT(TransformState) transform = TransformState::make_identity();
+  objects.clear();
+  objects.reserve(object_states.size());
+  for (const RenderState *state : object_states) {
+    CullableObject *object = new CullableObject(geom, state, transform);
+    object->_munged_data = geom->get_vertex_data();
+    objects.push_back(object);
+  }
+}
+
+/**
+ * Adds the objects to the bin and sorts it, and returns the elapsed time.
+ */
+static double
+time_bin(CullBin *bin, const pvector<CullableObject *> &objects) {
+  ClockObject *clock = ClockObject::get_global_clock();
+  Thread *current_thread = Thread::get_current_thread();
+
+  double start = clock->get_real_time();
+  for (CullableObject *object : objects) {
+    bin->add_object(object, current_thread);
+  }
+  bin->finish_cull(nullptr, current_thread);
+  return clock->get_real_time() - start;
+}
+
+/**
+ * Returns the runs of consecutive objects with the same state, in the order
+ * in which the bin would draw them.
+ */
+static StateRuns
+get_state_runs(CullBin *bin) {
+  StateRuns runs;
+  PT(PandaNode) root = bin->make_result_graph();
+  int num_children = root->get_num_children();
+  for (int i = 0; i < num_children; ++i) {
+    GeomNode *node = DCAST(GeomNode, root->get_child(i));
+    runs.push_back(std::pair<const RenderState *, int>(node->get_state(), node->get_num_geoms()));
+  }
+  return runs;
+}
+
+/**
+ * Checks that the radix-sorted bin draws the same objects as the
+ * comparator-sorted bin, with each state in one contiguous run.  The order of
+ * the runs differs by design: the comparator orders the states by
+ * compare_sort(), while the radix key orders them by shader and texture in
+ * the order they were first seen.
+ */
+static bool
+check_state_runs(const StateRuns &compared, const StateRuns &radix,
+                 size_t num_states) {
+  if (compared.size() != num_states || radix.size() != num_states) {
+    cerr << "state sort: " << radix.size() << " state changes with radix_sort(), "
+         << compared.size() << " with compare_sort(), expected "
+         << num_states << "\n";
+    return false;
+  }
+
+  pmap<const RenderState *, int> counts;
+  for (const std::pair<const RenderState *, int> &run : compared) {
+    counts[run.first] = run.second;
+  }
+  for (const std::pair<const RenderState *, int> &run : radix) {
+    pmap<const RenderState *, int>::const_iterator ci = counts.find(run.first);
+    if (ci == counts.end() || (*ci).second != run.second) {
+      cerr << "state sort: radix_sort() drew a different set of objects\n";
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * Measures the cost of sorting the objects in a cull bin, per 100,000
+ * objects, and checks that the radix sort agrees with the comparison sort it
+ * replaced.  The depth-sorted bins are measured by sorting a list of random
+ * distances both with std::sort and with radix_sort(), including the cost of
+ * computing the keys.  The state-sorted bin is measured by filling and
+ * sorting an actual CullBinStateSorted, and compared against a bin that does
+ * the same with std::sort and a comparator that walks the RenderStates.
+ *
+ * Usage: test_cullbin_sort [num_objects [num_iterations]]
+ */
+int
+main(int argc, char *argv[]) {
+  int num_objects = 100000;
+  int num_iterations = 10;
+  if (argc > 1) {
+    num_objects = atoi(argv[1]);
+  }
+  if (argc > 2) {
+    num_iterations = atoi(argv[2]);
+  }
+
+  init_libcull();
+
+  ClockObject *clock = ClockObject::get_global_clock();
+  double scale = 100000.0 / (double)num_objects / (double)num_iterations * 1000.0;
+
+  // First, the depth-sorted bins.
+  pvector<DepthData> depths(num_objects);
+  for (int i = 0; i < num_objects; ++i) {
+    depths[i]._dist = random_float(-1000.0f, 1000.0f);
+    depths[i]._sort_key = 0;
+  }
+
+  double std_sort_time = 0.0;
+  double radix_sort_time = 0.0;
+  pvector<DepthData> scratch;
+  for (int n = 0; n < num_iterations; ++n) {
+    pvector<DepthData> objects(depths);
+    double start = clock->get_real_time();
+    std::sort(objects.begin(), objects.end(),
+      [](const DepthData &a, const DepthData &b) {
+        return a._dist < b._dist;
+      });
+    std_sort_time += clock->get_real_time() - start;
+
+    pvector<DepthData> keyed(depths);
+    start = clock->get_real_time();
+    for (DepthData &data : keyed) {
+      data._sort_key = float_sort_key((float)data._dist);
+    }
+    radix_sort(keyed, scratch, &DepthData::_sort_key);
+    radix_sort_time += clock->get_real_time() - start;
+
+    for (int i = 0; i < num_objects; ++i) {
+      if (objects[i]._dist != keyed[i]._dist) {
+        cerr << "radix_sort() disagrees with std::sort at " << i << "\n";
+        return 1;
+      }
+    }
+  }
+
+  cerr << "depth sort, std::sort:  " << std_sort_time * scale << " ms per 100k\n";
+  cerr << "depth sort, radix_sort: " << radix_sort_time * scale << " ms per 100k\n";
+
+  // Now the state-sorted bin, with a few hundred distinct states.
+  pvector<CPT(RenderState)> states;
+  for (int t = 0; t < 16; ++t) {
+    PT(Texture) tex = new Texture("tex");
+    CPT(RenderAttrib) ta = TextureAttrib::make(tex);
+    for (int c = 0; c < 32; ++c) {
+      LColor color(random_float(0, 1), random_float(0, 1), random_float(0, 1), 1);
+      states.push_back(RenderState::make(ta, ColorAttrib::make_flat(color)));
+    }
+  }
+
+  pvector<CPT(RenderState)> object_states(num_objects);
+  pset<const RenderState *> used_states;
+  for (int i = 0; i < num_objects; ++i) {
+    object_states[i] = states[rand() % states.size()];
+    used_states.insert(object_states[i]);
+  }
+
+  PT(Geom) triangle = make_triangle();
+  pvector<CullableObject *> objects;
+
+  double compare_sort_time = 0.0;
+  double radix_bin_time = 0.0;
+  PStatCollector draw_collector("Draw");
+  for (int n = 0; n < num_iterations; ++n) {
+    PT(CompareSortedBin) compare_bin = new CompareSortedBin(draw_collector);
+    make_objects(objects, triangle, object_states);
+    compare_sort_time += time_bin(compare_bin, objects);
+
+    PT(CullBinStateSorted) radix_bin =
+      new CullBinStateSorted("opaque", nullptr, draw_collector);
+    make_objects(objects, triangle, object_states);
+    radix_bin_time += time_bin(radix_bin, objects);
+
+    if (n == 0 &&
+        !check_state_runs(get_state_runs(compare_bin), get_state_runs(radix_bin),
+                          used_states.size())) {
+      return 1;
+    }
+  }
+
+  cerr << "state sort, compare_sort(): " << compare_sort_time * scale << " ms per 100k\n";
+  cerr << "state sort, radix_sort():   " << radix_bin_time * scale << " ms per 100k\n";
+
+  return 0;
+}
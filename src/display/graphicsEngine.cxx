@@ -99,6 +99,12 @@ PStatCollector GraphicsEngine::_vertex_data_compressed_pcollector("Vertex Data:C
 PStatCollector GraphicsEngine::_vertex_data_unused_disk_pcollector("Vertex Data:Disk:Unused");
 PStatCollector GraphicsEngine::_vertex_data_used_disk_pcollector("Vertex Data:Disk:Used");
 
+PStatCollector GraphicsEngine::_bam_cache_hits_pcollector("BamCache:Hits");
+PStatCollector GraphicsEngine::_bam_cache_misses_pcollector("BamCache:Misses");
+PStatCollector GraphicsEngine::_bam_cache_stores_pcollector("BamCache:Stores");
+PStatCollector GraphicsEngine::_bam_cache_evictions_pcollector("BamCache:Evictions");
+PStatCollector GraphicsEngine::_bam_cache_lookup_pcollector("BamCache:Lookup latency");
+
 // These are counted independently by the collision system; we redefine them
 // here so we can reset them at each frame.
 PStatCollector GraphicsEngine::_cnode_volume_pcollector("Collision Volumes:CollisionNode");
@@ -173,6 +179,12 @@ GraphicsEngine(Pipeline *pipeline) :
 
   _singular_warning_last_frame = false;
   _singular_warning_this_frame = false;
+
+  _bam_cache_hits = 0;
+  _bam_cache_misses = 0;
+  _bam_cache_stores = 0;
+  _bam_cache_evictions = 0;
+  _bam_cache_lookup_time = 0.0;
 }
 
 /**
@@ -914,6 +926,32 @@ render_frame() {
       _vertex_data_compressed_pcollector.set_level(compressed);
       _vertex_data_unused_disk_pcollector.set_level(total_disk - used_disk);
       _vertex_data_used_disk_pcollector.set_level(used_disk);
+
+      // The BamCache keeps running totals; report the change since the last
+      // frame, and the average time per lookup in milliseconds.
+      BamCache *cache = BamCache::get_global_ptr();
+      int hits = cache->get_num_hits();
+      int misses = cache->get_num_misses();
+      int stores = cache->get_num_stores();
+      int evictions = cache->get_num_evictions();
+      double lookup_time = cache->get_lookup_time();
+
+      int num_lookups = (hits - _bam_cache_hits) + (misses - _bam_cache_misses);
+      _bam_cache_hits_pcollector.set_level(hits - _bam_cache_hits);
+      _bam_cache_misses_pcollector.set_level(misses - _bam_cache_misses);
+      _bam_cache_stores_pcollector.set_level(stores - _bam_cache_stores);
+      _bam_cache_evictions_pcollector.set_level(evictions - _bam_cache_evictions);
+      if (num_lookups > 0) {
+        _bam_cache_lookup_pcollector.set_level((lookup_time - _bam_cache_lookup_time) * 1000.0 / num_lookups);
+      } else {
+        _bam_cache_lookup_pcollector.set_level(0.0);
+      }
+
+      _bam_cache_hits = hits;
+      _bam_cache_misses = misses;
+      _bam_cache_stores = stores;
+      _bam_cache_evictions = evictions;
+      _bam_cache_lookup_time = lookup_time;
     }
 
 #endif  // DO_PSTATS
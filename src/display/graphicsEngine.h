@@ -345,6 +345,14 @@ private:
   bool _singular_warning_last_frame;
   bool _singular_warning_this_frame;
 
+  // The BamCache counters as of the previous frame, so that PStats can show
+  // the activity within each frame.
+  int _bam_cache_hits;
+  int _bam_cache_misses;
+  int _bam_cache_stores;
+  int _bam_cache_evictions;
+  double _bam_cache_lookup_time;
+
   ReMutex _lock;
   ReMutex _public_lock;
 
@@ -390,6 +398,12 @@ private:
   static PStatCollector _vertex_data_used_disk_pcollector;
   static PStatCollector _vertex_data_unused_disk_pcollector;
 
+  static PStatCollector _bam_cache_hits_pcollector;
+  static PStatCollector _bam_cache_misses_pcollector;
+  static PStatCollector _bam_cache_stores_pcollector;
+  static PStatCollector _bam_cache_evictions_pcollector;
+  static PStatCollector _bam_cache_lookup_pcollector;
+
   static PStatCollector _cnode_volume_pcollector;
   static PStatCollector _gnode_volume_pcollector;
   static PStatCollector _geom_volume_pcollector;
@@ -298,12 +298,15 @@ GraphicsStateGuardian::
   // matter too much.
   // Note that if uniquify-states is false, we can't iterate over all the
   // states, and some GSGs will linger.  Let's hope this isn't a problem.
-  LightReMutexHolder holder(*RenderState::_states_lock);
-  size_t size = RenderState::_states.get_num_entries();
-  for (size_t si = 0; si < size; ++si) {
-    const RenderState *state = RenderState::_states.get_key(si);
-    state->_mungers.remove(_id);
-    state->_munged_states.remove(_id);
+  StateCacheLock::Holder holder(*RenderState::_states_lock);
+  size_t num_stripes = RenderState::_states_lock->get_num_stripes();
+  for (size_t n = 0; n < num_stripes; ++n) {
+    size_t size = RenderState::_states[n].get_num_entries();
+    for (size_t si = 0; si < size; ++si) {
+      const RenderState *state = RenderState::_states[n].get_key(si);
+      state->_mungers.remove(_id);
+      state->_munged_states.remove(_id);
+    }
   }
 }
 
@@ -13,6 +13,7 @@
 
 #include "animBundleMaker.h"
 #include "config_egg2pg.h"
+#include "config_chan.h"
 
 #include "eggTable.h"
 #include "eggAnimData.h"
@@ -314,5 +315,9 @@ create_xfm_channel(EggXfmSAnim *egg_anim, const std::string &name,
     }
   }
 
+  if (quantize_anim_channels) {
+    table->quantize();
+  }
+
   return table;
 }
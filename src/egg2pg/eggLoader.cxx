@@ -857,12 +857,58 @@ load_textures() {
   EggTextureCollection tc;
   tc.find_used_textures(_data);
 
+  // The ordinary 2-d textures are handed to the TexturePool as one batch, so
+  // that their image files can be decoded on several threads at once.
+  TexturePool::LoadRequests requests;
+  pvector<EggTexture *> request_textures;
+
   EggTextureCollection::iterator ti;
+  for (ti = tc.begin(); ti != tc.end(); ++ti) {
+    EggTexture *egg_tex = (*ti);
+    switch (egg_tex->get_texture_type()) {
+    case EggTexture::TT_unspecified:
+    case EggTexture::TT_1d_texture:
+    case EggTexture::TT_2d_texture:
+      {
+        TexturePool::LoadRequest request;
+        bool wanted_alpha;
+        get_texture_options(egg_tex, request._primary_file_num_channels,
+                            wanted_alpha, request._options);
+        request._filename = egg_tex->get_fullpath();
+        if (egg_tex->has_alpha_filename() && wanted_alpha) {
+          request._alpha_filename = egg_tex->get_alpha_fullpath();
+          request._alpha_file_channel = egg_tex->get_alpha_file_channel();
+        }
+        request._read_mipmaps = egg_tex->get_read_mipmaps();
+        requests.push_back(std::move(request));
+        request_textures.push_back(egg_tex);
+      }
+      break;
+
+    default:
+      break;
+    }
+  }
+
+  pmap<EggTexture *, PT(Texture)> loaded;
+  if (requests.size() > 1) {
+    TexturePool::load_textures(requests);
+    for (size_t i = 0; i < requests.size(); ++i) {
+      loaded[request_textures[i]] = requests[i]._texture;
+    }
+  }
+
   for (ti = tc.begin(); ti != tc.end(); ++ti) {
     PT_EggTexture egg_tex = (*ti);
 
+    PT(Texture) tex;
+    pmap<EggTexture *, PT(Texture)>::const_iterator li = loaded.find(egg_tex);
+    if (li != loaded.end()) {
+      tex = (*li).second;
+    }
+
     TextureDef def;
-    if (load_texture(def, egg_tex)) {
+    if (load_texture(def, egg_tex, tex)) {
       // Now associate the pointers, so we'll be able to look up the Texture
       // pointer given an EggTexture pointer, later.
       _textures[egg_tex] = def;
@@ -870,15 +916,16 @@ load_textures() {
   }
 }
 
-
 /**
- *
+ * Determines the parameters with which the indicated texture should be
+ * loaded from the TexturePool.
  */
-bool EggLoader::
-load_texture(TextureDef &def, EggTexture *egg_tex) {
+void EggLoader::
+get_texture_options(EggTexture *egg_tex, int &wanted_channels,
+                    bool &wanted_alpha, LoaderOptions &options) const {
   // Check to see if we should reduce the number of channels in the texture.
-  int wanted_channels = 0;
-  bool wanted_alpha = false;
+  wanted_channels = 0;
+  wanted_alpha = false;
   switch (egg_tex->get_format()) {
   case EggTexture::F_red:
   case EggTexture::F_green:
@@ -922,18 +969,8 @@ load_texture(TextureDef &def, EggTexture *egg_tex) {
     wanted_alpha = egg_tex->has_alpha_filename();
   }
 
-  // Since some properties of the textures are inferred from the texture files
-  // themselves (if the properties are not explicitly specified in the egg
-  // file), then we add the textures as dependents for the egg file.
-  if (_record != nullptr) {
-    _record->add_dependent_file(egg_tex->get_fullpath());
-    if (egg_tex->has_alpha_filename() && wanted_alpha) {
-      _record->add_dependent_file(egg_tex->get_alpha_fullpath());
-    }
-  }
-
   // By convention, the egg loader will preload the simple texture images.
-  LoaderOptions options;
+  options = LoaderOptions();
   if (egg_preload_simple_textures) {
     options.set_texture_flags(options.get_texture_flags() | LoaderOptions::TF_preload_simple);
   }
@@ -965,36 +1002,66 @@ load_texture(TextureDef &def, EggTexture *egg_tex) {
     options.set_texture_flags(options.get_texture_flags() | LoaderOptions::TF_allow_compression);
   }
 
-  PT(Texture) tex;
   switch (egg_tex->get_texture_type()) {
   case EggTexture::TT_unspecified:
   case EggTexture::TT_1d_texture:
     options.set_texture_flags(options.get_texture_flags() | LoaderOptions::TF_allow_1d);
-    // Fall through.
+    break;
+
+  default:
+    break;
+  }
+}
+
+/**
+ * Fills in the TextureDef for the indicated texture.  If tex is not NULL, it
+ * has already been loaded by load_textures(); otherwise, it is loaded here.
+ */
+bool EggLoader::
+load_texture(TextureDef &def, EggTexture *egg_tex, PT(Texture) tex) {
+  int wanted_channels;
+  bool wanted_alpha;
+  LoaderOptions options;
+  get_texture_options(egg_tex, wanted_channels, wanted_alpha, options);
 
-  case EggTexture::TT_2d_texture:
+  // Since some properties of the textures are inferred from the texture files
+  // themselves (if the properties are not explicitly specified in the egg
+  // file), then we add the textures as dependents for the egg file.
+  if (_record != nullptr) {
+    _record->add_dependent_file(egg_tex->get_fullpath());
     if (egg_tex->has_alpha_filename() && wanted_alpha) {
-      tex = TexturePool::load_texture(egg_tex->get_fullpath(),
-                                      egg_tex->get_alpha_fullpath(),
-                                      wanted_channels,
-                                      egg_tex->get_alpha_file_channel(),
-                                      egg_tex->get_read_mipmaps(), options);
-    } else {
-      tex = TexturePool::load_texture(egg_tex->get_fullpath(),
-                                      wanted_channels,
-                                      egg_tex->get_read_mipmaps(), options);
+      _record->add_dependent_file(egg_tex->get_alpha_fullpath());
     }
-    break;
+  }
 
-  case EggTexture::TT_3d_texture:
-    tex = TexturePool::load_3d_texture(egg_tex->get_fullpath(),
-                                       egg_tex->get_read_mipmaps(), options);
-    break;
+  if (tex == nullptr) {
+    switch (egg_tex->get_texture_type()) {
+    case EggTexture::TT_unspecified:
+    case EggTexture::TT_1d_texture:
+    case EggTexture::TT_2d_texture:
+      if (egg_tex->has_alpha_filename() && wanted_alpha) {
+        tex = TexturePool::load_texture(egg_tex->get_fullpath(),
+                                        egg_tex->get_alpha_fullpath(),
+                                        wanted_channels,
+                                        egg_tex->get_alpha_file_channel(),
+                                        egg_tex->get_read_mipmaps(), options);
+      } else {
+        tex = TexturePool::load_texture(egg_tex->get_fullpath(),
+                                        wanted_channels,
+                                        egg_tex->get_read_mipmaps(), options);
+      }
+      break;
 
-  case EggTexture::TT_cube_map:
-    tex = TexturePool::load_cube_map(egg_tex->get_fullpath(),
-                                     egg_tex->get_read_mipmaps(), options);
-    break;
+    case EggTexture::TT_3d_texture:
+      tex = TexturePool::load_3d_texture(egg_tex->get_fullpath(),
+                                         egg_tex->get_read_mipmaps(), options);
+      break;
+
+    case EggTexture::TT_cube_map:
+      tex = TexturePool::load_cube_map(egg_tex->get_fullpath(),
+                                       egg_tex->get_read_mipmaps(), options);
+      break;
+    }
   }
 
   if (tex == nullptr) {
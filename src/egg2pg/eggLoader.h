@@ -117,7 +117,9 @@ private:
                           const LMatrix4d &mat);
 
   void load_textures();
-  bool load_texture(TextureDef &def, EggTexture *egg_tex);
+  void get_texture_options(EggTexture *egg_tex, int &wanted_channels,
+                           bool &wanted_alpha, LoaderOptions &options) const;
+  bool load_texture(TextureDef &def, EggTexture *egg_tex, PT(Texture) tex);
   void apply_texture_attributes(Texture *tex, const EggTexture *egg_tex);
   Texture::CompressionMode convert_compression_mode(EggTexture::CompressionMode compression_mode) const;
   SamplerState::WrapMode convert_wrap_mode(EggTexture::WrapMode wrap_mode) const;
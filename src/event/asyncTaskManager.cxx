@@ -20,6 +20,7 @@
 #include "pStatTimer.h"
 #include "clockObject.h"
 #include "config_event.h"
+#include "genericAsyncTask.h"
 #include <algorithm>
 
 using std::string;
@@ -554,6 +555,86 @@ write(std::ostream &out, int indent_level) const {
   }
 }
 
+/**
+ * Runs func(user_data) on the calling thread, and at the same time on up to
+ * num_jobs - 1 of the threads of the indicated task chain, and returns when
+ * all of them have finished.  If the chain does not exist yet, it is created
+ * with num_threads threads.
+ *
+ * Each call to func is expected to claim pieces of a shared job until there
+ * are none left, so that the job is complete as soon as any one of them
+ * returns.  Once the calling thread's call returns, the tasks that have not
+ * started yet are removed rather than waited for.  This means the job is
+ * still completed if the chain has no threads, or if this is called from one
+ * of the chain's own threads.
+ *
+ * The worker threads run at the calling thread's pipeline stage for the
+ * duration of the call.
+ */
+void AsyncTaskManager::
+run_parallel(const string &chain_name, int num_threads, int num_jobs,
+             ParallelFunc *func, void *user_data) {
+  int num_tasks = std::min(num_threads, num_jobs - 1);
+  if (num_tasks <= 0 || !Thread::is_threading_supported()) {
+    (*func)(user_data);
+    return;
+  }
+
+  PT(AsyncTaskChain) chain;
+  bool created = false;
+  {
+    MutexHolder holder(_lock);
+    chain = do_find_task_chain(chain_name);
+    if (chain == nullptr) {
+      chain = do_make_task_chain(chain_name);
+      created = true;
+    }
+  }
+  if (created) {
+    chain->set_num_threads(num_threads);
+    chain->set_thread_priority(TP_normal);
+  }
+
+  ParallelRun run;
+  run._func = func;
+  run._user_data = user_data;
+  run._pipeline_stage = Thread::get_current_pipeline_stage();
+
+  PT(GenericAsyncTask) tasks[max_parallel_tasks];
+  num_tasks = std::min(num_tasks, (int)max_parallel_tasks);
+  for (int i = 0; i < num_tasks; ++i) {
+    tasks[i] = new GenericAsyncTask(chain_name, &ParallelRun::task_func, &run);
+    tasks[i]->set_task_chain(chain_name);
+    add(tasks[i]);
+  }
+
+  (*func)(user_data);
+
+  // run lives on our stack, so we must still wait for the tasks that are
+  // already running.
+  for (int i = 0; i < num_tasks; ++i) {
+    tasks[i]->remove();
+    tasks[i]->wait();
+  }
+}
+
+/**
+ * The task function for run_parallel().
+ */
+AsyncTask::DoneStatus AsyncTaskManager::ParallelRun::
+task_func(GenericAsyncTask *, void *data) {
+  ParallelRun *run = (ParallelRun *)data;
+
+  Thread *current_thread = Thread::get_current_thread();
+  int pipeline_stage = current_thread->get_pipeline_stage();
+  current_thread->set_pipeline_stage(run->_pipeline_stage);
+
+  (*run->_func)(run->_user_data);
+
+  current_thread->set_pipeline_stage(pipeline_stage);
+  return AsyncTask::DS_done;
+}
+
 /**
  * Creates a new AsyncTaskChain of the indicated name and stores it within the
  * AsyncTaskManager.  If a task chain with this name already exists, returns
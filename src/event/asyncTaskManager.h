@@ -31,6 +31,8 @@
 #include "ordered_vector.h"
 #include "indirectCompareNames.h"
 
+class GenericAsyncTask;
+
 /**
  * A class to manage a loose queue of isolated tasks, which can be performed
  * either synchronously (in the foreground thread) or asynchronously (by a
@@ -95,6 +97,11 @@ PUBLISHED:
 
   INLINE static AsyncTaskManager *get_global_ptr();
 
+public:
+  typedef void ParallelFunc(void *user_data);
+  void run_parallel(const std::string &chain_name, int num_threads,
+                    int num_jobs, ParallelFunc *func, void *user_data);
+
 protected:
   AsyncTaskChain *do_make_task_chain(const std::string &name);
   AsyncTaskChain *do_find_task_chain(const std::string &name);
@@ -109,6 +116,17 @@ protected:
 private:
   static void make_global_ptr();
 
+  // The state shared by the tasks of one run_parallel() call.
+  class ParallelRun {
+  public:
+    static AsyncTask::DoneStatus task_func(GenericAsyncTask *task, void *data);
+
+    ParallelFunc *_func;
+    void *_user_data;
+    int _pipeline_stage;
+  };
+  static const int max_parallel_tasks = 64;
+
 protected:
   class AsyncTaskSortName {
   public:
@@ -14,13 +14,16 @@
     compress_string.h \
     config_express.h \
     copy_stream.h \
-    datagram.I datagram.h datagramGenerator.I \
+    datagram.I datagram.h \
+    datagramBufferPool.I datagramBufferPool.h \
+    datagramGenerator.I \
     datagramGenerator.h \
     datagramIterator.I datagramIterator.h datagramSink.I datagramSink.h \
     dcast.h dcast.T \
     encrypt_string.h \
     error_utils.h \
     export_dtool.h \
+    fileMapping.h fileMapping.I \
     fileReference.h fileReference.I \
     hashGeneratorBase.I hashGeneratorBase.h \
     hashVal.I hashVal.h \
@@ -81,12 +84,13 @@
     compress_string.cxx \
     config_express.cxx \
     copy_stream.cxx \
-    datagram.cxx datagramGenerator.cxx \
+    datagram.cxx datagramBufferPool.cxx datagramGenerator.cxx \
     datagramIterator.cxx \
     datagramSink.cxx \
     dcast.cxx \
     encrypt_string.cxx \
     error_utils.cxx \
+    fileMapping.cxx \
     fileReference.cxx \
     hashGeneratorBase.cxx hashVal.cxx \
     memoryInfo.cxx memoryUsage.cxx memoryUsagePointerCounts.cxx \
@@ -139,12 +143,15 @@
     compress_string.h \
     config_express.h \
     copy_stream.h \
-    datagram.I datagram.h datagramGenerator.I \
+    datagram.I datagram.h \
+    datagramBufferPool.I datagramBufferPool.h \
+    datagramGenerator.I \
     datagramGenerator.h \
     datagramIterator.I datagramIterator.h datagramSink.I datagramSink.h \
     dcast.h dcast.T \
     encrypt_string.h \
     error_utils.h \
+    fileMapping.h fileMapping.I \
     fileReference.h fileReference.I \
     hashGeneratorBase.I hashGeneratorBase.h \
     hashVal.I hashVal.h \
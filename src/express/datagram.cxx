@@ -25,15 +25,45 @@ TypeHandle Datagram::_type_handle;
  */
 Datagram::
 ~Datagram() {
+  release_array();
+}
+
+/**
+ * Copies the contents of the other datagram.  The datagram keeps its own
+ * buffer pool; see set_buffer_pool().
+ */
+Datagram &Datagram::
+operator = (const Datagram &copy) {
+  if (_data != copy._data) {
+    release_array();
+    _data = copy._data;
+  }
+  _stdfloat_double = copy._stdfloat_double;
+  return *this;
+}
+
+/**
+ * Takes over the contents of the other datagram.  The datagram keeps its own
+ * buffer pool; see set_buffer_pool().
+ */
+Datagram &Datagram::
+operator = (Datagram &&from) noexcept {
+  if (this != &from) {
+    release_array();
+    _data = std::move(from._data);
+    _stdfloat_double = from._stdfloat_double;
+  }
+  return *this;
 }
 
 /**
  * Resets the datagram to empty, in preparation for building up a new
- * datagram.
+ * datagram.  If the Datagram has a buffer pool, its storage is returned to
+ * the pool.
  */
 void Datagram::
 clear() {
-  _data.clear();
+  release_array();
 }
 
 /**
@@ -101,11 +131,11 @@ pad_bytes(size_t size) {
 
   if (_data == nullptr) {
     // Create a new array.
-    _data = PTA_uchar::empty_array(0);
+    _data = new_array();
 
   } else if (_data.get_ref_count() != 1) {
     // Copy on write.
-    PTA_uchar new_data = PTA_uchar::empty_array(0);
+    PTA_uchar new_data = new_array();
     new_data.v() = _data.v();
     _data = new_data;
   }
@@ -131,11 +161,11 @@ append_data(const void *data, size_t size) {
 
   if (_data == nullptr) {
     // Create a new array.
-    _data = PTA_uchar::empty_array(0);
+    _data = new_array();
 
   } else if (_data.get_ref_count() != 1) {
     // Copy on write.
-    PTA_uchar new_data = PTA_uchar::empty_array(0);
+    PTA_uchar new_data = new_array();
     new_data.v() = _data.v();
     _data = new_data;
   }
@@ -159,7 +189,13 @@ void Datagram::
 assign(const void *data, size_t size) {
   nassertv((int)size >= 0);
 
-  _data = PTA_uchar::empty_array(0);
+  if (_data == nullptr || _data.get_ref_count() != 1) {
+    release_array();
+    _data = new_array();
+  } else {
+    // We can reuse the array we already have.
+    _data.v().clear();
+  }
   _data.v().insert(_data.v().end(), (const unsigned char *)data,
                    (const unsigned char *)data + size);
 }
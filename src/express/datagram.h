@@ -21,6 +21,8 @@
 #include "littleEndian.h"
 #include "bigEndian.h"
 #include "pta_uchar.h"
+#include "pointerTo.h"
+#include "datagramBufferPool.h"
 
 /**
  * An ordered list of data elements, formatted in memory for transmission over
@@ -34,18 +36,24 @@
  *
  * A Datagram is itself headerless; it is simply a collection of data
  * elements.
+ *
+ * A Datagram may be given a DatagramBufferPool, in which case it takes its
+ * storage from the pool, and returns it there when it is done with it.  A
+ * Datagram constructed as a copy of another uses the same pool, but
+ * assigning one Datagram to another leaves the pool of each unchanged.
  */
 class EXPCL_PANDA_EXPRESS Datagram : public TypedObject {
 PUBLISHED:
   INLINE Datagram() = default;
   INLINE Datagram(const void *data, size_t size);
   INLINE explicit Datagram(vector_uchar data);
+  INLINE explicit Datagram(DatagramBufferPool *pool);
   Datagram(const Datagram &copy) = default;
   Datagram(Datagram &&from) noexcept = default;
   virtual ~Datagram();
 
-  Datagram &operator = (const Datagram &copy) = default;
-  Datagram &operator = (Datagram &&from) noexcept = default;
+  Datagram &operator = (const Datagram &copy);
+  Datagram &operator = (Datagram &&from) noexcept;
 
   virtual void clear();
   void dump_hex(std::ostream &out, unsigned int indent=0) const;
@@ -109,6 +117,9 @@ PUBLISHED:
   INLINE void set_stdfloat_double(bool stdfloat_double);
   INLINE bool get_stdfloat_double() const;
 
+  INLINE void set_buffer_pool(DatagramBufferPool *pool);
+  INLINE DatagramBufferPool *get_buffer_pool() const;
+
   INLINE bool operator == (const Datagram &other) const;
   INLINE bool operator != (const Datagram &other) const;
   INLINE bool operator < (const Datagram &other) const;
@@ -117,7 +128,11 @@ PUBLISHED:
   void write(std::ostream &out, unsigned int indent=0) const;
 
 private:
+  INLINE PTA_uchar new_array() const;
+  INLINE void release_array();
+
   PTA_uchar _data;
+  PT(DatagramBufferPool) _pool;
 
 #ifdef STDFLOAT_DOUBLE
   bool _stdfloat_double = true;
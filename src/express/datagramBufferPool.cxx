@@ -0,0 +1,89 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file datagramBufferPool.cxx
+ * @author lachbr
+ * @date 2026-10-18
+ */
+
+#include "datagramBufferPool.h"
+
+/**
+ *
+ */
+DatagramBufferPool::
+DatagramBufferPool(size_t max_buffers, size_t max_buffer_size) :
+  _max_buffers(max_buffers),
+  _max_buffer_size(max_buffer_size)
+{
+}
+
+/**
+ *
+ */
+DatagramBufferPool::
+~DatagramBufferPool() {
+}
+
+/**
+ * Returns the number of unused arrays currently held by the pool.
+ */
+size_t DatagramBufferPool::
+get_num_free_buffers() const {
+  _lock.lock();
+  size_t num_free = _free_buffers.size();
+  _lock.unlock();
+  return num_free;
+}
+
+/**
+ * Returns an empty array, which is not shared with anything else.  If the
+ * pool has an unused array, that one is returned, with whatever capacity it
+ * had; otherwise, a new array is allocated.
+ */
+PTA_uchar DatagramBufferPool::
+acquire() {
+  PTA_uchar buffer;
+
+  _lock.lock();
+  if (!_free_buffers.empty()) {
+    buffer = std::move(_free_buffers.back());
+    _free_buffers.pop_back();
+  }
+  _lock.unlock();
+
+  if (buffer == nullptr) {
+    buffer = PTA_uchar::empty_array(0);
+  }
+  return buffer;
+}
+
+/**
+ * Gives the indicated array back to the pool, if nothing else is still
+ * sharing it, and clears the pointer.  If the array is still shared, or the
+ * pool is already full, the pointer is merely cleared.
+ */
+void DatagramBufferPool::
+release(PTA_uchar &buffer) {
+  if (buffer == nullptr) {
+    return;
+  }
+
+  if (buffer.get_ref_count() == 1 &&
+      buffer.v().capacity() <= _max_buffer_size) {
+    buffer.v().clear();
+
+    _lock.lock();
+    if (_free_buffers.size() < _max_buffers) {
+      _free_buffers.push_back(std::move(buffer));
+    }
+    _lock.unlock();
+  }
+
+  buffer.clear();
+}
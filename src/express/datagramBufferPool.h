@@ -0,0 +1,60 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file datagramBufferPool.h
+ * @author lachbr
+ * @date 2026-10-18
+ */
+
+#ifndef DATAGRAMBUFFERPOOL_H
+#define DATAGRAMBUFFERPOOL_H
+
+#include "pandabase.h"
+#include "referenceCount.h"
+#include "pta_uchar.h"
+#include "pvector.h"
+#include "mutexImpl.h"
+
+/**
+ * A pool of byte arrays for Datagrams to store their data in.  A Datagram that
+ * has been given a pool takes its array from the pool instead of allocating a
+ * new one, and gives it back when the Datagram is cleared or destructed, if no
+ * other Datagram is still sharing it.  The arrays keep their capacity, so a
+ * program that builds or receives many datagrams of similar size stops
+ * allocating memory altogether once the pool has warmed up.
+ *
+ * Arrays may be returned to the pool from any thread.  Still, it is best for
+ * each thread that creates many datagrams to have a pool of its own, so that
+ * the threads don't contend for the same lock.
+ */
+class EXPCL_PANDA_EXPRESS DatagramBufferPool : public ReferenceCount {
+PUBLISHED:
+  explicit DatagramBufferPool(size_t max_buffers = 256,
+                              size_t max_buffer_size = 65536);
+  ~DatagramBufferPool();
+
+  INLINE size_t get_max_buffers() const;
+  INLINE size_t get_max_buffer_size() const;
+  size_t get_num_free_buffers() const;
+
+public:
+  PTA_uchar acquire();
+  void release(PTA_uchar &buffer);
+
+private:
+  size_t _max_buffers;
+  size_t _max_buffer_size;
+
+  mutable MutexImpl _lock;
+  typedef pvector<PTA_uchar> Buffers;
+  Buffers _free_buffers;
+};
+
+#include "datagramBufferPool.I"
+
+#endif
@@ -0,0 +1,234 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file fileMapping.cxx
+ * @author lachbr
+ * @date 2026-10-18
+ */
+
+#include "fileMapping.h"
+#include "config_express.h"
+#include "virtualFileSystem.h"
+#include "virtualFileSimple.h"
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN 1
+#endif
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+/**
+ *
+ */
+FileMapping::
+FileMapping() :
+  _base(nullptr),
+  _base_size(0),
+  _data(nullptr),
+  _size(0),
+  _mapped(false)
+{
+}
+
+/**
+ *
+ */
+FileMapping::
+~FileMapping() {
+  close();
+}
+
+/**
+ * Makes the indicated range available in memory.  The SubfileInfo may name
+ * either a file within the vfs or a physical file on disk.  If allow_map is
+ * false, or the range can't be mapped from a physical file, it is read into
+ * memory instead.  Returns true on success, false on failure.
+ */
+bool FileMapping::
+open(const SubfileInfo &info, bool allow_map) {
+  close();
+
+  if (info.get_size() <= 0) {
+    return false;
+  }
+  size_t size = (size_t)info.get_size();
+
+  if (allow_map) {
+    VirtualFileSystem *vfs = VirtualFileSystem::get_global_ptr();
+    PT(VirtualFile) vfile = vfs->get_file(info.get_filename());
+    if (vfile == nullptr) {
+      // It's not in the vfs; assume it names a physical file.
+      if (do_map(info.get_filename(), info.get_start(), size)) {
+        return true;
+      }
+
+    } else {
+      // A file that is decompressed on the fly has offsets that don't
+      // correspond to the bytes on disk, so we can't map it.
+      bool compressed = false;
+      if (vfile->is_of_type(VirtualFileSimple::get_class_type())) {
+        compressed = ((VirtualFileSimple *)vfile.p())->is_implicit_pz_file();
+      }
+      std::string extension = vfile->get_filename().get_extension();
+      if (extension == "pz" || extension == "gz") {
+        compressed = true;
+      }
+
+      SubfileInfo system_info;
+      if (!compressed && vfile->get_system_info(system_info) &&
+          (std::streamoff)info.get_start() + (std::streamoff)size <= system_info.get_size()) {
+        std::streampos start = system_info.get_start() + (std::streamoff)info.get_start();
+        if (do_map(system_info.get_filename(), start, size)) {
+          return true;
+        }
+      }
+    }
+  }
+
+  return do_read(info);
+}
+
+/**
+ * Releases the data.  Any pointers previously returned by get_data() become
+ * invalid.
+ */
+void FileMapping::
+close() {
+  if (_mapped) {
+#ifdef _WIN32
+    UnmapViewOfFile(_base);
+#else
+    munmap(_base, _base_size);
+#endif
+  } else if (_base != nullptr) {
+    PANDA_FREE_ARRAY(_base);
+  }
+
+  _base = nullptr;
+  _base_size = 0;
+  _data = nullptr;
+  _size = 0;
+  _mapped = false;
+}
+
+/**
+ * Maps the indicated range of the indicated physical file.  Returns true on
+ * success, false on failure.
+ */
+bool FileMapping::
+do_map(const Filename &filename, std::streampos start, size_t size) {
+  // The mapping must begin on a page boundary (or on Windows, on an
+  // allocation boundary), so we map from there and offset the pointer.
+  uint64_t offset = (uint64_t)(std::streamoff)start;
+
+#ifdef _WIN32
+  SYSTEM_INFO system_info;
+  GetSystemInfo(&system_info);
+  uint64_t base_offset = offset - offset % system_info.dwAllocationGranularity;
+  size_t base_size = size + (size_t)(offset - base_offset);
+
+  std::wstring os_filename = filename.to_os_specific_w();
+  HANDLE file = CreateFileW(os_filename.c_str(), GENERIC_READ, FILE_SHARE_READ,
+                            nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL,
+                            nullptr);
+  if (file == INVALID_HANDLE_VALUE) {
+    return false;
+  }
+
+  HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+  CloseHandle(file);
+  if (mapping == nullptr) {
+    return false;
+  }
+
+  // The view keeps the mapping object open.
+  void *base = MapViewOfFile(mapping, FILE_MAP_COPY, (DWORD)(base_offset >> 32),
+                             (DWORD)(base_offset & 0xffffffff), base_size);
+  CloseHandle(mapping);
+  if (base == nullptr) {
+    return false;
+  }
+
+#else
+  uint64_t page_size = (uint64_t)sysconf(_SC_PAGESIZE);
+  uint64_t base_offset = offset - offset % page_size;
+  size_t base_size = size + (size_t)(offset - base_offset);
+
+  std::string os_filename = filename.to_os_specific();
+  int fd = ::open(os_filename.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return false;
+  }
+
+  // The mapping keeps the file open.
+  void *base = mmap(nullptr, base_size, PROT_READ | PROT_WRITE, MAP_PRIVATE,
+                    fd, (off_t)base_offset);
+  ::close(fd);
+  if (base == MAP_FAILED) {
+    return false;
+  }
+#endif
+
+  if (express_cat.is_debug()) {
+    express_cat.debug()
+      << "Mapped " << size << " bytes at " << offset << " of " << filename
+      << "\n";
+  }
+
+  _base = base;
+  _base_size = base_size;
+  _data = (unsigned char *)base + (offset - base_offset);
+  _size = size;
+  _mapped = true;
+  return true;
+}
+
+/**
+ * Reads the indicated range into a heap buffer.  Returns true on success,
+ * false on failure.
+ */
+bool FileMapping::
+do_read(const SubfileInfo &info) {
+  VirtualFileSystem *vfs = VirtualFileSystem::get_global_ptr();
+  Filename filename = info.get_filename();
+  filename.set_binary();
+
+  std::istream *in = vfs->open_read_file(filename, true);
+  if (in == nullptr) {
+    express_cat.error()
+      << "Couldn't open " << filename << "\n";
+    return false;
+  }
+
+  size_t size = (size_t)info.get_size();
+  unsigned char *data = (unsigned char *)PANDA_MALLOC_ARRAY(size);
+  in->seekg(info.get_start());
+  in->read((char *)data, size);
+  bool success = !in->fail() && (size_t)in->gcount() == size;
+  vfs->close_read_file(in);
+
+  if (!success) {
+    express_cat.error()
+      << "Couldn't read " << size << " bytes at " << info.get_start()
+      << " of " << filename << "\n";
+    PANDA_FREE_ARRAY(data);
+    return false;
+  }
+
+  _base = data;
+  _base_size = size;
+  _data = data;
+  _size = size;
+  _mapped = false;
+  return true;
+}
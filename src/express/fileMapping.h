@@ -0,0 +1,61 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file fileMapping.h
+ * @author lachbr
+ * @date 2026-10-18
+ */
+
+#ifndef FILEMAPPING_H
+#define FILEMAPPING_H
+
+#include "pandabase.h"
+#include "referenceCount.h"
+#include "subfileInfo.h"
+
+/**
+ * This class makes a byte range of a file available in memory.  Where
+ * possible, the range is mapped directly from the file on disk with a private
+ * (copy-on-write) memory mapping, so that the data is paged in on demand and
+ * is never copied unless it is written to.  If the file cannot be mapped, for
+ * instance because it is compressed or encrypted within a Multifile, the
+ * range is instead read into an ordinary heap buffer.
+ *
+ * Either way, the data remains valid for as long as the FileMapping exists.
+ */
+class EXPCL_PANDA_EXPRESS FileMapping : public ReferenceCount {
+public:
+  FileMapping();
+  FileMapping(const FileMapping &copy) = delete;
+  ~FileMapping();
+
+  FileMapping &operator = (const FileMapping &copy) = delete;
+
+  bool open(const SubfileInfo &info, bool allow_map = true);
+  void close();
+
+  INLINE bool is_valid() const;
+  INLINE bool is_mapped() const;
+  INLINE const unsigned char *get_data() const;
+  INLINE unsigned char *get_write_data();
+  INLINE size_t get_size() const;
+
+private:
+  bool do_map(const Filename &filename, std::streampos start, size_t size);
+  bool do_read(const SubfileInfo &info);
+
+  void *_base;
+  size_t _base_size;
+  unsigned char *_data;
+  size_t _size;
+  bool _mapped;
+};
+
+#include "fileMapping.I"
+
+#endif
@@ -4,12 +4,14 @@
 #include "compress_string.cxx"
 #include "copy_stream.cxx"
 #include "datagram.cxx"
+#include "datagramBufferPool.cxx"
 #include "datagramGenerator.cxx"
 #include "datagramIterator.cxx"
 #include "datagramSink.cxx"
 #include "dcast.cxx"
 #include "encrypt_string.cxx"
 #include "error_utils.cxx"
+#include "fileMapping.cxx"
 #include "fileReference.cxx"
 #include "hashGeneratorBase.cxx"
 #include "hashVal.cxx"
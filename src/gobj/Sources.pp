@@ -6,7 +6,7 @@
 #begin lib_target
   #define TARGET gobj
   #define LOCAL_LIBS \
-    pstatclient event linmath mathutil pnmimage gsgbase putil
+    pstatclient event linmath mathutil ssemath pnmimage gsgbase putil
 
   #define BUILDING_DLL BUILDING_PANDA_GOBJ
 
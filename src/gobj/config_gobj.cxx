@@ -543,6 +543,29 @@ ConfigVariableInt glsl_include_recursion_limit
           "enabled.  This is used to prevent infinite recursion when "
           "two shader files include each other."));
 
+ConfigVariableInt animate_vertices_num_threads
+("animate-vertices-num-threads", 0,
+ PRC_DESC("The number of worker threads that will be started to help "
+          "skin the vertices of a large animated mesh on the CPU, when "
+          "hardware skinning is not in use.  The thread that animates the "
+          "mesh also participates.  Set this to 0 to skin all meshes on "
+          "the calling thread."));
+
+ConfigVariableInt animate_vertices_thread_min_rows
+("animate-vertices-thread-min-rows", 8192,
+ PRC_DESC("The minimum number of animated vertices a mesh must have before "
+          "its skinning is split across the threads configured by "
+          "animate-vertices-num-threads.  Smaller meshes aren't worth the "
+          "overhead of waking up the threads."));
+
+ConfigVariableInt texture_decode_num_threads
+("texture-decode-num-threads", 4,
+ PRC_DESC("The number of worker threads that will be started to help "
+          "decode the image files when a batch of textures is loaded at "
+          "once, as when a model with many textures is loaded.  The thread "
+          "that requested the batch also participates.  Set this to 0 to "
+          "decode all textures on the calling thread."));
+
 ConfigureFn(config_gobj) {
   AnimateVerticesRequest::init_type();
   BufferContext::init_type();
@@ -91,5 +91,8 @@ extern EXPCL_PANDA_GOBJ ConfigVariableBool stereo_lens_old_convergence;
 
 extern EXPCL_PANDA_GOBJ ConfigVariableBool glsl_preprocess;
 extern EXPCL_PANDA_GOBJ ConfigVariableInt glsl_include_recursion_limit;
+extern EXPCL_PANDA_GOBJ ConfigVariableInt animate_vertices_num_threads;
+extern EXPCL_PANDA_GOBJ ConfigVariableInt animate_vertices_thread_min_rows;
+extern EXPCL_PANDA_GOBJ ConfigVariableInt texture_decode_num_threads;
 
 #endif
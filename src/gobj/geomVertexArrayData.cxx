@@ -528,6 +528,19 @@ write_datagram(BamWriter *manager, Datagram &dg, void *extra_data) const {
 
   dg.add_uint32(_buffer.get_size());
 
+  if (manager->get_file_minor_ver() >= 47) {
+    // Large arrays may be written out of line, so that they can be mapped
+    // directly from the file when it is loaded.
+    bool file_data = (manager->get_file_endian() == BamWriter::BE_native &&
+                      manager->should_write_file_data(_buffer.get_size()));
+    dg.add_bool(file_data);
+    if (file_data) {
+      SubfileInfo info;
+      manager->write_file_data(info, _buffer.get_read_pointer(true), _buffer.get_size());
+      return;
+    }
+  }
+
   if (manager->get_file_endian() == BamWriter::BE_native) {
     // For native endianness, we only have to write the data directly.
     dg.append_data(_buffer.get_read_pointer(true), _buffer.get_size());
@@ -560,13 +573,43 @@ fillin(DatagramIterator &scan, BamReader *manager, void *extra_data) {
   } else {
     // Now, the array data is just stored directly.
     size_t size = scan.get_uint32();
-    _buffer.unclean_realloc(size);
-    _buffer.set_size(size);
 
-    const unsigned char *source_data =
-      (const unsigned char *)scan.get_datagram().get_data();
-    memcpy(_buffer.get_write_pointer(), source_data + scan.get_current_index(), size);
-    scan.skip_bytes(size);
+    bool file_data = false;
+    if (manager->get_file_minor_ver() >= 47) {
+      file_data = scan.get_bool();
+    }
+
+    if (file_data) {
+      // The data was written out of line.  Reference it directly from the
+      // file, if we can, rather than copying it.
+      SubfileInfo info;
+      manager->read_file_data(info);
+      PT(FileMapping) mapping = manager->map_file_data(info);
+      if (mapping != nullptr && mapping->get_size() == size &&
+          ((uintptr_t)mapping->get_data() % MEMORY_HOOK_ALIGNMENT) == 0) {
+        _buffer.set_mapping(mapping);
+
+      } else {
+        _buffer.unclean_realloc(size);
+        _buffer.set_size(size);
+        if (mapping != nullptr && mapping->get_size() == size) {
+          memcpy(_buffer.get_write_pointer(), mapping->get_data(), size);
+        } else {
+          gobj_cat.error()
+            << "Unable to read vertex data from " << info << "\n";
+          memset(_buffer.get_write_pointer(), 0, size);
+        }
+      }
+
+    } else {
+      _buffer.unclean_realloc(size);
+      _buffer.set_size(size);
+
+      const unsigned char *source_data =
+        (const unsigned char *)scan.get_datagram().get_data();
+      memcpy(_buffer.get_write_pointer(), source_data + scan.get_current_index(), size);
+      scan.skip_bytes(size);
+    }
   }
 
   bool endian_reversed = false;
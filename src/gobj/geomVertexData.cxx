@@ -21,6 +21,10 @@
 #include "bamWriter.h"
 #include "pset.h"
 #include "indent.h"
+#include "config_gobj.h"
+#include "asyncTaskManager.h"
+#include "atomicAdjust.h"
+#include "ssemath.h"
 
 using std::ostream;
 
@@ -1596,6 +1600,14 @@ update_animated_vertices(GeomVertexData::CData *cdata, Thread *current_thread) {
         new GeomVertexArrayDataHandle(cdata->_arrays[blend_array_index].get_read_pointer(current_thread), current_thread);
       const unsigned short *blendt = (const unsigned short *)blend_array_handle->get_read_pointer(true);
 
+      if (animate_vertices_num_threads > 0 &&
+          num_rows >= animate_vertices_thread_min_rows &&
+          Thread::is_threading_supported() &&
+          new_data->do_skin_threaded(new_format, tb_table, blendt, current_thread)) {
+        // The vertices were skinned by several threads at once.
+        return;
+      }
+
       size_t ci;
       for (ci = 0; ci < new_format->get_num_points(); ci++) {
         GeomVertexRewriter data(new_data, new_format->get_point(ci));
@@ -1770,6 +1782,218 @@ update_animated_vertices(GeomVertexData::CData *cdata, Thread *current_thread) {
 }
 
 
+/**
+ * The work of skinning a large mesh, split into ranges of rows that can be
+ * processed by several threads at once.  All of the data needed is gathered
+ * up front, so that the threads don't need to touch the GeomVertexData or the
+ * TransformBlendTable at all.
+ */
+class GeomVertexData::SkinJob {
+public:
+  class Column {
+  public:
+    unsigned char *_data;
+    size_t _stride;
+    int _num_values;
+    bool _is_point;
+    bool _is_normal;
+  };
+
+  void skin_range(int begin, int end);
+  void run();
+  static void run_func(void *data);
+
+  const unsigned short *_blendt;
+  pvector<Column> _columns;
+
+  // One entry per blend in the TransformBlendTable.
+  pvector<LMatrix4f> _mats;
+  pvector<LMatrix4f> _normal_mats;
+  pvector<bool> _normalize;
+
+  pvector<std::pair<int, int> > _ranges;
+  AtomicAdjust::Integer _next_range = 0;
+};
+
+/**
+ * Skins the indicated range of rows, for all of the columns.
+ */
+void GeomVertexData::SkinJob::
+skin_range(int begin, int end) {
+  int first_vertex = begin;
+  int first_bi = _blendt[first_vertex];
+
+  while (first_vertex < end) {
+    // Find the end of the series of vertices that share this blend index,
+    // as in update_animated_vertices().
+    int next_vertex = first_vertex;
+    int next_bi = first_bi;
+    ++next_vertex;
+    while (next_vertex < end) {
+      next_bi = _blendt[next_vertex];
+      if (next_bi != first_bi) {
+        break;
+      }
+      ++next_vertex;
+    }
+
+    size_t num_rows = next_vertex - first_vertex;
+    for (const Column &column : _columns) {
+      unsigned char *datat = column._data + first_vertex * column._stride;
+      if (column._is_point) {
+        if (column._num_values == 3) {
+          table_xform_point3f(datat, num_rows, column._stride, _mats[first_bi]);
+        } else {
+          table_xform_vecbase4f(datat, num_rows, column._stride, _mats[first_bi]);
+        }
+      } else if (column._is_normal) {
+        if (_normalize[first_bi]) {
+          table_xform_normal3f(datat, num_rows, column._stride, _normal_mats[first_bi]);
+        } else if (column._num_values == 3) {
+          table_xform_vector3f(datat, num_rows, column._stride, _normal_mats[first_bi]);
+        } else {
+          table_xform_vecbase4f(datat, num_rows, column._stride, _normal_mats[first_bi]);
+        }
+      } else {
+        if (column._num_values == 3) {
+          table_xform_vector3f(datat, num_rows, column._stride, _mats[first_bi]);
+        } else {
+          table_xform_vecbase4f(datat, num_rows, column._stride, _mats[first_bi]);
+        }
+      }
+    }
+
+    first_vertex = next_vertex;
+    first_bi = next_bi;
+  }
+}
+
+/**
+ * Skins ranges of rows until there are none left to claim.  This is run by
+ * the calling thread as well as by each of the worker threads.
+ */
+void GeomVertexData::SkinJob::
+run() {
+  AtomicAdjust::Integer num_ranges = (AtomicAdjust::Integer)_ranges.size();
+  AtomicAdjust::Integer i = AtomicAdjust::add(_next_range, 1) - 1;
+  while (i < num_ranges) {
+    skin_range(_ranges[i].first, _ranges[i].second);
+    i = AtomicAdjust::add(_next_range, 1) - 1;
+  }
+}
+
+/**
+ * The function passed to AsyncTaskManager::run_parallel().
+ */
+void GeomVertexData::SkinJob::
+run_func(void *data) {
+  ((SkinJob *)data)->run();
+}
+
+/**
+ * Applies the transforms of the indicated TransformBlendTable to this
+ * GeomVertexData, which must be the animated copy, splitting the work across
+ * the threads of the "skinning" task chain.  This is only possible when all
+ * of the point and vector columns are 3- or 4-component floats, and the blend
+ * indices are a table of ushorts.  Returns true if the vertices were
+ * animated, or false if this isn't possible and the caller should do it
+ * instead.
+ */
+bool GeomVertexData::
+do_skin_threaded(const GeomVertexFormat *format,
+                 const TransformBlendTable *tb_table,
+                 const unsigned short *blendt, Thread *current_thread) {
+  SkinJob job;
+  job._blendt = blendt;
+
+  // First, make sure we can handle all of the columns.
+  size_t num_points = format->get_num_points();
+  size_t num_columns = num_points + format->get_num_vectors();
+  bool any_normals = false;
+  for (size_t ci = 0; ci < num_columns; ++ci) {
+    const InternalName *name = (ci < num_points)
+      ? format->get_point(ci) : format->get_vector(ci - num_points);
+
+    int array_index;
+    const GeomVertexColumn *column;
+    if (!format->get_array_info(name, array_index, column)) {
+      return false;
+    }
+    if (column->get_numeric_type() != NT_float32 ||
+        (column->get_num_values() != 3 && column->get_num_values() != 4)) {
+      return false;
+    }
+  }
+
+  // Now get the pointers.  We hold the array handles until the job is done.
+  pvector<PT(GeomVertexArrayDataHandle)> handles(format->get_num_arrays());
+  for (size_t ci = 0; ci < num_columns; ++ci) {
+    const InternalName *name = (ci < num_points)
+      ? format->get_point(ci) : format->get_vector(ci - num_points);
+
+    int array_index;
+    const GeomVertexColumn *column;
+    format->get_array_info(name, array_index, column);
+    if (handles[array_index] == nullptr) {
+      handles[array_index] = modify_array_handle(array_index);
+    }
+
+    SkinJob::Column job_column;
+    job_column._data = handles[array_index]->get_write_pointer() + column->get_start();
+    job_column._stride = format->get_array(array_index)->get_stride();
+    job_column._num_values = column->get_num_values();
+    job_column._is_point = (ci < num_points);
+    job_column._is_normal = !job_column._is_point && column->get_contents() == C_normal;
+    any_normals = any_normals || job_column._is_normal;
+    job._columns.push_back(job_column);
+  }
+
+  // Fetch all of the matrices.
+  int num_blends = tb_table->get_num_blends();
+  job._mats.reserve(num_blends);
+  if (any_normals) {
+    job._normal_mats.reserve(num_blends);
+    job._normalize.reserve(num_blends);
+  }
+  for (int bi = 0; bi < num_blends; ++bi) {
+    LMatrix4 mat;
+    tb_table->get_blend(bi).get_blend(mat, current_thread);
+    job._mats.push_back(LCAST(float, mat));
+
+    if (any_normals) {
+      LMatrix4 xform;
+      job._normalize.push_back(calc_normal_xform(mat, xform));
+      job._normal_mats.push_back(LCAST(float, xform));
+    }
+  }
+
+  // Cut the rows into ranges.  We make several times as many ranges as
+  // threads, so that the threads finish at about the same time.
+  int num_threads = animate_vertices_num_threads;
+  const SparseArray &rows = tb_table->get_rows();
+  int num_subranges = rows.get_num_subranges();
+  int num_rows = 0;
+  for (int i = 0; i < num_subranges; ++i) {
+    num_rows += rows.get_subrange_end(i) - rows.get_subrange_begin(i);
+  }
+  int range_size = std::max(num_rows / ((num_threads + 1) * 4), 256);
+
+  for (int i = 0; i < num_subranges; ++i) {
+    int begin = rows.get_subrange_begin(i);
+    int end = rows.get_subrange_end(i);
+    while (begin < end) {
+      int range_end = std::min(begin + range_size, end);
+      job._ranges.push_back(std::pair<int, int>(begin, range_end));
+      begin = range_end;
+    }
+  }
+
+  AsyncTaskManager::get_global_ptr()->run_parallel("skinning", num_threads,
+    (int)job._ranges.size(), &SkinJob::run_func, &job);
+
+  return true;
+}
+
 /**
  * Transforms a range of vertices for one particular column, as a point.
  */
@@ -1830,29 +2054,7 @@ do_transform_vector_column(const GeomVertexFormat *format, GeomVertexRewriter &d
   bool normalize = false;
   if (data_column->get_contents() == C_normal) {
     // This is to preserve perpendicularity to the surface.
-    LVecBase3 scale_sq(mat.get_row3(0).length_squared(),
-                       mat.get_row3(1).length_squared(),
-                       mat.get_row3(2).length_squared());
-    if (IS_THRESHOLD_EQUAL(scale_sq[0], scale_sq[1], 2.0e-3f) &&
-        IS_THRESHOLD_EQUAL(scale_sq[0], scale_sq[2], 2.0e-3f)) {
-      // There is a uniform scale.
-      LVecBase3 scale, shear, hpr;
-      if (IS_THRESHOLD_EQUAL(scale_sq[0], 1, 2.0e-3f)) {
-        // No scale to worry about.
-        xform = mat;
-      } else if (decompose_matrix(mat.get_upper_3(), scale, shear, hpr)) {
-        // Make a new matrix with scale/translate taken out of the equation.
-        compose_matrix(xform, LVecBase3(1, 1, 1), shear, hpr, LVecBase3::zero());
-      } else {
-        normalize = true;
-      }
-    } else {
-      // There is a non-uniform scale, so we need to do all this to preserve
-      // orthogonality to the surface.
-      xform.invert_from(mat);
-      xform.transpose_in_place();
-      normalize = true;
-    }
+    normalize = calc_normal_xform(mat, xform);
   } else {
     xform = mat;
   }
@@ -1897,6 +2099,123 @@ do_transform_vector_column(const GeomVertexFormat *format, GeomVertexRewriter &d
   }
 }
 
+/**
+ * Computes the matrix that should be used to transform normals by the
+ * indicated matrix, so that they remain perpendicular to the surface.
+ * Returns true if the transformed normals must also be normalized.
+ */
+bool GeomVertexData::
+calc_normal_xform(const LMatrix4 &mat, LMatrix4 &xform) {
+  LVecBase3 scale_sq(mat.get_row3(0).length_squared(),
+                     mat.get_row3(1).length_squared(),
+                     mat.get_row3(2).length_squared());
+  if (IS_THRESHOLD_EQUAL(scale_sq[0], scale_sq[1], 2.0e-3f) &&
+      IS_THRESHOLD_EQUAL(scale_sq[0], scale_sq[2], 2.0e-3f)) {
+    // There is a uniform scale.
+    LVecBase3 scale, shear, hpr;
+    if (IS_THRESHOLD_EQUAL(scale_sq[0], 1, 2.0e-3f)) {
+      // No scale to worry about.
+      xform = mat;
+    } else if (decompose_matrix(mat.get_upper_3(), scale, shear, hpr)) {
+      // Make a new matrix with scale/translate taken out of the equation.
+      compose_matrix(xform, LVecBase3(1, 1, 1), shear, hpr, LVecBase3::zero());
+    } else {
+      xform = mat;
+      return true;
+    }
+    return false;
+  }
+
+  // There is a non-uniform scale, so we need to do all this to preserve
+  // orthogonality to the surface.
+  xform.invert_from(mat);
+  xform.transpose_in_place();
+  return true;
+}
+
+/**
+ * Loads the three floats at the indicated address into the first three
+ * components of a fltx4.  If may_overread is true, this simply loads 16
+ * bytes, which is only safe if there is more data following the three
+ * floats.
+ */
+static INLINE fltx4
+load_row3f(const unsigned char *p, bool may_overread) {
+  if (may_overread) {
+    return LoadUnalignedSIMD(p);
+  }
+  float tmp[4];
+  memcpy(tmp, p, sizeof(float) * 3);
+  tmp[3] = 0.0f;
+  return LoadUnalignedSIMD(tmp);
+}
+
+/**
+ * Transforms a table of three-component float vectors by the indicated
+ * matrix, four rows at a time.  If translate is true, they are transformed as
+ * points, otherwise as vectors; if normalize is true, the results are also
+ * normalized.  Returns the number of rows processed; the remaining rows (less
+ * than four) are left to the caller.
+ */
+static size_t
+simd_xform_rows3f(unsigned char *datat, size_t num_rows, size_t stride,
+                  const LMatrix4f &matf, bool translate, bool normalize) {
+  fltx4 m00 = ReplicateX4(matf(0, 0));
+  fltx4 m01 = ReplicateX4(matf(0, 1));
+  fltx4 m02 = ReplicateX4(matf(0, 2));
+  fltx4 m10 = ReplicateX4(matf(1, 0));
+  fltx4 m11 = ReplicateX4(matf(1, 1));
+  fltx4 m12 = ReplicateX4(matf(1, 2));
+  fltx4 m20 = ReplicateX4(matf(2, 0));
+  fltx4 m21 = ReplicateX4(matf(2, 1));
+  fltx4 m22 = ReplicateX4(matf(2, 2));
+  fltx4 m30 = translate ? ReplicateX4(matf(3, 0)) : Four_Zeros;
+  fltx4 m31 = translate ? ReplicateX4(matf(3, 1)) : Four_Zeros;
+  fltx4 m32 = translate ? ReplicateX4(matf(3, 2)) : Four_Zeros;
+
+  size_t i = 0;
+  for (; i + 4 <= num_rows; i += 4) {
+    unsigned char *p0 = datat + i * stride;
+    unsigned char *p1 = p0 + stride;
+    unsigned char *p2 = p1 + stride;
+    unsigned char *p3 = p2 + stride;
+
+    // Load the four rows and turn them on their side, so that we have the X,
+    // Y and Z components of all four rows in x, y and z.
+    fltx4 x = load_row3f(p0, true);
+    fltx4 y = load_row3f(p1, true);
+    fltx4 z = load_row3f(p2, true);
+    fltx4 w = load_row3f(p3, i + 4 < num_rows);
+    TransposeSIMD(x, y, z, w);
+
+    fltx4 rx = MaddSIMD(x, m00, MaddSIMD(y, m10, MaddSIMD(z, m20, m30)));
+    fltx4 ry = MaddSIMD(x, m01, MaddSIMD(y, m11, MaddSIMD(z, m21, m31)));
+    fltx4 rz = MaddSIMD(x, m02, MaddSIMD(y, m12, MaddSIMD(z, m22, m32)));
+
+    if (normalize) {
+      // Leave zero-length vectors alone, as LVector3f::normalize() does.
+      fltx4 len_sq = MaddSIMD(rx, rx, MaddSIMD(ry, ry, MulSIMD(rz, rz)));
+      fltx4 is_zero = CmpEqSIMD(len_sq, Four_Zeros);
+      len_sq = OrSIMD(AndNotSIMD(is_zero, len_sq), AndSIMD(is_zero, Four_Ones));
+      fltx4 inv_len = ReciprocalSqrtSIMD(len_sq);
+      rx = MulSIMD(rx, inv_len);
+      ry = MulSIMD(ry, inv_len);
+      rz = MulSIMD(rz, inv_len);
+    }
+
+    // Turn them back, and store only the first three components of each
+    // row, since the rest of the row may belong to another column.
+    w = Four_Zeros;
+    TransposeSIMD(rx, ry, rz, w);
+    StoreUnaligned3SIMD((float *)p0, rx);
+    StoreUnaligned3SIMD((float *)p1, ry);
+    StoreUnaligned3SIMD((float *)p2, rz);
+    StoreUnaligned3SIMD((float *)p3, w);
+  }
+
+  return i;
+}
+
 /**
  * Transforms each of the LPoint3f objects in the indicated table by the
  * indicated matrix.
@@ -1906,7 +2225,8 @@ table_xform_point3f(unsigned char *datat, size_t num_rows, size_t stride,
                     const LMatrix4f &matf) {
   // We don't bother checking for the unaligned case here, because in practice
   // it doesn't matter with a 3-component point.
-  for (size_t i = 0; i < num_rows; ++i) {
+  size_t i = simd_xform_rows3f(datat, num_rows, stride, matf, true, false);
+  for (; i < num_rows; ++i) {
     LPoint3f &vertex = *(LPoint3f *)(&datat[i * stride]);
     vertex *= matf;
   }
@@ -1921,7 +2241,8 @@ table_xform_normal3f(unsigned char *datat, size_t num_rows, size_t stride,
                      const LMatrix4f &matf) {
   // We don't bother checking for the unaligned case here, because in practice
   // it doesn't matter with a 3-component vector.
-  for (size_t i = 0; i < num_rows; ++i) {
+  size_t i = simd_xform_rows3f(datat, num_rows, stride, matf, false, true);
+  for (; i < num_rows; ++i) {
     LNormalf &vertex = *(LNormalf *)(&datat[i * stride]);
     vertex *= matf;
     vertex.normalize();
@@ -1937,7 +2258,8 @@ table_xform_vector3f(unsigned char *datat, size_t num_rows, size_t stride,
                      const LMatrix4f &matf) {
   // We don't bother checking for the unaligned case here, because in practice
   // it doesn't matter with a 3-component vector.
-  for (size_t i = 0; i < num_rows; ++i) {
+  size_t i = simd_xform_rows3f(datat, num_rows, stride, matf, false, false);
+  for (; i < num_rows; ++i) {
     LVector3f &vertex = *(LVector3f *)(&datat[i * stride]);
     vertex *= matf;
   }
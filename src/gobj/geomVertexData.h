@@ -341,6 +341,10 @@ private:
                                  const LMatrix4 &mat, int begin_row, int end_row);
   void do_transform_vector_column(const GeomVertexFormat *format, GeomVertexRewriter &data,
                                   const LMatrix4 &mat, int begin_row, int end_row);
+  bool do_skin_threaded(const GeomVertexFormat *format,
+                        const TransformBlendTable *tb_table,
+                        const unsigned short *blendt, Thread *current_thread);
+  static bool calc_normal_xform(const LMatrix4 &mat, LMatrix4 &xform);
   static void table_xform_point3f(unsigned char *datat, size_t num_rows,
                                   size_t stride, const LMatrix4f &matf);
   static void table_xform_normal3f(unsigned char *datat, size_t num_rows,
@@ -350,6 +354,8 @@ private:
   static void table_xform_vecbase4f(unsigned char *datat, size_t num_rows,
                                     size_t stride, const LMatrix4f &matf);
 
+  class SkinJob;
+
   static PStatCollector _convert_pcollector;
   static PStatCollector _scale_color_pcollector;
   static PStatCollector _set_color_pcollector;
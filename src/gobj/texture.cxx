@@ -38,6 +38,8 @@
 #include "indent.h"
 #include "cmath.h"
 #include "pStatTimer.h"
+#include "pnmFileType.h"
+#include "lightMutexHolder.h"
 #include "pbitops.h"
 #include "streamReader.h"
 #include "texturePeeker.h"
@@ -68,6 +70,8 @@ ConfigVariableEnum<Texture::QualityLevel> texture_quality_level
           "renderers.  See Texture::set_quality_level()."));
 
 PStatCollector Texture::_texture_read_pcollector("*:Texture:Read");
+Texture::DecodePCollectors *Texture::_decode_pcollectors = nullptr;
+LightMutex Texture::_decode_pcollectors_lock;
 TypeHandle Texture::_type_handle;
 TypeHandle Texture::CData::_type_handle;
 AutoTextureScale Texture::_textures_power_2 = ATS_unspecified;
@@ -3117,10 +3121,13 @@ do_read_one(CData *cdata, const Filename &fullpath, const Filename &alpha_fullpa
     }
 
     bool success;
-    if (read_floating_point) {
-      success = pfm.read(image_reader);
-    } else {
-      success = image.read(image_reader);
+    {
+      PStatTimer timer(get_decode_pcollector(image_reader->get_type()));
+      if (read_floating_point) {
+        success = pfm.read(image_reader);
+      } else {
+        success = image.read(image_reader);
+      }
     }
 
     if (!success) {
@@ -3168,7 +3175,12 @@ do_read_one(CData *cdata, const Filename &fullpath, const Filename &alpha_fullpa
         alpha_image.set_read_size(image.get_x_size(), image.get_y_size());
       }
 
-      if (!alpha_image.read(alpha_image_reader)) {
+      bool success;
+      {
+        PStatTimer timer(get_decode_pcollector(alpha_image_reader->get_type()));
+        success = alpha_image.read(alpha_image_reader);
+      }
+      if (!success) {
         gobj_cat.error()
           << "Texture::read() - couldn't read (alpha): " << alpha_fullpath << endl;
         return false;
@@ -9146,6 +9158,14 @@ do_filter_2d_mipmap_pages(const CData *cdata,
     --num_color_components;
   }
 
+  // sRGB rows are filtered a whole row at a time, so that the conversions can
+  // be vectorized.  This buffer holds the decoded rows.
+  bool srgb_rows = is_srgb(cdata->_format) && x_size != 1;
+  pvector<float> srgb_buffer;
+  if (srgb_rows) {
+    srgb_buffer.resize((size_t)to_x_size * pixel_size * 5);
+  }
+
   int num_pages = cdata->_z_size * cdata->_num_views;
   for (int z = 0; z < num_pages; ++z) {
     // For each level.
@@ -9159,7 +9179,13 @@ do_filter_2d_mipmap_pages(const CData *cdata,
         // For each row.
         nassertv(p == to._image.p() + z * to._page_size + (y / 2) * to_row_size);
         nassertv(q == from._image.p() + z * from._page_size + y * row_size);
-        if (x_size != 1) {
+        if (srgb_rows) {
+          filter_2d_unsigned_byte_srgb_row(p, q, to_x_size, pixel_size,
+                                           row_size, alpha, &srgb_buffer[0]);
+          p += to_row_size;
+          q += row_size;
+
+        } else if (x_size != 1) {
           int x;
           for (x = 0; x < x_size - 1; x += 2) {
             // For each pixel.
@@ -9521,6 +9547,52 @@ filter_2d_unsigned_byte_srgb_sse2(unsigned char *&p, const unsigned char *&q,
   ++q;
 }
 
+/**
+ * Averages each 2x2 block of pixels of a pair of sRGB rows into a single
+ * pixel, for producing the next mipmap level.  This produces the same result
+ * as filter_2d_unsigned_byte_srgb_sse2() for each component, but decodes and
+ * encodes the whole row at once.  The buffer must have room for 5 *
+ * to_x_size * pixel_size floats.
+ */
+void Texture::
+filter_2d_unsigned_byte_srgb_row(unsigned char *p, const unsigned char *q,
+                                 int to_x_size, size_t pixel_size,
+                                 size_t row_size, bool alpha, float *buffer) {
+  size_t to_count = (size_t)to_x_size * pixel_size;
+  size_t from_count = to_count * 2;
+  float *top = buffer;
+  float *bottom = top + from_count;
+  float *result = bottom + from_count;
+
+  decode_sRGB_float(q, top, from_count);
+  decode_sRGB_float(q + row_size, bottom, from_count);
+
+  for (int x = 0; x < to_x_size; ++x) {
+    size_t to_i = x * pixel_size;
+    size_t from_i = to_i * 2;
+    for (size_t c = 0; c < pixel_size; ++c) {
+      result[to_i + c] = (top[from_i + c] +
+                          top[from_i + pixel_size + c] +
+                          bottom[from_i + c] +
+                          bottom[from_i + pixel_size + c]) * 0.25f;
+    }
+  }
+
+  encode_sRGB_uchar(result, p, to_count);
+
+  if (alpha) {
+    // Alpha is always linear; redo it as in filter_2d_unsigned_byte().
+    for (int x = 0; x < to_x_size; ++x) {
+      size_t to_i = x * pixel_size + pixel_size - 1;
+      size_t from_i = x * pixel_size * 2 + pixel_size - 1;
+      p[to_i] = (unsigned char)(((unsigned int)q[from_i] +
+                                 (unsigned int)q[from_i + pixel_size] +
+                                 (unsigned int)q[from_i + row_size] +
+                                 (unsigned int)q[from_i + pixel_size + row_size]) >> 2);
+    }
+  }
+}
+
 /**
  * Averages a 2x2 block of pixel components into a single pixel component, for
  * producing the next mipmap level.  Increments p and q to the next component.
@@ -10079,9 +10151,22 @@ do_write_datagram_rawdata(CData *cdata, BamWriter *manager, Datagram &me) {
   } else {
     me.add_uint8(cdata->_ram_images.size());
     for (size_t n = 0; n < cdata->_ram_images.size(); ++n) {
+      size_t size = cdata->_ram_images[n]._image.size();
       me.add_uint32(cdata->_ram_images[n]._page_size);
-      me.add_uint32(cdata->_ram_images[n]._image.size());
-      me.append_data(cdata->_ram_images[n]._image, cdata->_ram_images[n]._image.size());
+      me.add_uint32(size);
+
+      if (manager->get_file_minor_ver() >= 47) {
+        // Large images may be written out of line, so that they can be read
+        // straight from the file when it is loaded.
+        bool file_data = manager->should_write_file_data(size);
+        me.add_bool(file_data);
+        if (file_data) {
+          SubfileInfo info;
+          manager->write_file_data(info, cdata->_ram_images[n]._image.p(), size);
+          continue;
+        }
+      }
+      me.append_data(cdata->_ram_images[n]._image, size);
     }
   }
 }
@@ -10355,6 +10440,30 @@ do_fillin_rawdata(CData *cdata, DatagramIterator &scan, BamReader *manager) {
     // fill the cdata->_image buffer with image data
     size_t u_size = scan.get_uint32();
 
+    bool file_data = false;
+    if (manager->get_file_minor_ver() >= 47) {
+      file_data = scan.get_bool();
+    }
+
+    if (file_data) {
+      // The image was written out of line.  Copy it straight from the file
+      // (or from a mapping of it), instead of by way of a datagram.
+      SubfileInfo info;
+      manager->read_file_data(info);
+      PT(FileMapping) mapping = manager->map_file_data(info);
+      if (mapping == nullptr || mapping->get_size() != u_size) {
+        gobj_cat.error()
+          << "Unable to read RAM image " << n << " from " << info << "\n";
+        return;
+      }
+
+      PTA_uchar image = PTA_uchar::empty_array(u_size, get_class_type());
+      memcpy(image.p(), mapping->get_data(), u_size);
+
+      cdata->_ram_images[n]._image = image;
+      continue;
+    }
+
     // Protect against large allocation.
     if (u_size > scan.get_remaining_size()) {
       gobj_cat.error()
@@ -10431,6 +10540,27 @@ do_fillin_from(CData *cdata, const Texture *dummy) {
   }
 }
 
+/**
+ * Returns the collector that times the decoding of images of the indicated
+ * type.  Textures may be read from several threads at once, so the table is
+ * protected by a lock; the collectors themselves are never removed.
+ */
+PStatCollector &Texture::
+get_decode_pcollector(PNMFileType *type) {
+  LightMutexHolder holder(_decode_pcollectors_lock);
+  if (_decode_pcollectors == nullptr) {
+    _decode_pcollectors = new DecodePCollectors;
+  }
+
+  DecodePCollectors::iterator pi = _decode_pcollectors->find(type);
+  if (pi == _decode_pcollectors->end()) {
+    std::string name = (type != nullptr) ? type->get_name() : "Unknown";
+    pi = _decode_pcollectors->insert(DecodePCollectors::value_type(
+      type, PStatCollector(_texture_read_pcollector, name))).first;
+  }
+  return (*pi).second;
+}
+
 /**
  *
  */
@@ -28,6 +28,7 @@
 #include "config_gobj.h"
 #include "pStatCollector.h"
 #include "pmutex.h"
+#include "lightMutex.h"
 #include "mutexHolder.h"
 #include "conditionVar.h"
 #include "loaderOptions.h"
@@ -894,6 +895,11 @@ private:
   static void filter_2d_unsigned_byte_srgb_sse2(unsigned char *&p,
                                                 const unsigned char *&q,
                                                 size_t pixel_size, size_t row_size);
+  static void filter_2d_unsigned_byte_srgb_row(unsigned char *p,
+                                               const unsigned char *q,
+                                               int to_x_size, size_t pixel_size,
+                                               size_t row_size, bool alpha,
+                                               float *buffer);
   static void filter_2d_unsigned_short(unsigned char *&p,
                                        const unsigned char *&q,
                                        size_t pixel_size, size_t row_size);
@@ -1066,6 +1072,13 @@ private:
 
   static AutoTextureScale _textures_power_2;
   static PStatCollector _texture_read_pcollector;
+
+  // One child of _texture_read_pcollector for each image file type, so that
+  // the decode time can be broken down by format.
+  static PStatCollector &get_decode_pcollector(PNMFileType *type);
+  typedef pmap<PNMFileType *, PStatCollector> DecodePCollectors;
+  static DecodePCollectors *_decode_pcollectors;
+  static LightMutex _decode_pcollectors_lock;
   static PT(Texture) _error_texture;
 
   // Datagram stuff
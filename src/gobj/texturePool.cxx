@@ -27,6 +27,8 @@
 #include "load_dso.h"
 #include "mutexHolder.h"
 #include "dcast.h"
+#include "asyncTaskManager.h"
+#include "atomicAdjust.h"
 
 #include <algorithm>
 
@@ -567,6 +569,72 @@ ns_load_texture(const Filename &orig_filename,
   return tex;
 }
 
+/**
+ * A batch of textures being loaded by load_textures().  Each thread claims
+ * the next unclaimed request until there are none left.
+ */
+class TexturePool::LoadJob {
+public:
+  void run();
+  static void run_func(void *data);
+
+  TexturePool *_pool;
+  LoadRequests *_requests;
+  AtomicAdjust::Integer _next_request = 0;
+};
+
+/**
+ * Loads requests until there are none left to claim.  This is run by the
+ * calling thread as well as by each of the worker threads.
+ */
+void TexturePool::LoadJob::
+run() {
+  AtomicAdjust::Integer num_requests = (AtomicAdjust::Integer)_requests->size();
+  AtomicAdjust::Integer i = AtomicAdjust::add(_next_request, 1) - 1;
+  while (i < num_requests) {
+    LoadRequest &request = (*_requests)[i];
+    if (request._alpha_filename.empty()) {
+      request._texture =
+        _pool->ns_load_texture(request._filename,
+                               request._primary_file_num_channels,
+                               request._read_mipmaps, request._options);
+    } else {
+      request._texture =
+        _pool->ns_load_texture(request._filename, request._alpha_filename,
+                               request._primary_file_num_channels,
+                               request._alpha_file_channel,
+                               request._read_mipmaps, request._options);
+    }
+    i = AtomicAdjust::add(_next_request, 1) - 1;
+  }
+}
+
+/**
+ * The function passed to AsyncTaskManager::run_parallel().
+ */
+void TexturePool::LoadJob::
+run_func(void *data) {
+  ((LoadJob *)data)->run();
+}
+
+/**
+ * The nonstatic implementation of load_textures().
+ */
+void TexturePool::
+ns_load_textures(LoadRequests &requests) {
+  LoadJob job;
+  job._pool = this;
+  job._requests = &requests;
+
+  // ns_load_texture() only holds the lock while it consults the pool, so the
+  // threads can decode their images at the same time.  If the same texture
+  // appears twice in the batch it may be decoded twice, but only the first
+  // copy to finish is kept in the pool.
+  AsyncTaskManager::get_global_ptr()->run_parallel("texture_decode",
+    texture_decode_num_threads, (int)requests.size(),
+    &LoadJob::run_func, &job);
+}
+
 /**
  * The nonstatic implementation of load_3d_texture().
  */
@@ -1216,7 +1284,13 @@ try_load_cache(PT(Texture) &tex, BamCache *cache, const Filename &filename,
       dummy->ensure_loader_type(filename);
       dummy.clear();
 
-      record = cache->lookup(filename, "txo");
+      // The texture flags that only affect how the texture is used, rather
+      // than its contents, are left out of the content key.
+      int key_flags = options.get_texture_flags() &
+        ~(LoaderOptions::TF_preload | LoaderOptions::TF_preload_simple);
+      record = cache->lookup(filename, "txo",
+                             format_string(key_flags) + " " +
+                             format_string(options.get_texture_num_views()));
       if (record != nullptr) {
         if (record->has_data()) {
           tex = DCAST(Texture, record->get_data());
@@ -23,6 +23,7 @@
 #include "loaderOptions.h"
 #include "pmutex.h"
 #include "pmap.h"
+#include "pvector.h"
 #include "textureCollection.h"
 
 class TexturePoolFilter;
@@ -104,6 +105,25 @@ PUBLISHED:
   static void write(std::ostream &out);
 
 public:
+  /**
+   * One texture to be loaded by load_textures().  The parameters have the
+   * same meaning as those to load_texture(); _texture is filled in with the
+   * result.
+   */
+  class LoadRequest {
+  public:
+    Filename _filename;
+    Filename _alpha_filename;
+    int _primary_file_num_channels = 0;
+    int _alpha_file_channel = 0;
+    bool _read_mipmaps = false;
+    LoaderOptions _options;
+    PT(Texture) _texture;
+  };
+  typedef pvector<LoadRequest> LoadRequests;
+
+  BLOCKING INLINE static void load_textures(LoadRequests &requests);
+
   typedef Texture::MakeTextureFunc MakeTextureFunc;
   void register_texture_type(MakeTextureFunc *func, const std::string &extensions);
 
@@ -124,6 +144,7 @@ private:
                            int alpha_file_channel,
                            bool read_mipmaps,
                            const LoaderOptions &options);
+  void ns_load_textures(LoadRequests &requests);
   Texture *ns_load_3d_texture(const Filename &filename_pattern,
                               bool read_mipmaps,
                               const LoaderOptions &options);
@@ -175,6 +196,8 @@ private:
 
   void load_filters();
 
+  class LoadJob;
+
   static TexturePool *_global_ptr;
 
   Mutex _lock;
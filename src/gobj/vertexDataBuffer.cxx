@@ -39,6 +39,7 @@ operator = (const VertexDataBuffer &copy) {
   _size = copy._size;
   _reserved_size = copy._size;
   _block = copy._block;
+  _mapping = copy._mapping;
   nassertv(_reserved_size >= _size);
 }
 
@@ -55,6 +56,7 @@ swap(VertexDataBuffer &other) {
   size_t reserved_size = _reserved_size;
 
   _block.swap(other._block);
+  _mapping.swap(other._mapping);
 
   _resident_data = other._resident_data;
   _size = other._size;
@@ -119,8 +121,9 @@ do_unclean_realloc(size_t reserved_size) {
         << this << ".unclean_realloc(" << reserved_size << ")\n";
     }
 
-    // If we're paged out, discard the page.
+    // If we're paged out or mapped, discard the page or mapping.
     _block = nullptr;
+    _mapping = nullptr;
 
     if (_resident_data != nullptr) {
       nassertv(_reserved_size != 0);
@@ -151,8 +154,8 @@ do_unclean_realloc(size_t reserved_size) {
  */
 void VertexDataBuffer::
 do_page_out(VertexDataBook &book) {
-  if (_block != nullptr || _reserved_size == 0) {
-    // We're already paged out.
+  if (_block != nullptr || _mapping != nullptr || _reserved_size == 0) {
+    // We're already paged out, or backed by a file mapping.
     return;
   }
   nassertv(_resident_data != nullptr);
@@ -194,11 +197,41 @@ do_page_in() {
     return;
   }
 
-  nassertv(_block != nullptr);
   nassertv(_reserved_size == _size);
 
+  if (_mapping != nullptr) {
+    // Copy the data out of the mapping.  The mapping itself is released,
+    // since we no longer need it.
+    _resident_data = (unsigned char *)get_class_type().allocate_array(_size);
+    nassertv(_resident_data != nullptr);
+
+    memcpy(_resident_data, _mapping->get_data(), _size);
+    _mapping = nullptr;
+    return;
+  }
+
+  nassertv(_block != nullptr);
+
   _resident_data = (unsigned char *)get_class_type().allocate_array(_size);
   nassertv(_resident_data != nullptr);
 
   memcpy(_resident_data, _block->get_pointer(true), _size);
 }
+
+/**
+ * Replaces the contents of the buffer with the data of the indicated
+ * FileMapping, which is referenced directly rather than copied.  The buffer
+ * keeps a reference to the mapping until it is modified or cleared.  The
+ * mapping's data must be aligned to MEMORY_HOOK_ALIGNMENT bytes.
+ */
+void VertexDataBuffer::
+set_mapping(FileMapping *mapping) {
+  LightMutexHolder holder(_lock);
+  nassertv(mapping != nullptr && mapping->is_valid());
+  nassertv(((uintptr_t)mapping->get_data() % MEMORY_HOOK_ALIGNMENT) == 0);
+
+  do_unclean_realloc(0);
+  _mapping = mapping;
+  _size = mapping->get_size();
+  _reserved_size = _size;
+}
@@ -5,6 +5,10 @@
 #include "socket_ip.h"
 #include "vector_uchar.h"
 
+#if !defined(_WIN32) && !defined(CPPPARSER)
+#include <sys/uio.h>
+#endif
+
 /**
  * Base functionality for a TCP connected socket This class is pretty useless
  * by itself but it does hide some of the platform differences from machine to
@@ -29,8 +33,12 @@ PUBLISHED:
   std::string RecvData(int max_len);
 public:
   inline int SendData(const char *data, int size);
+  inline int SendDataV(const char *const *parts, const int *lens, int count);
   inline int RecvData(char *data, int size);
 
+  // The most parts that SendDataV() will gather in a single call.
+  static const int max_send_parts = 64;
+
 public:
   static TypeHandle get_class_type() {
     return _type_handle;
@@ -168,6 +176,50 @@ SendData(const char *data, int size) {
   return DO_SOCKET_WRITE(_socket, data, size);
 }
 
+/**
+ * Sends the count buffers at parts, of the lengths given by lens, one after
+ * the other, in a single system call (writev-style).  At most max_send_parts
+ * buffers are sent.  Returns the total number of bytes written, which may be
+ * smaller than requested, or -1 on error.
+ */
+inline int Socket_TCP::
+SendDataV(const char *const *parts, const int *lens, int count) {
+  if (count > max_send_parts) {
+    count = max_send_parts;
+  }
+  if (count <= 0) {
+    return 0;
+  }
+
+#if defined(CPPPARSER)
+  return -1;
+
+#elif defined(_WIN32)
+  WSABUF buffers[max_send_parts];
+  for (int i = 0; i < count; ++i) {
+    buffers[i].buf = (char *)parts[i];
+    buffers[i].len = (ULONG)lens[i];
+  }
+  DWORD bytes_sent = 0;
+  if (WSASend(_socket, buffers, (DWORD)count, &bytes_sent, 0, nullptr, nullptr) != 0) {
+    return -1;
+  }
+  return (int)bytes_sent;
+
+#else
+  struct iovec iov[max_send_parts];
+  for (int i = 0; i < count; ++i) {
+    iov[i].iov_base = (void *)parts[i];
+    iov[i].iov_len = (size_t)lens[i];
+  }
+  struct msghdr msg;
+  memset(&msg, 0, sizeof(msg));
+  msg.msg_iov = iov;
+  msg.msg_iovlen = count;
+  return (int)sendmsg(_socket, &msg, 0);
+#endif
+}
+
 /**
  * Read the data from the connection - if error 0 if socket closed for read or
  * length is 0 + bytes read ( May be smaller than requested)
@@ -39,6 +39,11 @@ PUBLISHED:
   inline bool SendTo(const vector_uchar &data, const Socket_Address &address);
   inline bool SetToBroadCast();
 
+public:
+  inline int SendPackets(const char *const *parts, const int *part_lens,
+                         int num_parts, const Socket_Address *const *addresses,
+                         int count);
+
 public:
   static TypeHandle get_class_type() {
     return _type_handle;
@@ -117,4 +122,62 @@ SendTo(const vector_uchar &data, const Socket_Address &address) {
   return SendTo((char*) data.data(), data.size(), address);
 }
 
+/**
+ * Sends up to count datagrams in one system call, on platforms that support
+ * it (sendmmsg on Linux); elsewhere, this sends a single datagram.  Each
+ * datagram is gathered from num_parts consecutive entries of parts and
+ * part_lens, so that datagram i consists of the part_lens[i * num_parts] bytes
+ * at parts[i * num_parts], followed by the next part, and so on.  It is sent
+ * to addresses[i].
+ *
+ * Returns the number of datagrams sent, or -1 on error.
+ */
+inline int Socket_UDP::
+SendPackets(const char *const *parts, const int *part_lens, int num_parts,
+            const Socket_Address *const *addresses, int count) {
+  if (count > max_packet_batch) {
+    count = max_packet_batch;
+  }
+  if (count <= 0 || num_parts <= 0 || num_parts > max_packet_parts) {
+    return 0;
+  }
+
+#if defined(__linux__) && !defined(CPPPARSER)
+  struct mmsghdr msgs[max_packet_batch];
+  struct iovec iovecs[max_packet_batch * max_packet_parts];
+  for (int i = 0; i < count; ++i) {
+    struct iovec *iov = iovecs + i * num_parts;
+    for (int p = 0; p < num_parts; ++p) {
+      iov[p].iov_base = (void *)parts[i * num_parts + p];
+      iov[p].iov_len = (size_t)part_lens[i * num_parts + p];
+    }
+
+    const sockaddr *addr = &addresses[i]->GetAddressInfo();
+    memset(&msgs[i], 0, sizeof(msgs[i]));
+    msgs[i].msg_hdr.msg_name = (void *)addr;
+    msgs[i].msg_hdr.msg_namelen = SA_SIZEOF(addr);
+    msgs[i].msg_hdr.msg_iov = iov;
+    msgs[i].msg_hdr.msg_iovlen = (size_t)num_parts;
+  }
+
+  int val = sendmmsg(_socket, msgs, (unsigned int)count, 0);
+  return (val < 0) ? -1 : val;
+
+#else
+  bool okflag;
+  if (num_parts == 1) {
+    okflag = SendTo(parts[0], part_lens[0], *addresses[0]);
+  } else {
+    // We have to gather the parts ourselves.
+    vector_uchar data;
+    for (int p = 0; p < num_parts; ++p) {
+      data.insert(data.end(), (const unsigned char *)parts[p],
+                  (const unsigned char *)parts[p] + part_lens[p]);
+    }
+    okflag = SendTo(data, *addresses[0]);
+  }
+  return okflag ? 1 : -1;
+#endif
+}
+
 #endif //SOCKET_UDP_H
@@ -20,6 +20,15 @@ PUBLISHED:
   inline bool SetToBroadCast();
 
 public:
+  // The most datagrams that GetPackets() or SendPackets() will handle in a
+  // single call, and the most parts that SendPackets() will gather each
+  // datagram from.
+  static const int max_packet_batch = 64;
+  static const int max_packet_parts = 2;
+
+  inline int GetPackets(char *data, int max_len, int *lens,
+                        Socket_Address *addresses, int count);
+
   static TypeHandle get_class_type() {
     return _type_handle;
   }
@@ -178,6 +187,59 @@ GetPacket(char *data, int *max_len, Socket_Address &address) {
   return true;
 }
 
+/**
+ * Grabs up to count datagrams off the listening UDP socket in one system call,
+ * on platforms that support it (recvmmsg on Linux); elsewhere, this grabs a
+ * single datagram.  This waits for the first datagram as GetPacket() does,
+ * but not for any of the others.
+ *
+ * The datagrams are stored in data, max_len bytes apart, and their lengths
+ * and source addresses are filled into lens and addresses.  Returns the
+ * number of datagrams read, which is 0 if the read would have blocked, or -1
+ * on error.
+ */
+inline int Socket_UDP_Incoming::
+GetPackets(char *data, int max_len, int *lens, Socket_Address *addresses,
+           int count) {
+  if (count > max_packet_batch) {
+    count = max_packet_batch;
+  }
+  if (count <= 0) {
+    return 0;
+  }
+
+#if defined(__linux__) && !defined(CPPPARSER)
+  struct mmsghdr msgs[max_packet_batch];
+  struct iovec iovecs[max_packet_batch];
+  for (int i = 0; i < count; ++i) {
+    iovecs[i].iov_base = data + i * max_len;
+    iovecs[i].iov_len = (size_t)max_len;
+
+    memset(&msgs[i], 0, sizeof(msgs[i]));
+    msgs[i].msg_hdr.msg_name = &addresses[i].GetAddressInfo();
+    msgs[i].msg_hdr.msg_namelen = sizeof(sockaddr_storage);
+    msgs[i].msg_hdr.msg_iov = &iovecs[i];
+    msgs[i].msg_hdr.msg_iovlen = 1;
+  }
+
+  int val = recvmmsg(_socket, msgs, (unsigned int)count, MSG_WAITFORONE, nullptr);
+  if (val < 0) {
+    return (GetLastError() == LOCAL_BLOCKING_ERROR) ? 0 : -1;
+  }
+  for (int i = 0; i < val; ++i) {
+    lens[i] = (int)msgs[i].msg_len;
+  }
+  return val;
+
+#else
+  lens[0] = max_len;
+  if (!GetPacket(data, &lens[0], addresses[0])) {
+    return -1;
+  }
+  return (lens[0] > 0) ? 1 : 0;
+#endif
+}
+
 /**
  * Send data to specified address
  */
@@ -141,6 +141,28 @@ ConfigVariableInt net_max_write_per_epoch
           "to minimize the impact of the networking layer on the other "
           "threads."));
 
+ConfigVariableInt net_udp_batch_size
+("net-udp-batch-size", 32,
+ PRC_DESC("The maximum number of UDP datagrams that a threaded reader or "
+          "writer will receive or send at once.  Where the platform "
+          "supports it, these are transferred with a single system call.  "
+          "Set this to 1 to handle one datagram at a time."));
+
+ConfigVariableInt net_tcp_batch_size
+("net-tcp-batch-size", 32,
+ PRC_DESC("The maximum number of TCP datagrams that a threaded writer will "
+          "hold back before flushing the connections they are bound for.  "
+          "The datagrams held for each connection are sent together, "
+          "subject to collect-tcp-interval and collect-tcp-max-bytes.  "
+          "Set this to 1 to flush after each datagram."));
+
+ConfigVariableInt collect_tcp_max_bytes
+("collect-tcp-max-bytes", 65536,
+ PRC_DESC("The maximum number of bytes of TCP datagrams that a Connection "
+          "will hold before sending them, regardless of collect-tcp-interval.  "
+          "The held datagrams are sent together with a single gathering "
+          "write where the platform supports it."));
+
 ConfigVariableEnum<ThreadPriority> net_thread_priority
 ("net-thread-priority", TP_low,
  PRC_DESC("The default thread priority when creating threaded readers "
@@ -35,6 +35,9 @@ extern std::string make_thread_name(const std::string &thread_name, int thread_i
 
 extern ConfigVariableInt net_max_read_per_epoch;
 extern ConfigVariableInt net_max_write_per_epoch;
+extern ConfigVariableInt net_udp_batch_size;
+extern ConfigVariableInt net_tcp_batch_size;
+extern ConfigVariableInt collect_tcp_max_bytes;
 
 extern ConfigVariableEnum<ThreadPriority> net_thread_priority;
 
@@ -25,6 +25,9 @@
 #include "socket_tcp.h"
 #include "socket_udp.h"
 #include "dcast.h"
+#include "connectionWriter.h"
+
+#include <limits.h>
 
 
 /**
@@ -39,8 +42,9 @@ Connection(ConnectionManager *manager, Socket_IP *socket) :
 {
   _collect_tcp = collect_tcp;
   _collect_tcp_interval = collect_tcp_interval;
+  _collect_tcp_max_bytes = (size_t)std::max((int)collect_tcp_max_bytes, 0);
   _queued_data_start = 0.0;
-  _queued_count = 0;
+  _queued_bytes = 0;
 
 #if defined(HAVE_THREADS) && defined(SIMPLE_THREADS)
   // In the presence of SIMPLE_THREADS, we use non-blocking IO.  We simulate
@@ -141,6 +145,26 @@ get_collect_tcp_interval() const {
   return _collect_tcp_interval;
 }
 
+/**
+ * Specifies the maximum number of bytes of TCP datagrams to hold before
+ * sending them, even if the collect-tcp interval has not yet elapsed.  This
+ * also bounds the datagrams that a threaded ConnectionWriter will gather into
+ * a single write.
+ */
+void Connection::
+set_collect_tcp_max_bytes(size_t max_bytes) {
+  _collect_tcp_max_bytes = max_bytes;
+}
+
+/**
+ * Returns the maximum number of bytes of TCP datagrams to hold before sending
+ * them.  See set_collect_tcp_max_bytes().
+ */
+size_t Connection::
+get_collect_tcp_max_bytes() const {
+  return _collect_tcp_max_bytes;
+}
+
 /**
  * Sends the most recently queued TCP datagram(s) if enough time has elapsed.
  * This only has meaning if set_collect_tcp() has been set to true.
@@ -291,9 +315,13 @@ set_max_segment(int size) {
  * atomically writes the given datagram to the socket, returning true on
  * success, false on failure.  If the socket seems to be closed, it notifies
  * the ConnectionManager.
+ *
+ * If hold is true, a TCP datagram is not sent until collect-tcp-max-bytes is
+ * reached or the caller calls consider_flush(), so that the caller can
+ * gather several datagrams into one write.
  */
 bool Connection::
-send_datagram(const NetDatagram &datagram, int tcp_header_size) {
+send_datagram(const NetDatagram &datagram, int tcp_header_size, bool hold) {
   nassertr(_socket != nullptr, false);
 
   if (_socket->is_exact_type(Socket_UDP::get_class_type())) {
@@ -304,26 +332,34 @@ send_datagram(const NetDatagram &datagram, int tcp_header_size) {
     LightReMutexHolder holder(_write_mutex);
     DatagramUDPHeader header(datagram);
 
-    vector_uchar data;
+    // The header and the message are gathered by the socket layer, so the
+    // message is sent straight from the datagram's own buffer.
     CPTA_uchar header_data = header.get_array();
-    CPTA_uchar message = datagram.get_array();
-    data.insert(data.end(), header_data.begin(), header_data.end());
-    data.insert(data.end(), message.begin(), message.end());
+    const char *parts[2] = {
+      (const char *)header_data.p(),
+      (const char *)datagram.get_data(),
+    };
+    int part_lens[2] = {
+      (int)header_data.size(),
+      (int)datagram.get_length(),
+    };
 
     if (net_cat.is_debug()) {
       header.verify_datagram(datagram);
     }
 
-    int bytes_to_send = data.size();
-    Socket_Address addr = datagram.get_address().get_addr();
+    int bytes_to_send = part_lens[0] + part_lens[1];
+    const Socket_Address *addr = &datagram.get_address().get_addr();
 
-    bool okflag = udp->SendTo(data, addr);
+    bool okflag = (udp->SendPackets(parts, part_lens, 2, &addr, 1) == 1);
 #if defined(HAVE_THREADS) && defined(SIMPLE_THREADS)
     while (!okflag && udp->GetLastError() == LOCAL_BLOCKING_ERROR && udp->Active()) {
       Thread::force_yield();
-      okflag = udp->SendTo(data, addr);
+      okflag = (udp->SendPackets(parts, part_lens, 2, &addr, 1) == 1);
     }
 #endif  // SIMPLE_THREADS
+    AtomicAdjust::inc(ConnectionWriter::_num_udp_send_calls);
+    AtomicAdjust::inc(ConnectionWriter::_num_udp_datagrams_sent);
 
     if (net_cat.is_spam()) {
       net_cat.spam()
@@ -346,32 +382,23 @@ send_datagram(const NetDatagram &datagram, int tcp_header_size) {
 
   DatagramTCPHeader header(datagram, tcp_header_size);
 
-  LightReMutexHolder holder(_write_mutex);
-  CPTA_uchar header_data = header.get_array();
-  CPTA_uchar message = datagram.get_array();
-  _queued_data.insert(_queued_data.end(), header_data.begin(), header_data.end());
-  _queued_data.insert(_queued_data.end(), message.begin(), message.end());
-  _queued_count++;
-
   if (net_cat.is_debug()) {
     header.verify_datagram(datagram, tcp_header_size);
   }
 
-  if (!_collect_tcp ||
-      TrueClock::get_global_ptr()->get_short_time() - _queued_data_start >= _collect_tcp_interval) {
-    return do_flush();
-  }
-
-  return true;
+  LightReMutexHolder holder(_write_mutex);
+  CPTA_uchar header_data = header.get_array();
+  return queue_tcp_datagram(header_data.p(), (int)header_data.size(),
+                            datagram, hold);
 }
 
 /**
  * This method is intended only to be called by ConnectionWriter.  It
  * atomically writes the given datagram to the socket, without the Datagram
- * header.
+ * header.  See send_datagram() for the meaning of hold.
  */
 bool Connection::
-send_raw_datagram(const NetDatagram &datagram) {
+send_raw_datagram(const NetDatagram &datagram, bool hold) {
   nassertr(_socket != nullptr, false);
 
   if (_socket->is_exact_type(Socket_UDP::get_class_type())) {
@@ -379,24 +406,25 @@ send_raw_datagram(const NetDatagram &datagram) {
     Socket_UDP *udp;
     DCAST_INTO_R(udp, _socket, false);
 
-    CPTA_uchar msg = datagram.get_array();
-    vector_uchar data;
-    data.insert(data.end(), msg.begin(), msg.end());
+    const char *data = (const char *)datagram.get_data();
+    int data_len = (int)datagram.get_length();
 
     LightReMutexHolder holder(_write_mutex);
-    Socket_Address addr = datagram.get_address().get_addr();
-    bool okflag = udp->SendTo(data, addr);
+    const Socket_Address &addr = datagram.get_address().get_addr();
+    bool okflag = udp->SendTo(data, data_len, addr);
 #if defined(HAVE_THREADS) && defined(SIMPLE_THREADS)
     while (!okflag && udp->GetLastError() == LOCAL_BLOCKING_ERROR && udp->Active()) {
       Thread::force_yield();
-      okflag = udp->SendTo(data, addr);
+      okflag = udp->SendTo(data, data_len, addr);
     }
 #endif  // SIMPLE_THREADS
+    AtomicAdjust::inc(ConnectionWriter::_num_udp_send_calls);
+    AtomicAdjust::inc(ConnectionWriter::_num_udp_datagrams_sent);
 
     if (net_cat.is_spam()) {
       net_cat.spam()
         << "Sent UDP datagram with "
-        << data.size() << " bytes to " << (void *)this
+        << data_len << " bytes to " << (void *)this
         << ", ok = " << okflag << "\n";
     }
 
@@ -405,9 +433,37 @@ send_raw_datagram(const NetDatagram &datagram) {
 
   // We might queue up TCP packets for later sending.
   LightReMutexHolder holder(_write_mutex);
-  CPTA_uchar msg = datagram.get_array();
-  _queued_data.insert(_queued_data.end(), msg.begin(), msg.end());
-  _queued_count++;
+  return queue_tcp_datagram(nullptr, 0, datagram, hold);
+}
+
+/**
+ * Adds the indicated TCP datagram, preceded by the indicated header, to the
+ * queue of datagrams waiting to be sent, and then flushes the queue if it is
+ * time to.  This assumes the _write_mutex is already held.
+ */
+bool Connection::
+queue_tcp_datagram(const unsigned char *header, int header_size,
+                   const Datagram &datagram, bool hold) {
+  nassertr(header_size >= 0 && header_size <= 4, false);
+
+  // We don't copy the data; we just keep a reference to it until it has been
+  // sent.
+  _queued_datagrams.push_back(QueuedDatagram());
+  QueuedDatagram &queued = _queued_datagrams.back();
+  if (header_size > 0) {
+    memcpy(queued._header, header, header_size);
+  }
+  queued._header_size = header_size;
+  queued._data = datagram.get_array();
+  _queued_bytes += header_size + datagram.get_length();
+
+  if (_queued_bytes >= _collect_tcp_max_bytes) {
+    return do_flush();
+  }
+
+  if (hold) {
+    return true;
+  }
 
   if (!_collect_tcp ||
       TrueClock::get_global_ptr()->get_short_time() - _queued_data_start >= _collect_tcp_interval) {
@@ -417,63 +473,215 @@ send_raw_datagram(const NetDatagram &datagram) {
   return true;
 }
 
+/**
+ * This method is intended only to be called by ConnectionWriter.  It writes
+ * the indicated datagrams, which must all be bound for this UDP socket, in as
+ * few system calls as the platform allows.  Returns true on success, false on
+ * failure.
+ */
+bool Connection::
+send_udp_datagrams(const NetDatagram *datagrams, int num_datagrams,
+                   bool raw_mode) {
+  nassertr(_socket != nullptr, false);
+
+  Socket_UDP *udp;
+  DCAST_INTO_R(udp, _socket, false);
+
+  LightReMutexHolder holder(_write_mutex);
+
+  static const int max_batch = Socket_UDP::max_packet_batch;
+  const int num_parts = raw_mode ? 1 : 2;
+  const char *parts[max_batch * 2];
+  int part_lens[max_batch * 2];
+  const Socket_Address *addresses[max_batch];
+
+  // The headers for each group are built here; the messages themselves are
+  // gathered by the socket layer directly from each datagram's buffer.
+  unsigned char headers[max_batch][datagram_udp_header_size];
+
+  bool okflag = true;
+  int i = 0;
+  while (okflag && i < num_datagrams) {
+    int count = std::min(num_datagrams - i, max_batch);
+
+    size_t total_bytes = 0;
+    for (int j = 0; j < count; ++j) {
+      const NetDatagram &datagram = datagrams[i + j];
+      const char **packet_parts = parts + j * num_parts;
+      int *packet_lens = part_lens + j * num_parts;
+      if (!raw_mode) {
+        DatagramUDPHeader header(datagram);
+        memcpy(headers[j], header.get_array().p(), datagram_udp_header_size);
+        *packet_parts++ = (const char *)headers[j];
+        *packet_lens++ = datagram_udp_header_size;
+        total_bytes += datagram_udp_header_size;
+      }
+      *packet_parts = (const char *)datagram.get_data();
+      *packet_lens = (int)datagram.get_length();
+      total_bytes += datagram.get_length();
+      addresses[j] = &datagram.get_address().get_addr();
+    }
+
+    int num_sent = 0;
+    while (num_sent < count) {
+      int result = udp->SendPackets(parts + num_sent * num_parts,
+                                    part_lens + num_sent * num_parts,
+                                    num_parts, addresses + num_sent,
+                                    count - num_sent);
+      AtomicAdjust::inc(ConnectionWriter::_num_udp_send_calls);
+#if defined(HAVE_THREADS) && defined(SIMPLE_THREADS)
+      if (result < 0 && udp->GetLastError() == LOCAL_BLOCKING_ERROR && udp->Active()) {
+        Thread::force_yield();
+        continue;
+      }
+#endif  // SIMPLE_THREADS
+      if (result <= 0) {
+        okflag = false;
+        break;
+      }
+      num_sent += result;
+    }
+    AtomicAdjust::add(ConnectionWriter::_num_udp_datagrams_sent, num_sent);
+
+    if (net_cat.is_spam()) {
+      net_cat.spam()
+        << "Sent " << num_sent << " UDP datagram(s) with "
+        << total_bytes << " total bytes to " << (void *)this
+        << ", ok = " << okflag << "\n";
+    }
+
+    i += count;
+  }
+
+  return check_send_error(okflag);
+}
+
 /**
  * The private implementation of flush(), this assumes the _write_mutex is
- * already held.
+ * already held.  The queued datagrams are gathered from where they are,
+ * Socket_TCP::max_send_parts buffers at a time.
  */
 bool Connection::
 do_flush() {
-  if (_queued_data.empty()) {
-    _queued_count = 0;
+  if (_queued_datagrams.empty()) {
+    _queued_bytes = 0;
     _queued_data_start = TrueClock::get_global_ptr()->get_short_time();
     return true;
   }
 
   if (net_cat.is_spam()) {
     net_cat.spam()
-      << "Sending " << _queued_count << " TCP datagram(s) with "
-      << _queued_data.size() << " total bytes to " << (void *)this << "\n";
+      << "Sending " << _queued_datagrams.size() << " TCP datagram(s) with "
+      << _queued_bytes << " total bytes to " << (void *)this << "\n";
   }
 
   Socket_TCP *tcp;
   DCAST_INTO_R(tcp, _socket, false);
 
-  vector_uchar sending_data;
-  _queued_data.swap(sending_data);
-
-  _queued_count = 0;
+  // Take the datagrams off the queue first, in case we get called again
+  // while reporting an error.
+  QueuedDatagrams sending;
+  sending.swap(_queued_datagrams);
+  _queued_bytes = 0;
   _queued_data_start = TrueClock::get_global_ptr()->get_short_time();
 
 #if defined(HAVE_THREADS) && defined(SIMPLE_THREADS)
-  int max_send = net_max_write_per_epoch;
-  int data_sent = tcp->SendData((char *)sending_data.data(), std::min((size_t)max_send, sending_data.size()));
-  bool okflag = (data_sent == (int)sending_data.size());
-  if (!okflag) {
-    int total_sent = 0;
-    if (data_sent > 0) {
-      total_sent += data_sent;
-    }
+  size_t max_send = (size_t)std::max((int)net_max_write_per_epoch, 1);
+#else
+  size_t max_send = (size_t)INT_MAX;
+#endif
 
-    while (!okflag && tcp->Active() &&
-           (data_sent > 0 || tcp->GetLastError() == LOCAL_BLOCKING_ERROR)) {
-      if (data_sent == 0) {
-        Thread::force_yield();
-      } else {
-        Thread::consider_yield();
+  // Part 0 of each datagram is its header, and part 1 its data.  This returns
+  // the indicated part, and its length.
+  auto get_part = [&sending](size_t di, int pi, size_t &len) {
+    const QueuedDatagram &queued = sending[di];
+    if (pi == 0) {
+      len = (size_t)queued._header_size;
+      return (const char *)queued._header;
+    }
+    len = queued._data.size();
+    return (const char *)queued._data.p();
+  };
+
+  const char *parts[Socket_TCP::max_send_parts];
+  int lens[Socket_TCP::max_send_parts];
+
+  // The next byte to send is skip bytes into part pi of datagram di.
+  size_t di = 0;
+  int pi = 0;
+  size_t skip = 0;
+
+  bool okflag = true;
+  while (okflag) {
+    // Gather as many of the remaining parts as we can into one write.
+    int count = 0;
+    size_t gather_bytes = 0;
+    size_t gdi = di;
+    int gpi = pi;
+    size_t gskip = skip;
+    while (gdi < sending.size() && count < Socket_TCP::max_send_parts &&
+           gather_bytes < max_send) {
+      size_t len;
+      const char *part = get_part(gdi, gpi, len);
+      if (len > gskip) {
+        size_t part_len = std::min(len - gskip, max_send - gather_bytes);
+        parts[count] = part + gskip;
+        lens[count] = (int)part_len;
+        ++count;
+        gather_bytes += part_len;
       }
-      data_sent = tcp->SendData((char *)sending_data.data() + total_sent, std::min((size_t)max_send, sending_data.size() - total_sent));
-      if (data_sent > 0) {
-        total_sent += data_sent;
+      gskip = 0;
+      if (++gpi > 1) {
+        gpi = 0;
+        ++gdi;
       }
-      okflag = (total_sent == (int)sending_data.size());
     }
-  }
+    if (count == 0) {
+      // Everything has been sent.
+      break;
+    }
 
-#else  // SIMPLE_THREADS
-  int data_sent = tcp->SendData(sending_data);
-  bool okflag = (data_sent == (int)sending_data.size());
+    int data_sent = tcp->SendDataV(parts, lens, count);
+#if defined(HAVE_THREADS) && defined(SIMPLE_THREADS)
+    if (data_sent < 0 && tcp->GetLastError() == LOCAL_BLOCKING_ERROR &&
+        tcp->Active()) {
+      Thread::force_yield();
+      continue;
+    }
+#endif  // SIMPLE_THREADS
+    if (data_sent <= 0) {
+      okflag = false;
+      break;
+    }
+
+    // Advance past the bytes that were sent.
+    size_t remaining = (size_t)data_sent;
+    while (remaining > 0 && di < sending.size()) {
+      size_t len;
+      get_part(di, pi, len);
+      if (remaining < len - skip) {
+        skip += remaining;
+        remaining = 0;
+      } else {
+        remaining -= len - skip;
+        skip = 0;
+        if (++pi > 1) {
+          pi = 0;
+          ++di;
+        }
+      }
+    }
 
+#if defined(HAVE_THREADS) && defined(SIMPLE_THREADS)
+    Thread::consider_yield();
 #endif  // SIMPLE_THREADS
+  }
+
+  // Let go of the data, but hang on to the queue's storage for next time.
+  sending.clear();
+  if (_queued_datagrams.empty()) {
+    _queued_datagrams.swap(sending);
+  }
 
   return check_send_error(okflag);
 }
@@ -19,9 +19,12 @@
 #include "netAddress.h"
 #include "lightReMutex.h"
 #include "vector_uchar.h"
+#include "pta_uchar.h"
+#include "pvector.h"
 
 class Socket_IP;
 class ConnectionManager;
+class Datagram;
 class NetDatagram;
 
 /**
@@ -41,6 +44,8 @@ PUBLISHED:
   bool get_collect_tcp() const;
   void set_collect_tcp_interval(double interval);
   double get_collect_tcp_interval() const;
+  void set_collect_tcp_max_bytes(size_t max_bytes);
+  size_t get_collect_tcp_max_bytes() const;
 
   BLOCKING bool consider_flush();
   BLOCKING bool flush();
@@ -57,8 +62,13 @@ PUBLISHED:
   void set_max_segment(int size);
 
 private:
-  bool send_datagram(const NetDatagram &datagram, int tcp_header_size);
-  bool send_raw_datagram(const NetDatagram &datagram);
+  bool send_datagram(const NetDatagram &datagram, int tcp_header_size,
+                     bool hold = false);
+  bool send_raw_datagram(const NetDatagram &datagram, bool hold = false);
+  bool queue_tcp_datagram(const unsigned char *header, int header_size,
+                          const Datagram &datagram, bool hold);
+  bool send_udp_datagrams(const NetDatagram *datagrams, int num_datagrams,
+                          bool raw_mode);
   bool do_flush();
   bool check_send_error(bool okflag);
 
@@ -68,9 +78,21 @@ private:
 
   bool _collect_tcp;
   double _collect_tcp_interval;
+  size_t _collect_tcp_max_bytes;
   double _queued_data_start;
-  vector_uchar _queued_data;
-  int _queued_count;
+
+  // Each TCP datagram waiting to be sent is held as a copy of its header and
+  // a reference to its data, so that do_flush() can gather them all into one
+  // write without copying them together first.
+  class QueuedDatagram {
+  public:
+    unsigned char _header[4];
+    int _header_size;
+    CPTA_uchar _data;
+  };
+  typedef pvector<QueuedDatagram> QueuedDatagrams;
+  QueuedDatagrams _queued_datagrams;
+  size_t _queued_bytes;
 
   friend class ConnectionWriter;
 };
@@ -27,10 +27,22 @@
 #include "atomicAdjust.h"
 #include "config_downloader.h"
 
+#include <algorithm>
+
+#ifdef __linux__
+#include <sys/epoll.h>
+#include <poll.h>
+#include <unistd.h>
+#include <errno.h>
+#endif
+
 using std::min;
 
 static const int read_buffer_size = maximum_udp_datagram + datagram_udp_header_size;
 
+AtomicAdjust::Integer ConnectionReader::_num_udp_datagrams_read = 0;
+AtomicAdjust::Integer ConnectionReader::_num_udp_read_calls = 0;
+
 /**
  *
  */
@@ -40,6 +52,7 @@ SocketInfo(const PT(Connection) &connection) :
 {
   _busy = false;
   _error = false;
+  _removed = false;
 }
 
 /**
@@ -67,7 +80,8 @@ ReaderThread(ConnectionReader *reader, const std::string &thread_name,
   Thread(make_thread_name(thread_name, thread_index),
          make_thread_name(thread_name, thread_index)),
   _reader(reader),
-  _thread_index(thread_index)
+  _thread_index(thread_index),
+  _buffer_pool(new DatagramBufferPool)
 {
 }
 
@@ -84,11 +98,18 @@ thread_main() {
  * handle requests.  If num_threads is 0, the sockets will only be read by
  * polling, during an explicit poll() call.  (QueuedConnectionReader will do
  * this automatically.)
+ *
+ * poll_method specifies how the sockets are monitored.  PM_epoll is only
+ * available on Linux; elsewhere, or if the epoll instance can't be created,
+ * the reader falls back to PM_select.
  */
 ConnectionReader::
 ConnectionReader(ConnectionManager *manager, int num_threads,
-                 const std::string &thread_name) :
-  _manager(manager)
+                 const std::string &thread_name, PollMethod poll_method) :
+  _manager(manager),
+  _buffer_pool(new DatagramBufferPool),
+  _poll_method(PM_select),
+  _epoll_fd(-1)
 {
   if (!Thread::is_threading_supported()) {
 #ifndef NDEBUG
@@ -113,6 +134,22 @@ ConnectionReader(ConnectionManager *manager, int num_threads,
 
   _currently_polling_thread = -1;
 
+  if (poll_method == PM_epoll) {
+#ifdef __linux__
+    _epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (_epoll_fd >= 0) {
+      _poll_method = PM_epoll;
+    } else {
+      net_cat.warning()
+        << "Unable to create epoll instance (errno " << errno
+        << "); using select() instead.\n";
+    }
+#else
+    net_cat.warning()
+      << "epoll is not available on this platform; using select() instead.\n";
+#endif
+  }
+
   std::string reader_thread_name = thread_name;
   if (thread_name.empty()) {
     reader_thread_name = "ReaderThread";
@@ -158,6 +195,13 @@ ConnectionReader::
       sinfo->_connection.clear();
     }
   }
+
+#ifdef __linux__
+  if (_epoll_fd >= 0) {
+    ::close(_epoll_fd);
+    _epoll_fd = -1;
+  }
+#endif
 }
 
 /**
@@ -187,7 +231,26 @@ add_connection(Connection *connection) {
     }
   }
 
-  _sockets.push_back(new SocketInfo(connection));
+  SocketInfo *sinfo = new SocketInfo(connection);
+
+#ifdef __linux__
+  if (_poll_method == PM_epoll) {
+    // The socket is registered one-shot; it is rearmed in finish_socket().
+    struct epoll_event event;
+    event.events = EPOLLIN | EPOLLET | EPOLLONESHOT;
+    event.data.ptr = sinfo;
+    if (epoll_ctl(_epoll_fd, EPOLL_CTL_ADD,
+                  sinfo->get_socket()->GetSocket(), &event) != 0) {
+      net_cat.error()
+        << "Unable to add socket to epoll instance (errno " << errno
+        << ").\n";
+      delete sinfo;
+      return false;
+    }
+  }
+#endif
+
+  _sockets.push_back(sinfo);
 
   return true;
 }
@@ -214,7 +277,19 @@ remove_connection(Connection *connection) {
     return false;
   }
 
-  _removed_sockets.push_back(*si);
+  SocketInfo *sinfo = (*si);
+  sinfo->_removed = true;
+
+#ifdef __linux__
+  if (_poll_method == PM_epoll) {
+    // The SocketInfo may still be sitting in _ready_sockets; it won't be
+    // deleted until it has been purged from there too.
+    epoll_ctl(_epoll_fd, EPOLL_CTL_DEL, sinfo->get_socket()->GetSocket(),
+              nullptr);
+  }
+#endif
+
+  _removed_sockets.push_back(sinfo);
   _sockets.erase(si);
 
   return true;
@@ -385,6 +460,26 @@ flush_read_connection(Connection *connection) {
   // Now we can flush it completely.  We check if there is any read data
   // available on just this one socket; we can do this right here in this
   // thread, since we've already removed this connection from the reader.
+  sinfo._removed = true;
+
+#ifdef __linux__
+  if (_poll_method == PM_epoll) {
+    // A Socket_fdset can't hold a descriptor beyond FD_SETSIZE, which is
+    // likely with this many connections, so we use poll() here instead.
+    struct pollfd pfd;
+    pfd.fd = sinfo.get_socket()->GetSocket();
+    pfd.events = POLLIN;
+    pfd.revents = 0;
+    while (::poll(&pfd, 1, 0) > 0) {
+      sinfo._busy = true;
+      if (!process_incoming_data(&sinfo)) {
+        break;
+      }
+      pfd.revents = 0;
+    }
+    return;
+  }
+#endif
 
   Socket_fdset fdset;
   fdset.clear();
@@ -419,6 +514,13 @@ void ConnectionReader::
 finish_socket(SocketInfo *sinfo) {
   nassertv(sinfo->_busy);
 
+#ifdef __linux__
+  if (_poll_method == PM_epoll) {
+    rearm_socket(sinfo);
+    return;
+  }
+#endif
+
   // By marking the SocketInfo nonbusy, we make it available for future polls.
   sinfo->_busy = false;
 }
@@ -450,72 +552,62 @@ process_incoming_data(SocketInfo *sinfo) {
  */
 bool ConnectionReader::
 process_incoming_udp_data(SocketInfo *sinfo) {
-  Socket_UDP *socket;
-  DCAST_INTO_R(socket, sinfo->get_socket(), false);
-  Socket_Address addr;
-
-  // Read as many bytes as we can.
-  char buffer[read_buffer_size];
-  int bytes_read = read_buffer_size;
-
-  bool okflag = socket->GetPacket(buffer, &bytes_read, addr);
-
-  if (!okflag) {
-    finish_socket(sinfo);
-    return false;
+  // Read as many datagrams as we can.
+  char buffer[Socket_UDP::max_packet_batch][read_buffer_size];
+  int lens[Socket_UDP::max_packet_batch];
+  Socket_Address addresses[Socket_UDP::max_packet_batch];
 
-  } else if (bytes_read == 0) {
-    // The socket was closed (!).  This shouldn't happen with a UDP
-    // connection.  Oh well.  Report that and return.
-    if (_manager != nullptr) {
-      _manager->connection_reset(sinfo->_connection, 0);
-    }
-    finish_socket(sinfo);
+  int num_read = read_udp_batch(sinfo, &buffer[0][0], lens, addresses);
+  if (num_read == 0) {
     return false;
   }
 
-  // Since we are not running in raw mode, we decode the header to determine
-  // how big the datagram is.  This means we must have read at least a full
-  // header.
-  if (bytes_read < datagram_udp_header_size) {
-    net_cat.error()
-      << "Did not read entire header, discarding UDP datagram.\n";
-    finish_socket(sinfo);
-    return true;
+  if (_shutdown) {
+    return false;
   }
 
-  DatagramUDPHeader header(buffer);
+  // The datagrams draw their buffers from the pool, which gets them back
+  // once the application is done with them.
+  DatagramBufferPool *pool = get_buffer_pool();
 
-  char *dp = buffer + datagram_udp_header_size;
-  bytes_read -= datagram_udp_header_size;
+  for (int i = 0; i < num_read; ++i) {
+    // Since we are not running in raw mode, we decode the header to determine
+    // how big the datagram is.  This means we must have read at least a full
+    // header.
+    int bytes_read = lens[i];
+    if (bytes_read < datagram_udp_header_size) {
+      net_cat.error()
+        << "Did not read entire header, discarding UDP datagram.\n";
+      continue;
+    }
 
-  NetDatagram datagram(dp, bytes_read);
+    DatagramUDPHeader header(buffer[i]);
 
-  // Now that we've read all the data, it's time to finish the socket so
-  // another thread can read the next datagram.
-  finish_socket(sinfo);
+    char *dp = buffer[i] + datagram_udp_header_size;
+    bytes_read -= datagram_udp_header_size;
 
-  if (_shutdown) {
-    return false;
-  }
+    NetDatagram datagram;
+    datagram.set_buffer_pool(pool);
+    datagram.assign(dp, bytes_read);
 
-  // And now do whatever we need to do to process the datagram.
-  if (!header.verify_datagram(datagram)) {
-    net_cat.error()
-      << "Ignoring invalid UDP datagram.\n";
-  } else {
-    datagram.set_connection(sinfo->_connection);
-    datagram.set_address(NetAddress(addr));
+    // And now do whatever we need to do to process the datagram.
+    if (!header.verify_datagram(datagram)) {
+      net_cat.error()
+        << "Ignoring invalid UDP datagram.\n";
+    } else {
+      datagram.set_connection(sinfo->_connection);
+      datagram.set_address(NetAddress(addresses[i]));
+
+      if (net_cat.is_spam()) {
+        net_cat.spam()
+          << "Received UDP datagram with "
+          << datagram_udp_header_size + datagram.get_length()
+          << " bytes on " << (void *)datagram.get_connection()
+          << " from " << datagram.get_address() << "\n";
+      }
 
-    if (net_cat.is_spam()) {
-      net_cat.spam()
-        << "Received UDP datagram with "
-        << datagram_udp_header_size + datagram.get_length()
-        << " bytes on " << (void *)datagram.get_connection()
-        << " from " << datagram.get_address() << "\n";
+      receive_datagram(datagram);
     }
-
-    receive_datagram(datagram);
   }
 
   return true;
@@ -573,8 +665,10 @@ process_incoming_tcp_data(SocketInfo *sinfo) {
   DatagramTCPHeader header(buffer, _tcp_header_size);
   int size = header.get_datagram_size(_tcp_header_size);
 
-  // We have to loop until the entire datagram is read.
+  // We have to loop until the entire datagram is read.  A pooled buffer
+  // usually has room for it already.
   NetDatagram datagram;
+  datagram.set_buffer_pool(get_buffer_pool());
 
   while (!_shutdown && (int)datagram.get_length() < size) {
     int bytes_read;
@@ -659,54 +753,105 @@ process_incoming_tcp_data(SocketInfo *sinfo) {
  */
 bool ConnectionReader::
 process_raw_incoming_udp_data(SocketInfo *sinfo) {
+  // Read as many datagrams as we can.
+  char buffer[Socket_UDP::max_packet_batch][read_buffer_size];
+  int lens[Socket_UDP::max_packet_batch];
+  Socket_Address addresses[Socket_UDP::max_packet_batch];
+
+  int num_read = read_udp_batch(sinfo, &buffer[0][0], lens, addresses);
+  if (num_read == 0) {
+    return false;
+  }
+
+  if (_shutdown) {
+    return false;
+  }
+
+  DatagramBufferPool *pool = get_buffer_pool();
+
+  for (int i = 0; i < num_read; ++i) {
+    // In raw mode, we simply extract all the bytes and make that a datagram.
+    NetDatagram datagram;
+    datagram.set_buffer_pool(pool);
+    datagram.assign(buffer[i], lens[i]);
+
+    datagram.set_connection(sinfo->_connection);
+    datagram.set_address(NetAddress(addresses[i]));
+
+    if (net_cat.is_spam()) {
+      net_cat.spam()
+        << "Received raw UDP datagram with " << datagram.get_length()
+        << " bytes on " << (void *)datagram.get_connection()
+        << " from " << datagram.get_address() << "\n";
+    }
+
+    receive_datagram(datagram);
+  }
+
+  return true;
+}
+
+/**
+ * Reads up to net-udp-batch-size datagrams from the indicated UDP socket, in
+ * as few system calls as the platform allows, and then finishes the socket.
+ * data must have room for Socket_UDP::max_packet_batch datagrams of
+ * read_buffer_size bytes each.
+ *
+ * Returns the number of datagrams read, or 0 if the socket has failed or
+ * been closed.
+ */
+int ConnectionReader::
+read_udp_batch(SocketInfo *sinfo, char *data, int *lens,
+               Socket_Address *addresses) {
   Socket_UDP *socket;
-  DCAST_INTO_R(socket, sinfo->get_socket(), false);
-  Socket_Address addr;
+  DCAST_INTO_R(socket, sinfo->get_socket(), 0);
 
-  // Read as many bytes as we can.
-  char buffer[read_buffer_size];
-  int bytes_read = read_buffer_size;
+  int batch_size = net_udp_batch_size;
+  if (batch_size > Socket_UDP::max_packet_batch) {
+    batch_size = Socket_UDP::max_packet_batch;
+  } else if (batch_size < 1) {
+    batch_size = 1;
+  }
 
-  bool okflag = socket->GetPacket(buffer, &bytes_read, addr);
+  int num_read =
+    socket->GetPackets(data, read_buffer_size, lens, addresses, batch_size);
+  AtomicAdjust::inc(_num_udp_read_calls);
 
-  if (!okflag) {
+  if (num_read < 0) {
     finish_socket(sinfo);
-    return false;
+    return 0;
 
-  } else if (bytes_read == 0) {
+  } else if (num_read == 0) {
     // The socket was closed (!).  This shouldn't happen with a UDP
     // connection.  Oh well.  Report that and return.
     if (_manager != nullptr) {
       _manager->connection_reset(sinfo->_connection, 0);
     }
     finish_socket(sinfo);
-    return false;
+    return 0;
   }
 
-  // In raw mode, we simply extract all the bytes and make that a datagram.
-  NetDatagram datagram(buffer, bytes_read);
+  AtomicAdjust::add(_num_udp_datagrams_read, num_read);
 
   // Now that we've read all the data, it's time to finish the socket so
-  // another thread can read the next datagram.
+  // another thread can read the next datagrams.
   finish_socket(sinfo);
+  return num_read;
+}
 
-  if (_shutdown) {
-    return false;
-  }
-
-  datagram.set_connection(sinfo->_connection);
-  datagram.set_address(NetAddress(addr));
-
-  if (net_cat.is_spam()) {
-    net_cat.spam()
-      << "Received raw UDP datagram with " << datagram.get_length()
-      << " bytes on " << (void *)datagram.get_connection()
-      << " from " << datagram.get_address() << "\n";
+/**
+ * Returns the pool from which the calling thread should allocate the buffers
+ * of the datagrams it reads.
+ */
+DatagramBufferPool *ConnectionReader::
+get_buffer_pool() const {
+  Thread *current_thread = Thread::get_current_thread();
+  for (ReaderThread *thread : _threads) {
+    if (thread == current_thread) {
+      return thread->_buffer_pool;
+    }
   }
-
-  receive_datagram(datagram);
-
-  return true;
+  return _buffer_pool;
 }
 
 /**
@@ -738,7 +883,9 @@ process_raw_incoming_tcp_data(SocketInfo *sinfo) {
   }
 
   // In raw mode, we simply extract all the bytes and make that a datagram.
-  NetDatagram datagram(buffer, bytes_read);
+  NetDatagram datagram;
+  datagram.set_buffer_pool(get_buffer_pool());
+  datagram.assign(buffer, bytes_read);
 
   // Now that we've read all the data, it's time to finish the socket so
   // another thread can read the next datagram.
@@ -795,6 +942,12 @@ thread_run(int thread_index) {
  */
 ConnectionReader::SocketInfo *ConnectionReader::
 get_next_available_socket(bool allow_block, int current_thread_index) {
+#ifdef __linux__
+  if (_poll_method == PM_epoll) {
+    return get_next_ready_socket(allow_block, current_thread_index);
+  }
+#endif
+
   // Go to sleep on the select() mutex.  This guarantees that only one thread
   // is in this function at a time.
   MutexHolder holder(_select_mutex);
@@ -874,6 +1027,102 @@ get_next_available_socket(bool allow_block, int current_thread_index) {
 }
 
 
+#ifdef __linux__
+/**
+ * The PM_epoll implementation of get_next_available_socket().  Returns the
+ * next socket on the ready queue, waiting on the epoll instance to refill the
+ * queue if it is empty.
+ */
+ConnectionReader::SocketInfo *ConnectionReader::
+get_next_ready_socket(bool allow_block, int current_thread_index) {
+  // Only one thread at a time waits on the epoll instance; the others wait
+  // here, and then pick up whatever it has left on the ready queue.
+  MutexHolder holder(_select_mutex);
+
+  static const int max_events = 256;
+  struct epoll_event events[max_events];
+
+  while (!_shutdown) {
+    {
+      LightMutexHolder sockets_holder(_sockets_mutex);
+      purge_removed_sockets();
+
+      while (!_ready_sockets.empty()) {
+        SocketInfo *sinfo = _ready_sockets.front();
+        _ready_sockets.pop_front();
+        if (!sinfo->_removed && !sinfo->_error) {
+          sinfo->_busy = true;
+          return sinfo;
+        }
+      }
+    }
+
+    AtomicAdjust::set(_currently_polling_thread, current_thread_index);
+
+    int timeout = (int)(get_net_max_block() * 1000.0);
+    if (!allow_block) {
+      timeout = 0;
+    }
+#if defined(HAVE_THREADS) && defined(SIMPLE_THREADS)
+    // As above, we never wait in the presence of SIMPLE_THREADS.
+    timeout = 0;
+#endif
+
+    int num_events = epoll_wait(_epoll_fd, events, max_events, timeout);
+    if (num_events < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      net_cat.error()
+        << "epoll_wait failed (errno " << errno << ").\n";
+      Thread::force_yield();
+      return nullptr;
+    }
+
+    if (num_events == 0) {
+      if (!allow_block) {
+        return nullptr;
+      }
+      // If we reached net_max_block, go back and reconsider, so we can check
+      // the shutdown flag every once in a while.
+      Thread::force_yield();
+      continue;
+    }
+
+    for (int i = 0; i < num_events; ++i) {
+      _ready_sockets.push_back((SocketInfo *)events[i].data.ptr);
+    }
+  }
+
+  return nullptr;
+}
+
+/**
+ * The PM_epoll implementation of finish_socket().  Marks the socket nonbusy
+ * and rearms it on the epoll instance, which will report it again right away
+ * if more data arrived in the meantime.
+ */
+void ConnectionReader::
+rearm_socket(SocketInfo *sinfo) {
+  LightMutexHolder holder(_sockets_mutex);
+  sinfo->_busy = false;
+
+  // A removed socket has already been taken off the epoll instance, and its
+  // descriptor may even have been reused by now.
+  if (!sinfo->_removed && !sinfo->_error) {
+    struct epoll_event event;
+    event.events = EPOLLIN | EPOLLET | EPOLLONESHOT;
+    event.data.ptr = sinfo;
+    if (epoll_ctl(_epoll_fd, EPOLL_CTL_MOD,
+                  sinfo->get_socket()->GetSocket(), &event) != 0) {
+      net_cat.error()
+        << "Unable to rearm socket on epoll instance (errno " << errno
+        << ").\n";
+    }
+  }
+}
+#endif  // __linux__
+
 /**
  * Rebuilds the _fdset and _selecting_sockets arrays based on the sockets that
  * are currently available for selecting.
@@ -895,18 +1144,38 @@ rebuild_select_list() {
 
   // This is also a fine time to delete the contents of the _removed_sockets
   // list.
-  if (!_removed_sockets.empty()) {
-    Sockets still_busy_sockets;
-    for (si = _removed_sockets.begin(); si != _removed_sockets.end(); ++si) {
-      SocketInfo *sinfo = (*si);
-      if (sinfo->_busy) {
-        still_busy_sockets.push_back(sinfo);
-      } else {
-        delete sinfo;
+  purge_removed_sockets();
+}
+
+/**
+ * Deletes the SocketInfo objects on the _removed_sockets list that are no
+ * longer being read by any thread.  Assumes that both _select_mutex and
+ * _sockets_mutex are held.
+ */
+void ConnectionReader::
+purge_removed_sockets() {
+  if (_removed_sockets.empty()) {
+    return;
+  }
+
+  Sockets still_busy_sockets;
+  Sockets::const_iterator si;
+  for (si = _removed_sockets.begin(); si != _removed_sockets.end(); ++si) {
+    SocketInfo *sinfo = (*si);
+    if (sinfo->_busy) {
+      still_busy_sockets.push_back(sinfo);
+    } else {
+      if (!_ready_sockets.empty()) {
+        ReadySockets::iterator ri =
+          std::find(_ready_sockets.begin(), _ready_sockets.end(), sinfo);
+        if (ri != _ready_sockets.end()) {
+          _ready_sockets.erase(ri);
+        }
       }
+      delete sinfo;
     }
-    _removed_sockets.swap(still_busy_sockets);
   }
+  _removed_sockets.swap(still_busy_sockets);
 }
 
 /**
@@ -921,6 +1190,12 @@ accumulate_fdset(Socket_fdset &fdset) {
   for (si = _sockets.begin(); si != _sockets.end(); ++si) {
     SocketInfo *sinfo = (*si);
     if (!sinfo->_busy && !sinfo->_error) {
+#ifdef __linux__
+      // An epoll reader may well have more sockets than an fdset can hold.
+      if (sinfo->get_socket()->GetSocket() >= FD_SETSIZE) {
+        continue;
+      }
+#endif
       fdset.setForSocket(*sinfo->get_socket());
     }
   }
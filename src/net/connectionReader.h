@@ -23,8 +23,10 @@
 #include "lightMutex.h"
 #include "pvector.h"
 #include "pset.h"
+#include "pdeque.h"
 #include "socket_fdset.h"
 #include "atomicAdjust.h"
+#include "datagramBufferPool.h"
 
 class NetDatagram;
 class ConnectionManager;
@@ -60,8 +62,18 @@ PUBLISHED:
   // by a previous call to PR_Poll(), or (b) execute (and possibly block on) a
   // new call to PR_Poll().
 
+  // Alternatively, on Linux, the sockets may be monitored with epoll, which
+  // doesn't need to rebuild the list of sockets for each wait, and isn't
+  // limited to FD_SETSIZE sockets.  This is much more efficient for a reader
+  // that monitors thousands of connections.
+  enum PollMethod {
+    PM_select,
+    PM_epoll,
+  };
+
   explicit ConnectionReader(ConnectionManager *manager, int num_threads,
-                            const std::string &thread_name = std::string());
+                            const std::string &thread_name = std::string(),
+                            PollMethod poll_method = PM_select);
   virtual ~ConnectionReader();
 
   bool add_connection(Connection *connection);
@@ -73,6 +85,10 @@ PUBLISHED:
   ConnectionManager *get_manager() const;
   INLINE bool is_polling() const;
   int get_num_threads() const;
+  INLINE PollMethod get_poll_method() const;
+
+  INLINE static size_t get_num_udp_datagrams_read();
+  INLINE static size_t get_num_udp_read_calls();
 
   void set_raw_mode(bool mode);
   bool get_raw_mode() const;
@@ -95,6 +111,7 @@ protected:
     PT(Connection) _connection;
     bool _busy;
     bool _error;
+    bool _removed;
   };
   typedef pvector<SocketInfo *> Sockets;
 
@@ -107,6 +124,11 @@ protected:
   virtual bool process_raw_incoming_udp_data(SocketInfo *sinfo);
   virtual bool process_raw_incoming_tcp_data(SocketInfo *sinfo);
 
+  int read_udp_batch(SocketInfo *sinfo, char *data, int *lens,
+                     Socket_Address *addresses);
+
+  DatagramBufferPool *get_buffer_pool() const;
+
 protected:
   ConnectionManager *_manager;
 
@@ -126,8 +148,13 @@ private:
                                         int current_thread_index);
 
   void rebuild_select_list();
+  void purge_removed_sockets();
   void accumulate_fdset(Socket_fdset &fdset);
 
+  SocketInfo *get_next_ready_socket(bool allow_block,
+                                    int current_thread_index);
+  void rearm_socket(SocketInfo *sinfo);
+
 private:
   bool _raw_mode;
   int _tcp_header_size;
@@ -141,12 +168,20 @@ private:
 
     ConnectionReader *_reader;
     int _thread_index;
+
+    // Each thread recycles the buffers of the datagrams it reads through its
+    // own pool, so that the threads don't contend for a single pool.
+    PT(DatagramBufferPool) _buffer_pool;
   };
 
   typedef pvector< PT(ReaderThread) > Threads;
   Threads _threads;
   bool _polling;
 
+  // This pool serves the datagrams read by poll(), when there are no
+  // threads.
+  PT(DatagramBufferPool) _buffer_pool;
+
   // These structures are used to manage selecting for noise on available
   // sockets.
   Socket_fdset _fdset;
@@ -157,11 +192,27 @@ private:
   // socket.
   Mutex _select_mutex;
 
+  // In PM_epoll mode, the sockets are registered with _epoll_fd once, when
+  // they are added.  They are registered one-shot, so that only one thread at
+  // a time is told about each socket; the socket is rearmed when that thread
+  // calls finish_socket().  The thread that waits on the epoll queues up all
+  // of the sockets it is told about here, where the other threads can take
+  // them without waiting themselves.  This is protected by _select_mutex.
+  PollMethod _poll_method;
+  int _epoll_fd;
+  typedef pdeque<SocketInfo *> ReadySockets;
+  ReadySockets _ready_sockets;
+
   // This is atomically updated with the index (in _threads) of the thread
   // that is currently waiting on the PR_Poll() call.  It contains -1 if no
   // thread is so waiting.
   AtomicAdjust::Integer _currently_polling_thread;
 
+  // These count, across all readers, the UDP datagrams read and the system
+  // calls made to read them.
+  static AtomicAdjust::Integer _num_udp_datagrams_read;
+  static AtomicAdjust::Integer _num_udp_read_calls;
+
   friend class ConnectionManager;
   friend class ReaderThread;
 };
@@ -20,6 +20,9 @@
 #include "pnotify.h"
 #include "config_downloader.h"
 
+AtomicAdjust::Integer ConnectionWriter::_num_udp_datagrams_sent = 0;
+AtomicAdjust::Integer ConnectionWriter::_num_udp_send_calls = 0;
+
 /**
  *
  */
@@ -301,6 +304,25 @@ shutdown() {
   _threads.clear();
 }
 
+/**
+ * Returns the total number of UDP datagrams sent by all ConnectionWriters so
+ * far.  Together with get_num_udp_send_calls(), this indicates how well the
+ * sends are being batched.
+ */
+size_t ConnectionWriter::
+get_num_udp_datagrams_sent() {
+  return (size_t)AtomicAdjust::get(_num_udp_datagrams_sent);
+}
+
+/**
+ * Returns the total number of system calls made by all ConnectionWriters so
+ * far to send UDP datagrams.
+ */
+size_t ConnectionWriter::
+get_num_udp_send_calls() {
+  return (size_t)AtomicAdjust::get(_num_udp_send_calls);
+}
+
 /**
  * This should normally only be called when the associated ConnectionManager
  * destructs.  It resets the ConnectionManager pointer to NULL so we don't
@@ -320,13 +342,64 @@ void ConnectionWriter::
 thread_run(int thread_index) {
   nassertv(!_immediate);
 
-  NetDatagram datagram;
-  while (_queue.extract(datagram)) {
-    if (_raw_mode) {
-      datagram.get_connection()->send_raw_datagram(datagram);
-    } else {
-      datagram.get_connection()->send_datagram(datagram, _tcp_header_size);
+  // We take several datagrams off the queue at a time, so that a run of UDP
+  // datagrams bound for the same socket can be sent all at once, and the TCP
+  // datagrams bound for each connection can be gathered into one write.
+  size_t udp_batch_size = (size_t)std::max((int)net_udp_batch_size, 1);
+  int tcp_batch_size = std::max((int)net_tcp_batch_size, 1);
+  int batch_size = std::max((int)udp_batch_size, tcp_batch_size);
+
+  pvector<NetDatagram> datagrams;
+  pvector<Connection *> tcp_connections;
+  int num_tcp_held = 0;
+  while (_queue.extract(datagrams, batch_size)) {
+    size_t i = 0;
+    while (i < datagrams.size()) {
+      Connection *connection = datagrams[i].get_connection();
+      if (connection->get_socket()->is_exact_type(Socket_UDP::get_class_type())) {
+        size_t j = i + 1;
+        while (j < datagrams.size() && j - i < udp_batch_size &&
+               datagrams[j].get_connection() == connection) {
+          ++j;
+        }
+        connection->send_udp_datagrams(&datagrams[i], (int)(j - i), _raw_mode);
+        i = j;
+
+      } else {
+        if (_raw_mode) {
+          connection->send_raw_datagram(datagrams[i], true);
+        } else {
+          connection->send_datagram(datagrams[i], _tcp_header_size, true);
+        }
+        if (std::find(tcp_connections.begin(), tcp_connections.end(),
+                      connection) == tcp_connections.end()) {
+          tcp_connections.push_back(connection);
+        }
+        ++i;
+
+        if (++num_tcp_held >= tcp_batch_size) {
+          flush_tcp_connections(tcp_connections);
+          num_tcp_held = 0;
+        }
+      }
+      Thread::consider_yield();
     }
-    Thread::consider_yield();
+
+    flush_tcp_connections(tcp_connections);
+    num_tcp_held = 0;
+  }
+}
+
+/**
+ * Sends whatever TCP datagrams thread_run() has held back for the indicated
+ * connections, unless a connection is collecting its TCP datagrams for longer
+ * than that, and empties the list.  The datagrams taken off the queue keep
+ * the connections alive until then.
+ */
+void ConnectionWriter::
+flush_tcp_connections(pvector<Connection *> &tcp_connections) {
+  for (Connection *connection : tcp_connections) {
+    connection->consider_flush();
   }
+  tcp_connections.clear();
 }
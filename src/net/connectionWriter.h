@@ -20,6 +20,7 @@
 #include "pointerTo.h"
 #include "thread.h"
 #include "pvector.h"
+#include "atomicAdjust.h"
 
 class ConnectionManager;
 class NetAddress;
@@ -65,11 +66,15 @@ PUBLISHED:
 
   void shutdown();
 
+  static size_t get_num_udp_datagrams_sent();
+  static size_t get_num_udp_send_calls();
+
 protected:
   void clear_manager();
 
 private:
   void thread_run(int thread_index);
+  void flush_tcp_connections(pvector<Connection *> &tcp_connections);
   bool send_datagram(const NetDatagram &datagram);
 
 protected:
@@ -96,6 +101,12 @@ private:
 
   bool _immediate;
 
+  // These count, across all writers, the UDP datagrams sent and the system
+  // calls made to send them.  They are updated by Connection.
+  static AtomicAdjust::Integer _num_udp_datagrams_sent;
+  static AtomicAdjust::Integer _num_udp_send_calls;
+
+  friend class Connection;
   friend class ConnectionManager;
   friend class WriterThread;
 };
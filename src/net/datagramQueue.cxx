@@ -121,6 +121,40 @@ extract(NetDatagram &result) {
   return true;
 }
 
+/**
+ * Extracts up to max_count datagrams from the head of the queue.  Like the
+ * above, this blocks until at least one datagram is available; it then
+ * returns all that are available, up to max_count.
+ *
+ * The return value is true if any datagrams are extracted, or false if the
+ * queue was destroyed while waiting.
+ */
+bool DatagramQueue::
+extract(pvector<NetDatagram> &result, int max_count) {
+  result.clear();
+
+  MutexHolder holder(_cvlock);
+
+  while (_queue.empty() && !_shutdown) {
+    _cv.wait();
+  }
+
+  if (_shutdown) {
+    return false;
+  }
+
+  nassertr(!_queue.empty(), false);
+  do {
+    result.push_back(_queue.front());
+    _queue.pop_front();
+  } while (!_queue.empty() && (int)result.size() < max_count);
+
+  // Wake up any threads waiting to stuff things into the queue.
+  _cv.notify_all();
+
+  return true;
+}
+
 /**
  * Sets the maximum size the queue is allowed to grow to.  This is primarily
  * for a sanity check; this is a limit beyond which we can assume something
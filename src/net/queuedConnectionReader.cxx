@@ -22,8 +22,9 @@ template class QueuedReturn<NetDatagram>;
  *
  */
 QueuedConnectionReader::
-QueuedConnectionReader(ConnectionManager *manager, int num_threads) :
-  ConnectionReader(manager, num_threads)
+QueuedConnectionReader(ConnectionManager *manager, int num_threads,
+                       PollMethod poll_method) :
+  ConnectionReader(manager, num_threads, std::string(), poll_method)
 {
 #ifdef SIMULATE_NETWORK_DELAY
   _delay_active = false;
@@ -33,7 +33,8 @@ EXPORT_TEMPLATE_CLASS(EXPCL_PANDA_NET, EXPTP_PANDA_NET, QueuedReturn<NetDatagram
 class EXPCL_PANDA_NET QueuedConnectionReader : public ConnectionReader,
                                public QueuedReturn<NetDatagram> {
 PUBLISHED:
-  explicit QueuedConnectionReader(ConnectionManager *manager, int num_threads);
+  explicit QueuedConnectionReader(ConnectionManager *manager, int num_threads,
+                                  PollMethod poll_method = PM_select);
   virtual ~QueuedConnectionReader();
 
   BLOCKING bool data_available();
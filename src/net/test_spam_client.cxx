@@ -20,16 +20,41 @@
 #include "clockObject.h"
 #include "datagram_ui.h"
 #include "thread.h"
+#include "pvector.h"
+
+#include <algorithm>
+#include <string.h>
 
 int
 main(int argc, char *argv[]) {
-  if (argc != 3) {
-    nout << "test_spam_client host port\n";
+  // With -c, the client opens the indicated number of connections and sends a
+  // fixed datagram round-robin over all of them, instead of prompting for a
+  // datagram to send over one connection.  Run it against test_spam_server
+  // -echo to measure the server's throughput; note that 5k or 10k connections
+  // will require raising the file descriptor limit (ulimit -n) on both ends.
+  ConnectionReader::PollMethod poll_method = ConnectionReader::PM_select;
+  int num_connections = 0;
+
+  int i = 1;
+  while (i < argc && argv[i][0] == '-') {
+    if (strcmp(argv[i], "-epoll") == 0) {
+      poll_method = ConnectionReader::PM_epoll;
+    } else if (strcmp(argv[i], "-c") == 0 && i + 1 < argc) {
+      num_connections = atoi(argv[i + 1]);
+      ++i;
+    } else {
+      break;
+    }
+    ++i;
+  }
+
+  if (argc != i + 2) {
+    nout << "test_spam_client [-epoll] [-c num_connections] host port\n";
     exit(1);
   }
 
-  std::string hostname = argv[1];
-  int port = atoi(argv[2]);
+  std::string hostname = argv[i];
+  int port = atoi(argv[i + 1]);
 
   NetAddress host;
   if (!host.set_host(hostname, port)) {
@@ -37,58 +62,85 @@ main(int argc, char *argv[]) {
   }
 
   QueuedConnectionManager cm;
-  PT(Connection) c = cm.open_TCP_client_connection(host, 5000);
-
-  if (c.is_null()) {
-    nout << "No connection.\n";
-    exit(1);
-  }
+  QueuedConnectionReader reader(&cm, 10, poll_method);
+  ConnectionWriter writer(&cm, 10);
 
-  nout << "Successfully opened TCP connection to " << hostname
-       << " on port " << port << "\n";
+  typedef pvector< PT(Connection) > Connections;
+  Connections connections;
 
-  QueuedConnectionReader reader(&cm, 10);
-  reader.add_connection(c);
-  ConnectionWriter writer(&cm, 10);
+  int num_to_open = std::max(num_connections, 1);
+  for (int ci = 0; ci < num_to_open; ++ci) {
+    PT(Connection) c = cm.open_TCP_client_connection(host, 5000);
+    if (c.is_null()) {
+      nout << "No connection.\n";
+      exit(1);
+    }
+    reader.add_connection(c);
+    connections.push_back(c);
+  }
 
-  bool lost_connection = false;
+  nout << "Successfully opened " << connections.size()
+       << " TCP connection(s) to " << hostname << " on port " << port << "\n";
 
   NetDatagram datagram;
-  std::cout << "Enter a datagram.\n";
-  std::cin >> datagram;
-
-  nout << "Read datagram " << datagram << "\n";
-  datagram.dump_hex(nout);
-  nout << "\n";
+  if (num_connections == 0) {
+    std::cout << "Enter a datagram.\n";
+    std::cin >> datagram;
+
+    nout << "Read datagram " << datagram << "\n";
+    datagram.dump_hex(nout);
+    nout << "\n";
+  } else {
+    datagram.add_uint32(0);
+    datagram.add_string("The quick brown fox jumps over the lazy dog.");
+  }
 
   int num_sent = 0;
   int num_received = 0;
+  int last_num_received = 0;
+
+  // In the multiple-connection case, limit the number of datagrams in flight
+  // on each connection, so we measure the round trip rather than the size of
+  // the write queue.
+  static const int max_in_flight = 4;
 
   ClockObject *global_clock = ClockObject::get_global_clock();
   double last_reported_time = global_clock->get_real_time();
   static const double report_interval = 5.0;
 
-  while (!lost_connection) {
+  while (!connections.empty()) {
     // Send the datagram.
-    if (writer.send(datagram, c)) {
-      num_sent++;
+    if (num_connections == 0) {
+      if (writer.send(datagram, connections[0])) {
+        num_sent++;
+      }
+    } else if (num_sent - num_received <
+               (int)connections.size() * max_in_flight) {
+      Connections::const_iterator ci;
+      for (ci = connections.begin(); ci != connections.end(); ++ci) {
+        if (writer.send(datagram, (*ci))) {
+          num_sent++;
+        }
+      }
     }
 
     // Check for a lost connection.
     while (cm.reset_connection_available()) {
       PT(Connection) connection;
-        if (cm.get_reset_connection(connection)) {
+      if (cm.get_reset_connection(connection)) {
         nout << "Lost connection from "
              << connection->get_address() << "\n";
         cm.close_connection(connection);
-        if (connection == c) {
-          lost_connection = true;
+        Connections::iterator ci =
+          std::find(connections.begin(), connections.end(), connection);
+        if (ci != connections.end()) {
+          connections.erase(ci);
         }
       }
     }
 
     // Now poll for new datagrams on the socket.
-    if (reader.data_available()) {
+    while (reader.data_available()) {
       NetDatagram new_datagram;
       if (reader.get_data(new_datagram)) {
         num_received++;
@@ -97,9 +149,13 @@ main(int argc, char *argv[]) {
 
     double now = global_clock->get_real_time();
     if ((now - last_reported_time) > report_interval) {
+      double rate =
+        (num_received - last_num_received) / (now - last_reported_time);
       nout << "Sent " << num_sent << ", received "
-           << num_received << " datagrams.\n";
+           << num_received << " datagrams (" << (int)rate
+           << " datagrams/sec).\n";
       last_reported_time = now;
+      last_num_received = num_received;
     }
 
     // Yield the timeslice before we poll again.
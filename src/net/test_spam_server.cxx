@@ -29,18 +29,39 @@
 #include <sys/time.h>
 #include <sys/types.h>
 #include <unistd.h>
+#include <string.h>
 
 int
 main(int argc, char *argv[]) {
-  if (argc != 2) {
-    nout << "test_spam_server port\n";
+  // With -echo, each datagram is sent back only to the client that sent it,
+  // rather than to every client, so that the server can be loaded with many
+  // thousands of connections (see test_spam_client -c).  -epoll selects the
+  // epoll backend for the reader.
+  ConnectionReader::PollMethod poll_method = ConnectionReader::PM_select;
+  bool echo = false;
+
+  int i = 1;
+  while (i < argc && argv[i][0] == '-') {
+    if (strcmp(argv[i], "-epoll") == 0) {
+      poll_method = ConnectionReader::PM_epoll;
+    } else if (strcmp(argv[i], "-echo") == 0) {
+      echo = true;
+    } else {
+      break;
+    }
+    ++i;
+  }
+
+  if (argc != i + 1) {
+    nout << "test_spam_server [-epoll] [-echo] port\n";
     exit(1);
   }
 
-  int port = atoi(argv[1]);
+  int port = atoi(argv[i]);
 
   QueuedConnectionManager cm;
-  PT(Connection) rendezvous = cm.open_TCP_server_rendezvous(port, 5);
+  int backlog = echo ? 1024 : 5;
+  PT(Connection) rendezvous = cm.open_TCP_server_rendezvous(port, backlog);
 
   if (rendezvous.is_null()) {
     nout << "Cannot grab port " << port << ".\n";
@@ -55,11 +76,15 @@ main(int argc, char *argv[]) {
   typedef pset< PT(Connection) > Clients;
   Clients clients;
 
-  QueuedConnectionReader reader(&cm, 10);
+  QueuedConnectionReader reader(&cm, 10, poll_method);
+  if (reader.get_poll_method() == ConnectionReader::PM_epoll) {
+    nout << "Using epoll\n";
+  }
   ConnectionWriter writer(&cm, 10);
 
   int num_sent = 0;
   int num_received = 0;
+  int last_num_received = 0;
 
   ClockObject *global_clock = ClockObject::get_global_clock();
   double last_reported_time = global_clock->get_real_time();
@@ -73,7 +98,9 @@ main(int argc, char *argv[]) {
       NetAddress address;
       PT(Connection) new_connection;
       if (listener.get_new_connection(rv, address, new_connection)) {
-        nout << "Got connection from " << address << "\n";
+        if (!echo) {
+          nout << "Got connection from " << address << "\n";
+        }
         reader.add_connection(new_connection);
         clients.insert(new_connection);
       }
@@ -83,8 +110,10 @@ main(int argc, char *argv[]) {
     while (cm.reset_connection_available()) {
       PT(Connection) connection;
       if (cm.get_reset_connection(connection)) {
-        nout << "Lost connection from "
-             << connection->get_address() << "\n";
+        if (!echo) {
+          nout << "Lost connection from "
+               << connection->get_address() << "\n";
+        }
         clients.erase(connection);
         cm.close_connection(connection);
       }
@@ -95,20 +124,30 @@ main(int argc, char *argv[]) {
       NetDatagram datagram;
       if (reader.get_data(datagram)) {
         num_received++;
-        Clients::iterator ci;
-        for (ci = clients.begin(); ci != clients.end(); ++ci) {
-          if (writer.send(datagram, (*ci))) {
+        if (echo) {
+          if (writer.send(datagram, datagram.get_connection())) {
             num_sent++;
           }
+        } else {
+          Clients::iterator ci;
+          for (ci = clients.begin(); ci != clients.end(); ++ci) {
+            if (writer.send(datagram, (*ci))) {
+              num_sent++;
+            }
+          }
         }
       }
     }
 
     double now = global_clock->get_real_time();
     if ((now - last_reported_time) > report_interval) {
-      nout << "Sent " << num_sent << ", received "
-           << num_received << " datagrams.\n";
+      double rate =
+        (num_received - last_num_received) / (now - last_reported_time);
+      nout << clients.size() << " clients.  Sent " << num_sent << ", received "
+           << num_received << " datagrams (" << (int)rate
+           << " datagrams/sec).\n";
       last_reported_time = now;
+      last_num_received = num_received;
     }
 
     // Yield the timeslice before we poll again.
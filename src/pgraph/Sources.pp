@@ -1,7 +1,7 @@
 #define OTHER_LIBS interrogatedb \
                    dtoolutil:c dtoolbase:c dtool:m prc
 #define LOCAL_LIBS \
-    event gsgbase gobj putil linmath \
+    event gsgbase gobj putil linmath ssemath \
     downloader express pandabase pstatclient \
     keyvalues
 
@@ -107,6 +107,7 @@
     shaderParamAttrib.I shaderParamAttrib.h \
     shaderPool.I shaderPool.h \
     showBoundsEffect.I showBoundsEffect.h \
+    stateCacheLock.I stateCacheLock.h \
     stateMunger.I stateMunger.h \
     stencilAttrib.I stencilAttrib.h \
     texMatrixAttrib.I texMatrixAttrib.h \
@@ -210,6 +211,7 @@
     shaderParamAttrib.cxx \
     shaderPool.cxx \
     showBoundsEffect.cxx \
+    stateCacheLock.cxx \
     stateMunger.cxx \
     stencilAttrib.cxx \
     texMatrixAttrib.cxx \
@@ -313,6 +315,7 @@
     shaderParamAttrib.I shaderParamAttrib.h \
     shaderPool.I shaderPool.h \
     showBoundsEffect.I showBoundsEffect.h \
+    stateCacheLock.I stateCacheLock.h \
     stateMunger.I stateMunger.h \
     stencilAttrib.I stencilAttrib.h \
     texMatrixAttrib.I texMatrixAttrib.h \
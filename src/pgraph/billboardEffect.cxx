@@ -144,16 +144,20 @@ cull_callback(CullTraverser *trav, CullTraverserData &data,
     compute_billboard(node_transform, modelview_transform, camera_transform);
   }
   else {
-    // Compute the billboard effect for every instance individually.
+    // Compute the billboard effect for every instance individually.  We go
+    // through set_transform() rather than operator [], so that a packed
+    // list stays packed.
     InstanceList *instances = new InstanceList(*data._instances);
     data._instances = instances;
 
-    for (InstanceList::Instance &instance : *instances) {
+    size_t num_instances = instances->size();
+    for (size_t i = 0; i < num_instances; ++i) {
+      CPT(TransformState) instance_transform = instances->get_transform(i);
       CPT(TransformState) inst_node_transform = node_transform;
-      CPT(TransformState) inst_modelview_transform = modelview_transform->compose(instance.get_transform());
+      CPT(TransformState) inst_modelview_transform = modelview_transform->compose(instance_transform);
       compute_billboard(inst_node_transform, inst_modelview_transform, camera_transform);
 
-      instance.set_transform(instance.get_transform()->compose(inst_node_transform));
+      instances->set_transform(i, instance_transform->compose(inst_node_transform));
     }
 
     // We've already applied this onto the instances.
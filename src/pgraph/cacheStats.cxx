@@ -31,16 +31,16 @@ init() {
 
 /**
  * Reinitializes just those parts of the CacheStats that should be reset
- * between each reporting interval.
+ * between each reporting interval.  Assumes the report lock is held.
  */
 void CacheStats::
 reset(double now) {
 #ifndef NDEBUG
-  _cache_hits = 0;
-  _cache_misses = 0;
-  _cache_adds = 0;
-  _cache_new_adds = 0;
-  _cache_dels = 0;
+  AtomicAdjust::set(_cache_hits, 0);
+  AtomicAdjust::set(_cache_misses, 0);
+  AtomicAdjust::set(_cache_adds, 0);
+  AtomicAdjust::set(_cache_new_adds, 0);
+  AtomicAdjust::set(_cache_dels, 0);
   _last_reset = now;
 #endif  // NDEBUG
 }
@@ -51,12 +51,17 @@ reset(double now) {
 void CacheStats::
 write(std::ostream &out, const char *name) const {
 #ifndef NDEBUG
-  out << name << " cache: " << _cache_hits << " hits, "
-      << _cache_misses << " misses\n"
-      << _cache_adds + _cache_new_adds << "(" << _cache_new_adds << ") adds(new), "
-      << _cache_dels << " dels, "
-      << _total_cache_size << " / " << _num_states << " = "
-      << (double)_total_cache_size / (double)_num_states
+  AtomicAdjust::Integer cache_adds = AtomicAdjust::get(_cache_adds);
+  AtomicAdjust::Integer cache_new_adds = AtomicAdjust::get(_cache_new_adds);
+  AtomicAdjust::Integer total_cache_size = AtomicAdjust::get(_total_cache_size);
+  AtomicAdjust::Integer num_states = AtomicAdjust::get(_num_states);
+
+  out << name << " cache: " << AtomicAdjust::get(_cache_hits) << " hits, "
+      << AtomicAdjust::get(_cache_misses) << " misses\n"
+      << cache_adds + cache_new_adds << "(" << cache_new_adds << ") adds(new), "
+      << AtomicAdjust::get(_cache_dels) << " dels, "
+      << total_cache_size << " / " << num_states << " = "
+      << (double)total_cache_size / (double)num_states
       << " average cache size\n";
 #endif  // NDEBUG
 }
@@ -17,6 +17,9 @@
 #include "pandabase.h"
 #include "clockObject.h"
 #include "pnotify.h"
+#include "atomicAdjust.h"
+#include "lightMutex.h"
+#include "lightMutexHolder.h"
 
 /**
  * This is used to track the utilization of the TransformState and RenderState
@@ -39,13 +42,18 @@ public:
 
 private:
 #ifndef NDEBUG
-  int _cache_hits = 0;
-  int _cache_misses = 0;
-  int _cache_adds = 0;
-  int _cache_new_adds = 0;
-  int _cache_dels = 0;
-  int _total_cache_size = 0;
-  int _num_states = 0;
+  // The counters are updated while holding only one stripe of the state
+  // cache lock, if any, so they must be adjusted atomically.
+  AtomicAdjust::Integer _cache_hits = 0;
+  AtomicAdjust::Integer _cache_misses = 0;
+  AtomicAdjust::Integer _cache_adds = 0;
+  AtomicAdjust::Integer _cache_new_adds = 0;
+  AtomicAdjust::Integer _cache_dels = 0;
+  AtomicAdjust::Integer _total_cache_size = 0;
+  AtomicAdjust::Integer _num_states = 0;
+
+  // This protects _last_reset, and ensures only one thread writes a report.
+  LightMutex _report_lock;
   double _last_reset = 0.0;
 
   bool _cache_report = false;
@@ -149,24 +149,26 @@ cull_callback(CullTraverser *trav, CullTraverserData &data,
     CPT(TransformState) node_transform_copy = node_transform;
     if (node_transform_copy->is_identity()) {
       // Slightly optimized case.
-      for (InstanceList::Instance &instance : *instances) {
-        CPT(TransformState) true_net_transform = parent_net_transform->compose(instance.get_transform());
+      size_t num_instances = instances->size();
+      for (size_t i = 0; i < num_instances; ++i) {
+        CPT(TransformState) true_net_transform = parent_net_transform->compose(instances->get_transform(i));
         CPT(TransformState) want_net_transform = true_net_transform;
         adjust_transform(want_net_transform, node_transform_copy, data.node());
 
-        instance.set_transform(invert_net_transform->compose(want_net_transform));
+        instances->set_transform(i, invert_net_transform->compose(want_net_transform));
       }
     }
     else {
       // We apply the node_transform to the instances.
       node_transform = TransformState::make_identity();
 
-      for (InstanceList::Instance &instance : *instances) {
-        CPT(TransformState) true_net_transform = parent_net_transform->compose(instance.get_transform());
+      size_t num_instances = instances->size();
+      for (size_t i = 0; i < num_instances; ++i) {
+        CPT(TransformState) true_net_transform = parent_net_transform->compose(instances->get_transform(i));
         CPT(TransformState) want_net_transform = true_net_transform;
         adjust_transform(want_net_transform, node_transform_copy, data.node());
 
-        instance.set_transform(invert_net_transform->compose(want_net_transform)->compose(node_transform_copy));
+        instances->set_transform(i, invert_net_transform->compose(want_net_transform)->compose(node_transform_copy));
       }
     }
   }
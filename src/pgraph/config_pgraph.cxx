@@ -139,6 +139,31 @@ ConfigVariableBool debug_portal_cull
           "(You first need to enable portal culling, using the allow-portal-cull"
           "variable.)"));
 
+ConfigVariableBool parallel_cull
+("parallel-cull", false,
+ PRC_DESC("Set this true to have new CullTraversers split their traversal "
+          "across the worker threads of the \"cull\" task chain by default.  "
+          "The Geoms found by each subtree are buffered and passed on to "
+          "the CullHandler in the same order as the serial traversal would "
+          "produce them, so the final draw order is unchanged.  This is "
+          "ignored when portal culling is enabled.  See also "
+          "CullTraverser::set_parallel()."));
+
+ConfigVariableInt cull_num_threads
+("cull-num-threads", 3,
+ PRC_DESC("The number of worker threads that will be started to perform "
+          "parallel cull traversals.  The thread that calls traverse() "
+          "also participates.  These threads are only started if a "
+          "parallel traversal is actually performed."));
+
+ConfigVariableInt cull_parallel_split_depth
+("cull-parallel-split-depth", 2,
+ PRC_DESC("The depth below the scene root at which a parallel cull "
+          "traversal splits the scene graph into independent units of "
+          "work.  Nodes above this depth are visited on the calling "
+          "thread; each subtree rooted at this depth becomes one unit of "
+          "work."));
+
 ConfigVariableBool show_occluder_volumes
 ("show-occluder-volumes", false,
  PRC_DESC("Set this true to enable debug visualization of the volumes used "
@@ -213,6 +238,30 @@ ConfigVariableDouble garbage_collect_states_rate
           "performance if states accumulate faster than they can be "
           "cleaned up."));
 
+ConfigVariableInt garbage_collect_states_young_age
+("garbage-collect-states-young-age", 2,
+ PRC_DESC("The number of garbage collection steps that a newly created "
+          "TransformState or RenderState must survive before it is moved "
+          "out of the young generation.  Young states are examined on every "
+          "step; the rest of the cache is examined only once every "
+          "garbage-collect-states-old-interval steps."));
+
+ConfigVariableInt garbage_collect_states_old_interval
+("garbage-collect-states-old-interval", 8,
+ PRC_DESC("The number of garbage collection steps between scans of the "
+          "old generation of TransformStates and RenderStates.  Each scan "
+          "processes garbage-collect-states-rate of the old states.  Since "
+          "most states are freed while they are still young, this can be "
+          "fairly large."));
+
+ConfigVariableDouble garbage_collect_states_budget
+("garbage-collect-states-budget", 0.0,
+ PRC_DESC("The maximum amount of time, in milliseconds, that each garbage "
+          "collection step of the TransformState or RenderState cache may "
+          "take.  When it runs out, the step stops, and the next step "
+          "resumes where it left off.  The young generation is always "
+          "collected first.  Set this to 0 for no limit."));
+
 ConfigVariableBool transform_cache
 ("transform-cache", true,
  PRC_DESC("Set this true to enable the cache of TransformState objects.  "
@@ -35,6 +35,9 @@ extern ConfigVariableBool clip_plane_cull;
 extern ConfigVariableBool light_cull;
 extern ConfigVariableBool allow_portal_cull;
 extern ConfigVariableBool debug_portal_cull;
+extern ConfigVariableBool parallel_cull;
+extern ConfigVariableInt cull_num_threads;
+extern ConfigVariableInt cull_parallel_split_depth;
 extern ConfigVariableBool show_occluder_volumes;
 extern ConfigVariableBool unambiguous_graph;
 extern ConfigVariableBool detect_graph_cycles;
@@ -46,6 +49,9 @@ extern ConfigVariableBool paranoid_const;
 extern ConfigVariableBool auto_break_cycles;
 extern EXPCL_PANDA_PGRAPH ConfigVariableBool garbage_collect_states;
 extern ConfigVariableDouble garbage_collect_states_rate;
+extern ConfigVariableInt garbage_collect_states_young_age;
+extern ConfigVariableInt garbage_collect_states_old_interval;
+extern ConfigVariableDouble garbage_collect_states_budget;
 extern ConfigVariableBool transform_cache;
 extern ConfigVariableBool state_cache;
 extern ConfigVariableBool uniquify_transforms;
@@ -34,14 +34,148 @@
 #include "geomLinestrips.h"
 #include "geomLines.h"
 #include "geomVertexWriter.h"
+#include "asyncTaskManager.h"
+#include "atomicAdjust.h"
+#include "pStatTimer.h"
+#include "pdeque.h"
 
 PStatCollector CullTraverser::_nodes_pcollector("Nodes");
 PStatCollector CullTraverser::_geom_nodes_pcollector("Nodes:GeomNodes");
 PStatCollector CullTraverser::_geoms_pcollector("Geoms");
 PStatCollector CullTraverser::_geoms_occluded_pcollector("Geoms:Occluded");
+PStatCollector CullTraverser::_parallel_pcollector("Cull:Parallel");
+PStatCollector CullTraverser::_dispatch_pcollector("Cull:Parallel:Dispatch");
 
 TypeHandle CullTraverser::_type_handle;
 
+/**
+ * One piece of a parallel cull traversal, in traversal order.  This is either
+ * a subtree that is to be visited by a worker thread, or a run of objects
+ * that were recorded by the calling thread in between two subtrees.  Either
+ * way, the objects are collected here until they can be passed on to the
+ * real CullHandler.
+ */
+class CullTraverser::DeferredUnit : public CullHandler {
+public:
+  virtual void record_object(CullableObject *object,
+                             const CullTraverser *traverser);
+
+  bool _has_subtree = false;
+  NodePath _node_path;
+  CPT(TransformState) _net_transform;
+  CPT(RenderState) _state;
+  PT(GeometricBoundingVolume) _view_frustum;
+  CPT(CullPlanes) _cull_planes;
+  CPT(CullLights) _cull_lights;
+  CPT(InstanceList) _instances;
+  DrawMask _draw_mask;
+  int _portal_depth = 0;
+
+  pvector<CullableObject *> _objects;
+  Levels _levels;
+};
+
+/**
+ * Stands in for the CullHandler while the calling thread walks the top of the
+ * scene graph, and hands out the deferred subtrees to the worker threads.
+ */
+class CullTraverser::ParallelCull : public CullHandler {
+public:
+  ParallelCull(CullTraverser *trav, int root_depth);
+
+  virtual void record_object(CullableObject *object,
+                             const CullTraverser *traverser);
+
+  void run();
+  static void run_func(void *data);
+
+  CullTraverser *_trav;
+  int _root_depth;
+  int _split_depth;
+
+  // A deque, so that references to earlier units stay valid as we add more.
+  pdeque<DeferredUnit> _units;
+  pvector<DeferredUnit *> _jobs;
+  AtomicAdjust::Integer _next_job;
+};
+
+/**
+ *
+ */
+void CullTraverser::DeferredUnit::
+record_object(CullableObject *object, const CullTraverser *) {
+  _objects.push_back(object);
+}
+
+/**
+ *
+ */
+CullTraverser::ParallelCull::
+ParallelCull(CullTraverser *trav, int root_depth) :
+  _trav(trav),
+  _root_depth(root_depth),
+  _split_depth(std::max((int)cull_parallel_split_depth, 1)),
+  _next_job(0)
+{
+}
+
+/**
+ * Called for objects found by the calling thread above the split depth.
+ */
+void CullTraverser::ParallelCull::
+record_object(CullableObject *object, const CullTraverser *) {
+  if (_units.empty() || _units.back()._has_subtree) {
+    _units.push_back(DeferredUnit());
+  }
+  _units.back()._objects.push_back(object);
+}
+
+/**
+ * Visits deferred subtrees until there are none left to claim.  This is run
+ * by the calling thread as well as by each of the worker threads.
+ */
+void CullTraverser::ParallelCull::
+run() {
+  Thread *current_thread = Thread::get_current_thread();
+
+  // Each thread gets its own traverser, which collects the objects and the
+  // counts into the unit that it is currently working on.  The worker threads
+  // already run at the cull thread's pipeline stage.
+  CullTraverser trav(*_trav);
+  trav.local_object();
+  trav._current_thread = current_thread;
+
+  AtomicAdjust::Integer num_jobs = (AtomicAdjust::Integer)_jobs.size();
+  AtomicAdjust::Integer i = AtomicAdjust::add(_next_job, 1) - 1;
+  while (i < num_jobs) {
+    DeferredUnit &unit = *_jobs[i];
+    trav._cull_handler = &unit;
+    trav._levels = &unit._levels;
+
+    CullTraverserData data(unit._node_path, unit._net_transform, unit._state,
+                           unit._view_frustum, current_thread);
+    data._cull_planes = std::move(unit._cull_planes);
+    data._cull_lights = std::move(unit._cull_lights);
+    data._instances = std::move(unit._instances);
+    data._draw_mask = unit._draw_mask;
+    data._portal_depth = unit._portal_depth;
+    if (!data._cull_planes->is_empty() || !data._cull_lights->is_empty()) {
+      data._node_reader.check_cached(true);
+    }
+
+    trav.do_traverse(data);
+    i = AtomicAdjust::add(_next_job, 1) - 1;
+  }
+}
+
+/**
+ * The function that runs on each of the threads of the "cull" task chain.
+ */
+void CullTraverser::ParallelCull::
+run_func(void *data) {
+  ((ParallelCull *)data)->run();
+}
+
 /**
  *
  */
@@ -56,6 +190,9 @@ CullTraverser() :
   _cull_handler = nullptr;
   _portal_clipper = nullptr;
   _effective_incomplete_render = true;
+  _parallel = parallel_cull;
+  _deferred = nullptr;
+  _levels = nullptr;
 }
 
 /**
@@ -73,7 +210,10 @@ CullTraverser(const CullTraverser &copy) :
   _view_frustum(copy._view_frustum),
   _cull_handler(copy._cull_handler),
   _portal_clipper(copy._portal_clipper),
-  _effective_incomplete_render(copy._effective_incomplete_render)
+  _effective_incomplete_render(copy._effective_incomplete_render),
+  _parallel(copy._parallel),
+  _deferred(nullptr),
+  _levels(nullptr)
 {
 }
 
@@ -152,6 +292,9 @@ traverse(const NodePath &root) {
       do_traverse(my_data);
     }
 
+  } else if (can_traverse_parallel()) {
+    traverse_parallel(root);
+
   } else {
     CullTraverserData data(root, TransformState::make_identity(),
                            _initial_state, _view_frustum,
@@ -169,7 +312,7 @@ traverse(const NodePath &root) {
  */
 void CullTraverser::
 traverse_below(CullTraverserData &data) {
-  _nodes_pcollector.add_level(1);
+  add_nodes_level(1);
   PandaNodePipelineReader *node_reader = data.node_reader();
   PandaNode *node = data.node();
 
@@ -220,6 +363,102 @@ end_traverse() {
   _cull_handler->end_traverse();
 }
 
+/**
+ * Returns true if the next call to traverse() may be performed in parallel.
+ */
+bool CullTraverser::
+can_traverse_parallel() const {
+  if (!_parallel || cull_num_threads <= 0 ||
+      !Thread::is_threading_supported()) {
+    return false;
+  }
+
+  // A derived traverser may have redefined traverse_below(), which the
+  // per-thread copies of this object would not know about.
+  if (get_type() != get_class_type()) {
+    return false;
+  }
+
+  return _portal_clipper == nullptr;
+}
+
+/**
+ * Performs the traversal from the indicated root, handing the subtrees at
+ * cull-parallel-split-depth to the threads of the "cull" task chain.  The
+ * objects found are then passed on to the CullHandler in the same order that
+ * the serial traversal would have produced them in.
+ */
+void CullTraverser::
+traverse_parallel(const NodePath &root) {
+  ParallelCull deferred(this, root.get_num_nodes());
+
+  {
+    PStatTimer timer(_parallel_pcollector);
+
+    // First, walk the top of the graph on this thread, collecting the objects
+    // we come across and setting aside the subtrees below the split depth.
+    CullHandler *cull_handler = _cull_handler;
+    _cull_handler = &deferred;
+    _deferred = &deferred;
+
+    CullTraverserData data(root, TransformState::make_identity(),
+                           _initial_state, _view_frustum,
+                           _current_thread);
+
+    if (data.is_in_view(_camera_mask)) {
+      do_traverse(data);
+    }
+
+    _deferred = nullptr;
+    _cull_handler = cull_handler;
+
+    // Now visit the subtrees, spread across this thread and the threads of
+    // the "cull" task chain.
+    AsyncTaskManager::get_global_ptr()->run_parallel
+      ("cull", cull_num_threads, (int)deferred._jobs.size(),
+       &ParallelCull::run_func, &deferred);
+  }
+
+  PStatTimer timer(_dispatch_pcollector);
+  for (const DeferredUnit &unit : deferred._units) {
+    for (CullableObject *object : unit._objects) {
+      _cull_handler->record_object(object, this);
+    }
+    add_nodes_level(unit._levels._nodes);
+    add_geom_nodes_level(unit._levels._geom_nodes);
+    add_geoms_level(unit._levels._geoms);
+  }
+}
+
+/**
+ * Called by do_traverse() on the calling thread during a parallel traversal.
+ * If the indicated node is at the split depth, saves the subtree rooted there
+ * for one of the worker threads, and returns true.  Otherwise, returns false
+ * to indicate that the node should be visited right away.
+ */
+bool CullTraverser::
+defer_traverse(CullTraverserData &data) {
+  NodePath node_path = data.get_node_path();
+  if (node_path.get_num_nodes() - _deferred->_root_depth < _deferred->_split_depth) {
+    return false;
+  }
+
+  _deferred->_units.push_back(DeferredUnit());
+  DeferredUnit &unit = _deferred->_units.back();
+  unit._has_subtree = true;
+  unit._node_path = std::move(node_path);
+  unit._net_transform = data._net_transform;
+  unit._state = data._state;
+  unit._view_frustum = data._view_frustum;
+  unit._cull_planes = data._cull_planes;
+  unit._cull_lights = data._cull_lights;
+  unit._instances = data._instances;
+  unit._draw_mask = data._draw_mask;
+  unit._portal_depth = data._portal_depth;
+  _deferred->_jobs.push_back(&unit);
+  return true;
+}
+
 /**
  * Draws an appropriate visualization of the indicated bounding volume.
  */
@@ -229,7 +468,7 @@ draw_bounding_volume(const BoundingVolume *vol,
   PT(Geom) bounds_viz = make_bounds_viz(vol);
 
   if (bounds_viz != nullptr) {
-    _geoms_pcollector.add_level(2);
+    add_geoms_level(2);
     CullableObject *outer_viz =
       new CullableObject(bounds_viz, get_bounds_outer_viz_state(),
                          internal_transform);
@@ -254,7 +493,7 @@ show_bounds(CullTraverserData &data, bool tight) {
     PT(Geom) bounds_viz = make_tight_bounds_viz(node);
 
     if (bounds_viz != nullptr) {
-      _geoms_pcollector.add_level(1);
+      add_geoms_level(1);
       CullableObject *outer_viz =
         new CullableObject(std::move(bounds_viz), get_bounds_outer_viz_state(),
                            internal_transform);
@@ -276,8 +515,9 @@ show_bounds(CullTraverserData &data, bool tight) {
     }
   } else {
     // Draw bounds for every instance.
-    for (const InstanceList::Instance &instance : *data._instances) {
-      CPT(TransformState) transform = internal_transform->compose(instance.get_transform());
+    size_t num_instances = data._instances->size();
+    for (size_t ii = 0; ii < num_instances; ++ii) {
+      CPT(TransformState) transform = internal_transform->compose(data._instances->get_transform(ii));
       draw_bounding_volume(node->get_bounds(), transform);
 
       if (node->is_geom_node()) {
@@ -77,6 +77,9 @@ PUBLISHED:
 
   INLINE bool get_effective_incomplete_render() const;
 
+  INLINE void set_parallel(bool parallel);
+  INLINE bool get_parallel() const;
+
   void traverse(const NodePath &root);
   virtual void traverse_below(CullTraverserData &data);
   INLINE void do_traverse(CullTraverserData &data);
@@ -84,6 +87,9 @@ PUBLISHED:
   virtual void end_traverse();
 
   INLINE static void flush_level();
+  INLINE void add_nodes_level(int level) const;
+  INLINE void add_geom_nodes_level(int level) const;
+  INLINE void add_geoms_level(int level) const;
 
   void draw_bounding_volume(const BoundingVolume *vol,
                             const TransformState *internal_transform) const;
@@ -100,8 +106,26 @@ public:
   static PStatCollector _geom_nodes_pcollector;
   static PStatCollector _geoms_pcollector;
   static PStatCollector _geoms_occluded_pcollector;
+  static PStatCollector _parallel_pcollector;
+  static PStatCollector _dispatch_pcollector;
 
 private:
+  class DeferredUnit;
+  class ParallelCull;
+
+  // A worker thread of a parallel traversal counts the nodes and Geoms it
+  // visits here, since only the cull thread may increment the collectors.
+  class Levels {
+  public:
+    int _nodes = 0;
+    int _geom_nodes = 0;
+    int _geoms = 0;
+  };
+
+  bool can_traverse_parallel() const;
+  void traverse_parallel(const NodePath &root);
+  bool defer_traverse(CullTraverserData &data);
+
   void show_bounds(CullTraverserData &data, bool tight);
   static PT(Geom) make_bounds_viz(const BoundingVolume *vol);
   PT(Geom) make_tight_bounds_viz(PandaNode *node) const;
@@ -122,6 +146,14 @@ private:
   CullHandler *_cull_handler;
   PortalClipper *_portal_clipper;
   bool _effective_incomplete_render;
+  bool _parallel;
+
+  // This is non-NULL only while the calling thread is walking the top of the
+  // scene graph during a parallel traversal.
+  ParallelCull *_deferred;
+
+  // This is non-NULL only on the traversers of the worker threads.
+  Levels *_levels;
 
 public:
   static TypeHandle get_class_type() {
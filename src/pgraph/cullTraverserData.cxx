@@ -84,11 +84,7 @@ void CullTraverserData::
 apply_transform(const TransformState *node_transform) {
   if (!node_transform->is_identity()) {
     if (_instances != nullptr) {
-      InstanceList *instances = new InstanceList(*_instances);
-      for (InstanceList::Instance &instance : *instances) {
-        instance.set_transform(instance.get_transform()->compose(node_transform));
-      }
-      _instances = std::move(instances);
+      _instances = _instances->compose(node_transform);
       return;
     }
 
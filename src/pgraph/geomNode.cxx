@@ -500,7 +500,7 @@ is_renderable() const {
  */
 void GeomNode::
 add_for_draw(CullTraverser *trav, CullTraverserData &data) {
-  trav->_geom_nodes_pcollector.add_level(1);
+  trav->add_geom_nodes_level(1);
 
   if (pgraph_cat.is_spam()) {
     pgraph_cat.spam()
@@ -513,7 +513,7 @@ add_for_draw(CullTraverser *trav, CullTraverserData &data) {
   // Get all the Geoms, with no decalling.
   Geoms geoms = get_geoms(current_thread);
   int num_geoms = geoms.get_num_geoms();
-  trav->_geoms_pcollector.add_level(num_geoms);
+  trav->add_geoms_level(num_geoms);
   CPT(TransformState) internal_transform = data.get_internal_transform(trav);
 
   if (num_geoms == 1) {
@@ -17,6 +17,10 @@
 #include "bamWriter.h"
 #include "bitArray.h"
 #include "geomVertexWriter.h"
+#include "boundingSphere.h"
+#include "boundingHexahedron.h"
+#include "lightMutexHolder.h"
+#include "ssemath.h"
 
 TypeHandle InstanceList::_type_handle;
 
@@ -32,7 +36,15 @@ make_cow_copy() {
  *
  */
 InstanceList::
-InstanceList() {
+InstanceList() :
+  _packed(false),
+  _stale_begin(0),
+  _stale_end(0),
+  _dirty_begin(0),
+  _dirty_end(0),
+  _spheres_stale(true),
+  _spheres_radius(0)
+{
 }
 
 /**
@@ -40,8 +52,27 @@ InstanceList() {
  */
 InstanceList::
 InstanceList(const InstanceList &copy) :
-  _instances(copy._instances)
+  _packed(copy._packed),
+  _stale_begin(0),
+  _stale_end(copy._matrices.size()),
+  _matrices(copy._matrices),
+  _dirty_begin(0),
+  _dirty_end(0),
+  _spheres_stale(true),
+  _spheres_radius(0)
 {
+  if (!_packed) {
+    _instances = copy._instances;
+  } else {
+    // Share the instance array too, so that a list that is copied in order
+    // to be modified can still be updated without being rebuilt.
+    // get_array_data() makes its own copy of the array before it changes it,
+    // if the other list still holds on to it.
+    LightMutexHolder holder(copy._cache_lock);
+    _cached_array = copy._cached_array;
+    _dirty_begin = copy._dirty_begin;
+    _dirty_end = copy._dirty_end;
+  }
 }
 
 /**
@@ -51,6 +82,133 @@ InstanceList::
 ~InstanceList() {
 }
 
+/**
+ * Specifies whether the instances should be stored as packed matrices rather
+ * than as TransformStates.  A packed list keeps its matrices in the same
+ * layout as the instance array that is sent to the graphics card, so that
+ * get_array_data() can copy them directly, and set_matrix() can change
+ * individual instances without rebuilding the whole array.  This is most
+ * useful for large lists of instances that are updated every frame.
+ *
+ * Asking for a modifiable Instance object from a packed list converts it back
+ * to an unpacked list.
+ */
+void InstanceList::
+set_packed(bool packed) {
+  if (packed == _packed) {
+    return;
+  }
+
+  if (packed) {
+    _matrices.clear();
+    _matrices.reserve(_instances.size());
+    for (const Instance &instance : _instances) {
+      _matrices.push_back(LCAST(float, instance.get_mat()));
+    }
+    _instances.clear();
+  } else {
+    _instances.clear();
+    _instances.reserve(_matrices.size());
+    for (const LMatrix4f &mat : _matrices) {
+      _instances.push_back(Instance(TransformState::make_mat(LCAST(PN_stdfloat, mat))));
+    }
+    _matrices.clear();
+  }
+
+  _packed = packed;
+  mark_stale();
+}
+
+/**
+ * Adds a new instance with the indicated transformation matrix to the list.
+ * On a packed list, this does not need to create a TransformState.
+ */
+void InstanceList::
+append(const LMatrix4 &mat) {
+  if (_packed) {
+    _matrices.push_back(LCAST(float, mat));
+  } else {
+    _instances.push_back(Instance(TransformState::make_mat(mat)));
+  }
+  mark_stale();
+}
+
+/**
+ * Returns the transformation matrix of the nth instance.
+ */
+LMatrix4 InstanceList::
+get_matrix(size_t n) const {
+  nassertr(n < size(), LMatrix4::ident_mat());
+  return get_instance_mat(n);
+}
+
+/**
+ * Replaces the transformation matrix of the nth instance.  On a packed list,
+ * this only marks the one row of the instance array as needing to be
+ * updated.
+ */
+void InstanceList::
+set_matrix(size_t n, const LMatrix4 &mat) {
+  nassertv(n < size());
+
+  if (!_packed) {
+    _instances[n].set_mat(mat);
+    mark_stale();
+    return;
+  }
+
+  _matrices[n] = LCAST(float, mat);
+
+  LightMutexHolder holder(_cache_lock);
+  if (_cached_array != nullptr) {
+    if (_dirty_begin == _dirty_end) {
+      _dirty_begin = n;
+      _dirty_end = n + 1;
+    } else {
+      _dirty_begin = std::min(_dirty_begin, n);
+      _dirty_end = std::max(_dirty_end, n + 1);
+    }
+  }
+  _spheres_stale = true;
+  if (_stale_begin == _stale_end) {
+    _stale_begin = n;
+    _stale_end = n + 1;
+  } else {
+    _stale_begin = std::min(_stale_begin, n);
+    _stale_end = std::max(_stale_end, n + 1);
+  }
+}
+
+/**
+ * Returns the transform of the nth instance.  On a packed list, this creates
+ * a new TransformState from the matrix; prefer get_matrix() when the matrix
+ * is all that is needed.
+ */
+CPT(TransformState) InstanceList::
+get_transform(size_t n) const {
+  nassertr(n < size(), TransformState::make_identity());
+  if (_packed) {
+    return TransformState::make_mat(LCAST(PN_stdfloat, _matrices[n]));
+  } else {
+    return _instances[n].get_transform();
+  }
+}
+
+/**
+ * Replaces the transform of the nth instance.  Unlike operator [], this does
+ * not convert a packed list to an unpacked one.
+ */
+void InstanceList::
+set_transform(size_t n, const TransformState *transform) {
+  nassertv(n < size());
+  if (_packed) {
+    set_matrix(n, transform->get_mat());
+  } else {
+    _instances[n].set_transform(transform);
+    mark_stale();
+  }
+}
+
 /**
  * Transforms all of the instances in the list by the indicated matrix.
  */
@@ -59,6 +217,25 @@ xform(const LMatrix4 &mat) {
 
 }
 
+/**
+ * Composes the indicated transform onto each of the instances, as if it were
+ * applied to a node below the instance transform.
+ */
+void InstanceList::
+compose_transform(const TransformState *transform) {
+  if (_packed) {
+    LMatrix4f node_mat = LCAST(float, transform->get_mat());
+    for (LMatrix4f &mat : _matrices) {
+      mat = node_mat * mat;
+    }
+  } else {
+    for (Instance &instance : _instances) {
+      instance.set_transform(instance.get_transform()->compose(transform));
+    }
+  }
+  mark_stale();
+}
+
 /**
  * Returns an immutable copy without the bits turned on in the indicated mask.
  */
@@ -80,47 +257,302 @@ without(const BitArray &mask) const {
   }
 
   InstanceList *new_list = new InstanceList;
-  new_list->_instances.reserve(num_instances - num_culled);
+  if (_packed) {
+    new_list->_packed = true;
+    new_list->_matrices.reserve(num_instances - num_culled);
+
+    for (size_t i = (size_t)mask.get_lowest_off_bit(); i < num_instances; ++i) {
+      if (!mask.get_bit(i)) {
+        new_list->_matrices.push_back(_matrices[i]);
+      }
+    }
+    new_list->_stale_end = new_list->_matrices.size();
+  } else {
+    new_list->_instances.reserve(num_instances - num_culled);
+
+    for (size_t i = (size_t)mask.get_lowest_off_bit(); i < num_instances; ++i) {
+      if (!mask.get_bit(i)) {
+        new_list->_instances.push_back(_instances[i]);
+      }
+    }
+  }
+
+  return new_list;
+}
+
+/**
+ * Returns a new list in which the indicated transform is composed onto each
+ * of the instances, as by compose_transform().  A packed list remains packed.
+ */
+CPT(InstanceList) InstanceList::
+compose(const TransformState *transform) const {
+  if (transform->is_identity()) {
+    return this;
+  }
 
-  for (size_t i = (size_t)mask.get_lowest_off_bit(); i < num_instances; ++i) {
-    if (!mask.get_bit(i)) {
-      new_list->_instances.push_back(_instances[i]);
+  PT(InstanceList) new_list = new InstanceList;
+  size_t num_instances = size();
+  if (_packed) {
+    new_list->_packed = true;
+    new_list->_matrices.reserve(num_instances);
+    LMatrix4f node_mat = LCAST(float, transform->get_mat());
+    for (const LMatrix4f &mat : _matrices) {
+      new_list->_matrices.push_back(node_mat * mat);
+    }
+    new_list->_stale_end = num_instances;
+  } else {
+    new_list->_instances.reserve(num_instances);
+    for (const Instance &instance : _instances) {
+      new_list->_instances.push_back(Instance(instance.get_transform()->compose(transform)));
     }
   }
+  return new_list;
+}
+
+/**
+ * Returns a new list containing each of the other list's instances placed
+ * below each of the instances of this list, as when an InstancedNode is
+ * found below another InstancedNode.  The result is packed if either list is.
+ */
+CPT(InstanceList) InstanceList::
+compose(const InstanceList *other) const {
+  PT(InstanceList) new_list = new InstanceList;
+  size_t num_instances = size();
+  size_t num_other = other->size();
 
+  if (_packed || other->_packed) {
+    new_list->_packed = true;
+    new_list->_matrices.reserve(num_instances * num_other);
+    for (size_t i = 0; i < num_instances; ++i) {
+      LMatrix4f parent_mat = LCAST(float, get_instance_mat(i));
+      for (size_t j = 0; j < num_other; ++j) {
+        new_list->_matrices.push_back(LCAST(float, other->get_instance_mat(j)) * parent_mat);
+      }
+    }
+    new_list->_stale_end = new_list->_matrices.size();
+  } else {
+    new_list->_instances.reserve(num_instances * num_other);
+    for (const Instance &parent_instance : _instances) {
+      for (const Instance &this_instance : other->_instances) {
+        new_list->_instances.push_back(Instance(parent_instance.get_transform()->compose(this_instance.get_transform())));
+      }
+    }
+  }
   return new_list;
 }
 
 /**
- * Returns a GeomVertexArrayData containing the matrices.
+ * Determines which of the instances are entirely outside the indicated
+ * frustum, given the bounding sphere of the instanced geometry, and turns on
+ * the corresponding bits in the culled mask, suitable for passing to
+ * without().  Both volumes are in the coordinate space of the InstancedNode,
+ * ie. before the instance transforms are applied.
+ *
+ * The instance spheres are cached, so this is cheap to call every frame as
+ * long as the list and the bounding sphere don't change.
  */
-CPT(GeomVertexArrayData) InstanceList::
-get_array_data(const GeomVertexArrayFormat *format) const {
-  CPT(GeomVertexArrayData) array_data = _cached_array;
-  if (array_data != nullptr) {
-    if (array_data->get_array_format() == format) {
-      return array_data;
+void InstanceList::
+compute_culled(BitArray &culled, const BoundingSphere *bounds,
+               const BoundingHexahedron *frustum) const {
+  nassertv(bounds != nullptr && frustum != nullptr);
+  nassertv(!bounds->is_empty() && !bounds->is_infinite());
+
+  size_t num_instances = size();
+  if (num_instances == 0) {
+    return;
+  }
+
+  static const int max_planes = 6;
+  int num_planes = frustum->get_num_planes();
+  nassertv(num_planes <= max_planes);
+
+  fltx4 plane_a[max_planes];
+  fltx4 plane_b[max_planes];
+  fltx4 plane_c[max_planes];
+  fltx4 plane_d[max_planes];
+  for (int p = 0; p < num_planes; ++p) {
+    LPlane plane = frustum->get_plane(p);
+    plane_a[p] = ReplicateX4((float)plane[0]);
+    plane_b[p] = ReplicateX4((float)plane[1]);
+    plane_c[p] = ReplicateX4((float)plane[2]);
+    plane_d[p] = ReplicateX4((float)plane[3]);
+  }
+
+  LightMutexHolder holder(_cache_lock);
+  if (_spheres_stale || _spheres_center != bounds->get_center() ||
+      _spheres_radius != bounds->get_radius()) {
+    update_spheres(bounds->get_center(), bounds->get_radius());
+  }
+
+  const float *xs = _sphere_x.data();
+  const float *ys = _sphere_y.data();
+  const float *zs = _sphere_z.data();
+  const float *rs = _sphere_r.data();
+
+  for (size_t i = 0; i < num_instances; i += 4) {
+    fltx4 x = LoadUnalignedSIMD(xs + i);
+    fltx4 y = LoadUnalignedSIMD(ys + i);
+    fltx4 z = LoadUnalignedSIMD(zs + i);
+    fltx4 r = LoadUnalignedSIMD(rs + i);
+
+    // A sphere is outside the frustum if it is entirely in front of any one
+    // of the planes.
+    fltx4 outside = LoadZeroSIMD();
+    for (int p = 0; p < num_planes; ++p) {
+      fltx4 dist = MaddSIMD(x, plane_a[p],
+                   MaddSIMD(y, plane_b[p],
+                   MaddSIMD(z, plane_c[p], plane_d[p])));
+      outside = OrSIMD(outside, CmpGtSIMD(dist, r));
+    }
+
+    int mask = TestSignSIMD(outside);
+    for (size_t j = 0; mask != 0; ++j, mask >>= 1) {
+      if ((mask & 1) != 0 && i + j < num_instances) {
+        culled.set_bit(i + j);
+      }
     }
   }
+}
+
+/**
+ * Recomputes the cached bounding sphere of each instance, given the bounding
+ * sphere of the instanced geometry.  Assumes the lock is held.
+ */
+void InstanceList::
+update_spheres(const LPoint3 &center, PN_stdfloat radius) const {
+  size_t num_instances = size();
+  size_t padded_size = (num_instances + 3) & ~(size_t)3;
+  _sphere_x.resize(padded_size);
+  _sphere_y.resize(padded_size);
+  _sphere_z.resize(padded_size);
+  _sphere_r.resize(padded_size);
+
+  for (size_t i = 0; i < num_instances; ++i) {
+    LMatrix4 mat = get_instance_mat(i);
+    LPoint3 instance_center = center * mat;
+
+    // Scale the radius by the largest axis scale, to be safe in the presence
+    // of a non-uniform scale.
+    PN_stdfloat scale2 = std::max(mat.get_row3(0).length_squared(),
+                         std::max(mat.get_row3(1).length_squared(),
+                                  mat.get_row3(2).length_squared()));
+
+    _sphere_x[i] = (float)instance_center[0];
+    _sphere_y[i] = (float)instance_center[1];
+    _sphere_z[i] = (float)instance_center[2];
+    _sphere_r[i] = (float)(radius * csqrt(scale2));
+  }
 
+  for (size_t i = num_instances; i < padded_size; ++i) {
+    _sphere_x[i] = 0.0f;
+    _sphere_y[i] = 0.0f;
+    _sphere_z[i] = 0.0f;
+    _sphere_r[i] = 0.0f;
+  }
+
+  _spheres_center = center;
+  _spheres_radius = radius;
+  _spheres_stale = false;
+}
+
+/**
+ * Returns a GeomVertexArrayData containing the matrices.
+ */
+CPT(GeomVertexArrayData) InstanceList::
+get_array_data(const GeomVertexArrayFormat *format) const {
   nassertr(format != nullptr, nullptr);
 
+  LightMutexHolder holder(_cache_lock);
   size_t num_instances = size();
-  PT(GeomVertexArrayData) new_array = new GeomVertexArrayData(format, GeomEnums::UH_stream);
-  new_array->unclean_set_num_rows(num_instances);
 
-  {
-    GeomVertexWriter writer(new_array, Thread::get_current_thread());
-    writer.set_column(InternalName::get_instance_matrix());
-    for (size_t i = 0; i < num_instances; ++i) {
-      writer.set_matrix4(_instances[i].get_mat());
+  if (_cached_array != nullptr &&
+      _cached_array->get_array_format() == format) {
+    if (_dirty_begin < _dirty_end) {
+      // Only some of the matrices of a packed list have changed; update just
+      // those rows.  We may only modify the array we already have if nobody
+      // else holds on to it; it may still be in use by a copy of this list,
+      // or by a caller that we handed it to before.
+      PT(GeomVertexArrayData) array_data;
+      if (_cached_array->get_ref_count() == 1) {
+        array_data = (GeomVertexArrayData *)_cached_array.p();
+      } else {
+        array_data = new GeomVertexArrayData(*_cached_array);
+      }
+      write_rows(array_data, _dirty_begin, _dirty_end);
+      _cached_array = array_data;
+      _dirty_begin = 0;
+      _dirty_end = 0;
     }
+    return _cached_array;
   }
 
+  // A packed list is likely to be changed again, so we keep the array around
+  // and modify it in place.
+  PT(GeomVertexArrayData) new_array = new GeomVertexArrayData(format,
+    _packed ? GeomEnums::UH_dynamic : GeomEnums::UH_stream);
+  new_array->unclean_set_num_rows(num_instances);
+  write_rows(new_array, 0, num_instances);
+
   _cached_array = new_array;
+  _dirty_begin = 0;
+  _dirty_end = 0;
   return new_array;
 }
 
+/**
+ * Writes the matrices of the indicated range of instances to the
+ * corresponding rows of the array.  Assumes the lock is held.
+ */
+void InstanceList::
+write_rows(GeomVertexArrayData *array, size_t begin, size_t end) const {
+  if (begin >= end) {
+    return;
+  }
+
+  Thread *current_thread = Thread::get_current_thread();
+  const GeomVertexArrayFormat *format = array->get_array_format();
+  const GeomVertexColumn *column = format->get_column(InternalName::get_instance_matrix());
+  nassertv(column != nullptr);
+
+  if (_packed && column->get_numeric_type() == GeomEnums::NT_float32 &&
+      column->get_total_bytes() == sizeof(LMatrix4f) &&
+      column->get_start() == 0 && format->get_stride() == sizeof(LMatrix4f)) {
+    // The array has the same layout as our matrices, so we can just copy
+    // them in directly.
+    PT(GeomVertexArrayDataHandle) handle = array->modify_handle(current_thread);
+    unsigned char *dest = handle->get_write_pointer();
+    memcpy(dest + begin * sizeof(LMatrix4f), &_matrices[begin],
+           (end - begin) * sizeof(LMatrix4f));
+    return;
+  }
+
+  GeomVertexWriter writer(array, current_thread);
+  writer.set_column(InternalName::get_instance_matrix());
+  writer.set_row(begin);
+  for (size_t i = begin; i < end; ++i) {
+    writer.set_matrix4(get_instance_mat(i));
+  }
+}
+
+/**
+ * Brings the entries of the list of Instance objects whose matrices have
+ * changed up to date, for a packed list, and returns it.
+ */
+const InstanceList::Instances &InstanceList::
+unpack_instances() const {
+  LightMutexHolder holder(_cache_lock);
+  if (_stale_begin < _stale_end || _instances.size() != _matrices.size()) {
+    _instances.resize(_matrices.size());
+    size_t end = std::min(_stale_end, _matrices.size());
+    for (size_t i = _stale_begin; i < end; ++i) {
+      _instances[i] = Instance(TransformState::make_mat(LCAST(PN_stdfloat, _matrices[i])));
+    }
+    _stale_begin = 0;
+    _stale_end = 0;
+  }
+  return _instances;
+}
+
 /**
  *
  */
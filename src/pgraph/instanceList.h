@@ -19,8 +19,11 @@
 #include "transformState.h"
 #include "pvector.h"
 #include "geomVertexArrayData.h"
+#include "lightMutex.h"
 
 class BitArray;
+class BoundingSphere;
+class BoundingHexahedron;
 class FactoryParams;
 
 /**
@@ -83,6 +86,7 @@ PUBLISHED:
   void append(const LPoint3 &pos,
               const LQuaternion &quat,
               const LVecBase3 &scale = LVecBase3(1));
+  void append(const LMatrix4 &mat);
 
   INLINE size_t size() const;
   INLINE const Instance &operator [] (size_t n) const;
@@ -90,7 +94,17 @@ PUBLISHED:
   INLINE void clear();
   INLINE void reserve(size_t);
 
+  void set_packed(bool packed);
+  INLINE bool is_packed() const;
+  MAKE_PROPERTY(packed, is_packed, set_packed);
+
+  LMatrix4 get_matrix(size_t n) const;
+  void set_matrix(size_t n, const LMatrix4 &mat);
+  CPT(TransformState) get_transform(size_t n) const;
+  void set_transform(size_t n, const TransformState *transform);
+
   void xform(const LMatrix4 &mat);
+  void compose_transform(const TransformState *transform);
 
 public:
   typedef pvector<Instance> Instances;
@@ -108,6 +122,10 @@ public:
   INLINE const_iterator cend() const;
 
   CPT(InstanceList) without(const BitArray &mask) const;
+  CPT(InstanceList) compose(const TransformState *transform) const;
+  CPT(InstanceList) compose(const InstanceList *other) const;
+  void compute_culled(BitArray &culled, const BoundingSphere *bounds,
+                      const BoundingHexahedron *frustum) const;
 
   CPT(GeomVertexArrayData) get_array_data(const GeomVertexArrayFormat *format) const;
 
@@ -115,10 +133,48 @@ public:
   virtual void write(std::ostream &out, int indent_level) const;
 
 private:
-  Instances _instances;
+  INLINE void mark_stale();
+  INLINE const Instances &get_instances() const;
+  const Instances &unpack_instances() const;
+  INLINE LMatrix4 get_instance_mat(size_t n) const;
+  void update_spheres(const LPoint3 &center, PN_stdfloat radius) const;
+  void write_rows(GeomVertexArrayData *array, size_t begin, size_t end) const;
+
+  // If _packed is false, the instances are stored in _instances.  If it is
+  // true, they are stored as matrices in _matrices, in the same layout as the
+  // instance array, and _instances is only filled in on demand, for code
+  // that wants to look at the individual Instance objects.  In that case,
+  // the entries in the range [_stale_begin, _stale_end) of _instances are
+  // out of date.
+  bool _packed;
+  mutable Instances _instances;
+  mutable size_t _stale_begin;
+  mutable size_t _stale_end;
+  pvector<LMatrix4f> _matrices;
+
+  // This lock protects all of the cached data below, as well as the
+  // on-demand _instances of a packed list.
+  mutable LightMutex _cache_lock;
 
   mutable CPT(GeomVertexArrayData) _cached_array;
 
+  // The range of rows of a packed list that have been changed with
+  // set_matrix() since they were last copied into _cached_array.
+  mutable size_t _dirty_begin;
+  mutable size_t _dirty_end;
+
+  // The bounding sphere of each instance, stored as a structure of arrays
+  // (padded to a multiple of four) so that compute_culled() can test four
+  // instances at a time.  This is computed from the sphere that was passed
+  // to the last call to compute_culled().
+  mutable bool _spheres_stale;
+  mutable LPoint3 _spheres_center;
+  mutable PN_stdfloat _spheres_radius;
+  mutable pvector<float> _sphere_x;
+  mutable pvector<float> _sphere_y;
+  mutable pvector<float> _sphere_z;
+  mutable pvector<float> _sphere_r;
+
 public:
   static void register_with_read_factory();
   virtual void write_datagram(BamWriter *manager, Datagram &dg) override;
@@ -14,6 +14,7 @@
 #include "instancedNode.h"
 #include "boundingBox.h"
 #include "boundingSphere.h"
+#include "boundingHexahedron.h"
 #include "cullTraverserData.h"
 #include "cullPlanes.h"
 
@@ -167,7 +168,7 @@ calc_tight_bounds(LPoint3 &min_point, LPoint3 &max_point, bool &found_any,
   CPT(TransformState) next_transform = transform->compose(get_transform(current_thread));
 
   for (size_t ii = 0; ii < instances->size(); ++ii) {
-    CPT(TransformState) instance_transform = next_transform->compose((*instances)[ii].get_transform());
+    CPT(TransformState) instance_transform = next_transform->compose(instances->get_transform(ii));
 
     Children cr = get_children(current_thread);
     size_t num_children = cr.get_num_children();
@@ -207,14 +208,7 @@ cull_callback(CullTraverser *trav, CullTraverserData &data) {
 
   if (data._instances != nullptr) {
     // We are already under an instanced node.  Create a new combined list.
-    InstanceList *new_list = new InstanceList();
-    new_list->reserve(data._instances->size() * instances->size());
-    for (const InstanceList::Instance &parent_instance : *data._instances) {
-      for (const InstanceList::Instance &this_instance : *instances) {
-        new_list->append(parent_instance.get_transform()->compose(this_instance.get_transform()));
-      }
-    }
-    instances = new_list;
+    instances = data._instances->compose(instances);
   }
 
   if (data._view_frustum != nullptr || !data._cull_planes->is_empty()) {
@@ -224,21 +218,55 @@ cull_callback(CullTraverser *trav, CullTraverserData &data) {
 
     // Keep track of which instances should be culled away.
     BitArray culled_instances;
-    culled_instances.set_range(0, instances->size());
 
-    for (size_t ii = 0; ii < instances->size(); ++ii) {
-      CullTraverserData instance_data(data);
-      instance_data.apply_transform((*instances)[ii].get_transform());
+    const BoundingHexahedron *frustum = nullptr;
+    if (data._cull_planes->is_empty() &&
+        data._view_frustum->is_exact_type(BoundingHexahedron::get_class_type()) &&
+        !data._view_frustum->is_empty() && !data._view_frustum->is_infinite()) {
+      frustum = (const BoundingHexahedron *)data._view_frustum.p();
+    }
 
+    if (frustum != nullptr) {
+      // This is the common case: just a view frustum.  Put a sphere around
+      // all of the children, and let the InstanceList test all of the
+      // instances against the frustum in one pass.
+      pvector<const BoundingVolume *> child_volumes;
+      child_volumes.reserve(children.size());
       for (size_t ci = 0; ci < children.size(); ++ci) {
-        CullTraverserData child_data(instance_data, children.get_child(ci),
-                                     instance_data._net_transform,
-                                     instance_data._state,
-                                     instance_data._view_frustum);
-        if (child_data.is_in_view(trav->get_camera_mask())) {
-          // Yep, the instance is in view.
-          culled_instances.clear_bit(ii);
-          break;
+        child_volumes.push_back(children.get_child_connection(ci).get_bounds());
+      }
+
+      // If we can't compute a sphere, we just keep all of the instances.
+      BoundingSphere bounds;
+      if (child_volumes.empty()) {
+        culled_instances.set_range(0, instances->size());
+
+      } else if (bounds.around(&child_volumes[0], &child_volumes[0] + child_volumes.size())) {
+        if (bounds.is_empty()) {
+          culled_instances.set_range(0, instances->size());
+
+        } else if (!bounds.is_infinite()) {
+          instances->compute_culled(culled_instances, &bounds, frustum);
+        }
+      }
+
+    } else {
+      culled_instances.set_range(0, instances->size());
+
+      for (size_t ii = 0; ii < instances->size(); ++ii) {
+        CullTraverserData instance_data(data);
+        instance_data.apply_transform(instances->get_transform(ii));
+
+        for (size_t ci = 0; ci < children.size(); ++ci) {
+          CullTraverserData child_data(instance_data, children.get_child(ci),
+                                       instance_data._net_transform,
+                                       instance_data._state,
+                                       instance_data._view_frustum);
+          if (child_data.is_in_view(trav->get_camera_mask())) {
+            // Yep, the instance is in view.
+            culled_instances.clear_bit(ii);
+            break;
+          }
         }
       }
     }
@@ -345,19 +373,21 @@ compute_external_bounds(CPT(BoundingVolume) &external_bounds,
   }
 
   // Now that we have a sphere encompassing the children, we will make a box
-  // surrounding all the instances, extended by the computed radius.
-  LPoint3 min_point = (*instances)[0].get_pos();
+  // surrounding all the instances, extended by the computed radius.  We look
+  // at the matrices directly, so that a packed list need not create a
+  // TransformState for each instance.
+  size_t num_instances = instances->size();
+  LPoint3 min_point = instances->get_matrix(0).get_row3(3);
   LPoint3 max_point(min_point);
 
-  for (const InstanceList::Instance &instance : *instances) {
+  for (size_t ii = 0; ii < num_instances; ++ii) {
     // To make the math easier and not have to take rotations into account, we
     // take the highest scale component and multiply it by the radius of the
     // bounding sphere on the origin we just calculated.
-    LVecBase3 scale = instance.get_scale();
-    PN_stdfloat max_scale = std::max(std::fabs(scale[0]), std::max(std::fabs(scale[1]), std::fabs(scale[2])));
-    PN_stdfloat inst_radius = max_scale * max_radius;
+    LMatrix4 mat = instances->get_matrix(ii);
+    PN_stdfloat inst_radius = get_max_scale(mat) * max_radius;
     LVector3 extends_by(inst_radius);
-    LPoint3 pos = instance.get_pos();
+    LPoint3 pos = mat.get_row3(3);
     min_point = min_point.fmin(pos - extends_by);
     max_point = max_point.fmax(pos + extends_by);
   }
@@ -373,11 +403,10 @@ compute_external_bounds(CPT(BoundingVolume) &external_bounds,
     LPoint3 center = (min_point + max_point) * 0.5;
 
     PN_stdfloat max_distance = 0;
-    for (const InstanceList::Instance &instance : *instances) {
-      LVecBase3 scale = instance.get_scale();
-      PN_stdfloat max_scale = std::max(std::fabs(scale[0]), std::max(std::fabs(scale[1]), std::fabs(scale[2])));
-      PN_stdfloat inst_radius = max_scale * max_radius;
-      PN_stdfloat distance = (instance.get_pos() - center).length() + inst_radius;
+    for (size_t ii = 0; ii < num_instances; ++ii) {
+      LMatrix4 mat = instances->get_matrix(ii);
+      PN_stdfloat inst_radius = get_max_scale(mat) * max_radius;
+      PN_stdfloat distance = (LPoint3(mat.get_row3(3)) - center).length() + inst_radius;
       max_distance = std::max(max_distance, distance);
     }
 
@@ -401,6 +430,17 @@ compute_external_bounds(CPT(BoundingVolume) &external_bounds,
   external_bounds = gbv;
 }
 
+/**
+ * Returns the largest scale factor applied by the indicated instance matrix,
+ * ie. the length of its longest axis.
+ */
+PN_stdfloat InstancedNode::
+get_max_scale(const LMatrix4 &mat) {
+  return csqrt(std::max(mat.get_row3(0).length_squared(),
+               std::max(mat.get_row3(1).length_squared(),
+                        mat.get_row3(2).length_squared())));
+}
+
 /**
  * Tells the BamReader how to create objects of type GeomNode.
  */
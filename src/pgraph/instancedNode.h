@@ -74,6 +74,9 @@ protected:
                                        int pipeline_stage,
                                        Thread *current_thread) const override;
 
+private:
+  static PN_stdfloat get_max_scale(const LMatrix4 &mat);
+
 private:
   // This is the data that must be cycled between pipeline stages.
   class EXPCL_PANDA_PGRAPH CData final : public CycleData {
@@ -304,7 +304,9 @@ try_load_file(const Filename &pathname, const LoaderOptions &options,
   if (cache->get_cache_models() &&
       (options.get_flags() & LoaderOptions::LF_no_disk_cache) == 0) {
     // See if the model can be found in the on-disk cache, if it is active.
-    record = cache->lookup(pathname, "bam");
+    // Of the loader flags, only the animation conversion affects the result.
+    int key_flags = options.get_flags() & LoaderOptions::LF_convert_anim;
+    record = cache->lookup(pathname, "bam", format_string(key_flags));
     if (record != nullptr) {
       if (record->has_data()) {
         if (report_errors) {
@@ -40,18 +40,29 @@
 
 using std::ostream;
 
-LightReMutex *RenderState::_states_lock = nullptr;
-RenderState::States RenderState::_states;
+StateCacheLock *RenderState::_states_lock = nullptr;
+RenderState::States *RenderState::_states = nullptr;
 const RenderState *RenderState::_empty_state = nullptr;
 UpdateSeq RenderState::_last_cycle_detect;
-size_t RenderState::_garbage_index = 0;
+size_t *RenderState::_garbage_index = nullptr;
+RenderState::YoungStates *RenderState::_young_states = nullptr;
+size_t RenderState::_young_gc_stripe = 0;
+int RenderState::_old_gc_countdown = 0;
+size_t RenderState::_old_gc_stripe = 0;
 
 PStatCollector RenderState::_cache_update_pcollector("*:State Cache:Update");
 PStatCollector RenderState::_garbage_collect_pcollector("*:State Cache:Garbage Collect");
+PStatCollector RenderState::_garbage_collect_young_pcollector("*:State Cache:Garbage Collect:Young");
+PStatCollector RenderState::_garbage_collect_old_pcollector("*:State Cache:Garbage Collect:Old");
 PStatCollector RenderState::_state_compose_pcollector("*:State Cache:Compose State");
 PStatCollector RenderState::_state_invert_pcollector("*:State Cache:Invert State");
 PStatCollector RenderState::_node_counter("RenderStates:On nodes");
 PStatCollector RenderState::_cache_counter("RenderStates:Cached");
+PStatCollector RenderState::_lock_acquire_counter("RenderStates:Lock:Acquired");
+PStatCollector RenderState::_lock_contended_counter("RenderStates:Lock:Contended");
+PStatCollector RenderState::_young_counter("RenderStates:Young");
+PStatCollector RenderState::_young_reclaimed_counter("RenderStates:Reclaimed:Young");
+PStatCollector RenderState::_old_reclaimed_counter("RenderStates:Reclaimed:Old");
 PStatCollector RenderState::_state_break_cycles_pcollector("*:State Cache:Break Cycles");
 PStatCollector RenderState::_state_validate_pcollector("*:State Cache:Validate");
 
@@ -74,6 +85,7 @@ RenderState() :
     init_states();
   }
   _saved_entry = -1;
+  _young_index = -1;
   _last_mi = -1;
   _cache_stats.add_num_states(1);
   _read_overrides = nullptr;
@@ -101,6 +113,7 @@ RenderState(const RenderState &copy) :
   }
 
   _saved_entry = -1;
+  _young_index = -1;
   _last_mi = -1;
   _cache_stats.add_num_states(1);
   _read_overrides = nullptr;
@@ -121,10 +134,9 @@ RenderState::
   nassertv(!is_destructing());
   set_destructing();
 
-  LightReMutexHolder holder(*_states_lock);
-
-  // unref() should have cleared these.
-  nassertv(_saved_entry == -1);
+  // unref() should have cleared these.  No other thread can be looking at our
+  // composition cache now, so we don't need to hold the lock.
+  nassertv(_saved_entry == -1 && _young_index == -1);
   nassertv(_composition_cache.is_empty() && _invert_composition_cache.is_empty());
 
   // If this was true at the beginning of the destructor, but is no longer
@@ -362,9 +374,30 @@ compose(const RenderState *other) const {
     return do_compose(other);
   }
 
-  LightReMutexHolder holder(*_states_lock);
+  {
+    StateCacheLock::StripeHolder holder(*_states_lock, get_cache_stripe());
+
+    // Is this composition already cached?
+    int index = _composition_cache.find(other);
+    if (index != -1) {
+      const Composition &comp = _composition_cache.get_data(index);
+      if (comp._result != nullptr) {
+        // Here's the cache!
+        _cache_stats.inc_hits();
+        return comp._result;
+      }
+    }
+  }
+
+  // Not in the cache.  Compute a new result.  We mustn't hold the lock while
+  // we do this, since uniquifying the new result takes a different stripe.
+  CPT(RenderState) result = do_compose(other);
+
+  // We need to hold the stripes for both this object and the other object,
+  // since we may have to add an entry to both caches.
+  StateCacheLock::PairHolder holder(*_states_lock, get_cache_stripe(),
+                                    other->get_cache_stripe());
 
-  // Is this composition already cached?
   int index = _composition_cache.find(other);
   if (index != -1) {
     Composition &comp = ((RenderState *)this)->_composition_cache.modify_data(index);
@@ -372,7 +405,6 @@ compose(const RenderState *other) const {
       // Well, it wasn't cached already, but we already had an entry (probably
       // created for the reverse direction), so use the same entry to store
       // the new result.
-      CPT(RenderState) result = do_compose(other);
       comp._result = result;
 
       if (result != (const RenderState *)this) {
@@ -381,7 +413,8 @@ compose(const RenderState *other) const {
         result->cache_ref();
       }
     }
-    // Here's the cache!
+    // Here's the cache!  If another thread got here first while we weren't
+    // holding the lock, this is its result rather than ours.
     _cache_stats.inc_hits();
     return comp._result;
   }
@@ -393,11 +426,8 @@ compose(const RenderState *other) const {
 
   // The cache entry in this object is the only one that indicates the result;
   // the other will be NULL for now.
-  CPT(RenderState) result = do_compose(other);
-
   _cache_stats.add_total_size(1);
   _cache_stats.inc_adds(_composition_cache.is_empty());
-
   ((RenderState *)this)->_composition_cache[other]._result = result;
 
   if (other != this) {
@@ -451,9 +481,30 @@ invert_compose(const RenderState *other) const {
     return do_invert_compose(other);
   }
 
-  LightReMutexHolder holder(*_states_lock);
+  {
+    StateCacheLock::StripeHolder holder(*_states_lock, get_cache_stripe());
+
+    // Is this composition already cached?
+    int index = _invert_composition_cache.find(other);
+    if (index != -1) {
+      const Composition &comp = _invert_composition_cache.get_data(index);
+      if (comp._result != nullptr) {
+        // Here's the cache!
+        _cache_stats.inc_hits();
+        return comp._result;
+      }
+    }
+  }
+
+  // Not in the cache.  Compute a new result.  We mustn't hold the lock while
+  // we do this, since uniquifying the new result takes a different stripe.
+  CPT(RenderState) result = do_invert_compose(other);
+
+  // We need to hold the stripes for both this object and the other object,
+  // since we may have to add an entry to both caches.
+  StateCacheLock::PairHolder holder(*_states_lock, get_cache_stripe(),
+                                    other->get_cache_stripe());
 
-  // Is this composition already cached?
   int index = _invert_composition_cache.find(other);
   if (index != -1) {
     Composition &comp = ((RenderState *)this)->_invert_composition_cache.modify_data(index);
@@ -461,7 +512,6 @@ invert_compose(const RenderState *other) const {
       // Well, it wasn't cached already, but we already had an entry (probably
       // created for the reverse direction), so use the same entry to store
       // the new result.
-      CPT(RenderState) result = do_invert_compose(other);
       comp._result = result;
 
       if (result != (const RenderState *)this) {
@@ -470,7 +520,8 @@ invert_compose(const RenderState *other) const {
         result->cache_ref();
       }
     }
-    // Here's the cache!
+    // Here's the cache!  If another thread got here first while we weren't
+    // holding the lock, this is its result rather than ours.
     _cache_stats.inc_hits();
     return comp._result;
   }
@@ -482,8 +533,6 @@ invert_compose(const RenderState *other) const {
 
   // The cache entry in this object is the only one that indicates the result;
   // the other will be NULL for now.
-  CPT(RenderState) result = do_invert_compose(other);
-
   _cache_stats.add_total_size(1);
   _cache_stats.inc_adds(_invert_composition_cache.is_empty());
   ((RenderState *)this)->_invert_composition_cache[other]._result = result;
@@ -626,8 +675,9 @@ unref() const {
   // We always have to grab the lock, since we will definitely need to be
   // holding it if we happen to drop the reference count to 0. Having to grab
   // the lock at every call to unref() is a big limiting factor on
-  // parallelization.
-  LightReMutexHolder holder(*_states_lock);
+  // parallelization.  We need all of the stripes, since we may be touching
+  // the caches of any number of other states.
+  StateCacheLock::Holder holder(*_states_lock);
 
   if (auto_break_cycles && uniquify_states) {
     if (get_cache_ref_count() > 0 &&
@@ -720,8 +770,12 @@ get_max_priority() {
  */
 int RenderState::
 get_num_states() {
-  LightReMutexHolder holder(*_states_lock);
-  return _states.get_num_entries();
+  size_t num_states = 0;
+  for (size_t n = 0; n < _states_lock->get_num_stripes(); ++n) {
+    StateCacheLock::StripeHolder holder(*_states_lock, n);
+    num_states += _states[n].get_num_entries();
+  }
+  return (int)num_states;
 }
 
 /**
@@ -739,40 +793,42 @@ get_num_states() {
  */
 int RenderState::
 get_num_unused_states() {
-  LightReMutexHolder holder(*_states_lock);
+  StateCacheLock::Holder holder(*_states_lock);
 
   // First, we need to count the number of times each RenderState object is
   // recorded in the cache.
   typedef pmap<const RenderState *, int> StateCount;
   StateCount state_count;
 
-  size_t size = _states.get_num_entries();
-  for (size_t si = 0; si < size; ++si) {
-    const RenderState *state = _states.get_key(si);
-
-    size_t i;
-    size_t cache_size = state->_composition_cache.get_num_entries();
-    for (i = 0; i < cache_size; ++i) {
-      const RenderState *result = state->_composition_cache.get_data(i)._result;
-      if (result != nullptr && result != state) {
-        // Here's a RenderState that's recorded in the cache.  Count it.
-        std::pair<StateCount::iterator, bool> ir =
-          state_count.insert(StateCount::value_type(result, 1));
-        if (!ir.second) {
-          // If the above insert operation fails, then it's already in the
-          // cache; increment its value.
-          (*(ir.first)).second++;
+  for (size_t n = 0; n < _states_lock->get_num_stripes(); ++n) {
+    size_t size = _states[n].get_num_entries();
+    for (size_t si = 0; si < size; ++si) {
+      const RenderState *state = _states[n].get_key(si);
+
+      size_t i;
+      size_t cache_size = state->_composition_cache.get_num_entries();
+      for (i = 0; i < cache_size; ++i) {
+        const RenderState *result = state->_composition_cache.get_data(i)._result;
+        if (result != nullptr && result != state) {
+          // Here's a RenderState that's recorded in the cache.  Count it.
+          std::pair<StateCount::iterator, bool> ir =
+            state_count.insert(StateCount::value_type(result, 1));
+          if (!ir.second) {
+            // If the above insert operation fails, then it's already in the
+            // cache; increment its value.
+            (*(ir.first)).second++;
+          }
         }
       }
-    }
-    cache_size = state->_invert_composition_cache.get_num_entries();
-    for (i = 0; i < cache_size; ++i) {
-      const RenderState *result = state->_invert_composition_cache.get_data(i)._result;
-      if (result != nullptr && result != state) {
-        std::pair<StateCount::iterator, bool> ir =
-          state_count.insert(StateCount::value_type(result, 1));
-        if (!ir.second) {
-          (*(ir.first)).second++;
+      cache_size = state->_invert_composition_cache.get_num_entries();
+      for (i = 0; i < cache_size; ++i) {
+        const RenderState *result = state->_invert_composition_cache.get_data(i)._result;
+        if (result != nullptr && result != state) {
+          std::pair<StateCount::iterator, bool> ir =
+            state_count.insert(StateCount::value_type(result, 1));
+          if (!ir.second) {
+            (*(ir.first)).second++;
+          }
         }
       }
     }
@@ -819,10 +875,10 @@ get_num_unused_states() {
  */
 int RenderState::
 clear_cache() {
-  LightReMutexHolder holder(*_states_lock);
+  StateCacheLock::Holder holder(*_states_lock);
 
   PStatTimer timer(_cache_update_pcollector);
-  int orig_size = _states.get_num_entries();
+  int orig_size = get_num_states();
 
   // First, we need to copy the entire set of states to a temporary vector,
   // reference-counting each object.  That way we can walk through the copy,
@@ -833,10 +889,12 @@ clear_cache() {
     TempStates temp_states;
     temp_states.reserve(orig_size);
 
-    size_t size = _states.get_num_entries();
-    for (size_t si = 0; si < size; ++si) {
-      const RenderState *state = _states.get_key(si);
-      temp_states.push_back(state);
+    for (size_t n = 0; n < _states_lock->get_num_stripes(); ++n) {
+      size_t size = _states[n].get_num_entries();
+      for (size_t si = 0; si < size; ++si) {
+        const RenderState *state = _states[n].get_key(si);
+        temp_states.push_back(state);
+      }
     }
 
     // Now it's safe to walk through the list, destroying the cache within
@@ -874,7 +932,7 @@ clear_cache() {
     // the various objects' caches will go away.
   }
 
-  int new_size = _states.get_num_entries();
+  int new_size = get_num_states();
   return orig_size - new_size;
 }
 
@@ -884,6 +942,12 @@ clear_cache() {
  * appropriately.  It does no harm to call it even if this variable is not
  * true, but there is probably no advantage in that case.
  *
+ * RenderStates that were created recently are examined on every call, since most
+ * states are only used briefly.  The rest are examined only once every
+ * garbage-collect-states-old-interval calls.  If garbage-collect-states-budget
+ * is set, each call stops after that much time, and the next call resumes
+ * where it left off.
+ *
  * This automatically calls RenderAttrib::garbage_collect() as well.
  */
 int RenderState::
@@ -894,79 +958,227 @@ garbage_collect() {
     return num_attribs;
   }
 
-  LightReMutexHolder holder(*_states_lock);
+  // We hold all of the stripes while we do this, since breaking cycles and
+  // removing the cache pointers of a state touches other states' caches.
+  StateCacheLock::Holder holder(*_states_lock);
 
   PStatTimer timer(_garbage_collect_pcollector);
-  size_t orig_size = _states.get_num_entries();
 
-  // How many elements to process this pass?
-  size_t size = orig_size;
-  size_t num_this_pass = std::max(0, int(size * garbage_collect_states_rate));
-  if (num_this_pass <= 0) {
-    return num_attribs;
+  // If we run past this time, we stop, and pick up where we left off on the
+  // next call.
+  double deadline = 0.0;
+  if (garbage_collect_states_budget > 0.0) {
+    deadline = ClockObject::get_global_clock()->get_real_time() +
+      garbage_collect_states_budget * 0.001;
   }
 
-  bool break_and_uniquify = (auto_break_cycles && uniquify_transforms);
+  size_t num_stripes = _states_lock->get_num_stripes();
+  bool out_of_time = false;
 
-  size_t si = _garbage_index;
-  if (si >= size) {
-    si = 0;
+  // Most states are only used briefly, so we first look at the ones that
+  // were created recently.  We start with the stripe that we ran out of time
+  // on last time, so that they all get a turn.
+  int num_young = 0;
+  size_t num_young_states = 0;
+  {
+    PStatTimer young_timer(_garbage_collect_young_pcollector);
+    size_t first = _young_gc_stripe % num_stripes;
+    for (size_t i = 0; i < num_stripes; ++i) {
+      size_t n = (first + i) % num_stripes;
+      if (!out_of_time) {
+        num_young += garbage_collect_young(n, deadline, out_of_time);
+        if (out_of_time) {
+          _young_gc_stripe = n;
+        }
+      }
+      num_young_states += _young_states[n].size();
+    }
   }
 
-  num_this_pass = std::min(num_this_pass, size);
-  size_t stop_at_element = (si + num_this_pass) % size;
+  // The states that have survived that long are likely to stick around, so
+  // we only look at them every so often.
+  int num_old = 0;
+  if (_old_gc_countdown > 0) {
+    --_old_gc_countdown;
+  }
+  if (_old_gc_countdown == 0 && !out_of_time) {
+    PStatTimer old_timer(_garbage_collect_old_pcollector);
+    while (_old_gc_stripe < num_stripes) {
+      num_old += garbage_collect_old(_old_gc_stripe, deadline, out_of_time);
+      if (out_of_time) {
+        break;
+      }
+      ++_old_gc_stripe;
+    }
 
-  do {
-    RenderState *state = (RenderState *)_states.get_key(si);
+    if (_old_gc_stripe >= num_stripes) {
+      // We got through all of them.  Schedule the next scan.
+      _old_gc_stripe = 0;
+      _old_gc_countdown = std::max((int)garbage_collect_states_old_interval, 1);
+    }
+  }
+
+  _young_counter.set_level(num_young_states);
+  _young_reclaimed_counter.set_level(num_young);
+  _old_reclaimed_counter.set_level(num_old);
+
+  return num_young + num_old + num_attribs;
+}
+
+/**
+ * Collects the young generation in the nth stripe of the cache.  Each young
+ * state that is no longer referenced outside the cache is deleted; each one
+ * that has survived enough of these passes is promoted to the old generation.
+ * Returns the number of states deleted.  Sets out_of_time if the deadline
+ * passed before the whole list was examined.
+ *
+ * You must already be holding all stripes of _states_lock before you call
+ * this method.
+ */
+int RenderState::
+garbage_collect_young(size_t n, double deadline, bool &out_of_time) {
+  YoungStates &young = _young_states[n];
+  int max_age = std::max((int)garbage_collect_states_young_age, 1);
+  bool break_and_uniquify = (auto_break_cycles && uniquify_transforms);
+
+  int num_deleted = 0;
+  size_t num_visited = 0;
+  size_t i = 0;
+  while (i < young.size()) {
+    // Checking the clock isn't free, so we only do it every so often.
+    if ((++num_visited & 31) == 0 && is_past_deadline(deadline)) {
+      out_of_time = true;
+      break;
+    }
+
+    RenderState *state = (RenderState *)young[i]._state;
     if (break_and_uniquify) {
       if (state->get_cache_ref_count() > 0 &&
           state->get_ref_count() == state->get_cache_ref_count()) {
-        // If we have removed all the references to this state not in the
-        // cache, leaving only references in the cache, then we need to
-        // check for a cycle involving this RenderState and break it if it
-        // exists.
         state->detect_and_break_cycles();
       }
     }
 
     if (!state->unref_if_one()) {
-      // This state has recently been unreffed to 1 (the one we added when
-      // we stored it in the cache).  Now it's time to delete it.  This is
-      // safe, because we're holding the _states_lock, so it's not possible
-      // for some other thread to find the state in the cache and ref it
-      // while we're doing this.  Also, we've just made sure to unref it to 0,
-      // to ensure that another thread can't get it via a weak pointer.
-
+      // No one else is using this state; delete it, as in
+      // garbage_collect_old().  This also removes it from the young list, so
+      // the current index now contains one we still need to visit.
       state->release_new();
       state->remove_cache_pointers();
       state->cache_unref_only();
       delete state;
+      ++num_deleted;
+
+    } else if (++young[i]._age >= max_age) {
+      // It has been around long enough; promote it to the old generation.
+      // This, too, moves another element into the current index.
+      state->release_young();
+
+    } else {
+      ++i;
+    }
+  }
+
+  return num_deleted;
+}
+
+/**
+ * Collects part of the old generation in the nth stripe of the cache, by
+ * walking through garbage-collect-states-rate of the table, continuing from
+ * where the last pass left off.  Young states are skipped.  Returns the
+ * number of states deleted.  Sets out_of_time if the deadline passed before
+ * the pass was completed.
+ *
+ * You must already be holding all stripes of _states_lock before you call
+ * this method.
+ */
+int RenderState::
+garbage_collect_old(size_t n, double deadline, bool &out_of_time) {
+  States &states = _states[n];
+  size_t orig_size = states.get_num_entries();
+
+  // How many elements to process this pass?
+  size_t size = orig_size;
+  size_t num_this_pass = std::max(0, int(size * garbage_collect_states_rate));
+  if (num_this_pass <= 0) {
+    return 0;
+  }
+
+  bool break_and_uniquify = (auto_break_cycles && uniquify_transforms);
 
-      // When we removed it from the hash map, it swapped the last element
-      // with the one we just removed.  So the current index contains one we
-      // still need to visit.
-      --size;
-      --si;
-      if (stop_at_element > 0) {
-        --stop_at_element;
+  size_t si = _garbage_index[n];
+  if (si >= size) {
+    si = 0;
+  }
+
+  num_this_pass = std::min(num_this_pass, size);
+  size_t stop_at_element = (si + num_this_pass) % size;
+  size_t num_visited = 0;
+
+  do {
+    if ((++num_visited & 31) == 0 && is_past_deadline(deadline)) {
+      out_of_time = true;
+      break;
+    }
+
+    RenderState *state = (RenderState *)states.get_key(si);
+
+    // Young states are left to garbage_collect_young().
+    if (state->_young_index == -1) {
+      if (break_and_uniquify) {
+        if (state->get_cache_ref_count() > 0 &&
+            state->get_ref_count() == state->get_cache_ref_count()) {
+          // If we have removed all the references to this state not in the
+          // cache, leaving only references in the cache, then we need to
+          // check for a cycle involving this RenderState and break it if it
+          // exists.
+          state->detect_and_break_cycles();
+        }
+      }
+
+      if (!state->unref_if_one()) {
+        // This state has recently been unreffed to 1 (the one we added when
+        // we stored it in the cache).  Now it's time to delete it.  This is
+        // safe, because we're holding the _states_lock, so it's not possible
+        // for some other thread to find the state in the cache and ref it
+        // while we're doing this.  Also, we've just made sure to unref it to
+        // 0, to ensure that another thread can't get it via a weak pointer.
+        state->release_new();
+        state->remove_cache_pointers();
+        state->cache_unref_only();
+        delete state;
+
+        // When we removed it from the hash map, it swapped the last element
+        // with the one we just removed.  So the current index contains one we
+        // still need to visit.
+        --size;
+        --si;
+        if (stop_at_element > 0) {
+          --stop_at_element;
+        }
+        if (size == 0) {
+          // Unlike the whole cache, a single stripe may become empty.
+          si = 0;
+          break;
+        }
       }
     }
 
     si = (si + 1) % size;
   } while (si != stop_at_element);
-  _garbage_index = si;
+  _garbage_index[n] = si;
 
-  nassertr(_states.get_num_entries() == size, 0);
+  nassertr(states.get_num_entries() == size, 0);
 
 #ifdef _DEBUG
-  nassertr(_states.validate(), 0);
+  nassertr(states.validate(), 0);
 #endif
 
   // If we just cleaned up a lot of states, see if we can reduce the table in
   // size.  This will help reduce iteration overhead in the future.
-  _states.consider_shrink_table();
+  states.consider_shrink_table();
 
-  return (int)orig_size - (int)size + num_attribs;
+  return (int)orig_size - (int)size;
 }
 
 /**
@@ -975,14 +1187,16 @@ garbage_collect() {
  */
 void RenderState::
 clear_munger_cache() {
-  LightReMutexHolder holder(*_states_lock);
+  StateCacheLock::Holder holder(*_states_lock);
 
-  size_t size = _states.get_num_entries();
-  for (size_t si = 0; si < size; ++si) {
-    RenderState *state = (RenderState *)(_states.get_key(si));
-    state->_mungers.clear();
-    state->_munged_states.clear();
-    state->_last_mi = -1;
+  for (size_t n = 0; n < _states_lock->get_num_stripes(); ++n) {
+    size_t size = _states[n].get_num_entries();
+    for (size_t si = 0; si < size; ++si) {
+      RenderState *state = (RenderState *)(_states[n].get_key(si));
+      state->_mungers.clear();
+      state->_munged_states.clear();
+      state->_last_mi = -1;
+    }
   }
 }
 
@@ -1001,66 +1215,68 @@ clear_munger_cache() {
  */
 void RenderState::
 list_cycles(ostream &out) {
-  LightReMutexHolder holder(*_states_lock);
+  StateCacheLock::Holder holder(*_states_lock);
 
   typedef pset<const RenderState *> VisitedStates;
   VisitedStates visited;
   CompositionCycleDesc cycle_desc;
 
-  size_t size = _states.get_num_entries();
-  for (size_t si = 0; si < size; ++si) {
-    const RenderState *state = _states.get_key(si);
-
-    bool inserted = visited.insert(state).second;
-    if (inserted) {
-      ++_last_cycle_detect;
-      if (r_detect_cycles(state, state, 1, _last_cycle_detect, &cycle_desc)) {
-        // This state begins a cycle.
-        CompositionCycleDesc::reverse_iterator csi;
-
-        out << "\nCycle detected of length " << cycle_desc.size() + 1 << ":\n"
-            << "state " << (void *)state << ":" << state->get_ref_count()
-            << " =\n";
-        state->write(out, 2);
-        for (csi = cycle_desc.rbegin(); csi != cycle_desc.rend(); ++csi) {
-          const CompositionCycleDescEntry &entry = (*csi);
-          if (entry._inverted) {
-            out << "invert composed with ";
-          } else {
-            out << "composed with ";
-          }
-          out << (const void *)entry._obj << ":" << entry._obj->get_ref_count()
-              << " " << *entry._obj << "\n"
-              << "produces " << (const void *)entry._result << ":"
-              << entry._result->get_ref_count() << " =\n";
-          entry._result->write(out, 2);
-          visited.insert(entry._result);
-        }
+  for (size_t n = 0; n < _states_lock->get_num_stripes(); ++n) {
+    size_t size = _states[n].get_num_entries();
+    for (size_t si = 0; si < size; ++si) {
+      const RenderState *state = _states[n].get_key(si);
 
-        cycle_desc.clear();
-      } else {
+      bool inserted = visited.insert(state).second;
+      if (inserted) {
         ++_last_cycle_detect;
-        if (r_detect_reverse_cycles(state, state, 1, _last_cycle_detect, &cycle_desc)) {
+        if (r_detect_cycles(state, state, 1, _last_cycle_detect, &cycle_desc)) {
           // This state begins a cycle.
-          CompositionCycleDesc::iterator csi;
+          CompositionCycleDesc::reverse_iterator csi;
 
-          out << "\nReverse cycle detected of length " << cycle_desc.size() + 1 << ":\n"
-              << "state ";
-          for (csi = cycle_desc.begin(); csi != cycle_desc.end(); ++csi) {
+          out << "\nCycle detected of length " << cycle_desc.size() + 1 << ":\n"
+              << "state " << (void *)state << ":" << state->get_ref_count()
+              << " =\n";
+          state->write(out, 2);
+          for (csi = cycle_desc.rbegin(); csi != cycle_desc.rend(); ++csi) {
             const CompositionCycleDescEntry &entry = (*csi);
-            out << (const void *)entry._result << ":"
+            if (entry._inverted) {
+              out << "invert composed with ";
+            } else {
+              out << "composed with ";
+            }
+            out << (const void *)entry._obj << ":" << entry._obj->get_ref_count()
+                << " " << *entry._obj << "\n"
+                << "produces " << (const void *)entry._result << ":"
                 << entry._result->get_ref_count() << " =\n";
             entry._result->write(out, 2);
-            out << (const void *)entry._obj << ":"
-                << entry._obj->get_ref_count() << " =\n";
-            entry._obj->write(out, 2);
             visited.insert(entry._result);
           }
-          out << (void *)state << ":"
-              << state->get_ref_count() << " =\n";
-          state->write(out, 2);
 
           cycle_desc.clear();
+        } else {
+          ++_last_cycle_detect;
+          if (r_detect_reverse_cycles(state, state, 1, _last_cycle_detect, &cycle_desc)) {
+            // This state begins a cycle.
+            CompositionCycleDesc::iterator csi;
+
+            out << "\nReverse cycle detected of length " << cycle_desc.size() + 1 << ":\n"
+                << "state ";
+            for (csi = cycle_desc.begin(); csi != cycle_desc.end(); ++csi) {
+              const CompositionCycleDescEntry &entry = (*csi);
+              out << (const void *)entry._result << ":"
+                  << entry._result->get_ref_count() << " =\n";
+              entry._result->write(out, 2);
+              out << (const void *)entry._obj << ":"
+                  << entry._obj->get_ref_count() << " =\n";
+              entry._obj->write(out, 2);
+              visited.insert(entry._result);
+            }
+            out << (void *)state << ":"
+                << state->get_ref_count() << " =\n";
+            state->write(out, 2);
+
+            cycle_desc.clear();
+          }
         }
       }
     }
@@ -1075,13 +1291,15 @@ list_cycles(ostream &out) {
  */
 void RenderState::
 list_states(ostream &out) {
-  LightReMutexHolder holder(*_states_lock);
+  StateCacheLock::Holder holder(*_states_lock);
 
-  size_t size = _states.get_num_entries();
-  out << size << " states:\n";
-  for (size_t si = 0; si < size; ++si) {
-    const RenderState *state = _states.get_key(si);
-    state->write(out, 2);
+  out << get_num_states() << " states:\n";
+  for (size_t n = 0; n < _states_lock->get_num_stripes(); ++n) {
+    size_t size = _states[n].get_num_entries();
+    for (size_t si = 0; si < size; ++si) {
+      const RenderState *state = _states[n].get_key(si);
+      state->write(out, 2);
+    }
   }
 }
 
@@ -1095,44 +1313,49 @@ bool RenderState::
 validate_states() {
   PStatTimer timer(_state_validate_pcollector);
 
-  LightReMutexHolder holder(*_states_lock);
-  if (_states.is_empty()) {
-    return true;
-  }
+  StateCacheLock::Holder holder(*_states_lock);
+  for (size_t n = 0; n < _states_lock->get_num_stripes(); ++n) {
+    const States &states = _states[n];
+    if (states.is_empty()) {
+      continue;
+    }
 
-  if (!_states.validate()) {
-    pgraph_cat.error()
-      << "RenderState::_states cache is invalid!\n";
-    return false;
-  }
-
-  size_t size = _states.get_num_entries();
-  size_t si = 0;
-  nassertr(si < size, false);
-  nassertr(_states.get_key(si)->get_ref_count() >= 0, false);
-  size_t snext = si;
-  ++snext;
-  while (snext < size) {
-    nassertr(_states.get_key(snext)->get_ref_count() >= 0, false);
-    const RenderState *ssi = _states.get_key(si);
-    const RenderState *ssnext = _states.get_key(snext);
-    int c = ssi->compare_to(*ssnext);
-    int ci = ssnext->compare_to(*ssi);
-    if ((ci < 0) != (c > 0) ||
-        (ci > 0) != (c < 0) ||
-        (ci == 0) != (c == 0)) {
+    if (!states.validate()) {
       pgraph_cat.error()
-        << "RenderState::compare_to() not defined properly!\n";
-      pgraph_cat.error(false)
-        << "(a, b): " << c << "\n";
-      pgraph_cat.error(false)
-        << "(b, a): " << ci << "\n";
-      ssi->write(pgraph_cat.error(false), 2);
-      ssnext->write(pgraph_cat.error(false), 2);
+        << "RenderState::_states cache is invalid!\n";
       return false;
     }
-    si = snext;
+
+    size_t size = states.get_num_entries();
+    size_t si = 0;
+    nassertr(si < size, false);
+    nassertr(states.get_key(si)->get_ref_count() >= 0, false);
+    nassertr(states.get_key(si)->get_states_stripe() == n, false);
+    size_t snext = si;
     ++snext;
+    while (snext < size) {
+      nassertr(states.get_key(snext)->get_ref_count() >= 0, false);
+      nassertr(states.get_key(snext)->get_states_stripe() == n, false);
+      const RenderState *ssi = states.get_key(si);
+      const RenderState *ssnext = states.get_key(snext);
+      int c = ssi->compare_to(*ssnext);
+      int ci = ssnext->compare_to(*ssi);
+      if ((ci < 0) != (c > 0) ||
+          (ci > 0) != (c < 0) ||
+          (ci == 0) != (c == 0)) {
+        pgraph_cat.error()
+          << "RenderState::compare_to() not defined properly!\n";
+        pgraph_cat.error(false)
+          << "(a, b): " << c << "\n";
+        pgraph_cat.error(false)
+          << "(b, a): " << ci << "\n";
+        ssi->write(pgraph_cat.error(false), 2);
+        ssnext->write(pgraph_cat.error(false), 2);
+        return false;
+      }
+      si = snext;
+      ++snext;
+    }
   }
 
   return true;
@@ -1282,17 +1505,11 @@ return_unique(RenderState *state) {
   }
 #endif
 
-  LightReMutexHolder holder(*_states_lock);
-
-  if (state->_saved_entry != -1) {
-    // This state is already in the cache.  nassertr(_states.find(state) ==
-    // state->_saved_entry, pt_state);
-    return state;
-  }
-
   // Ensure each of the individual attrib pointers has been uniquified before
-  // we add the state to the cache.
-  if (!uniquify_attribs && !state->is_empty()) {
+  // we add the state to the cache.  This has to happen before we choose the
+  // stripe, since it may change the hash.  A state that isn't in the cache
+  // yet isn't shared with any other thread, so we don't need the lock.
+  if (state->_saved_entry == -1 && !uniquify_attribs && !state->is_empty()) {
     SlotMask mask = state->_filled_slots;
     int slot = mask.get_lowest_on_bit();
     while (slot >= 0) {
@@ -1304,7 +1521,17 @@ return_unique(RenderState *state) {
     }
   }
 
-  int si = _states.find(state);
+  // We only need to hold the stripe that this state would be stored in.
+  size_t n = state->get_states_stripe();
+  StateCacheLock::StripeHolder holder(*_states_lock, n);
+
+  if (state->_saved_entry != -1) {
+    // This state is already in the cache.  nassertr(_states.find(state) ==
+    // state->_saved_entry, pt_state);
+    return state;
+  }
+
+  int si = _states[n].find(state);
   if (si != -1) {
     // There's an equivalent state already in the set.  Return it.  The state
     // that was passed may be newly created and therefore may not be
@@ -1312,7 +1539,7 @@ return_unique(RenderState *state) {
     if (state->get_ref_count() == 0) {
       delete state;
     }
-    return _states.get_key(si);
+    return _states[n].get_key(si);
   }
 
   // Not already in the set; add it.
@@ -1321,8 +1548,12 @@ return_unique(RenderState *state) {
     // reference count when we store it in the cache, so that it won't be
     // deleted while it's in it.
     state->cache_ref();
+
+    // It starts out in the young generation.
+    state->_young_index = (int)_young_states[n].size();
+    _young_states[n].push_back({state, 0});
   }
-  si = _states.store(state, nullptr);
+  si = _states[n].store(state, nullptr);
 
   // Save the index and return the input state.
   state->_saved_entry = si;
@@ -1590,15 +1821,43 @@ r_detect_reverse_cycles(const RenderState *start_state,
  * This inverse of return_new, this releases this object from the global
  * RenderState table.
  *
- * You must already be holding _states_lock before you call this method.
+ * You must already be holding all stripes of _states_lock before you call
+ * this method.
  */
 void RenderState::
 release_new() {
-  nassertv(_states_lock->debug_is_locked());
+  nassertv(_states_lock->debug_is_all_locked());
 
   if (_saved_entry != -1) {
     _saved_entry = -1;
-    nassertv_always(_states.remove(this));
+    nassertv_always(_states[get_states_stripe()].remove(this));
+    release_young();
+  }
+}
+
+/**
+ * Removes this object from the young generation list, if it is on it.  This
+ * happens either when it is released from the global table, or when it has
+ * survived long enough to be promoted to the old generation.
+ *
+ * You must already be holding all stripes of _states_lock before you call
+ * this method.
+ */
+void RenderState::
+release_young() {
+  if (_young_index != -1) {
+    YoungStates &young = _young_states[get_states_stripe()];
+    nassertv((size_t)_young_index < young.size() &&
+             young[_young_index]._state == this);
+
+    // Move the last element into our slot.
+    size_t last = young.size() - 1;
+    if ((size_t)_young_index != last) {
+      young[_young_index] = young[last];
+      ((RenderState *)young[_young_index]._state)->_young_index = _young_index;
+    }
+    young.pop_back();
+    _young_index = -1;
   }
 }
 
@@ -1607,11 +1866,12 @@ release_new() {
  * RenderState.  The pointers to this object may be scattered around in the
  * various CompositionCaches from other RenderState objects.
  *
- * You must already be holding _states_lock before you call this method.
+ * You must already be holding all stripes of _states_lock before you call
+ * this method.
  */
 void RenderState::
 remove_cache_pointers() {
-  nassertv(_states_lock->debug_is_locked());
+  nassertv(_states_lock->debug_is_all_locked());
 
   // Fortunately, since we added CompositionCache records in pairs, we know
   // exactly the set of RenderState objects that have us in their cache: it's
@@ -1839,7 +2099,11 @@ init_states() {
   // _states_lock without a startup race condition.  For the meantime, this is
   // OK because we guarantee that this method is called at static init time,
   // presumably when there is still only one thread in the world.
-  _states_lock = new LightReMutex("RenderState::_states_lock");
+  _states_lock = new StateCacheLock("RenderState::_states_lock",
+                                    StateCacheLock::get_default_num_stripes());
+  _states = new States[_states_lock->get_num_stripes()];
+  _garbage_index = new size_t[_states_lock->get_num_stripes()]();
+  _young_states = new YoungStates[_states_lock->get_num_stripes()];
   _cache_stats.init();
   nassertv(Thread::get_current_thread() == Thread::get_main_thread());
 
@@ -1847,7 +2111,7 @@ init_states() {
   // is declared globally, and lives forever.
   RenderState *state = new RenderState;
   state->local_object();
-  state->_saved_entry = _states.store(state, nullptr);
+  state->_saved_entry = _states[state->get_states_stripe()].store(state, nullptr);
   _empty_state = state;
 }
 
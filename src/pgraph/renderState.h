@@ -31,6 +31,7 @@
 #include "deletedChain.h"
 #include "simpleHashMap.h"
 #include "cacheStats.h"
+#include "stateCacheLock.h"
 #include "renderAttribRegistry.h"
 
 class FactoryParams;
@@ -214,6 +215,14 @@ private:
   void release_new();
   void remove_cache_pointers();
 
+  INLINE size_t get_states_stripe() const;
+  INLINE size_t get_cache_stripe() const;
+
+  void release_young();
+  static int garbage_collect_young(size_t n, double deadline, bool &out_of_time);
+  static int garbage_collect_old(size_t n, double deadline, bool &out_of_time);
+  INLINE static bool is_past_deadline(double deadline);
+
   void determine_bin_index();
   void determine_cull_callback();
   void fill_default();
@@ -240,12 +249,16 @@ public:
   mutable Filename _fullpath;
 
 private:
-  // This mutex protects _states.  It also protects any modification to the
+  // This lock protects _states.  It also protects any modification to the
   // cache, which is encoded in _composition_cache and
-  // _invert_composition_cache.
-  static LightReMutex *_states_lock;
+  // _invert_composition_cache.  It is divided into stripes; each stripe
+  // protects its own part of _states, and the composition caches of the
+  // states whose pointers map to it.
+  static StateCacheLock *_states_lock;
   typedef SimpleHashMap<const RenderState *, std::nullptr_t, indirect_compare_to_hash<const RenderState *> > States;
-  static States _states;
+
+  // There is one of these for each stripe of _states_lock.
+  static States *_states;
   static const RenderState *_empty_state;
 
   // This iterator records the entry corresponding to this RenderState object
@@ -253,6 +266,10 @@ private:
   // when the RenderState destructs.
   int _saved_entry;
 
+  // This is the index of this object in the young generation list for its
+  // stripe, or -1 if it is not in the young generation.
+  int _young_index;
+
   // This data structure manages the job of caching the composition of two
   // RenderStates.  It's complicated because we have to be sure to remove the
   // entry if *either* of the input RenderStates destructs.  To implement
@@ -295,11 +312,30 @@ private:
   static UpdateSeq _last_cycle_detect;
 
   // This keeps track of our current position through the garbage collection
-  // cycle.
-  static size_t _garbage_index;
+  // cycle, for each stripe of _states.
+  static size_t *_garbage_index;
+
+  // The states that have recently been added to _states make up the young
+  // generation, which is collected on every garbage collection step.  There
+  // is one of these lists for each stripe of _states.
+  class YoungState {
+  public:
+    const RenderState *_state;
+    int _age;
+  };
+  typedef pvector<YoungState> YoungStates;
+  static YoungStates *_young_states;
+  static size_t _young_gc_stripe;
+
+  // The rest of _states is scanned only every few steps.  These keep track of
+  // when the next scan is due and how far along it is.
+  static int _old_gc_countdown;
+  static size_t _old_gc_stripe;
 
   static PStatCollector _cache_update_pcollector;
   static PStatCollector _garbage_collect_pcollector;
+  static PStatCollector _garbage_collect_young_pcollector;
+  static PStatCollector _garbage_collect_old_pcollector;
   static PStatCollector _state_compose_pcollector;
   static PStatCollector _state_invert_pcollector;
   static PStatCollector _state_break_cycles_pcollector;
@@ -307,6 +343,11 @@ private:
 
   static PStatCollector _node_counter;
   static PStatCollector _cache_counter;
+  static PStatCollector _lock_acquire_counter;
+  static PStatCollector _lock_contended_counter;
+  static PStatCollector _young_counter;
+  static PStatCollector _young_reclaimed_counter;
+  static PStatCollector _old_reclaimed_counter;
 
 private:
   // This is the actual data within the RenderState: a set of max_slots
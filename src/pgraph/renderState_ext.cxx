@@ -29,7 +29,8 @@
 PyObject *Extension<RenderState>::
 get_composition_cache() const {
   extern struct Dtool_PyTypedObject Dtool_RenderState;
-  LightReMutexHolder holder(*RenderState::_states_lock);
+  StateCacheLock::StripeHolder holder(*RenderState::_states_lock,
+                                      _this->get_cache_stripe());
   size_t cache_size = _this->_composition_cache.get_num_entries();
   PyObject *list = PyList_New(cache_size);
 
@@ -77,7 +78,8 @@ get_composition_cache() const {
 PyObject *Extension<RenderState>::
 get_invert_composition_cache() const {
   extern struct Dtool_PyTypedObject Dtool_RenderState;
-  LightReMutexHolder holder(*RenderState::_states_lock);
+  StateCacheLock::StripeHolder holder(*RenderState::_states_lock,
+                                      _this->get_cache_stripe());
   size_t cache_size = _this->_invert_composition_cache.get_num_entries();
   PyObject *list = PyList_New(cache_size);
 
@@ -118,22 +120,25 @@ get_invert_composition_cache() const {
 PyObject *Extension<RenderState>::
 get_states() {
   extern struct Dtool_PyTypedObject Dtool_RenderState;
-  LightReMutexHolder holder(*RenderState::_states_lock);
+  StateCacheLock::Holder holder(*RenderState::_states_lock);
 
-  size_t num_states = RenderState::_states.get_num_entries();
+  size_t num_stripes = RenderState::_states_lock->get_num_stripes();
+  size_t num_states = (size_t)RenderState::get_num_states();
   PyObject *list = PyList_New(num_states);
   size_t i = 0;
 
-  size_t size = RenderState::_states.get_num_entries();
-  for (size_t si = 0; si < size; ++si) {
-    const RenderState *state = RenderState::_states.get_key(si);
-    state->ref();
-    PyObject *a =
-      DTool_CreatePyInstanceTyped((void *)state, Dtool_RenderState,
-                                  true, true, state->get_type_index());
-    nassertr(i < num_states, list);
-    PyList_SET_ITEM(list, i, a);
-    ++i;
+  for (size_t n = 0; n < num_stripes; ++n) {
+    size_t size = RenderState::_states[n].get_num_entries();
+    for (size_t si = 0; si < size; ++si) {
+      const RenderState *state = RenderState::_states[n].get_key(si);
+      state->ref();
+      PyObject *a =
+        DTool_CreatePyInstanceTyped((void *)state, Dtool_RenderState,
+                                    true, true, state->get_type_index());
+      nassertr(i < num_states, list);
+      PyList_SET_ITEM(list, i, a);
+      ++i;
+    }
   }
   nassertr(i == num_states, list);
   return list;
@@ -0,0 +1,129 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file stateCacheLock.cxx
+ * @author lachbr
+ * @date 2026-10-18
+ */
+
+#include "stateCacheLock.h"
+#include "configVariableInt.h"
+
+/**
+ * Creates a lock with the indicated number of stripes, which is rounded up to
+ * the next power of two.
+ */
+StateCacheLock::
+StateCacheLock(const std::string &name, size_t num_stripes) {
+  _num_stripes = 1;
+  while (_num_stripes < num_stripes) {
+    _num_stripes <<= 1;
+  }
+  _stripe_mask = _num_stripes - 1;
+
+  _stripes = new Stripe[_num_stripes];
+  for (size_t n = 0; n < _num_stripes; ++n) {
+    _stripes[n]._mutex.set_name(name);
+    _stripes[n]._num_acquires = 0;
+    _stripes[n]._num_contended = 0;
+  }
+}
+
+/**
+ *
+ */
+StateCacheLock::
+~StateCacheLock() {
+  delete[] _stripes;
+}
+
+/**
+ * Acquires all of the stripes, in order.
+ */
+void StateCacheLock::
+acquire_all() const {
+  for (size_t n = 0; n < _num_stripes; ++n) {
+    acquire(n);
+  }
+}
+
+/**
+ * Releases all of the stripes acquired by acquire_all().
+ */
+void StateCacheLock::
+release_all() const {
+  size_t n = _num_stripes;
+  while (n > 0) {
+    --n;
+    release(n);
+  }
+}
+
+/**
+ * Returns true if the current thread holds all of the stripes.  Only
+ * meaningful in a debug build.
+ */
+bool StateCacheLock::
+debug_is_all_locked() const {
+  for (size_t n = 0; n < _num_stripes; ++n) {
+    if (!_stripes[n]._mutex.debug_is_locked()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * Reports the number of times the stripes were acquired, and the number of
+ * times a thread had to wait for another thread to release a stripe, since
+ * the last call to flush_level().  This should be called once per frame.
+ */
+void StateCacheLock::
+flush_level(PStatCollector &acquire_pcollector,
+            PStatCollector &contended_pcollector) const {
+#ifdef DO_PSTATS
+  if (!acquire_pcollector.is_active() && !contended_pcollector.is_active()) {
+    return;
+  }
+
+  int num_acquires = 0;
+  int num_contended = 0;
+  for (size_t n = 0; n < _num_stripes; ++n) {
+    Stripe &stripe = _stripes[n];
+    stripe._mutex.acquire();
+    num_acquires += stripe._num_acquires;
+    num_contended += stripe._num_contended;
+    stripe._num_acquires = 0;
+    stripe._num_contended = 0;
+    stripe._mutex.release();
+  }
+
+  acquire_pcollector.set_level(num_acquires);
+  contended_pcollector.set_level(num_contended);
+#endif  // DO_PSTATS
+}
+
+/**
+ * Returns the number of stripes that the state caches should be divided into,
+ * as configured by state-cache-num-stripes.
+ */
+size_t StateCacheLock::
+get_default_num_stripes() {
+  // This is declared here rather than in config_pgraph.cxx because the state
+  // caches may be initialized at static init time.
+  static ConfigVariableInt state_cache_num_stripes
+  ("state-cache-num-stripes", 16,
+   PRC_DESC("The number of independently-locked stripes that the "
+            "TransformState and RenderState caches are divided into.  More "
+            "stripes reduce lock contention when several threads compose "
+            "states at once.  If garbage-collect-states is false, every "
+            "unref of a state must lock the whole cache, so it is better to "
+            "set this to 1 in that case."));
+
+  return (size_t)std::max((int)state_cache_num_stripes, 1);
+}
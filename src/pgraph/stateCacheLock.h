@@ -0,0 +1,118 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file stateCacheLock.h
+ * @author lachbr
+ * @date 2026-10-18
+ */
+
+#ifndef STATECACHELOCK_H
+#define STATECACHELOCK_H
+
+#include "pandabase.h"
+#include "lightReMutex.h"
+#include "pStatCollector.h"
+
+/**
+ * This is the lock that protects one of the global state caches, such as the
+ * TransformState or RenderState cache.  Rather than a single mutex, it is
+ * divided into a number of stripes, each with its own mutex, so that threads
+ * working on unrelated states don't contend with each other.
+ *
+ * Each entry in the global table of unique states is protected by the stripe
+ * chosen by its hash, and each state's composition cache is protected by the
+ * stripe chosen by its pointer.  Operations that walk the whole cache, such as
+ * garbage collection, must hold all of the stripes at once.  Stripes are
+ * always acquired in ascending order to avoid deadlock.
+ */
+class EXPCL_PANDA_PGRAPH StateCacheLock {
+public:
+  StateCacheLock(const std::string &name, size_t num_stripes);
+  StateCacheLock(const StateCacheLock &copy) = delete;
+  ~StateCacheLock();
+
+  StateCacheLock &operator = (const StateCacheLock &copy) = delete;
+
+  INLINE size_t get_num_stripes() const;
+  INLINE size_t get_hash_stripe(size_t hash) const;
+  INLINE size_t get_pointer_stripe(const void *ptr) const;
+
+  INLINE void acquire(size_t n) const;
+  INLINE void release(size_t n) const;
+  void acquire_all() const;
+  void release_all() const;
+
+  INLINE bool debug_is_locked(size_t n) const;
+  bool debug_is_all_locked() const;
+
+  void flush_level(PStatCollector &acquire_pcollector,
+                   PStatCollector &contended_pcollector) const;
+
+  static size_t get_default_num_stripes();
+
+  /**
+   * Holds one stripe of the lock for the lifetime of the object.
+   */
+  class StripeHolder {
+  public:
+    INLINE StripeHolder(const StateCacheLock &lock, size_t n);
+    StripeHolder(const StripeHolder &copy) = delete;
+    INLINE ~StripeHolder();
+
+  private:
+    const StateCacheLock &_lock;
+    size_t _n;
+  };
+
+  /**
+   * Holds two stripes of the lock, acquired in the correct order, for the
+   * lifetime of the object.  The two stripes may be the same.
+   */
+  class PairHolder {
+  public:
+    INLINE PairHolder(const StateCacheLock &lock, size_t a, size_t b);
+    PairHolder(const PairHolder &copy) = delete;
+    INLINE ~PairHolder();
+
+  private:
+    const StateCacheLock &_lock;
+    size_t _a, _b;
+  };
+
+  /**
+   * Holds all stripes of the lock for the lifetime of the object.
+   */
+  class Holder {
+  public:
+    INLINE Holder(const StateCacheLock &lock);
+    Holder(const Holder &copy) = delete;
+    INLINE ~Holder();
+
+  private:
+    const StateCacheLock &_lock;
+  };
+
+private:
+  class Stripe {
+  public:
+    LightReMutex _mutex;
+
+    // These are only modified while the mutex is held, and are reported to
+    // PStats by flush_level().
+    int _num_acquires;
+    int _num_contended;
+  };
+
+  Stripe *_stripes;
+  size_t _num_stripes;
+  size_t _stripe_mask;
+};
+
+#include "stateCacheLock.I"
+
+#endif
@@ -369,9 +369,10 @@ compute_child(CullTraverser *trav, CullTraverserData &data) {
     // Can't really do much with instancing in FadeLODNode; let's instead
     // just calculate the centroid of the visible instances.
     center = LPoint3(0);
-    for (const InstanceList::Instance &instance : *data._instances) {
-      center += cdata->_center *
-        rel_transform->compose(instance.get_transform())->get_mat();
+    size_t num_instances = data._instances->size();
+    for (size_t ii = 0; ii < num_instances; ++ii) {
+      center += cdata->_center * data._instances->get_matrix(ii) *
+        rel_transform->get_mat();
     }
     center *= 1.0 / data._instances->size();
   }
@@ -98,6 +98,37 @@ const float to_linear_float_table[256] = { 0, 0.000304f, 0.000607f, 0.000911f,
   0.887923f, 0.896269f, 0.904661f, 0.913099f, 0.921582f, 0.930111f, 0.938686f,
   0.947307f, 0.955973f, 0.964686f, 0.973445f, 0.982251f, 0.991102f, 1.000000f};
 
+/**
+ * Decodes an array of sRGB-encoded unsigned char values to linearized floats
+ * in the range 0-1.
+ */
+void
+decode_sRGB_float(const unsigned char *from, float *into, size_t count) {
+  const unsigned char *end = from + count;
+  while (from < end) {
+    *into++ = to_linear_float_table[*from++];
+  }
+}
+
+/**
+ * Encodes an array of linearized floating-point values in the range 0-1 to
+ * sRGB-encoded unsigned char values.  Inputs outside this range are clamped.
+ *
+ * As with the single-value version, this automatically uses the SSE2 version
+ * when SSE2 support is known at compile time.
+ */
+void
+encode_sRGB_uchar(const float *from, unsigned char *into, size_t count) {
+#if defined(__SSE2__) || (_M_IX86_FP >= 2) || defined(_M_X64) || defined(_M_AMD64)
+  encode_sRGB_uchar_sse2(from, into, count);
+#else
+  const float *end = from + count;
+  while (from < end) {
+    *into++ = encode_sRGB_uchar(*from++);
+  }
+#endif
+}
+
 
 #if defined(__SSE2__) || (_M_IX86_FP >= 2) || defined(_M_X64) || defined(_M_AMD64)
 // SSE2 support enabled at compile time.  No runtime detection mechanism
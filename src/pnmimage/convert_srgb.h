@@ -47,6 +47,13 @@ INLINE void encode_sRGB_uchar(const LColorf &from, xel &into, xelval &into_alpha
 INLINE void encode_sRGB_uchar(const LColord &from, xel &into);
 INLINE void encode_sRGB_uchar(const LColord &from, xel &into, xelval &into_alpha);
 
+// These convert a whole array of components at once.  They are used by the
+// image filters, which work on a row of an image at a time.
+EXPCL_PANDA_PNMIMAGE void decode_sRGB_float(const unsigned char *from,
+                                            float *into, size_t count);
+EXPCL_PANDA_PNMIMAGE void encode_sRGB_uchar(const float *from,
+                                            unsigned char *into, size_t count);
+
 // Use these functions if you know that SSE2 support is available.  Otherwise,
 // they will crash!
 #if defined(__SSE2__) || defined(__i386__) || defined(_M_IX86) || defined(_M_X64) || defined(_M_AMD64)
@@ -55,6 +62,9 @@ EXPCL_PANDA_PNMIMAGE void encode_sRGB_uchar_sse2(const LColorf &from,
                                                  xel &into);
 EXPCL_PANDA_PNMIMAGE void encode_sRGB_uchar_sse2(const LColorf &from,
                                                  xel &into, xelval &into_alpha);
+EXPCL_PANDA_PNMIMAGE void encode_sRGB_uchar_sse2(const float *from,
+                                                 unsigned char *into,
+                                                 size_t count);
 
 // Use the following to find out if you can call either of the above.
 EXPCL_PANDA_PNMIMAGE bool has_sse2_sRGB_encode();
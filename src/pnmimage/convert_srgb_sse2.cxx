@@ -17,17 +17,21 @@
 #include "convert_srgb.h"
 #include "luse.h"
 
+#include <string.h>
+
 #if defined(__SSE2__) || (_M_IX86_FP >= 2) || defined(_M_X64) || defined(_M_AMD64)
 
 #include <xmmintrin.h>
 #include <emmintrin.h>
 
-static INLINE __m128i _encode_sRGB_sse2_mul255(__m128 val) {
+static INLINE __m128i _encode_sRGB_sse2_mul255(__m128 val,
+                                                __m128 linear_factor,
+                                                __m128 linear_threshold) {
   // This an SSE2-based approximation of the sRGB encode function.  It has a
   // maximum error of around 0.001, which is by far small enough for a uchar.
   // It is also at least 10x as fast as the original; up to 40x when taking
-  // advantage of vectorization.  Note that the fourth float is only
-  // multiplied with 255.
+  // advantage of vectorization.  Values below the threshold are only
+  // multiplied by the linear factor.
 
   // Part of the code in this function is derived from:
   // http:stackoverflow.coma64866302135754
@@ -68,18 +72,13 @@ static INLINE __m128i _encode_sRGB_sse2_mul255(__m128 val) {
   xavg = _mm_mul_ps(xavg, _mm_set1_ps(269.122f));
   xavg = _mm_sub_ps(xavg, _mm_set1_ps(13.55f));
 
-  // Compute the linear section.  This is also the path that the alpha channel
-  // takes, so we set the alpha multiplier to 255 (since alpha is not sRGB-
-  // converted).
-  __m128 lval = _mm_mul_ps(val,
-    _mm_set_ps(255.0f, 3294.6f, 3294.6f, 3294.6f));
+  // Compute the linear section.
+  __m128 lval = _mm_mul_ps(val, linear_factor);
 
   lval = _mm_add_ps(lval, _mm_set1_ps(0.5f));
 
-  // Decide which version to return.  Rig the alpha comparator to always fail
-  // so that the linear path is always chosen for alpha.
-  __m128 mask = _mm_cmpge_ps(val,
-    _mm_set_ps(2.0f, 0.0031308f, 0.0031308f, 0.0031308f));
+  // Decide which version to return.
+  __m128 mask = _mm_cmpge_ps(val, linear_threshold);
 
   // This is a non-branching way to return one or the other value.
   return _mm_cvttps_epi32(_mm_or_ps(
@@ -87,6 +86,15 @@ static INLINE __m128i _encode_sRGB_sse2_mul255(__m128 val) {
     _mm_andnot_ps(mask, lval)));
 }
 
+static INLINE __m128i _encode_sRGB_sse2_mul255(__m128 val) {
+  // The alpha channel takes the linear path, so we set the alpha multiplier
+  // to 255 (since alpha is not sRGB-converted), and rig the alpha comparator
+  // to always fail.
+  return _encode_sRGB_sse2_mul255(val,
+    _mm_set_ps(255.0f, 3294.6f, 3294.6f, 3294.6f),
+    _mm_set_ps(2.0f, 0.0031308f, 0.0031308f, 0.0031308f));
+}
+
 unsigned char
 encode_sRGB_uchar_sse2(float val) {
   // Running only a single component through this function is still way faster
@@ -124,6 +132,30 @@ encode_sRGB_uchar_sse2(const LColorf &color, xel &into, xelval &into_alpha) {
   into_alpha = _mm_extract_epi16(vals, 6);
 }
 
+void
+encode_sRGB_uchar_sse2(const float *from, unsigned char *into, size_t count) {
+  // Here all four floats are color components, so none of them take the
+  // alpha path.
+  const __m128 linear_factor = _mm_set1_ps(3294.6f);
+  const __m128 linear_threshold = _mm_set1_ps(0.0031308f);
+
+  size_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    __m128i vals = _encode_sRGB_sse2_mul255(_mm_loadu_ps(from + i),
+                                            linear_factor, linear_threshold);
+
+    // The values are already in the range 0-255, so packing them down
+    // doesn't saturate anything.
+    vals = _mm_packs_epi32(vals, vals);
+    vals = _mm_packus_epi16(vals, vals);
+    int packed = _mm_cvtsi128_si32(vals);
+    memcpy(into + i, &packed, 4);
+  }
+  for (; i < count; ++i) {
+    into[i] = encode_sRGB_uchar_sse2(from[i]);
+  }
+}
+
 #elif defined(__i386__) || defined(_M_IX86)
 // Somehow we're still compiling this without SSE2 support, even though the
 // target architecture could (in theory) support SSE2.  We still have to
@@ -146,4 +178,9 @@ encode_sRGB_uchar_sse2(const LColorf &color, xel &into, xelval &into_alpha) {
   encode_sRGB_uchar(color, into, into_alpha);
 }
 
+void
+encode_sRGB_uchar_sse2(const float *from, unsigned char *into, size_t count) {
+  encode_sRGB_uchar(from, into, count);
+}
+
 #endif
@@ -47,15 +47,16 @@ FUNCTION_NAME(IMAGETYPE &dest, const IMAGETYPE &source,
 
   make_filter(scale, width, filter, filter_width, actual_width);
 
+  RowKernel kernel;
+  make_row_kernel(kernel, dest.ASIZE(), source.ASIZE(), scale,
+                  filter, filter_width, actual_width);
+
   for (b = 0; b < source.BSIZE(); b++) {
     for (a = 0; a < source.ASIZE(); a++) {
       temp_source[a] = (StoreType)(source_max * source.GETVAL(a, b, channel));
     }
 
-    filter_row(temp_dest, dest.ASIZE(),
-               temp_source, source.ASIZE(),
-               scale,
-               filter, filter_width, actual_width);
+    filter_row(temp_dest, temp_source, kernel);
 
     for (a = 0; a < dest.ASIZE(); a++) {
       matrix[a][b] = temp_dest[a];
@@ -71,12 +72,11 @@ FUNCTION_NAME(IMAGETYPE &dest, const IMAGETYPE &source,
   temp_dest = (StoreType *)PANDA_MALLOC_ARRAY(dest.BSIZE() * sizeof(StoreType));
 
   make_filter(scale, width, filter, filter_width, actual_width);
+  make_row_kernel(kernel, dest.BSIZE(), source.BSIZE(), scale,
+                  filter, filter_width, actual_width);
 
   for (a = 0; a < dest.ASIZE(); a++) {
-    filter_row(temp_dest, dest.BSIZE(),
-               matrix[a], source.BSIZE(),
-               scale,
-               filter, filter_width, actual_width);
+    filter_row(temp_dest, matrix[a], kernel);
 
     for (b = 0; b < dest.BSIZE(); b++) {
       dest.SETVAL(a, b, channel, (float)temp_dest[b]/(float)source_max);
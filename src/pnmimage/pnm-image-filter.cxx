@@ -31,11 +31,18 @@
 
 #include "pandabase.h"
 #include <math.h>
+#include <algorithm>
 #include "cmath.h"
 #include "thread.h"
 
 #include "pnmImage.h"
 #include "pfmFile.h"
+#include "pvector.h"
+
+#if defined(__SSE2__) || (_M_IX86_FP >= 2) || defined(_M_X64) || defined(_M_AMD64)
+#include <xmmintrin.h>
+#include <emmintrin.h>
+#endif
 
 using std::max;
 using std::min;
@@ -105,13 +112,29 @@ static const WorkType filter_max = 255;
 // the radius of interest of the filter function.  The array may need to be
 // larger (by a factor of scale), to adequately cover all the values.
 
+// The weights that are applied to produce each destination value depend only
+// on the lengths of the rows and on the filter, not on the image data.  So
+// that we don't have to look them up again for every row of the image, they
+// are gathered up front into a RowKernel by make_row_kernel(), and each row is
+// then filtered with a simple dot product, which can be vectorized.
+
+class RowKernel {
+public:
+  // For each destination value, the first source value that contributes to
+  // it, and the position of its weights in _weights.
+  pvector<int> _left;
+  pvector<int> _count;
+  pvector<size_t> _offset;
+  pvector<WorkType> _net_weight;
+  pvector<WorkType> _weights;
+};
+
 static void
-filter_row(StoreType dest[], int dest_len,
-           const StoreType source[], int source_len,
-           float scale,                    //  == dest_len / source_len
-           const WorkType filter[],
-           float filter_width,
-           int actual_width) {
+make_row_kernel(RowKernel &kernel, int dest_len, int source_len,
+                float scale,                    //  == dest_len / source_len
+                const WorkType filter[],
+                float filter_width,
+                int actual_width) {
   // If we are expanding the row (scale > 1.0), we need to look at a
   // fractional granularity.  Hence, we scale our filter index by scale.  If
   // we are compressing (scale < 1.0), we don't need to fiddle with the filter
@@ -125,6 +148,12 @@ filter_row(StoreType dest[], int dest_len,
     iscale = scale;
   }
 
+  kernel._left.resize(dest_len);
+  kernel._count.resize(dest_len);
+  kernel._offset.resize(dest_len);
+  kernel._net_weight.resize(dest_len);
+  kernel._weights.clear();
+
   for (int dest_x = 0; dest_x < dest_len; dest_x++) {
     // The additional offset of 0.5 keeps the pixel centered.
     float center = (dest_x + 0.5f) / scale - 0.5f;
@@ -139,9 +168,11 @@ filter_row(StoreType dest[], int dest_len,
     // us to flip the sign of the offset when we cross the center point.
     int right_center = (int)cceil(center);
 
-    WorkType net_weight = 0;
-    WorkType net_value = 0;
+    kernel._left[dest_x] = left;
+    kernel._count[dest_x] = max(right - left + 1, 0);
+    kernel._offset[dest_x] = kernel._weights.size();
 
+    WorkType net_weight = 0;
     int index, source_x;
 
     // This loop is broken into two pieces--the left of center and the right
@@ -150,18 +181,66 @@ filter_row(StoreType dest[], int dest_len,
     for (source_x = left; source_x < right_center; source_x++) {
       index = (int)cfloor(iscale * (center - source_x) + 0.5f);
       nassertv(index >= 0 && index < actual_width);
-      net_value += filter[index] * source[source_x];
+      kernel._weights.push_back(filter[index]);
       net_weight += filter[index];
     }
 
     for (; source_x <= right; source_x++) {
       index = (int)cfloor(iscale * (source_x - center) + 0.5f);
       nassertv(index >= 0 && index < actual_width);
-      net_value += filter[index] * source[source_x];
+      kernel._weights.push_back(filter[index]);
       net_weight += filter[index];
     }
 
+    kernel._net_weight[dest_x] = net_weight;
+  }
+}
+
+// Returns the sum of the products of the corresponding values of the two
+// arrays.  The float version is vectorized where SSE2 is known to be
+// available.
+template<class Type>
+static INLINE WorkType
+dot_row(const WorkType weights[], const Type source[], int count) {
+  WorkType net_value = 0;
+  for (int i = 0; i < count; ++i) {
+    net_value += weights[i] * source[i];
+  }
+  return net_value;
+}
+
+#if defined(__SSE2__) || (_M_IX86_FP >= 2) || defined(_M_X64) || defined(_M_AMD64)
+static INLINE float
+dot_row(const float weights[], const float source[], int count) {
+  __m128 sum = _mm_setzero_ps();
+  int i = 0;
+  for (; i + 4 <= count; i += 4) {
+    sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(weights + i),
+                                     _mm_loadu_ps(source + i)));
+  }
+
+  // Add the four lanes together.
+  sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+  sum = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, 1));
+  float net_value = _mm_cvtss_f32(sum);
+
+  for (; i < count; ++i) {
+    net_value += weights[i] * source[i];
+  }
+  return net_value;
+}
+#endif
+
+static void
+filter_row(StoreType dest[], const StoreType source[],
+           const RowKernel &kernel) {
+  int dest_len = (int)kernel._left.size();
+  for (int dest_x = 0; dest_x < dest_len; dest_x++) {
+    WorkType net_weight = kernel._net_weight[dest_x];
     if (net_weight > 0) {
+      WorkType net_value =
+        dot_row(&kernel._weights[0] + kernel._offset[dest_x],
+                source + kernel._left[dest_x], kernel._count[dest_x]);
       dest[dest_x] = (StoreType)(net_value / net_weight);
     } else {
       dest[dest_x] = 0;
@@ -682,80 +761,94 @@ gaussian_filter_from(float width, const PfmFile &copy) {
   filter_image(*this, copy, width, &gaussian_filter_impl);
 }
 
-// The following functions are support for quick_box_filter().
+// The following functions are support for quick_filter_from().  The box
+// filter is separable: the contribution of each source pixel is the product
+// of its contribution along x and its contribution along y.  So rather than
+// visiting every source pixel once for each destination pixel, we first add up
+// the source rows that contribute to a destination row, and then add up the
+// pixels along that sum.
+
+// The source pixels along one axis that contribute to one destination pixel.
+// These are always consecutive; their contributions are stored in a separate
+// array.
+class BoxSpan {
+public:
+  int _first;
+  int _count;
+  size_t _offset;
+  float _net_contrib;
+};
 
-static INLINE void
-box_filter_xel(const PNMImage &img,
-               int x, int y, float x_contrib, float y_contrib,
-               LColorf &color, float &pixel_count) {
-
-  float contrib = x_contrib * y_contrib;
-  color += img.get_xel_a(x, y) * contrib;
-  pixel_count += contrib;
-}
-
-static INLINE void
-box_filter_line(const PNMImage &image,
-                float x0, int y, float x1, float y_contrib,
-                LColorf &color, float &pixel_count) {
-  int x = (int)x0;
-  // Get the first (partial) xel
-  box_filter_xel(image, x, y, (float)(x+1)-x0, y_contrib,
-                 color, pixel_count);
-
-  int x_last = (int)x1;
-  if (x < x_last) {
-    x++;
-    while (x < x_last) {
-      // Get each consecutive (complete) xel
-      box_filter_xel(image, x, y, 1.0f, y_contrib,
-                     color, pixel_count);
-      x++;
+static void
+make_box_span(BoxSpan &span, pvector<float> &contribs,
+              float v0, float v1, int size) {
+  span._offset = contribs.size();
+
+  int v = (int)v0;
+  span._first = v;
+  // Get the first (partial) value
+  contribs.push_back((float)(v+1)-v0);
+
+  int v_last = (int)v1;
+  if (v < v_last) {
+    v++;
+    while (v < v_last) {
+      // Get each consecutive (complete) value
+      contribs.push_back(1.0f);
+      v++;
     }
 
-    // Get the final (partial) xel
-    float x_contrib = x1 - (float)x_last;
-    if (x_contrib > 0.0001f && x < image.get_x_size()) {
-      box_filter_xel(image, x, y, x_contrib, y_contrib,
-                     color, pixel_count);
+    // Get the final (partial) value
+    float contrib = v1 - (float)v_last;
+    if (contrib > 0.0001f && v < size) {
+      contribs.push_back(contrib);
     }
   }
-}
 
-static LColorf
-box_filter_region(const PNMImage &image,
-                  float x0, float y0, float x1, float y1) {
-  LColorf color = LColorf::zero();
-  float pixel_count = 0.0f;
-
-  assert(y0 >= 0 && y1 >= 0);
-
-  int y = (int)y0;
-  // Get the first (partial) row
-  box_filter_line(image, x0, y, x1, (float)(y+1)-y0,
-                  color, pixel_count);
-
-  int y_last = (int)y1;
-  if (y < y_last) {
-    y++;
-    while (y < y_last) {
-      // Get each consecutive (complete) row
-      box_filter_line(image, x0, y, x1, 1.0f,
-                      color, pixel_count);
-      y++;
-    }
+  span._count = (int)(contribs.size() - span._offset);
+  span._net_contrib = 0.0f;
+  for (int i = 0; i < span._count; ++i) {
+    span._net_contrib += contribs[span._offset + i];
+  }
+}
 
-    // Get the final (partial) row
-    float y_contrib = y1 - (float)y_last;
-    if (y_contrib > 0.0001f && y < image.get_y_size()) {
-      box_filter_line(image, x0, y, x1, y_contrib,
-                      color, pixel_count);
-    }
+// Adds the values of source, scaled by contrib, to the values of dest.
+static INLINE void
+add_scaled_row(float *dest, const float *source, float contrib, int count) {
+  int i = 0;
+#if defined(__SSE2__) || (_M_IX86_FP >= 2) || defined(_M_X64) || defined(_M_AMD64)
+  __m128 scale = _mm_set1_ps(contrib);
+  for (; i + 4 <= count; i += 4) {
+    __m128 val = _mm_mul_ps(_mm_loadu_ps(source + i), scale);
+    _mm_storeu_ps(dest + i, _mm_add_ps(_mm_loadu_ps(dest + i), val));
+  }
+#endif
+  for (; i < count; ++i) {
+    dest[i] += source[i] * contrib;
   }
+}
 
-  // cerr << pixel_count << "\n";
-  color /= pixel_count;
-  return color;
+// Returns the sum of the indicated consecutive RGBA pixels, each scaled by
+// the corresponding contribution.
+static INLINE LColorf
+sum_scaled_pixels(const float *pixels, const float *contribs, int count) {
+#if defined(__SSE2__) || (_M_IX86_FP >= 2) || defined(_M_X64) || defined(_M_AMD64)
+  __m128 sum = _mm_setzero_ps();
+  for (int i = 0; i < count; ++i) {
+    sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(pixels + i * 4),
+                                     _mm_set1_ps(contribs[i])));
+  }
+  float result[4];
+  _mm_storeu_ps(result, sum);
+  return LColorf(result[0], result[1], result[2], result[3]);
+#else
+  LColorf sum = LColorf::zero();
+  for (int i = 0; i < count; ++i) {
+    sum += LColorf(pixels[i * 4], pixels[i * 4 + 1],
+                   pixels[i * 4 + 2], pixels[i * 4 + 3]) * contribs[i];
+  }
+  return sum;
+#endif
 }
 
 /**
@@ -777,36 +870,54 @@ quick_filter_from(const PNMImage &from, int xborder, int yborder) {
   int to_xoff = xborder / 2;
   int to_yoff = yborder / 2;
 
-  float from_x0, from_x1, from_y0, from_y1;
-  int to_x, to_y;
-
   float x_scale = (float)from_xs / (float)to_xs;
   float y_scale = (float)from_ys / (float)to_ys;
 
-  LColorf color;
+  int to_x_begin = max(0, -to_xoff);
+  int to_x_end = min(to_xs, get_x_size()-to_xoff);
+  int to_y_begin = max(0, -to_yoff);
+  int to_y_end = min(to_ys, get_y_size()-to_yoff);
+  if (to_x_begin >= to_x_end || to_y_begin >= to_y_end) {
+    return;
+  }
 
-  from_y0 = max(0, -to_yoff) * y_scale;
-  for (to_y = max(0, -to_yoff);
-       to_y < min(to_ys, get_y_size()-to_yoff);
-       to_y++) {
-    from_y1 = (to_y+1) * y_scale;
+  // The box from (from_x0, from_y0) - (from_x1, from_y1) but not including
+  // (from_x1, from_y1) maps to the pixel (to_x, to_y).  The spans along x are
+  // the same for every row, so we compute them once.
+  pvector<BoxSpan> x_spans(to_x_end - to_x_begin);
+  pvector<float> x_contribs;
+  for (int to_x = to_x_begin; to_x < to_x_end; to_x++) {
+    make_box_span(x_spans[to_x - to_x_begin], x_contribs,
+                  to_x * x_scale, (to_x+1) * x_scale, from_xs);
+  }
 
-    from_x0 = max(0, -to_xoff) * x_scale;
-    for (to_x = max(0, -to_xoff);
-         to_x < min(to_xs, get_x_size()-to_xoff);
-         to_x++) {
-      from_x1 = (to_x+1) * x_scale;
+  pvector<float> from_row(from_xs * 4);
+  pvector<float> row_sum(from_xs * 4);
+  pvector<float> y_contribs;
+
+  for (int to_y = to_y_begin; to_y < to_y_end; to_y++) {
+    BoxSpan y_span;
+    y_contribs.clear();
+    make_box_span(y_span, y_contribs, to_y * y_scale, (to_y+1) * y_scale,
+                  from_ys);
+
+    // Add up the rows that contribute to this row.
+    std::fill(row_sum.begin(), row_sum.end(), 0.0f);
+    for (int i = 0; i < y_span._count; ++i) {
+      from.get_xel_a_row(y_span._first + i, &from_row[0]);
+      add_scaled_row(&row_sum[0], &from_row[0], y_contribs[i], from_xs * 4);
+    }
 
-      // Now the box from (from_x0, from_y0) - (from_x1, from_y1) but not
-      // including (from_x1, from_y1) maps to the pixel (to_x, to_y).
-      color = box_filter_region(from,
-                                from_x0, from_y0, from_x1, from_y1);
+    // Now add up the pixels of that sum for each pixel of the row.
+    for (int to_x = to_x_begin; to_x < to_x_end; to_x++) {
+      const BoxSpan &x_span = x_spans[to_x - to_x_begin];
+      LColorf color =
+        sum_scaled_pixels(&row_sum[0] + x_span._first * 4,
+                          &x_contribs[0] + x_span._offset, x_span._count);
 
+      color /= x_span._net_contrib * y_span._net_contrib;
       set_xel_a(to_xoff + to_x, to_yoff + to_y, color);
-
-      from_x0 = from_x1;
     }
-    from_y0 = from_y1;
     Thread::consider_yield();
   }
 }
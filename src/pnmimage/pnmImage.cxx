@@ -21,6 +21,11 @@
 #include "stackedPerlinNoise2.h"
 #include <algorithm>
 
+#if defined(__SSE2__) || (_M_IX86_FP >= 2) || defined(_M_X64) || defined(_M_AMD64)
+#include <xmmintrin.h>
+#include <emmintrin.h>
+#endif
+
 using std::max;
 using std::min;
 
@@ -1066,6 +1071,116 @@ set_alpha_array(xelval *alpha) {
   _alpha = alpha;
 }
 
+/**
+ * Fetches the RGBA colors of an entire row of the image at once, as with
+ * get_xel_a(), into the indicated array, which must have room for 4 *
+ * get_x_size() floats.  This is faster than calling get_xel_a() for each
+ * pixel, especially for images in the linear color space, which are
+ * converted several components at a time.
+ */
+void PNMImage::
+get_xel_a_row(int y, float *into) const {
+  nassertv(y >= 0 && y < _y_size);
+  const xel *xels = row(y);
+  const xelval *alpha = has_alpha() ? alpha_row(y) : nullptr;
+
+  switch (_xel_encoding) {
+  case XE_generic:
+  case XE_generic_alpha:
+#if defined(__SSE2__) || (_M_IX86_FP >= 2) || defined(_M_X64) || defined(_M_AMD64)
+    {
+      __m128 scale = _mm_set1_ps(_inv_maxval);
+      for (int x = 0; x < _x_size; ++x) {
+        __m128i vals = _mm_set_epi32((alpha != nullptr) ? alpha[x] : 0,
+                                     xels[x].b, xels[x].g, xels[x].r);
+        _mm_storeu_ps(into + x * 4, _mm_mul_ps(_mm_cvtepi32_ps(vals), scale));
+      }
+    }
+#else
+    for (int x = 0; x < _x_size; ++x) {
+      into[x * 4 + 0] = xels[x].r * _inv_maxval;
+      into[x * 4 + 1] = xels[x].g * _inv_maxval;
+      into[x * 4 + 2] = xels[x].b * _inv_maxval;
+      into[x * 4 + 3] = (alpha != nullptr) ? alpha[x] * _inv_maxval : 0.0f;
+    }
+#endif
+    break;
+
+  case XE_uchar_sRGB:
+  case XE_uchar_sRGB_alpha:
+  case XE_uchar_sRGB_sse2:
+  case XE_uchar_sRGB_alpha_sse2:
+    for (int x = 0; x < _x_size; ++x) {
+      into[x * 4 + 0] = decode_sRGB_float((unsigned char)xels[x].r);
+      into[x * 4 + 1] = decode_sRGB_float((unsigned char)xels[x].g);
+      into[x * 4 + 2] = decode_sRGB_float((unsigned char)xels[x].b);
+      into[x * 4 + 3] = (alpha != nullptr) ? alpha[x] * (1.f / 255.f) : 0.0f;
+    }
+    break;
+
+  default:
+    for (int x = 0; x < _x_size; ++x) {
+      LColorf color = get_xel_a(x, y);
+      into[x * 4 + 0] = color[0];
+      into[x * 4 + 1] = color[1];
+      into[x * 4 + 2] = color[2];
+      into[x * 4 + 3] = color[3];
+    }
+    break;
+  }
+}
+
+/**
+ * Changes the RGBA colors of an entire row of the image at once, as with
+ * set_xel_a(), from the indicated array of 4 * get_x_size() floats.
+ */
+void PNMImage::
+set_xel_a_row(int y, const float *from) {
+  nassertv(y >= 0 && y < _y_size);
+  xel *xels = row(y);
+  xelval *alpha = has_alpha() ? alpha_row(y) : nullptr;
+
+  switch (_xel_encoding) {
+  case XE_generic:
+  case XE_generic_alpha:
+#if defined(__SSE2__) || (_M_IX86_FP >= 2) || defined(_M_X64) || defined(_M_AMD64)
+    {
+      // Clamping before the conversion is equivalent to clamp_val() after
+      // it, since the conversion truncates toward zero.
+      __m128 maxval = _mm_set1_ps((float)get_maxval());
+      __m128 half = _mm_set1_ps(0.5f);
+      __m128 zero = _mm_setzero_ps();
+      for (int x = 0; x < _x_size; ++x) {
+        __m128 scaled = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(from + x * 4), maxval), half);
+        scaled = _mm_min_ps(_mm_max_ps(scaled, zero), maxval);
+
+        int vals[4];
+        _mm_storeu_si128((__m128i *)vals, _mm_cvttps_epi32(scaled));
+        xels[x].r = (xelval)vals[0];
+        xels[x].g = (xelval)vals[1];
+        xels[x].b = (xelval)vals[2];
+        if (alpha != nullptr) {
+          alpha[x] = (xelval)vals[3];
+        }
+      }
+    }
+#else
+    for (int x = 0; x < _x_size; ++x) {
+      set_xel_a(x, y, LColorf(from[x * 4 + 0], from[x * 4 + 1],
+                              from[x * 4 + 2], from[x * 4 + 3]));
+    }
+#endif
+    break;
+
+  default:
+    for (int x = 0; x < _x_size; ++x) {
+      set_xel_a(x, y, LColorf(from[x * 4 + 0], from[x * 4 + 1],
+                              from[x * 4 + 2], from[x * 4 + 3]));
+    }
+    break;
+  }
+}
+
 /**
  * Copies a rectangular area of another image into a rectangular area of this
  * image.  Both images must already have been initialized.  The upper-left
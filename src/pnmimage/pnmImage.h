@@ -331,6 +331,9 @@ public:
   void set_array(xel *array);
   void set_alpha_array(xelval *alpha);
 
+  void get_xel_a_row(int y, float *into) const;
+  void set_xel_a_row(int y, const float *from);
+
 private:
   INLINE void allocate_array();
   INLINE void allocate_alpha();
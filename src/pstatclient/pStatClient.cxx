@@ -26,6 +26,8 @@
 #include "thread.h"
 #include "clockObject.h"
 #include "neverFreeMemory.h"
+#include "connectionReader.h"
+#include "connectionWriter.h"
 
 using std::string;
 
@@ -45,6 +47,10 @@ PStatCollector PStatClient::_pstats_pcollector("*:PStats");
 PStatCollector PStatClient::_clock_wait_pcollector("Wait:Clock Wait:Sleep");
 PStatCollector PStatClient::_clock_busy_wait_pcollector("Wait:Clock Wait:Spin");
 PStatCollector PStatClient::_thread_block_pcollector("Wait:Thread block");
+PStatCollector PStatClient::_udp_datagrams_read_pcollector("UDP datagrams:Read");
+PStatCollector PStatClient::_udp_datagrams_sent_pcollector("UDP datagrams:Sent");
+PStatCollector PStatClient::_udp_read_calls_pcollector("UDP syscalls:Read");
+PStatCollector PStatClient::_udp_send_calls_pcollector("UDP syscalls:Send");
 
 PStatClient *PStatClient::_global_pstats = nullptr;
 
@@ -378,6 +384,31 @@ main_tick() {
   }
 #endif  // DO_MEMORY_USAGE
 
+  // Similarly, the net module keeps running totals of its UDP traffic, which
+  // we report here as the count for each frame.  Comparing the datagrams to
+  // the system calls shows how well the reads and writes are being batched.
+  static size_t last_udp_datagrams_read = 0;
+  static size_t last_udp_datagrams_sent = 0;
+  static size_t last_udp_read_calls = 0;
+  static size_t last_udp_send_calls = 0;
+
+  size_t udp_datagrams_read = ConnectionReader::get_num_udp_datagrams_read();
+  size_t udp_datagrams_sent = ConnectionWriter::get_num_udp_datagrams_sent();
+  size_t udp_read_calls = ConnectionReader::get_num_udp_read_calls();
+  size_t udp_send_calls = ConnectionWriter::get_num_udp_send_calls();
+
+  if (is_connected()) {
+    _udp_datagrams_read_pcollector.set_level(udp_datagrams_read - last_udp_datagrams_read);
+    _udp_datagrams_sent_pcollector.set_level(udp_datagrams_sent - last_udp_datagrams_sent);
+    _udp_read_calls_pcollector.set_level(udp_read_calls - last_udp_read_calls);
+    _udp_send_calls_pcollector.set_level(udp_send_calls - last_udp_send_calls);
+  }
+
+  last_udp_datagrams_read = udp_datagrams_read;
+  last_udp_datagrams_sent = udp_datagrams_sent;
+  last_udp_read_calls = udp_read_calls;
+  last_udp_send_calls = udp_send_calls;
+
   get_global_pstats()->client_main_tick();
 }
 
@@ -246,6 +246,10 @@ private:
   static PStatCollector _clock_wait_pcollector;
   static PStatCollector _clock_busy_wait_pcollector;
   static PStatCollector _thread_block_pcollector;
+  static PStatCollector _udp_datagrams_read_pcollector;
+  static PStatCollector _udp_datagrams_sent_pcollector;
+  static PStatCollector _udp_read_calls_pcollector;
+  static PStatCollector _udp_send_calls_pcollector;
 
   static PStatClient *_global_pstats;
 
@@ -220,6 +220,12 @@ static LevelCollectorProperties level_properties[] = {
   { 1, "Collision Volumes",                { 1.0, 0.8, 0.5 },  "", 500 },
   { 1, "Collision Tests",                  { 0.5, 0.8, 1.0 },  "", 100 },
   { 1, "Command latency",                  { 0.8, 0.2, 0.0 },  "ms", 10, 1.0 / 1000.0 },
+  { 1, "UDP datagrams",                    { 0.2, 0.6, 0.9 },  "", 500 },
+  { 1, "UDP datagrams:Read",               { 0.1, 0.8, 0.3 } },
+  { 1, "UDP datagrams:Sent",               { 0.9, 0.4, 0.1 } },
+  { 1, "UDP syscalls",                     { 0.6, 0.2, 0.8 },  "", 500 },
+  { 1, "UDP syscalls:Read",                { 0.1, 0.8, 0.3 } },
+  { 1, "UDP syscalls:Send",                { 0.9, 0.4, 0.1 } },
   { 0, nullptr }
 };
 
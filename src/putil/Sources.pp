@@ -13,8 +13,10 @@
     autoTextureScale.h \
     bam.h \
     bamCache.h bamCache.I \
+    bamCacheDirectoryStore.h bamCacheDirectoryStore.I \
     bamCacheIndex.h bamCacheIndex.I \
     bamCacheRecord.h bamCacheRecord.I \
+    bamCacheStore.h \
     bamEnums.h \
     bamReader.I bamReader.h bamReaderParam.I \
     bamReaderParam.h \
@@ -81,8 +83,10 @@
     animInterface.cxx \
     autoTextureScale.cxx \
     bamCache.cxx \
+    bamCacheDirectoryStore.cxx \
     bamCacheIndex.cxx \
     bamCacheRecord.cxx \
+    bamCacheStore.cxx \
     bamEnums.cxx \
     bamReader.cxx bamReaderParam.cxx \
     bamWriter.cxx \
@@ -132,8 +136,10 @@
     autoTextureScale.h \
     bam.h \
     bamCache.h bamCache.I \
+    bamCacheDirectoryStore.h bamCacheDirectoryStore.I \
     bamCacheIndex.h bamCacheIndex.I \
     bamCacheRecord.h bamCacheRecord.I \
+    bamCacheStore.h \
     bamEnums.h \
     bamReader.I bamReader.h bamReaderParam.I bamReaderParam.h \
     bamWriter.I bamWriter.h \
@@ -237,6 +243,16 @@
 
 #end test_bin_target
 
+#begin test_bin_target
+  #define TARGET test_bamCacheStore
+
+  #define SOURCES \
+    test_bamCacheStore.cxx
+
+  #define LOCAL_LIBS $[LOCAL_LIBS] putil
+
+#end test_bin_target
+
 #begin test_bin_target
   #define TARGET test_filename
 
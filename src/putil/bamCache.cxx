@@ -11,6 +11,7 @@
  * @date 2006-06-09
  */
 
+
 #include "bamCache.h"
 #include "bamCacheIndex.h"
 #include "bamReader.h"
@@ -26,6 +27,11 @@
 #include "configVariableString.h"
 #include "configVariableFilename.h"
 #include "virtualFileSystem.h"
+#include "bamCacheDirectoryStore.h"
+#include "pandaSystem.h"
+#include "trueClock.h"
+#include "mutexHolder.h"
+#include "indent.h"
 
 using std::istream;
 using std::ostream;
@@ -41,8 +47,14 @@ BamCache::
 BamCache() :
   _active(true),
   _read_only(false),
-  _index(new BamCacheIndex),
-  _index_stale_since(0)
+  _content_addressed(false),
+  _total_cache_kbytes(0),
+  _num_hits(0),
+  _num_misses(0),
+  _num_stores(0),
+  _num_evictions(0),
+  _lookup_time(0.0),
+  _store_time(0.0)
 {
   ConfigVariableFilename model_cache_dir
     ("model-cache-dir", Filename(),
@@ -59,6 +71,13 @@ BamCache() :
      PRC_DESC("This is the amount of time, in seconds, between automatic "
               "flushes of the model-cache index."));
 
+  ConfigVariableBool model_cache_flush_thread
+    ("model-cache-flush-thread", true,
+     PRC_DESC("If this is true, and threading is available, the model-cache "
+              "index is flushed to disk by a background thread.  If it is "
+              "false, it is flushed from time to time by whichever thread "
+              "happens to be using the cache, or by the main loop."));
+
   ConfigVariableBool model_cache_models
     ("model-cache-models", true,
      PRC_DESC("If this is set to true, models will be cached in the "
@@ -84,7 +103,43 @@ BamCache() :
 
   ConfigVariableInt model_cache_max_kbytes
     ("model-cache-max-kbytes", 10485760,
-     PRC_DESC("This is the maximum size of the model cache, in kilobytes."));
+     PRC_DESC("This is the maximum size of the model cache, in kilobytes.  "
+              "When it is exceeded, the least-recently-used files are "
+              "removed until the cache is 10% below this size."));
+
+  ConfigVariableBool model_cache_content_addressed
+    ("model-cache-content-addressed", false,
+     PRC_DESC("If this is true, files in the model cache are named by a hash "
+              "of the contents of the source file, the loader options, and "
+              "the version of Panda, rather than by the source pathname, and "
+              "they are validated by the contents of their dependent files "
+              "rather than by timestamp.  This costs a read of the source "
+              "file on each lookup, but it allows the cache to be shared "
+              "between machines via model-cache-store-dir.  This requires "
+              "OpenSSL."));
+
+  ConfigVariableString model_cache_content_salt
+    ("model-cache-content-salt", "",
+     PRC_DESC("An arbitrary string that is mixed into the content hash in "
+              "content-addressed mode.  Change this to invalidate all of the "
+              "shared cache files at once, for instance after changing a "
+              "converter or a config setting that affects loading."));
+
+  ConfigVariableFilename model_cache_store_dir
+    ("model-cache-store-dir", Filename(),
+     PRC_DESC("The full path to a directory, possibly on a network share, "
+              "that holds cache files shared between several machines.  "
+              "This is only used if model-cache-content-addressed is true.  "
+              "Files that are not in the local model-cache-dir are copied "
+              "from here, and newly cached files are copied here.  Since "
+              "cached models refer to their textures by full pathname, a "
+              "shared file is only used when the model and its textures are "
+              "at the same paths as on the machine that wrote it."));
+
+  ConfigVariableBool model_cache_store_read_only
+    ("model-cache-store-read-only", false,
+     PRC_DESC("Set this true to use model-cache-store-dir without ever "
+              "adding files to it."));
 
   _cache_models = model_cache_models;
   _cache_textures = model_cache_textures;
@@ -93,6 +148,18 @@ BamCache() :
 
   _flush_time = model_cache_flush;
   _max_kbytes = model_cache_max_kbytes;
+  _use_flush_thread = model_cache_flush_thread;
+  _content_salt = model_cache_content_salt;
+  set_content_addressed(model_cache_content_addressed);
+
+  if (!model_cache_store_dir.empty()) {
+    _store = new BamCacheDirectoryStore(model_cache_store_dir,
+                                        model_cache_store_read_only);
+  }
+
+  for (int i = 0; i < num_shards; ++i) {
+    _shards[i]._index = new BamCacheIndex;
+  }
 
   if (!model_cache_dir.empty()) {
     set_root(model_cache_dir);
@@ -104,9 +171,13 @@ BamCache() :
  */
 BamCache::
 ~BamCache() {
+  stop_flush_thread();
   flush_index();
-  delete _index;
-  _index = nullptr;
+
+  for (int i = 0; i < num_shards; ++i) {
+    delete _shards[i]._index;
+    _shards[i]._index = nullptr;
+  }
 }
 
 /**
@@ -120,29 +191,93 @@ BamCache::
  */
 void BamCache::
 set_root(const Filename &root) {
-  ReMutexHolder holder(_lock);
+  stop_flush_thread();
   flush_index();
-  _root = root;
 
-  // The root filename must be a directory.
   VirtualFileSystem *vfs = VirtualFileSystem::get_global_ptr();
-  if (!vfs->is_directory(_root)) {
-    vfs->make_directory_full(_root);
+
+  // Hold all of the shards, so that no lookup or store is in progress while
+  // we switch directories.
+  int i;
+  for (i = 0; i < num_shards; ++i) {
+    _shards[i]._lock.acquire();
   }
 
-  delete _index;
-  _index = new BamCacheIndex;
-  _index_stale_since = 0;
+  bool is_directory;
+  {
+    ReMutexHolder holder(_lock);
+    _root = root;
 
-  if (!vfs->is_directory(_root)) {
-    util_cat.error()
-      << "Unable to make directory " << _root << ", caching disabled.\n";
-    _active = false;
-    return;
+    // The root filename must be a directory.
+    if (!vfs->is_directory(_root)) {
+      vfs->make_directory_full(_root);
+    }
+
+    is_directory = vfs->is_directory(_root);
+    if (!is_directory) {
+      util_cat.error()
+        << "Unable to make directory " << _root << ", caching disabled.\n";
+      _active = false;
+    }
   }
 
-  read_index();
-  check_cache_size();
+  for (i = 0; i < num_shards; ++i) {
+    Shard &shard = _shards[i];
+    delete shard._index;
+    shard._index = new BamCacheIndex;
+    update_cache_size(shard);
+    shard._index_stale_since = 0;
+    shard._index_pathname = Filename();
+    shard._index_ref_contents.clear();
+
+    ostringstream strm;
+    strm << std::hex << i;
+    shard._dir = Filename(root, Filename(strm.str()));
+
+    if (is_directory) {
+      if (!vfs->is_directory(shard._dir)) {
+        vfs->make_directory(shard._dir);
+      }
+      read_index(shard);
+    }
+  }
+
+  if (is_directory) {
+    migrate_legacy_files();
+  }
+
+  while (i > 0) {
+    --i;
+    _shards[i]._lock.release();
+  }
+
+  if (is_directory) {
+    check_cache_size();
+    start_flush_thread();
+  }
+}
+
+/**
+ * Changes whether cache files are named by the contents of their source
+ * files, rather than by their pathnames.  In content-addressed mode, each
+ * lookup must read the entire source file, but identical source files share
+ * one cache file, and the cache files may be shared with other machines
+ * through a store; see set_store().
+ *
+ * This mode requires OpenSSL; without it, this has no effect.
+ */
+void BamCache::
+set_content_addressed(bool flag) {
+#ifndef HAVE_OPENSSL
+  if (flag) {
+    util_cat.warning()
+      << "Content-addressed model cache requires OpenSSL.\n";
+    flag = false;
+  }
+#endif  // HAVE_OPENSSL
+
+  ReMutexHolder holder(_lock);
+  _content_addressed = flag;
 }
 
 /**
@@ -160,29 +295,76 @@ set_root(const Filename &root) {
  * source file), and then call record->set_data() to record the resulting
  * loaded object; and finally, you should call store() to write the cached
  * record to disk.
+ *
+ * The options_key should describe any options that affect the loaded object.
+ * It is only used in content-addressed mode, where it becomes part of the
+ * hash.
  */
 PT(BamCacheRecord) BamCache::
-lookup(const Filename &source_filename, const string &cache_extension) {
-  ReMutexHolder holder(_lock);
+lookup(const Filename &source_filename, const string &cache_extension,
+       const string &options_key) {
   consider_flush_index();
 
+  TrueClock *clock = TrueClock::get_global_ptr();
+  double start = clock->get_short_time();
+
   VirtualFileSystem *vfs = VirtualFileSystem::get_global_ptr();
 
   Filename source_pathname(source_filename);
   source_pathname.make_absolute(vfs->get_cwd());
 
   Filename rel_pathname(source_pathname);
-  rel_pathname.make_relative_to(_root, false);
+  rel_pathname.make_relative_to(get_root(), false);
   if (rel_pathname.is_local()) {
     // If the source pathname is already within the cache directory, don't
     // cache it further.
     return nullptr;
   }
 
-  Filename cache_filename = hash_filename(source_pathname.get_fullpath());
+  // If the source can't be read, as in the case of a multipage texture
+  // pattern, we fall back to naming the cache file by pathname.
+  string content_key;
+  if (get_content_addressed()) {
+    content_key = make_content_key(source_pathname, cache_extension, options_key);
+  }
+
+  // The cache file goes in the shard named by the first digit of its hash.
+  string hash = content_key.empty() ? hash_filename(source_pathname.get_fullpath()) : content_key;
+  Filename cache_filename(Filename(hash.substr(0, 1)), Filename(hash));
   cache_filename.set_extension(cache_extension);
 
-  return find_and_read_record(source_pathname, cache_filename);
+  Shard &shard = _shards[get_shard_index(cache_filename)];
+
+  if (!content_key.empty()) {
+    // If we don't have the file locally, see if another machine has already
+    // cooked it.  We don't hold the shard for this, since it may involve a
+    // slow copy over the network; the store only moves the file into place
+    // once it is complete, so a reader never sees a partial file.
+    PT(BamCacheStore) store = get_store();
+    Filename cache_pathname = shard.get_cache_pathname(cache_filename);
+    if (store != nullptr && !cache_pathname.exists()) {
+      store->fetch(cache_filename.get_basename(), cache_pathname);
+    }
+  }
+
+  PT(BamCacheRecord) record;
+  {
+    ReMutexHolder holder(shard._lock);
+    record = find_and_read_record(shard, source_pathname, cache_filename, content_key);
+  }
+
+  double elapsed = clock->get_short_time() - start;
+  {
+    LightMutexHolder holder(_stats_lock);
+    if (record->has_data()) {
+      ++_num_hits;
+    } else {
+      ++_num_misses;
+    }
+    _lookup_time += elapsed;
+  }
+
+  return record;
 }
 
 /**
@@ -192,21 +374,60 @@ lookup(const Filename &source_filename, const string &cache_extension) {
  */
 bool BamCache::
 store(BamCacheRecord *record) {
-  VirtualFileSystem *vfs = VirtualFileSystem::get_global_ptr();
-  ReMutexHolder holder(_lock);
   nassertr(!record->_cache_pathname.empty(), false);
   nassertr(record->has_data(), false);
 
-  if (_read_only) {
+  if (get_read_only()) {
     return false;
   }
 
   consider_flush_index();
 
+  TrueClock *clock = TrueClock::get_global_ptr();
+  double start = clock->get_short_time();
+
+  Shard &shard = _shards[get_shard_index(record->get_cache_filename())];
+  bool success;
+  {
+    ReMutexHolder holder(shard._lock);
+    success = do_store(shard, record);
+  }
+
+  double elapsed = clock->get_short_time() - start;
+  {
+    LightMutexHolder holder(_stats_lock);
+    if (success) {
+      ++_num_stores;
+    }
+    _store_time += elapsed;
+  }
+
+  if (success) {
+    // Offer the new file to the other machines.  We don't hold the shard for
+    // this, since it may involve a slow copy over the network.
+    PT(BamCacheStore) store = get_store();
+    if (store != nullptr && !record->get_content_key().empty()) {
+      store->publish(record->get_cache_filename().get_basename(),
+                     record->_cache_pathname);
+    }
+
+    // Now make room for the new file.
+    check_cache_size();
+  }
+  return success;
+}
+
+/**
+ * The implementation of store().  Assumes the shard's lock is held.
+ */
+bool BamCache::
+do_store(Shard &shard, BamCacheRecord *record) {
+  VirtualFileSystem *vfs = VirtualFileSystem::get_global_ptr();
+
 #ifndef NDEBUG
-  // Ensure that the cache_pathname is within the _root directory tree.
+  // Ensure that the cache_pathname is within the shard's directory.
   Filename rel_pathname(record->_cache_pathname);
-  rel_pathname.make_relative_to(_root, false);
+  rel_pathname.make_relative_to(shard._dir, false);
   nassertr(rel_pathname.is_local(), false);
 #endif  // NDEBUG
 
@@ -298,7 +519,7 @@ store(BamCacheRecord *record) {
     }
   }
 
-  add_to_index(record);
+  add_to_index(shard, record);
 
   return true;
 }
@@ -312,54 +533,152 @@ void BamCache::
 emergency_read_only() {
   util_cat.error() <<
     "Could not write to the Bam Cache.  Disabling future attempts.\n";
+  ReMutexHolder holder(_lock);
   _read_only = true;
 }
 
 /**
  * Flushes the index if enough time has elapsed since the index was last
- * flushed.
+ * flushed.  This does nothing if the index is being flushed by a background
+ * thread.
  */
 void BamCache::
 consider_flush_index() {
-#if defined(HAVE_THREADS) || defined(DEBUG_THREADS)
-  if (!_lock.try_lock()) {
-    // If we can't grab the lock, no big deal.  We don't want to hold up
-    // the frame waiting for a cache operation.  We can try again later.
+  {
+    ReMutexHolder holder(_lock);
+    if (_flush_thread != nullptr) {
+      return;
+    }
+  }
+
+  flush_stale_indexes(false);
+}
+
+/**
+ * Ensures the index is written to disk.
+ */
+void BamCache::
+flush_index() {
+  for (int i = 0; i < num_shards; ++i) {
+    Shard &shard = _shards[i];
+    ReMutexHolder holder(shard._lock);
+    flush_shard_index(shard);
+  }
+}
+
+/**
+ * Writes the contents of the index to standard output.
+ */
+void BamCache::
+list_index(ostream &out, int indent_level) const {
+  for (int i = 0; i < num_shards; ++i) {
+    const Shard &shard = _shards[i];
+    ReMutexHolder holder(shard._lock);
+    indent(out, indent_level) << shard._dir << ":\n";
+    shard._index->write(out, indent_level + 2);
+  }
+}
+
+/**
+ * Starts the thread that flushes the index in the background, if it is
+ * enabled and not already running.
+ */
+void BamCache::
+start_flush_thread() {
+  if (!_use_flush_thread || !Thread::is_threading_supported()) {
     return;
   }
-#endif
 
-  if (_index_stale_since != 0) {
-    int elapsed = (int)time(nullptr) - (int)_index_stale_since;
-    if (elapsed > _flush_time) {
-      flush_index();
+  ReMutexHolder holder(_lock);
+  if (_flush_thread == nullptr) {
+    _flush_thread = new FlushThread(this);
+    if (!_flush_thread->start(TP_low, true)) {
+      _flush_thread = nullptr;
     }
   }
+}
+
+/**
+ * Stops the background flush thread, if it is running, and waits for it to
+ * exit.
+ */
+void BamCache::
+stop_flush_thread() {
+  PT(FlushThread) thread;
+  {
+    ReMutexHolder holder(_lock);
+    thread = _flush_thread;
+    _flush_thread = nullptr;
+  }
+
+  // The thread may need _lock to finish what it is doing, so we must not
+  // hold it while we wait.
+  if (thread != nullptr) {
+    thread->stop();
+  }
+}
+
+/**
+ * Writes each shard index that has been stale for longer than the flush
+ * time.  If wait is false, shards that are currently in use by another thread
+ * are skipped.
+ */
+void BamCache::
+flush_stale_indexes(bool wait) {
+  int flush_time = get_flush_time();
+  time_t now = time(nullptr);
+  bool any_flushed = false;
+
+  for (int i = 0; i < num_shards; ++i) {
+    Shard &shard = _shards[i];
+#if defined(HAVE_THREADS) || defined(DEBUG_THREADS)
+    if (wait) {
+      shard._lock.acquire();
+    } else if (!shard._lock.try_lock()) {
+      // If we can't grab the lock, no big deal.  We don't want to hold up
+      // the frame waiting for a cache operation.  We can try again later.
+      continue;
+    }
+#endif
+
+    if (shard._index_stale_since != 0) {
+      int elapsed = (int)now - (int)shard._index_stale_since;
+      if (elapsed > flush_time) {
+        flush_shard_index(shard);
+        any_flushed = true;
+      }
+    }
 
 #if defined(HAVE_THREADS) || defined(DEBUG_THREADS)
-  _lock.unlock();
+    shard._lock.release();
 #endif
+  }
+
+  if (any_flushed) {
+    // Flushing may have merged in files stored by other processes.
+    check_cache_size();
+  }
 }
 
 /**
- * Ensures the index is written to disk.
+ * Ensures the shard's index is written to disk.  Assumes the shard's lock is
+ * held.
  */
 void BamCache::
-flush_index() {
-  ReMutexHolder holder(_lock);
-  if (_index_stale_since == 0) {
+flush_shard_index(Shard &shard) {
+  if (shard._index_stale_since == 0) {
     // Never mind.
     return;
   }
 
   while (true) {
-    if (_read_only) {
+    if (get_read_only()) {
       return;
     }
 
-    Filename temp_pathname = Filename::temporary(_root, "index-", ".boo");
+    Filename temp_pathname = Filename::temporary(shard._dir, "index-", ".boo");
 
-    if (!do_write_index(temp_pathname, _index)) {
+    if (!do_write_index(temp_pathname, shard._index)) {
       emergency_read_only();
       return;
     }
@@ -367,8 +686,8 @@ flush_index() {
     // Now atomically write the name of this index file to the index reference
     // file.
     VirtualFileSystem *vfs = VirtualFileSystem::get_global_ptr();
-    Filename index_ref_pathname(_root, Filename("index_name.txt"));
-    string old_index = _index_ref_contents;
+    Filename index_ref_pathname(shard._dir, Filename("index_name.txt"));
+    string old_index = shard._index_ref_contents;
     string new_index = temp_pathname.get_basename() + "\n";
     string orig_index;
 
@@ -376,79 +695,73 @@ flush_index() {
       // We successfully wrote our version of the index, and no other process
       // beat us to it.  Our index is now the official one.  Remove the old
       // index.
-      vfs->delete_file(_index_pathname);
-      _index_pathname = temp_pathname;
-      _index_ref_contents = new_index;
-      _index_stale_since = 0;
+      vfs->delete_file(shard._index_pathname);
+      shard._index_pathname = temp_pathname;
+      shard._index_ref_contents = new_index;
+      shard._index_stale_since = 0;
       return;
     }
 
     // Shoot, some other process updated the index while we were trying to
     // update it, and they beat us to it.  We have to merge, and try again.
     vfs->delete_file(temp_pathname);
-    _index_pathname = Filename(_root, Filename(trim(orig_index)));
-    _index_ref_contents = orig_index;
-    read_index();
+    shard._index_pathname = Filename(shard._dir, Filename(trim(orig_index)));
+    shard._index_ref_contents = orig_index;
+    read_index(shard);
   }
-  check_cache_size();
 }
 
 /**
- * Writes the contents of the index to standard output.
+ * Reads, or re-reads the shard's index file from disk.  If the index is
+ * stale, the index file is read and then merged with our current index.
+ * Assumes the shard's lock is held.
  */
 void BamCache::
-list_index(ostream &out, int indent_level) const {
-  _index->write(out, indent_level);
-}
-
-/**
- * Reads, or re-reads the index file from disk.  If _index_stale_since is
- * nonzero, the index file is read and then merged with our current index.
- */
-void BamCache::
-read_index() {
-  if (!read_index_pathname(_index_pathname, _index_ref_contents)) {
+read_index(Shard &shard) {
+  if (!read_index_pathname(shard, shard._index_pathname, shard._index_ref_contents)) {
     // Couldn't read the index ref; rebuild the index.
-    rebuild_index();
+    rebuild_index(shard);
     return;
   }
 
   while (true) {
-    BamCacheIndex *new_index = do_read_index(_index_pathname);
+    BamCacheIndex *new_index = do_read_index(shard._index_pathname);
     if (new_index != nullptr) {
-      merge_index(new_index);
+      merge_index(shard, new_index);
       return;
     }
 
     // We couldn't read the index.  Maybe it's been removed already.  See if
     // the index_pathname has changed.
-    Filename old_index_pathname = _index_pathname;
-    if (!read_index_pathname(_index_pathname, _index_ref_contents)) {
+    Filename old_index_pathname = shard._index_pathname;
+    if (!read_index_pathname(shard, shard._index_pathname, shard._index_ref_contents)) {
       // Couldn't read the index ref; rebuild the index.
-      rebuild_index();
+      rebuild_index(shard);
       return;
     }
 
-    if (old_index_pathname == _index_pathname) {
+    if (old_index_pathname == shard._index_pathname) {
       // Nope, we just couldn't read it.  Delete it and build a new one.
       VirtualFileSystem *vfs = VirtualFileSystem::get_global_ptr();
-      vfs->delete_file(_index_pathname);
-      rebuild_index();
-      flush_index();
+      vfs->delete_file(shard._index_pathname);
+      rebuild_index(shard);
+      flush_shard_index(shard);
       return;
     }
   }
 }
 
 /**
- * Atomically reads the current index filename from the index reference file.
- * The index filename moves around as different processes update the index.
+ * Atomically reads the current index filename from the shard's index
+ * reference file.  The index filename moves around as different processes
+ * update the index.
  */
 bool BamCache::
-read_index_pathname(Filename &index_pathname, string &index_ref_contents) const {
+read_index_pathname(const Shard &shard, Filename &index_pathname,
+                    string &index_ref_contents) const {
   VirtualFileSystem *vfs = VirtualFileSystem::get_global_ptr();
   index_ref_contents.clear();
-  Filename index_ref_pathname(_root, Filename("index_name.txt"));
+  Filename index_ref_pathname(shard._dir, Filename("index_name.txt"));
   if (!vfs->atomic_read_contents(index_ref_pathname, index_ref_contents)) {
     return false;
   }
@@ -457,31 +770,32 @@ read_index_pathname(Filename &index_pathname, string &index_ref_contents) const
   if (trimmed.empty()) {
     index_pathname = Filename();
   } else {
-    index_pathname = Filename(_root, Filename(trimmed));
+    index_pathname = Filename(shard._dir, Filename(trimmed));
   }
   return true;
 }
 
 /**
  * The supplied index file has been updated by some other process.  Merge it
- * with our current index.
+ * with the shard's current index.
  *
  * Ownership of the pointer is transferred with this call.  The caller should
  * assume that new_index will be deleted by this method.
  */
 void BamCache::
-merge_index(BamCacheIndex *new_index) {
-  if (_index_stale_since == 0) {
+merge_index(Shard &shard, BamCacheIndex *new_index) {
+  if (shard._index_stale_since == 0) {
     // If our index isn't stale, just replace it.
-    delete _index;
-    _index = new_index;
+    delete shard._index;
+    shard._index = new_index;
+    update_cache_size(shard);
     return;
   }
 
-  BamCacheIndex *old_index = _index;
+  BamCacheIndex *old_index = shard._index;
   old_index->release_records();
   new_index->release_records();
-  _index = new BamCacheIndex;
+  shard._index = new BamCacheIndex;
 
   BamCacheIndex::Records::const_iterator ai = old_index->_records.begin();
   BamCacheIndex::Records::const_iterator bi = new_index->_records.begin();
@@ -491,20 +805,20 @@ merge_index(BamCacheIndex *new_index) {
     if ((*ai).first < (*bi).first) {
       // Here is an entry we have in our index, not present in the new index.
       PT(BamCacheRecord) record = (*ai).second;
-      Filename cache_pathname(_root, record->get_cache_filename());
+      Filename cache_pathname = shard.get_cache_pathname(record->get_cache_filename());
       if (cache_pathname.exists()) {
         // The file exists; keep it.
-        _index->_records.insert(_index->_records.end(), BamCacheIndex::Records::value_type(record->get_source_pathname(), record));
+        shard._index->_records.insert(shard._index->_records.end(), BamCacheIndex::Records::value_type(BamCacheIndex::get_key(record), record));
       }
       ++ai;
 
     } else if ((*bi).first < (*ai).first) {
       // Here is an entry in the new index, not present in our index.
       PT(BamCacheRecord) record = (*bi).second;
-      Filename cache_pathname(_root, record->get_cache_filename());
+      Filename cache_pathname = shard.get_cache_pathname(record->get_cache_filename());
       if (cache_pathname.exists()) {
         // The file exists; keep it.
-        _index->_records.insert(_index->_records.end(), BamCacheIndex::Records::value_type(record->get_source_pathname(), record));
+        shard._index->_records.insert(shard._index->_records.end(), BamCacheIndex::Records::value_type(BamCacheIndex::get_key(record), record));
       }
       ++bi;
 
@@ -515,18 +829,18 @@ merge_index(BamCacheIndex *new_index) {
       if (*a_record == *b_record) {
         // They're the same entry.  It doesn't really matter which one we
         // keep.
-        _index->_records.insert(_index->_records.end(), BamCacheIndex::Records::value_type(a_record->get_source_pathname(), a_record));
+        shard._index->_records.insert(shard._index->_records.end(), BamCacheIndex::Records::value_type(BamCacheIndex::get_key(a_record), a_record));
 
       } else {
         // They're different.  Just throw them both away, and re-read the
         // current data from the cache file.
 
-        Filename cache_pathname(_root, a_record->get_cache_filename());
+        Filename cache_pathname = shard.get_cache_pathname(a_record->get_cache_filename());
 
         if (cache_pathname.exists()) {
           PT(BamCacheRecord) record = do_read_record(cache_pathname, false);
           if (record != nullptr) {
-            _index->_records.insert(_index->_records.end(), BamCacheIndex::Records::value_type(record->get_source_pathname(), record));
+            shard._index->_records.insert(shard._index->_records.end(), BamCacheIndex::Records::value_type(BamCacheIndex::get_key(record), record));
           }
         }
       }
@@ -539,10 +853,10 @@ merge_index(BamCacheIndex *new_index) {
   while (ai != old_index->_records.end()) {
     // Here is an entry we have in our index, not present in the new index.
     PT(BamCacheRecord) record = (*ai).second;
-    Filename cache_pathname(_root, record->get_cache_filename());
+    Filename cache_pathname = shard.get_cache_pathname(record->get_cache_filename());
     if (cache_pathname.exists()) {
       // The file exists; keep it.
-      _index->_records.insert(_index->_records.end(), BamCacheIndex::Records::value_type(record->get_source_pathname(), record));
+      shard._index->_records.insert(shard._index->_records.end(), BamCacheIndex::Records::value_type(BamCacheIndex::get_key(record), record));
     }
     ++ai;
   }
@@ -550,34 +864,37 @@ merge_index(BamCacheIndex *new_index) {
   while (bi != new_index->_records.end()) {
     // Here is an entry in the new index, not present in our index.
     PT(BamCacheRecord) record = (*bi).second;
-    Filename cache_pathname(_root, record->get_cache_filename());
+    Filename cache_pathname = shard.get_cache_pathname(record->get_cache_filename());
     if (cache_pathname.exists()) {
       // The file exists; keep it.
-      _index->_records.insert(_index->_records.end(), BamCacheIndex::Records::value_type(record->get_source_pathname(), record));
+      shard._index->_records.insert(shard._index->_records.end(), BamCacheIndex::Records::value_type(BamCacheIndex::get_key(record), record));
     }
     ++bi;
   }
 
-  _index->process_new_records();
+  shard._index->process_new_records();
+  update_cache_size(shard);
 }
 
 /**
- * Regenerates the index from scratch by scanning the directory.
+ * Regenerates the shard's index from scratch by scanning its directory.
+ * Assumes the shard's lock is held.
  */
 void BamCache::
-rebuild_index() {
+rebuild_index(Shard &shard) {
   VirtualFileSystem *vfs = VirtualFileSystem::get_global_ptr();
 
-  PT(VirtualFileList) contents = vfs->scan_directory(_root);
+  PT(VirtualFileList) contents = vfs->scan_directory(shard._dir);
   if (contents == nullptr) {
     util_cat.error()
-      << "Unable to read directory " << _root << ", caching disabled.\n";
+      << "Unable to read directory " << shard._dir << ", caching disabled.\n";
     set_active(false);
     return;
   }
 
-  delete _index;
-  _index = new BamCacheIndex;
+  delete shard._index;
+  shard._index = new BamCacheIndex;
+  update_cache_size(shard);
 
   int num_files = contents->get_num_files();
   for (int ci = 0; ci < num_files; ++ci) {
@@ -585,7 +902,7 @@ rebuild_index() {
     Filename filename = file->get_filename();
     if (filename.get_extension() == "bam" ||
         filename.get_extension() == "txo") {
-      Filename pathname(_root, filename);
+      Filename pathname(shard._dir, filename.get_basename());
 
       PT(BamCacheRecord) record = do_read_record(pathname, false);
       if (record == nullptr) {
@@ -599,7 +916,7 @@ rebuild_index() {
       } else {
         record->_record_access_time = record->_recorded_time;
 
-        bool inserted = _index->_records.insert(BamCacheIndex::Records::value_type(record->get_source_pathname(), record)).second;
+        bool inserted = shard._index->_records.insert(BamCacheIndex::Records::value_type(BamCacheIndex::get_key(record), record)).second;
         if (!inserted) {
           util_cat.info()
             << "Multiple cache files defining " << record->get_source_pathname() << "\n";
@@ -608,66 +925,183 @@ rebuild_index() {
       }
     }
   }
-  _index->process_new_records();
+  shard._index->process_new_records();
+  update_cache_size(shard);
 
-  _index_stale_since = time(nullptr);
-  check_cache_size();
-  flush_index();
+  shard._index_stale_since = time(nullptr);
+  flush_shard_index(shard);
 }
 
 /**
- * Updates the index entry for the indicated record.  Note that a copy of the
- * record is made first.
+ * Updates the shard's index entry for the indicated record.  Note that a copy
+ * of the record is made first.  Assumes the shard's lock is held.
  */
 void BamCache::
-add_to_index(const BamCacheRecord *record) {
+add_to_index(Shard &shard, const BamCacheRecord *record) {
   PT(BamCacheRecord) new_record = record->make_copy();
 
-  if (_index->add_record(new_record)) {
-    mark_index_stale();
-    check_cache_size();
+  if (shard._index->add_record(new_record)) {
+    update_cache_size(shard);
+  }
+
+  // Even if only the access time has changed, the index still needs to be
+  // written eventually, or the recency of a shard that sees nothing but hits
+  // would be lost.  The writes are limited to one per model-cache-flush.
+  mark_index_stale(shard);
+}
+
+/**
+ * Removes the shard's index entry with the indicated key, if there is one;
+ * see BamCacheIndex::make_key().  Assumes the shard's lock is held.
+ */
+void BamCache::
+remove_from_index(Shard &shard, const Filename &key) {
+  if (shard._index->remove_record(key)) {
+    mark_index_stale(shard);
+    update_cache_size(shard);
   }
 }
 
 /**
- * Removes the index entry for the indicated record, if there is one.
+ * Brings the total cache size up to date with the size of the shard's index,
+ * after the index has changed.  Assumes the shard's lock is held.
  */
 void BamCache::
-remove_from_index(const Filename &source_pathname) {
-  if (_index->remove_record(source_pathname)) {
-    mark_index_stale();
+update_cache_size(Shard &shard) {
+  int cache_kbytes = (int)(shard._index->_cache_size / 1024);
+  if (cache_kbytes != shard._cache_kbytes) {
+    AtomicAdjust::add(_total_cache_kbytes, cache_kbytes - shard._cache_kbytes);
+    shard._cache_kbytes = cache_kbytes;
   }
 }
 
 /**
- * If the cache size has exceeded its specified size limit, removes an old
- * file.
+ * If the cache size has exceeded its specified size limit, removes the least
+ * recently used files until it is comfortably below the limit, so that we
+ * don't have to evict again on the very next store.  The caller must not hold
+ * any shard lock.
  */
 void BamCache::
 check_cache_size() {
-  if (_index->_cache_size == 0) {
-    // 0 means no limit.
+  int max_kbytes = get_cache_max_kbytes();
+  if ((int)AtomicAdjust::get(_total_cache_kbytes) <= max_kbytes) {
     return;
   }
 
-  if (_index->_cache_size / 1024 > _max_kbytes) {
-    while (_index->_cache_size / 1024 > _max_kbytes) {
-      PT(BamCacheRecord) record = _index->evict_old_file();
-      if (record == nullptr) {
-        // Never mind; the cache is empty.
-        break;
-      }
-      VirtualFileSystem *vfs = VirtualFileSystem::get_global_ptr();
-      Filename cache_pathname(_root, record->get_cache_filename());
-      if (util_cat.is_debug()) {
-        util_cat.debug()
-          << "Deleting " << cache_pathname
-          << " to keep cache size below " << _max_kbytes << "K\n";
+  int target_kbytes = max_kbytes - max_kbytes / 10;
+  VirtualFileSystem *vfs = VirtualFileSystem::get_global_ptr();
+
+  while ((int)AtomicAdjust::get(_total_cache_kbytes) > target_kbytes) {
+    // Each shard keeps its own records in LRU order, so the oldest file in
+    // the cache is the oldest of the shards' oldest files.
+    int oldest_shard = -1;
+    time_t oldest_time = 0;
+    for (int i = 0; i < num_shards; ++i) {
+      Shard &shard = _shards[i];
+      ReMutexHolder holder(shard._lock);
+      BamCacheRecord *record = shard._index->get_old_file();
+      if (record != nullptr &&
+          (oldest_shard < 0 || record->_record_access_time < oldest_time)) {
+        oldest_shard = i;
+        oldest_time = record->_record_access_time;
       }
+    }
+
+    if (oldest_shard < 0) {
+      // Never mind; the cache is empty.
+      break;
+    }
+
+    // Another thread may have touched the shard since we looked at it, in
+    // which case we evict a slightly newer file; no great harm.
+    Shard &shard = _shards[oldest_shard];
+    ReMutexHolder holder(shard._lock);
+    PT(BamCacheRecord) record = shard._index->evict_old_file();
+    if (record == nullptr) {
+      continue;
+    }
+    mark_index_stale(shard);
+    update_cache_size(shard);
+
+    Filename cache_pathname = shard.get_cache_pathname(record->get_cache_filename());
+    if (util_cat.is_debug()) {
+      util_cat.debug()
+        << "Deleting " << cache_pathname
+        << " to keep cache size below " << max_kbytes << "K\n";
+    }
+    vfs->delete_file(cache_pathname);
+
+    LightMutexHolder stats_holder(_stats_lock);
+    ++_num_evictions;
+  }
+}
+
+/**
+ * Moves the cache files left in the root directory by a version of Panda
+ * that did not divide the cache into shards into the shard directories where
+ * they now belong, and adds them to the shard indexes.  The old index is
+ * removed; the files would otherwise never be found or evicted.  Assumes the
+ * lock of every shard is held.
+ */
+void BamCache::
+migrate_legacy_files() {
+  VirtualFileSystem *vfs = VirtualFileSystem::get_global_ptr();
+  Filename root = get_root();
+
+  Filename index_ref_pathname(root, Filename("index_name.txt"));
+  if (!vfs->exists(index_ref_pathname)) {
+    return;
+  }
+
+  PT(VirtualFileList) contents = vfs->scan_directory(root);
+  if (contents == nullptr) {
+    return;
+  }
+
+  int num_migrated = 0;
+  int num_files = contents->get_num_files();
+  for (int ci = 0; ci < num_files; ++ci) {
+    VirtualFile *file = contents->get_file(ci);
+    if (!file->is_regular_file()) {
+      continue;
+    }
+    Filename filename = file->get_filename();
+    string extension = filename.get_extension();
+    if (extension == "boo") {
+      // An old index file.  The records are read from the files themselves.
+      file->delete_file();
+      continue;
+    }
+    if (extension != "bam" && extension != "txo") {
+      continue;
+    }
+
+    Filename cache_filename(filename.get_basename());
+    Shard &shard = _shards[get_shard_index(cache_filename)];
+    Filename cache_pathname = shard.get_cache_pathname(cache_filename);
+    if (vfs->exists(cache_pathname) ||
+        !vfs->rename_file(filename, cache_pathname)) {
+      // Leave it be; we may be sharing the directory with an older version
+      // of Panda that is still using it.
+      continue;
+    }
+
+    PT(BamCacheRecord) record = do_read_record(cache_pathname, false);
+    if (record == nullptr) {
       vfs->delete_file(cache_pathname);
+      continue;
     }
-    mark_index_stale();
+    record->_record_access_time = record->_recorded_time;
+    add_to_index(shard, record);
+    ++num_migrated;
+  }
+
+  if (util_cat.is_debug()) {
+    util_cat.debug()
+      << "Moved " << num_migrated << " old-style cache files from " << root
+      << " into the shard directories.\n";
   }
+  vfs->delete_file(index_ref_pathname);
 }
 
 /**
@@ -778,14 +1212,15 @@ do_write_index(const Filename &index_pathname, const BamCacheIndex *index) {
  * the case of a hash collision, it may be a variant of the cache filename.
  */
 PT(BamCacheRecord) BamCache::
-find_and_read_record(const Filename &source_pathname,
-                     const Filename &cache_filename) {
+find_and_read_record(Shard &shard, const Filename &source_pathname,
+                     const Filename &cache_filename,
+                     const string &content_key) {
   int pass = 0;
   while (true) {
     PT(BamCacheRecord) record =
-      read_record(source_pathname, cache_filename, pass);
+      read_record(shard, source_pathname, cache_filename, content_key, pass);
     if (record != nullptr) {
-      add_to_index(record);
+      add_to_index(shard, record);
       return record;
     }
     ++pass;
@@ -797,11 +1232,11 @@ find_and_read_record(const Filename &source_pathname,
  * be read and it matches the source filename.
  */
 PT(BamCacheRecord) BamCache::
-read_record(const Filename &source_pathname,
-            const Filename &cache_filename,
+read_record(Shard &shard, const Filename &source_pathname,
+            const Filename &cache_filename, const string &content_key,
             int pass) {
   VirtualFileSystem *vfs = VirtualFileSystem::get_global_ptr();
-  Filename cache_pathname(_root, cache_filename);
+  Filename cache_pathname = shard.get_cache_pathname(cache_filename);
   if (pass != 0) {
     ostringstream strm;
     strm << cache_pathname.get_basename_wo_extension() << "_" << pass;
@@ -816,6 +1251,7 @@ read_record(const Filename &source_pathname,
     }
     PT(BamCacheRecord) record =
       new BamCacheRecord(source_pathname, cache_filename);
+    record->_content_key = content_key;
     record->_cache_pathname = cache_pathname;
     return record;
   }
@@ -833,15 +1269,48 @@ read_record(const Filename &source_pathname,
         << "Deleting invalid cache file " << cache_pathname << "\n";
     }
     vfs->delete_file(cache_pathname);
-    remove_from_index(source_pathname);
+    remove_from_index(shard, BamCacheIndex::make_key(source_pathname, content_key));
 
     PT(BamCacheRecord) record =
       new BamCacheRecord(source_pathname, cache_filename);
+    record->_content_key = content_key;
     record->_cache_pathname = cache_pathname;
     return record;
   }
 
-  if (record->get_source_pathname() != source_pathname) {
+  if (!content_key.empty()) {
+    if (record->get_content_key() != content_key) {
+      // This might be just a hash conflict.
+      if (util_cat.is_debug()) {
+        util_cat.debug()
+          << "Cache file " << cache_pathname << " has content key "
+          << record->get_content_key() << ", not " << content_key << "\n";
+      }
+      return nullptr;
+    }
+
+    // The record may have been written on another machine, or for another
+    // copy of the same file.  Either way, it now belongs to this one, unless
+    // the other copy found its textures and such relative to a different
+    // directory; then the cached data refers to the wrong files, and the
+    // caller will have to reload it.
+    if (!record->relocate_source(source_pathname)) {
+      if (util_cat.is_debug()) {
+        util_cat.debug()
+          << "Cache file " << cache_pathname << " was written for "
+          << record->get_source_pathname() << ", not "
+          << source_pathname << "\n";
+      }
+      record->clear_data();
+      record->clear_dependent_files();
+      record->_source_pathname = source_pathname;
+    }
+    PT(VirtualFile) source_file = vfs->get_file(source_pathname);
+    if (source_file != nullptr) {
+      record->_source_timestamp = source_file->get_timestamp();
+    }
+
+  } else if (record->get_source_pathname() != source_pathname) {
     // This might be just a hash conflict.
     if (util_cat.is_debug()) {
       util_cat.debug()
@@ -959,6 +1428,43 @@ do_read_record(const Filename &cache_pathname, bool read_data) {
   return record;
 }
 
+/**
+ * Returns the name to use for a cache file in content-addressed mode: a hash
+ * of the source file contents, together with everything else that affects
+ * the cached object.  Returns the empty string if the source file can't be
+ * read.
+ */
+string BamCache::
+make_content_key(const Filename &source_pathname, const string &cache_extension,
+                 const string &options_key) const {
+#ifdef HAVE_OPENSSL
+  HashVal source_hash;
+  if (!source_hash.hash_file(source_pathname)) {
+    return string();
+  }
+
+  string salt;
+  {
+    ReMutexHolder holder(_lock);
+    salt = _content_salt;
+  }
+
+  ostringstream strm;
+  strm << source_hash.as_hex() << " " << cache_extension
+       << " " << options_key
+       << " " << PandaSystem::get_version_string()
+       << " " << _bam_major_ver << "." << _bam_minor_ver
+       << " " << salt;
+
+  HashVal hv;
+  hv.hash_string(strm.str());
+  return hv.as_hex();
+
+#else  // HAVE_OPENSSL
+  return string();
+#endif  // HAVE_OPENSSL
+}
+
 /**
  * Returns the appropriate filename to use for a cache file, given the
  * fullpath string to the source filename.
@@ -989,6 +1495,94 @@ hash_filename(const string &filename) {
 #endif  // HAVE_OPENSSL
 }
 
+/**
+ * Returns the index of the shard that holds the indicated cache file, which
+ * is given by the first hex digit of its basename.
+ */
+int BamCache::
+get_shard_index(const Filename &cache_filename) {
+  string basename = cache_filename.get_basename();
+  if (basename.empty()) {
+    return 0;
+  }
+
+  char ch = basename[0];
+  if (ch >= '0' && ch <= '9') {
+    return ch - '0';
+  } else if (ch >= 'a' && ch <= 'f') {
+    return ch - 'a' + 10;
+  } else if (ch >= 'A' && ch <= 'F') {
+    return ch - 'A' + 10;
+  }
+  return 0;
+}
+
+/**
+ *
+ */
+BamCache::Shard::
+Shard() :
+  _index(nullptr),
+  _index_stale_since(0),
+  _cache_kbytes(0)
+{
+}
+
+/**
+ * Returns the full pathname of the indicated cache file, which must belong to
+ * this shard.
+ */
+Filename BamCache::Shard::
+get_cache_pathname(const Filename &cache_filename) const {
+  return Filename(_dir, Filename(cache_filename.get_basename()));
+}
+
+/**
+ *
+ */
+BamCache::FlushThread::
+FlushThread(BamCache *cache) :
+  Thread("BamCacheFlush", "BamCacheFlush"),
+  _cache(cache),
+  _cvar(_lock),
+  _stop(false)
+{
+}
+
+/**
+ * Signals the thread to exit, and waits for it to do so.
+ */
+void BamCache::FlushThread::
+stop() {
+  {
+    MutexHolder holder(_lock);
+    _stop = true;
+    _cvar.notify();
+  }
+  join();
+}
+
+/**
+ * The main loop of the flush thread.
+ */
+void BamCache::FlushThread::
+thread_main() {
+  while (true) {
+    double flush_time = (double)std::max(_cache->get_flush_time(), 1);
+    {
+      MutexHolder holder(_lock);
+      if (!_stop) {
+        _cvar.wait(flush_time);
+      }
+      if (_stop) {
+        return;
+      }
+    }
+
+    _cache->flush_stale_indexes(true);
+  }
+}
+
 /**
  * Constructs the global BamCache object.
  */
@@ -16,12 +16,18 @@
 
 #include "pandabase.h"
 #include "bamCacheRecord.h"
+#include "bamCacheStore.h"
 #include "pointerTo.h"
 #include "filename.h"
 #include "pmap.h"
 #include "pvector.h"
 #include "reMutex.h"
 #include "reMutexHolder.h"
+#include "lightMutexHolder.h"
+#include "pmutex.h"
+#include "conditionVar.h"
+#include "thread.h"
+#include "atomicAdjust.h"
 
 #include <time.h>
 
@@ -38,6 +44,17 @@ class BamCacheIndex;
  * multiple different processes writing to the same index, and without relying
  * too heavily on low-level os-provided file locks (which work poorly with C++
  * iostreams).
+ *
+ * The cache files are divided among a number of shards, according to the
+ * first hex digit of their hashed filename.  Each shard is a subdirectory of
+ * the cache root with its own index and its own lock, so that several threads
+ * may look up and store cache files at the same time.  Stale indexes are
+ * written to disk by a background thread, if threading is available.
+ *
+ * Normally, cache files are named by the source pathname, and are validated
+ * against the timestamps of the source files.  In content-addressed mode,
+ * they are instead named by a hash of the source file contents, so that they
+ * may also be shared with other machines through a BamCacheStore.
  */
 class EXPCL_PANDA_PUTIL BamCache {
 PUBLISHED:
@@ -71,8 +88,15 @@ PUBLISHED:
   INLINE void set_read_only(bool ro);
   INLINE bool get_read_only() const;
 
+  void set_content_addressed(bool flag);
+  INLINE bool get_content_addressed() const;
+
+  INLINE void set_store(BamCacheStore *store);
+  INLINE BamCacheStore *get_store() const;
+
   PT(BamCacheRecord) lookup(const Filename &source_filename,
-                            const std::string &cache_extension);
+                            const std::string &cache_extension,
+                            const std::string &options_key = std::string());
   bool store(BamCacheRecord *record);
 
   void consider_flush_index();
@@ -80,6 +104,13 @@ PUBLISHED:
 
   void list_index(std::ostream &out, int indent_level = 0) const;
 
+  INLINE int get_num_hits() const;
+  INLINE int get_num_misses() const;
+  INLINE int get_num_stores() const;
+  INLINE int get_num_evictions() const;
+  INLINE double get_lookup_time() const;
+  INLINE double get_store_time() const;
+
   INLINE static BamCache *get_global_ptr();
   INLINE static void consider_flush_global_index();
   INLINE static void flush_global_index();
@@ -96,34 +127,97 @@ PUBLISHED:
   MAKE_PROPERTY(flush_time, get_flush_time, set_flush_time);
   MAKE_PROPERTY(cache_max_kbytes, get_cache_max_kbytes, set_cache_max_kbytes);
   MAKE_PROPERTY(read_only, get_read_only, set_read_only);
+  MAKE_PROPERTY(content_addressed, get_content_addressed, set_content_addressed);
+  MAKE_PROPERTY(store, get_store, set_store);
 
 private:
-  void read_index();
-  bool read_index_pathname(Filename &index_pathname,
+  enum { num_shards = 16 };
+
+  // One subdirectory of the cache, with its own index.  The members are
+  // protected by _lock.  A thread should not hold the lock of more than one
+  // shard at a time, except in set_root(), which acquires them in order; and
+  // it should not acquire a shard lock while holding the BamCache's _lock.
+  class Shard {
+  public:
+    Shard();
+
+    Filename get_cache_pathname(const Filename &cache_filename) const;
+
+    ReMutex _lock;
+    Filename _dir;
+    BamCacheIndex *_index;
+    time_t _index_stale_since;
+
+    // The size of the files in _index, in kilobytes, as last added to the
+    // BamCache's _total_cache_kbytes.
+    int _cache_kbytes;
+
+    Filename _index_pathname;
+    std::string _index_ref_contents;
+  };
+
+  // This thread writes the stale shard indexes to disk every flush_time
+  // seconds, so that the loading threads don't have to.
+  class FlushThread : public Thread {
+  public:
+    FlushThread(BamCache *cache);
+
+    void stop();
+
+  protected:
+    virtual void thread_main();
+
+  private:
+    BamCache *_cache;
+
+    Mutex _lock;
+    ConditionVar _cvar;
+    bool _stop;
+  };
+
+  void start_flush_thread();
+  void stop_flush_thread();
+  void flush_stale_indexes(bool wait);
+
+  bool do_store(Shard &shard, BamCacheRecord *record);
+
+  void flush_shard_index(Shard &shard);
+  void read_index(Shard &shard);
+  bool read_index_pathname(const Shard &shard, Filename &index_pathname,
                            std::string &index_ref_contents) const;
-  void merge_index(BamCacheIndex *new_index);
-  void rebuild_index();
-  INLINE void mark_index_stale();
+  void merge_index(Shard &shard, BamCacheIndex *new_index);
+  void rebuild_index(Shard &shard);
+  INLINE static void mark_index_stale(Shard &shard);
 
-  void add_to_index(const BamCacheRecord *record);
-  void remove_from_index(const Filename &source_filename);
+  void add_to_index(Shard &shard, const BamCacheRecord *record);
+  void remove_from_index(Shard &shard, const Filename &key);
+  void update_cache_size(Shard &shard);
 
   void check_cache_size();
+  void migrate_legacy_files();
 
   void emergency_read_only();
 
   static BamCacheIndex *do_read_index(const Filename &index_pathname);
   static bool do_write_index(const Filename &index_pathname, const BamCacheIndex *index);
 
-  PT(BamCacheRecord) find_and_read_record(const Filename &source_pathname,
-                                          const Filename &cache_filename);
-  PT(BamCacheRecord) read_record(const Filename &source_pathname,
+  PT(BamCacheRecord) find_and_read_record(Shard &shard,
+                                          const Filename &source_pathname,
+                                          const Filename &cache_filename,
+                                          const std::string &content_key);
+  PT(BamCacheRecord) read_record(Shard &shard,
+                                 const Filename &source_pathname,
                                  const Filename &cache_filename,
+                                 const std::string &content_key,
                                  int pass);
   static PT(BamCacheRecord) do_read_record(const Filename &cache_pathname,
                                            bool read_data);
 
+  std::string make_content_key(const Filename &source_pathname,
+                               const std::string &cache_extension,
+                               const std::string &options_key) const;
   static std::string hash_filename(const std::string &filename);
+  static int get_shard_index(const Filename &cache_filename);
   static void make_global();
 
   bool _active;
@@ -135,13 +229,27 @@ private:
   Filename _root;
   int _flush_time;
   int _max_kbytes;
+  bool _content_addressed;
+  std::string _content_salt;
+  PT(BamCacheStore) _store;
   static BamCache *_global_ptr;
 
-  BamCacheIndex *_index;
-  time_t _index_stale_since;
-
-  Filename _index_pathname;
-  std::string _index_ref_contents;
+  Shard _shards[num_shards];
+  PT(FlushThread) _flush_thread;
+  bool _use_flush_thread;
+
+  // The sum of the _cache_kbytes of all of the shards, so that store() can
+  // check the cache size without visiting every shard.
+  AtomicAdjust::Integer _total_cache_kbytes;
+
+  // These are protected by _stats_lock.
+  int _num_hits;
+  int _num_misses;
+  int _num_stores;
+  int _num_evictions;
+  double _lookup_time;
+  double _store_time;
+  LightMutex _stats_lock;
 
   ReMutex _lock;
 };
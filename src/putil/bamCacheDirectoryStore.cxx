@@ -0,0 +1,140 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file bamCacheDirectoryStore.cxx
+ * @author lachbr
+ * @date 2026-10-18
+ */
+
+#include "bamCacheDirectoryStore.h"
+#include "config_putil.h"
+#include "virtualFileSystem.h"
+
+TypeHandle BamCacheDirectoryStore::_type_handle;
+
+/**
+ *
+ */
+BamCacheDirectoryStore::
+BamCacheDirectoryStore(const Filename &root, bool read_only) :
+  _root(root),
+  _read_only(read_only)
+{
+}
+
+/**
+ *
+ */
+BamCacheDirectoryStore::
+~BamCacheDirectoryStore() {
+}
+
+/**
+ * Returns the full pathname at which the named entry is, or would be,
+ * stored.  Entries are spread among subdirectories by the first two
+ * characters of their name, to keep the directories to a manageable size.
+ */
+Filename BamCacheDirectoryStore::
+get_entry_pathname(const std::string &name) const {
+  Filename dirname(_root, Filename(name.substr(0, 2)));
+  return Filename(dirname, Filename(name));
+}
+
+/**
+ * Copies the named entry out of the store to the indicated local pathname.
+ * Returns true on success, or false if the store doesn't have the entry or it
+ * could not be copied.
+ */
+bool BamCacheDirectoryStore::
+fetch(const std::string &name, const Filename &pathname) {
+  VirtualFileSystem *vfs = VirtualFileSystem::get_global_ptr();
+  Filename entry_pathname = Filename::binary_filename(get_entry_pathname(name));
+  if (!vfs->exists(entry_pathname)) {
+    return false;
+  }
+
+  // Copy it next to the destination first, so that no one sees a partial
+  // file at the destination.
+  Filename temp_pathname = Filename::temporary(pathname.get_dirname(), "fetch-", ".tmp");
+  temp_pathname.set_binary();
+  if (!vfs->copy_file(entry_pathname, temp_pathname)) {
+    util_cat.warning()
+      << "Unable to copy " << entry_pathname << " from cache store.\n";
+    vfs->delete_file(temp_pathname);
+    return false;
+  }
+
+  if (!vfs->rename_file(temp_pathname, pathname)) {
+    vfs->delete_file(temp_pathname);
+    return vfs->exists(pathname);
+  }
+
+  if (util_cat.is_debug()) {
+    util_cat.debug()
+      << "Fetched " << entry_pathname << " from cache store.\n";
+  }
+  return true;
+}
+
+/**
+ * Copies the indicated local file into the store under the indicated name,
+ * unless the store already has an entry by that name.  Returns true if the
+ * store now has the entry, false if it could not be published.
+ */
+bool BamCacheDirectoryStore::
+publish(const std::string &name, const Filename &pathname) {
+  if (_read_only) {
+    return false;
+  }
+
+  VirtualFileSystem *vfs = VirtualFileSystem::get_global_ptr();
+  Filename entry_pathname = Filename::binary_filename(get_entry_pathname(name));
+  if (vfs->exists(entry_pathname)) {
+    // Some other machine got there first.  Since the name is derived from
+    // the contents, its file is as good as ours.
+    return true;
+  }
+
+  Filename dirname = entry_pathname.get_dirname();
+  if (!vfs->is_directory(dirname)) {
+    vfs->make_directory_full(dirname);
+  }
+
+  Filename temp_pathname = Filename::temporary(dirname, "publish-", ".tmp");
+  temp_pathname.set_binary();
+  if (!vfs->copy_file(Filename::binary_filename(pathname), temp_pathname)) {
+    util_cat.warning()
+      << "Unable to copy " << pathname << " to cache store " << _root << "\n";
+    vfs->delete_file(temp_pathname);
+    return false;
+  }
+
+  if (!vfs->rename_file(temp_pathname, entry_pathname)) {
+    // We may have lost a race with another machine publishing the same
+    // entry, which is fine.
+    vfs->delete_file(temp_pathname);
+    return vfs->exists(entry_pathname);
+  }
+
+  if (util_cat.is_debug()) {
+    util_cat.debug()
+      << "Published " << entry_pathname << " to cache store.\n";
+  }
+  return true;
+}
+
+/**
+ *
+ */
+void BamCacheDirectoryStore::
+output(std::ostream &out) const {
+  out << get_type() << " " << _root;
+  if (_read_only) {
+    out << " (read-only)";
+  }
+}
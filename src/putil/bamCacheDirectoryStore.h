@@ -0,0 +1,71 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file bamCacheDirectoryStore.h
+ * @author lachbr
+ * @date 2026-10-18
+ */
+
+#ifndef BAMCACHEDIRECTORYSTORE_H
+#define BAMCACHEDIRECTORYSTORE_H
+
+#include "pandabase.h"
+#include "bamCacheStore.h"
+
+/**
+ * A BamCacheStore that keeps its entries in a directory, which may be on a
+ * network share visible to several machines.  Entries are written to a
+ * temporary file and renamed into place, so readers never see a partial
+ * file.  Since entries are named by content, an entry that already exists is
+ * never rewritten.
+ *
+ * Machines that should only consume the cache, such as render nodes, may
+ * open the store read-only.
+ */
+class EXPCL_PANDA_PUTIL BamCacheDirectoryStore : public BamCacheStore {
+PUBLISHED:
+  explicit BamCacheDirectoryStore(const Filename &root, bool read_only = false);
+  virtual ~BamCacheDirectoryStore();
+
+  INLINE const Filename &get_root() const;
+  INLINE bool get_read_only() const;
+  MAKE_PROPERTY(root, get_root);
+  MAKE_PROPERTY(read_only, get_read_only);
+
+  Filename get_entry_pathname(const std::string &name) const;
+
+  virtual bool fetch(const std::string &name, const Filename &pathname);
+  virtual bool publish(const std::string &name, const Filename &pathname);
+
+  virtual void output(std::ostream &out) const;
+
+private:
+  Filename _root;
+  bool _read_only;
+
+public:
+  static TypeHandle get_class_type() {
+    return _type_handle;
+  }
+  static void init_type() {
+    BamCacheStore::init_type();
+    register_type(_type_handle, "BamCacheDirectoryStore",
+                  BamCacheStore::get_class_type());
+  }
+  virtual TypeHandle get_type() const {
+    return get_class_type();
+  }
+  virtual TypeHandle force_init_type() {init_type(); return get_class_type();}
+
+private:
+  static TypeHandle _type_handle;
+};
+
+#include "bamCacheDirectoryStore.I"
+
+#endif
@@ -115,28 +115,42 @@ evict_old_file() {
 
   // The first record in the linked list is the least-recently-used one.
   PT(BamCacheRecord) record = (BamCacheRecord *)_next;
-  bool removed = remove_record(record->get_source_pathname());
+  bool removed = remove_record(get_key(record));
   nassertr(removed, nullptr);
 
   return record;
 }
 
+/**
+ * Returns the record that evict_old_file() would remove, without removing
+ * it, or NULL if the cache is empty.
+ */
+BamCacheRecord *BamCacheIndex::
+get_old_file() const {
+  if (_next == this) {
+    return nullptr;
+  }
+  return (BamCacheRecord *)_next;
+}
+
 /**
  * Adds a newly-created BamCacheRecord into the index.  If a matching record
  * is already in the index, it is replaced with the new record.  Returns true
  * if the record was added, or false if the equivalent record was already
- * there and the index is unchanged.
+ * there; in that case only its access time is updated.
  */
 bool BamCacheIndex::
 add_record(BamCacheRecord *record) {
   std::pair<Records::iterator, bool> result =
-    _records.insert(Records::value_type(record->get_source_pathname(), record));
+    _records.insert(Records::value_type(get_key(record), record));
   if (!result.second) {
     // We already had a record for this filename; it gets replaced.
     BamCacheRecord *orig_record = (*result.first).second;
     orig_record->remove_from_list();
     if (*orig_record == *record) {
-      // Well, never mind.  The record hasn't changed.
+      // Well, never mind.  The record hasn't changed, except that it has just
+      // been accessed, which moves it to the end of the list.
+      orig_record->_record_access_time = record->_record_access_time;
       orig_record->insert_before(this);
       return false;
     }
@@ -156,8 +170,8 @@ add_record(BamCacheRecord *record) {
  * was no such record and the index is unchanged.
  */
 bool BamCacheIndex::
-remove_record(const Filename &source_pathname) {
-  Records::iterator ri = _records.find(source_pathname);
+remove_record(const Filename &key) {
+  Records::iterator ri = _records.find(key);
   if (ri == _records.end()) {
     // No entry for this record; no problem.
     return false;
@@ -223,7 +237,7 @@ complete_pointers(TypedWritable **p_list, BamReader *manager) {
     PT(BamCacheRecord) record = DCAST(BamCacheRecord, p_list[pi++]);
     (*vi) = record;
 
-    bool inserted = _records.insert(Records::value_type(record->get_source_pathname(), record)).second;
+    bool inserted = _records.insert(Records::value_type(get_key(record), record)).second;
     if (!inserted) {
       util_cat.info()
         << "Multiple cache files defining " << record->get_source_pathname()
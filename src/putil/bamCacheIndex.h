@@ -42,11 +42,18 @@ private:
   void process_new_records();
   void release_records();
   PT(BamCacheRecord) evict_old_file();
+  BamCacheRecord *get_old_file() const;
 
   bool add_record(BamCacheRecord *record);
-  bool remove_record(const Filename &source_pathname);
+  bool remove_record(const Filename &key);
+
+  INLINE static Filename make_key(const Filename &source_pathname,
+                                  const std::string &content_key);
+  INLINE static Filename get_key(const BamCacheRecord *record);
 
 private:
+  // The records are keyed by source pathname; or, in content-addressed mode,
+  // by content key, since several source files may share one cache file.
   typedef pmap<Filename, PT(BamCacheRecord) > Records;
 
   Records _records;
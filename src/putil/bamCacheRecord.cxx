@@ -62,6 +62,7 @@ BamCacheRecord(const BamCacheRecord &copy) :
   _recorded_time(copy._recorded_time),
   _record_size(copy._record_size),
   _source_timestamp(copy._source_timestamp),
+  _content_key(copy._content_key),
   _ptr(nullptr),
   _ref_ptr(nullptr),
   _record_access_time(copy._record_access_time)
@@ -92,6 +93,12 @@ dependents_unchanged() const {
   DependentFiles::const_iterator fi;
   for (fi = _files.begin(); fi != _files.end(); ++fi) {
     const DependentFile &dfile = (*fi);
+    if (!_content_key.empty() && dfile._pathname == _source_pathname) {
+      // The source file's contents are already part of the content key, and
+      // its pathname is the one on the machine that wrote the record.
+      continue;
+    }
+
     PT(VirtualFile) file = vfs->get_file(dfile._pathname);
     if (file == nullptr) {
       // No such file.
@@ -102,6 +109,18 @@ dependents_unchanged() const {
         }
         return false;
       }
+    } else if (!_content_key.empty()) {
+      // Timestamps aren't meaningful across machines, so compare contents.
+      HashVal hash;
+      hash_dependent_file(dfile._pathname, hash);
+      if (hash != dfile._hash) {
+        if (util_cat.is_debug()) {
+          util_cat.debug()
+            << dfile._pathname << " has changed contents.\n";
+        }
+        return false;
+      }
+
     } else {
       if (file->get_timestamp() != dfile._timestamp ||
           file->get_file_size() != dfile._size) {
@@ -161,6 +180,7 @@ add_dependent_file(const Filename &pathname) {
   } else {
     dfile._timestamp = file->get_timestamp();
     dfile._size = file->get_file_size();
+    hash_dependent_file(dfile._pathname, dfile._hash);
 
     if (dfile._pathname == _source_pathname) {
       _source_timestamp = dfile._timestamp;
@@ -180,6 +200,7 @@ add_dependent_file(const VirtualFile *file) {
 
   dfile._timestamp = file->get_timestamp();
   dfile._size = file->get_file_size();
+  hash_dependent_file(dfile._pathname, dfile._hash);
 
   if (dfile._pathname == _source_pathname) {
     _source_timestamp = dfile._timestamp;
@@ -218,6 +239,59 @@ write(std::ostream &out, int indent_level) const {
   }
 }
 
+/**
+ * Moves a content-addressed record, which may have been written for a copy of
+ * the same source file in another directory, over to the indicated source
+ * pathname.  Returns false if any of the dependent files would be found
+ * somewhere else relative to the new source file; the cached data still
+ * references the old ones, so the record can't be used for this source.
+ */
+bool BamCacheRecord::
+relocate_source(const Filename &source_pathname) {
+  Filename old_dirname = _source_pathname.get_dirname();
+  Filename new_dirname = source_pathname.get_dirname();
+
+  DependentFiles::iterator fi;
+  for (fi = _files.begin(); fi != _files.end(); ++fi) {
+    DependentFile &dfile = (*fi);
+    if (dfile._pathname == _source_pathname) {
+      dfile._pathname = source_pathname;
+      continue;
+    }
+
+    Filename relative = dfile._pathname;
+    if (relative.make_relative_to(old_dirname)) {
+      Filename resolved(new_dirname, relative);
+      resolved.standardize();
+      if (resolved != dfile._pathname) {
+        if (util_cat.is_debug()) {
+          util_cat.debug()
+            << dfile._pathname << " would be " << resolved << " for "
+            << source_pathname << ".\n";
+        }
+        return false;
+      }
+    }
+  }
+
+  _source_pathname = source_pathname;
+  return true;
+}
+
+/**
+ * Computes the hash of the indicated dependent file's contents, if this is a
+ * content-addressed record.  Otherwise, or if the file can't be read, leaves
+ * the hash at its default value.
+ */
+void BamCacheRecord::
+hash_dependent_file(const Filename &pathname, HashVal &hash) const {
+#ifdef HAVE_OPENSSL
+  if (!_content_key.empty()) {
+    hash.hash_file(pathname);
+  }
+#endif  // HAVE_OPENSSL
+}
+
 /**
  * Returns a timestamp value formatted nicely for output.
  */
@@ -279,6 +353,15 @@ write_datagram(BamWriter *manager, Datagram &dg) {
     dg.add_uint32(file._timestamp);
     dg.add_uint64(file._size);
   }
+
+  if (manager->get_file_minor_ver() >= 48) {
+    dg.add_string(_content_key);
+    if (!_content_key.empty()) {
+      for (fi = _files.begin(); fi != _files.end(); ++fi) {
+        (*fi)._hash.write_datagram(dg);
+      }
+    }
+  }
 }
 
 /**
@@ -326,4 +409,13 @@ fillin(DatagramIterator &scan, BamReader *manager) {
       _source_timestamp = file._timestamp;
     }
   }
+
+  if (manager->get_file_minor_ver() >= 48) {
+    _content_key = scan.get_string();
+    if (!_content_key.empty()) {
+      for (DependentFile &file : _files) {
+        file._hash.read_datagram(scan);
+      }
+    }
+  }
 }
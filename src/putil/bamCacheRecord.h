@@ -18,6 +18,7 @@
 #include "typedWritableReferenceCount.h"
 #include "pointerTo.h"
 #include "linkedListNode.h"
+#include "hashVal.h"
 
 class BamWriter;
 class BamReader;
@@ -51,11 +52,13 @@ PUBLISHED:
   INLINE const Filename &get_cache_filename() const;
   INLINE time_t get_source_timestamp() const;
   INLINE time_t get_recorded_time() const;
+  INLINE const std::string &get_content_key() const;
 
   MAKE_PROPERTY(source_pathname, get_source_pathname);
   MAKE_PROPERTY(cache_filename, get_cache_filename);
   MAKE_PROPERTY(source_timestamp, get_source_timestamp);
   MAKE_PROPERTY(recorded_time, get_recorded_time);
+  MAKE_PROPERTY(content_key, get_content_key);
 
   INLINE int get_num_dependent_files() const;
   INLINE const Filename &get_dependent_pathname(int n) const;
@@ -87,6 +90,8 @@ private:
   };
 
   static std::string format_timestamp(time_t timestamp);
+  bool relocate_source(const Filename &source_pathname);
+  void hash_dependent_file(const Filename &pathname, HashVal &hash) const;
 
   Filename _source_pathname;
   Filename _cache_filename;
@@ -94,11 +99,17 @@ private:
   std::streamsize _record_size;  // this is accurate only in the index file.
   time_t _source_timestamp;  // Not record to the cache file.
 
+  // This is empty unless the record was created by a BamCache in content-
+  // addressed mode, in which case it is the hash that names the cache file,
+  // and the dependent files are validated by their contents.
+  std::string _content_key;
+
   class DependentFile {
   public:
     Filename _pathname;
     time_t _timestamp;
     std::streamsize _size;
+    HashVal _hash;
   };
 
   typedef pvector<DependentFile> DependentFiles;
@@ -0,0 +1,38 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file bamCacheStore.cxx
+ * @author lachbr
+ * @date 2026-10-18
+ */
+
+#include "bamCacheStore.h"
+
+TypeHandle BamCacheStore::_type_handle;
+
+/**
+ *
+ */
+BamCacheStore::
+BamCacheStore() {
+}
+
+/**
+ *
+ */
+BamCacheStore::
+~BamCacheStore() {
+}
+
+/**
+ *
+ */
+void BamCacheStore::
+output(std::ostream &out) const {
+  out << get_type();
+}
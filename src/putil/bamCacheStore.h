@@ -0,0 +1,75 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file bamCacheStore.h
+ * @author lachbr
+ * @date 2026-10-18
+ */
+
+#ifndef BAMCACHESTORE_H
+#define BAMCACHESTORE_H
+
+#include "pandabase.h"
+#include "typedReferenceCount.h"
+#include "filename.h"
+
+/**
+ * This is an abstract base class for a shared repository of cache files,
+ * which the BamCache consults when it is in content-addressed mode (see
+ * BamCache::set_content_addressed()).
+ *
+ * Entries in the store are named by the hash of the source file contents, so
+ * a file cooked on one machine may be used by any other machine that loads
+ * the same source file with the same options and the same version of Panda.
+ * The BamCache always keeps its own local copy of each entry; the store is
+ * only consulted on a local miss, and is given each newly cooked file.
+ */
+class EXPCL_PANDA_PUTIL BamCacheStore : public TypedReferenceCount {
+protected:
+  BamCacheStore();
+
+PUBLISHED:
+  virtual ~BamCacheStore();
+
+  // Copies the named entry out of the store to the indicated local pathname.
+  // Returns true on success, or false if the store doesn't have the entry or
+  // it could not be copied.  The local file should not appear until it is
+  // complete, since this is called without holding the cache's lock.
+  virtual bool fetch(const std::string &name, const Filename &pathname)=0;
+
+  // Offers the indicated local file to the store under the indicated name.
+  // Returns true if the store now has the entry, whether or not it was copied
+  // by this call, or false if it could not be published.
+  virtual bool publish(const std::string &name, const Filename &pathname)=0;
+
+  virtual void output(std::ostream &out) const;
+
+public:
+  static TypeHandle get_class_type() {
+    return _type_handle;
+  }
+  static void init_type() {
+    TypedReferenceCount::init_type();
+    register_type(_type_handle, "BamCacheStore",
+                  TypedReferenceCount::get_class_type());
+  }
+  virtual TypeHandle get_type() const {
+    return get_class_type();
+  }
+  virtual TypeHandle force_init_type() {init_type(); return get_class_type();}
+
+private:
+  static TypeHandle _type_handle;
+};
+
+INLINE std::ostream &operator << (std::ostream &out, const BamCacheStore &store) {
+  store.output(out);
+  return out;
+}
+
+#endif
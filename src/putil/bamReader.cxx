@@ -19,6 +19,7 @@
 #include "datagramIterator.h"
 #include "config_putil.h"
 #include "pipelineCyclerBase.h"
+#include "mutexHolder.h"
 
 using std::string;
 
@@ -49,6 +50,8 @@ BamReader(DatagramGenerator *source)
   _pta_id = -1;
   _long_object_id = false;
   _long_pta_id = false;
+  _read_ahead_size = (size_t)std::max((int)bam_read_ahead_size, 0);
+  _read_ahead_pos = 0;
 }
 
 
@@ -57,6 +60,7 @@ BamReader(DatagramGenerator *source)
  */
 BamReader::
 ~BamReader() {
+  stop_read_ahead();
   nassertv(_num_extra_objects == 0);
   nassertv(_nesting_level == 0);
 }
@@ -67,6 +71,7 @@ BamReader::
  */
 void BamReader::
 set_source(DatagramGenerator *source) {
+  stop_read_ahead();
   _source = source;
   if (_needs_init && _source != nullptr) {
     bool success = init();
@@ -247,6 +252,10 @@ read_object(TypedWritable *&ptr, ReferenceCount *&ref_ptr) {
   ref_ptr = nullptr;
   nassertr(_num_extra_objects == 0, false);
 
+  if (_read_ahead == nullptr && _read_ahead_size != 0 && !_needs_init) {
+    start_read_ahead();
+  }
+
   int start_level = _nesting_level;
 
   // First, read the base object.
@@ -685,6 +694,22 @@ read_file_data(SubfileInfo &info) {
   _file_data_records.pop_front();
 }
 
+/**
+ * Makes the file data block returned by read_file_data() available in memory.
+ * If possible, and bam-map-file-data is true, it is mapped directly from the
+ * file; otherwise, it is read into memory.  Returns NULL on failure.
+ */
+PT(FileMapping) BamReader::
+map_file_data(const SubfileInfo &info) {
+  PT(FileMapping) mapping = new FileMapping;
+  if (!mapping->open(info, bam_map_file_data)) {
+    bam_cat.error()
+      << "Unable to load file data " << info << "\n";
+    return nullptr;
+  }
+  return mapping;
+}
+
 /**
  * Reads in the indicated CycleData object.  This should be used by classes
  * that store some or all of their data within a CycleData subclass, in
@@ -1101,11 +1126,20 @@ p_read_object() {
     // we can hand it to a future object who may request it.
     {
       SubfileInfo info;
-      if (!_source->save_datagram(info)) {
+      if (!save_datagram(info)) {
         bam_cat.error()
           << "Failed to read file data.\n";
         return 0;
       }
+
+      // Since bam version 6.47, the token may be followed by the number of
+      // bytes of alignment padding at the start of the data.
+      if (scan.get_remaining_size() >= 4) {
+        std::streamsize padding = scan.get_uint32();
+        nassertr(padding <= info.get_size(), 0);
+        info = SubfileInfo(info.get_file(), info.get_start() + padding,
+                           info.get_size() - padding);
+      }
       _file_data_records.push_back(info);
     }
 
@@ -1546,3 +1580,191 @@ finalize() {
     }
   }
 }
+
+/**
+ * Skips over the next datagram in the stream, recording its position within
+ * the file in the indicated SubfileInfo, so that it may be read later.
+ * Returns true on success, false on failure.
+ */
+bool BamReader::
+save_datagram(SubfileInfo &info) {
+  nassertr(_source != nullptr, false);
+  if (_read_ahead != nullptr) {
+    return _read_ahead->save_datagram(info);
+  }
+  return _source->save_datagram(info);
+}
+
+/**
+ * Spawns the thread that reads datagrams from the source ahead of
+ * p_read_object().  From this point until stop_read_ahead() is called, the
+ * source is only accessed by that thread.
+ */
+void BamReader::
+start_read_ahead() {
+  nassertv(_read_ahead == nullptr);
+  if (!Thread::is_threading_supported()) {
+    return;
+  }
+
+  _read_ahead_pos = _source->get_file_pos();
+  _read_ahead = new ReadAheadThread(_source, _read_ahead_size,
+                                    get_file_minor_ver() >= 21);
+  if (!_read_ahead->start(TP_normal, true)) {
+    _read_ahead.clear();
+  }
+}
+
+/**
+ * Stops the read-ahead thread, if it is running, and waits for it to finish.
+ * Any datagrams it has read but that have not yet been consumed are
+ * discarded.
+ */
+void BamReader::
+stop_read_ahead() {
+  if (_read_ahead != nullptr) {
+    _read_ahead->stop();
+    _read_ahead.clear();
+  }
+}
+
+/**
+ *
+ */
+BamReader::ReadAheadThread::
+ReadAheadThread(DatagramGenerator *source, size_t max_bytes,
+                bool file_data_codes) :
+  Thread("bam-read-ahead", "bam-read-ahead"),
+  _source(source),
+  _max_bytes(max_bytes),
+  _file_data_codes(file_data_codes),
+  _space_cvar(_lock),
+  _data_cvar(_lock),
+  _num_bytes(0),
+  _done(false),
+  _stop(false)
+{
+}
+
+/**
+ * Returns the next datagram read from the source, waiting for it if
+ * necessary.  Returns false at the end of the stream or on error.
+ */
+bool BamReader::ReadAheadThread::
+get_datagram(Datagram &datagram, std::streampos &file_pos) {
+  MutexHolder holder(_lock);
+  while (_records.empty() && !_done) {
+    _data_cvar.wait();
+  }
+  if (_records.empty()) {
+    return false;
+  }
+
+  Record &record = _records.front();
+  nassertr(!record._is_file_data, false);
+  _num_bytes -= record._datagram.get_length();
+  datagram = std::move(record._datagram);
+  file_pos = record._file_pos;
+  _records.pop_front();
+
+  _space_cvar.notify();
+  return true;
+}
+
+/**
+ * Returns the position of the file data datagram that was skipped over
+ * following the most recent BOC_file_data record.  Returns false on error.
+ */
+bool BamReader::ReadAheadThread::
+save_datagram(SubfileInfo &info) {
+  MutexHolder holder(_lock);
+  while (_records.empty() && !_done) {
+    _data_cvar.wait();
+  }
+  if (_records.empty() || !_records.front()._is_file_data) {
+    return false;
+  }
+
+  info = _records.front()._file_data;
+  _records.pop_front();
+  return true;
+}
+
+/**
+ * Returns true if all of the datagrams in the source have been consumed.
+ */
+bool BamReader::ReadAheadThread::
+is_eof() {
+  MutexHolder holder(_lock);
+  return _done && _records.empty() && _source->is_eof();
+}
+
+/**
+ * Tells the thread to stop reading, and waits for it to exit.
+ */
+void BamReader::ReadAheadThread::
+stop() {
+  {
+    MutexHolder holder(_lock);
+    _stop = true;
+    _space_cvar.notify();
+  }
+  join();
+}
+
+/**
+ * The main loop of the read-ahead thread.  Reads datagrams from the source
+ * until the end of the stream, or until it has _max_bytes of unconsumed data
+ * queued up, in which case it waits for the reader to catch up.
+ */
+void BamReader::ReadAheadThread::
+thread_main() {
+  while (true) {
+    {
+      MutexHolder holder(_lock);
+      while (_num_bytes >= _max_bytes && !_stop) {
+        _space_cvar.wait();
+      }
+      if (_stop) {
+        return;
+      }
+    }
+
+    // Now read the next datagram without holding the lock, so the reader can
+    // continue to consume the datagrams already queued.
+    Record record;
+    record._is_file_data = false;
+    bool success = !_source->is_error() && _source->get_datagram(record._datagram);
+    record._file_pos = _source->get_file_pos();
+    bool have_record = success;
+
+    // A BOC_file_data record is followed by a datagram of raw file data,
+    // which the reader will want to skip over and read later.  We must do
+    // that here, since the reader can't touch the source while we own it.
+    Record file_record;
+    file_record._is_file_data = false;
+    if (success && _file_data_codes && record._datagram.get_length() != 0 &&
+        *(const uint8_t *)record._datagram.get_data() == BOC_file_data) {
+      success = _source->save_datagram(file_record._file_data);
+      file_record._is_file_data = success;
+      file_record._file_pos = _source->get_file_pos();
+    }
+
+    MutexHolder holder(_lock);
+    if (have_record) {
+      _num_bytes += record._datagram.get_length();
+      _records.push_back(std::move(record));
+    }
+    if (file_record._is_file_data) {
+      _records.push_back(std::move(file_record));
+    }
+    if (!success) {
+      _done = true;
+    }
+    _data_cvar.notify();
+
+    if (_done) {
+      return;
+    }
+  }
+}
@@ -25,6 +25,7 @@
 #include "bamReaderParam.h"
 #include "bamEnums.h"
 #include "subfileInfo.h"
+#include "fileMapping.h"
 #include "loaderOptions.h"
 #include "factory.h"
 #include "vector_int.h"
@@ -34,6 +35,9 @@
 #include "dcast.h"
 #include "pipelineCyclerBase.h"
 #include "referenceCount.h"
+#include "thread.h"
+#include "pmutex.h"
+#include "conditionVar.h"
 
 #include <algorithm>
 
@@ -132,6 +136,9 @@ PUBLISHED:
   INLINE const LoaderOptions &get_loader_options() const;
   INLINE void set_loader_options(const LoaderOptions &options);
 
+  INLINE size_t get_read_ahead_size() const;
+  INLINE void set_read_ahead_size(size_t read_ahead_size);
+
   BLOCKING TypedWritable *read_object();
   BLOCKING bool read_object(TypedWritable *&ptr, ReferenceCount *&ref_ptr);
 
@@ -154,6 +161,7 @@ PUBLISHED:
   MAKE_PROPERTY(source, get_source, set_source);
   MAKE_PROPERTY(filename, get_filename);
   MAKE_PROPERTY(loader_options, get_loader_options, set_loader_options);
+  MAKE_PROPERTY(read_ahead_size, get_read_ahead_size, set_read_ahead_size);
 
   MAKE_PROPERTY(file_version, get_file_version);
   MAKE_PROPERTY(file_endian, get_file_endian);
@@ -167,6 +175,7 @@ public:
   void skip_pointer(DatagramIterator &scan);
 
   void read_file_data(SubfileInfo &info);
+  PT(FileMapping) map_file_data(const SubfileInfo &info);
 
   void read_cdata(DatagramIterator &scan, PipelineCyclerBase &cycler);
   void read_cdata(DatagramIterator &scan, PipelineCyclerBase &cycler,
@@ -220,6 +229,10 @@ private:
   void finalize();
 
   INLINE bool get_datagram(Datagram &datagram);
+  bool save_datagram(SubfileInfo &info);
+
+  void start_read_ahead();
+  void stop_read_ahead();
 
 public:
   // Inherit from this class to piggyback additional temporary data on the
@@ -237,6 +250,48 @@ private:
   DatagramGenerator *_source;
   bool _needs_init;
 
+  // This thread reads datagrams from the source ahead of the objects that
+  // are being constructed from them, if read_ahead_size is nonzero.
+  class ReadAheadThread : public Thread {
+  public:
+    ReadAheadThread(DatagramGenerator *source, size_t max_bytes,
+                    bool file_data_codes);
+
+    bool get_datagram(Datagram &datagram, std::streampos &file_pos);
+    bool save_datagram(SubfileInfo &info);
+    bool is_eof();
+    void stop();
+
+  protected:
+    virtual void thread_main();
+
+  private:
+    class Record {
+    public:
+      Datagram _datagram;
+      SubfileInfo _file_data;
+      bool _is_file_data;
+      std::streampos _file_pos;
+    };
+    typedef pdeque<Record> Records;
+
+    DatagramGenerator *_source;
+    size_t _max_bytes;
+    bool _file_data_codes;
+
+    // The following members are protected by _lock.
+    Mutex _lock;
+    ConditionVar _space_cvar;
+    ConditionVar _data_cvar;
+    Records _records;
+    size_t _num_bytes;
+    bool _done;
+    bool _stop;
+  };
+  PT(ReadAheadThread) _read_ahead;
+  size_t _read_ahead_size;
+  std::streampos _read_ahead_pos;
+
   bool _long_object_id;
   bool _long_pta_id;
 
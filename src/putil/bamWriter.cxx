@@ -100,6 +100,8 @@ BamWriter(DatagramSink *target) :
   _file_endian = bam_endian;
   _file_stdfloat_double = bam_stdfloat_double;
   _file_texture_mode = bam_texture_mode;
+  _file_data_alignment = (size_t)std::max((int)bam_file_data_alignment, 0);
+  _file_data_min_size = (size_t)std::max((int)bam_file_data_min_size, 1);
 }
 
 /**
@@ -415,6 +417,51 @@ write_file_data(SubfileInfo &result, const SubfileInfo &source) {
   // order and queued up in the BamReader.
 }
 
+/**
+ * Writes a block of auxiliary file data from the indicated buffer.  The data
+ * is written aligned to get_file_data_alignment() bytes within the stream, so
+ * that it may later be mapped directly into memory.  This must be balanced by
+ * a matching call to read_file_data() on restore, which will return exactly
+ * the indicated bytes.
+ */
+void BamWriter::
+write_file_data(SubfileInfo &result, const void *data, size_t size) {
+  // The BOC_file_data token is followed by the number of padding bytes at the
+  // start of the file data datagram.  The data begins after the 5-byte token
+  // datagram and the two length prefixes, the second of which is 12 bytes
+  // instead of 4 for a datagram of 4 GB or more.
+  size_t alignment = std::max(_file_data_alignment, (size_t)1);
+  std::streamoff data_pos = (std::streamoff)_target->get_file_pos() + 4 + 5 + 4;
+  size_t padding = (size_t)((alignment - data_pos % alignment) % alignment);
+  if (padding + size >= (uint32_t)-1) {
+    data_pos += 8;
+    padding = (size_t)((alignment - data_pos % alignment) % alignment);
+    if (padding + size < (uint32_t)-1) {
+      padding += alignment;
+    }
+  }
+
+  Datagram dg;
+  dg.add_uint8(BOC_file_data);
+  dg.add_uint32((uint32_t)padding);
+  if (!_target->put_datagram(dg)) {
+    util_cat.error()
+      << "Unable to write data to output.\n";
+    return;
+  }
+
+  Datagram file_dg;
+  file_dg.pad_bytes(padding);
+  file_dg.append_data(data, size);
+  if (!_target->put_datagram(file_dg)) {
+    util_cat.error()
+      << "Unable to write file data to output.\n";
+    return;
+  }
+
+  result = SubfileInfo(_target->get_file(), data_pos + padding, size);
+}
+
 /**
  * Writes out the indicated CycleData object.  This should be used by classes
  * that store some or all of their data within a CycleData subclass, in
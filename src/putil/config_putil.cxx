@@ -13,8 +13,10 @@
 
 #include "config_putil.h"
 #include "animInterface.h"
+#include "bamCacheDirectoryStore.h"
 #include "bamCacheIndex.h"
 #include "bamCacheRecord.h"
+#include "bamCacheStore.h"
 #include "bamReader.h"
 #include "bamReaderParam.h"
 #include "bitArray.h"
@@ -89,6 +91,37 @@ ConfigVariableEnum<BamEnums::BamTextureMode> bam_texture_mode
  PRC_DESC("Set this to specify how textures should be written into Bam files."
           "See the panda source or documentation for available options."));
 
+ConfigVariableInt bam_file_data_alignment
+("bam-file-data-alignment", 0,
+ PRC_DESC("If this is nonzero, large binary data blocks such as vertex arrays "
+          "and texture images are written to bam files out of line, "
+          "uncompressed and aligned to this many bytes, so that they may be "
+          "mapped directly from the file into memory when it is loaded "
+          "rather than copied.  This should be the page size, usually 4096. "
+          "Set it to 0 to store the blocks inline with their objects."));
+
+ConfigVariableInt bam_file_data_min_size
+("bam-file-data-min-size", 65536,
+ PRC_DESC("The smallest binary data block, in bytes, that is written out of "
+          "line when bam-file-data-alignment is nonzero.  Smaller blocks are "
+          "not worth the padding and are stored inline."));
+
+ConfigVariableBool bam_map_file_data
+("bam-map-file-data", true,
+ PRC_DESC("Set this true to map the aligned binary data blocks of a bam file "
+          "directly into memory when it is loaded from a plain file or an "
+          "uncompressed Multifile subfile, so that they are paged in on "
+          "demand instead of copied.  If this is false, or the file cannot "
+          "be mapped, the blocks are read into memory."));
+
+ConfigVariableInt bam_read_ahead_size
+("bam-read-ahead-size", 0,
+ PRC_DESC("If this is nonzero, a BamReader reads and decompresses the "
+          "datagrams of a bam file on a separate thread, in parallel with "
+          "constructing the objects from them, staying up to this many bytes "
+          "ahead of the objects.  Set it to 0 to read the file on the calling "
+          "thread only."));
+
 ConfigureFn(config_putil) {
   init_libputil();
 }
@@ -190,8 +223,10 @@ init_libputil() {
   initialized = true;
 
   AnimInterface::init_type();
+  BamCacheDirectoryStore::init_type();
   BamCacheIndex::init_type();
   BamCacheRecord::init_type();
+  BamCacheStore::init_type();
   BamReaderAuxData::init_type();
   BamReaderParam::init_type();
   BitArray::init_type();
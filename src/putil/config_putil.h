@@ -39,6 +39,10 @@ extern EXPCL_PANDA_PUTIL ConfigVariableInt bam_version;
 extern EXPCL_PANDA_PUTIL ConfigVariableEnum<BamEnums::BamEndian> bam_endian;
 extern EXPCL_PANDA_PUTIL ConfigVariableBool bam_stdfloat_double;
 extern EXPCL_PANDA_PUTIL ConfigVariableEnum<BamEnums::BamTextureMode> bam_texture_mode;
+extern EXPCL_PANDA_PUTIL ConfigVariableInt bam_file_data_alignment;
+extern EXPCL_PANDA_PUTIL ConfigVariableInt bam_file_data_min_size;
+extern EXPCL_PANDA_PUTIL ConfigVariableBool bam_map_file_data;
+extern EXPCL_PANDA_PUTIL ConfigVariableInt bam_read_ahead_size;
 
 BEGIN_PUBLISH
 EXPCL_PANDA_PUTIL ConfigVariableSearchPath &get_model_path();
@@ -1,8 +1,10 @@
 #include "animInterface.cxx"
 #include "autoTextureScale.cxx"
 #include "bamCache.cxx"
+#include "bamCacheDirectoryStore.cxx"
 #include "bamCacheIndex.cxx"
 #include "bamCacheRecord.cxx"
+#include "bamCacheStore.cxx"
 #include "bamEnums.cxx"
 #include "bamReader.cxx"
 #include "bamReaderParam.cxx"
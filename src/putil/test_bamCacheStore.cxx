@@ -0,0 +1,70 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file test_bamCacheStore.cxx
+ * @author lachbr
+ * @date 2026-10-18
+ */
+
+#include "bamCacheDirectoryStore.h"
+#include "virtualFileSystem.h"
+
+int
+main(int argc, char *argv[]) {
+  if (argc < 3) {
+    std::cerr
+      << "test_bamCacheStore store-dir file [file ...]\n\n"
+      << "Publishes each of the named files to a BamCacheDirectoryStore in\n"
+      << "the indicated directory, then fetches it back again and checks\n"
+      << "that the contents survived the round trip.\n\n";
+    exit(1);
+  }
+
+  VirtualFileSystem *vfs = VirtualFileSystem::get_global_ptr();
+  PT(BamCacheDirectoryStore) store =
+    new BamCacheDirectoryStore(Filename::from_os_specific(argv[1]));
+
+  int num_failed = 0;
+  for (int i = 2; i < argc; ++i) {
+    Filename pathname = Filename::from_os_specific(argv[i]);
+    pathname.make_absolute();
+
+    std::string orig_data;
+    if (!vfs->read_file(pathname, orig_data, true)) {
+      std::cerr << "Couldn't read " << pathname << "\n";
+      ++num_failed;
+      continue;
+    }
+
+    std::string name = pathname.get_basename();
+    if (!store->publish(name, pathname)) {
+      std::cerr << "Couldn't publish " << pathname << "\n";
+      ++num_failed;
+      continue;
+    }
+
+    Filename fetched = Filename::temporary("", "fetched-");
+    fetched.set_binary();
+    std::string fetched_data;
+    if (!store->fetch(name, fetched) ||
+        !vfs->read_file(fetched, fetched_data, true)) {
+      std::cerr << "Couldn't fetch " << name << "\n";
+      ++num_failed;
+
+    } else if (fetched_data != orig_data) {
+      std::cerr << name << " was changed by the store.\n";
+      ++num_failed;
+
+    } else {
+      std::cerr << name << ": " << store->get_entry_pathname(name) << "\n";
+    }
+    vfs->delete_file(fetched);
+  }
+
+  return (num_failed == 0) ? 0 : 1;
+}
@@ -13,6 +13,7 @@
     rayTraceGeometry.h \
     rayTraceHitResult.h \
     rayTraceHitResult4.h \
+    rayTraceRayStream.h \
     rayTraceScene.h \
     rayTraceTriangleMesh.h
 
@@ -20,9 +21,28 @@
     config_raytrace.cxx \
     rayTrace.cxx \
     rayTraceGeometry.cxx \
+    rayTraceRayStream.cxx \
     rayTraceScene.cxx \
     rayTraceTriangleMesh.cxx
 
   #define IGATESCAN all
 
 #end lib_target
+
+#begin test_bin_target
+  #define TARGET test_raytrace_stream
+  #define LOCAL_LIBS $[LOCAL_LIBS] raytrace
+
+  #define SOURCES \
+    test_raytrace_stream.cxx
+
+#end test_bin_target
+
+#begin test_bin_target
+  #define TARGET test_raytrace_normal
+  #define LOCAL_LIBS $[LOCAL_LIBS] raytrace
+
+  #define SOURCES \
+    test_raytrace_normal.cxx
+
+#end test_bin_target
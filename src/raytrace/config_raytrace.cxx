@@ -14,6 +14,7 @@
 #include "config_raytrace.h"
 #include "rayTraceGeometry.h"
 #include "rayTraceTriangleMesh.h"
+#include "rayTraceRayStream.h"
 
 NotifyCategoryDef(raytrace, "");
 
@@ -23,6 +24,21 @@ ConfigureFn(config_raytrace) {
   init_libraytrace();
 }
 
+ConfigVariableInt raytrace_num_threads
+("raytrace-num-threads", 0,
+ PRC_DESC("The number of worker threads that RayTraceScene::trace_stream() "
+          "may use to trace large ray streams.  The stream is split into "
+          "chunks of raytrace-stream-chunk-size rays, which are traced on "
+          "the \"raytrace\" task chain as well as the calling thread.  Set "
+          "this to 0 to always trace streams on the calling thread."));
+
+ConfigVariableInt raytrace_stream_chunk_size
+("raytrace-stream-chunk-size", 1024,
+ PRC_DESC("The number of rays of a RayTraceRayStream that are handed to "
+          "Embree in a single call, and the unit of work that is given to "
+          "each worker thread.  Streams shorter than this are always traced "
+          "on the calling thread."));
+
 /**
  * Initializes the library.  This must be called at least once before any of
  * the functions or classes in this library can be used.  Normally it will be
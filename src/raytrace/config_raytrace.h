@@ -17,6 +17,7 @@
 #include "dconfig.h"
 #include "pandabase.h"
 #include "notifyCategoryProxy.h"
+#include "configVariableInt.h"
 
 NotifyCategoryDecl(raytrace, EXPCL_PANDA_RAYTRACE, EXPTP_PANDA_RAYTRACE);
 
@@ -30,6 +31,9 @@ typedef struct RTCSceneTy* RTCScene;
 struct RTCGeometryTy;
 typedef struct RTCGeometryTy* RTCGeometry;
 
+extern EXPCL_PANDA_RAYTRACE ConfigVariableInt raytrace_num_threads;
+extern EXPCL_PANDA_RAYTRACE ConfigVariableInt raytrace_stream_chunk_size;
+
 extern EXPCL_PANDA_RAYTRACE void init_libraytrace();
 
 #endif // CONFIG_RAYTRACE_H
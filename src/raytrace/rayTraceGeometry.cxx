@@ -24,9 +24,26 @@ RayTraceGeometry::RayTraceGeometry( int type, const std::string &name ) :
         _geometry = rtcNewGeometry( RayTrace::get_device(), (RTCGeometryType)type );
         // All bits on by default
         rtcSetGeometryMask( _geometry, BitMask32::all_on().get_word() );
+        _mask = BitMask32::all_on().get_word();
+        _build_quality = RTC_BUILD_QUALITY_MEDIUM;
+
+        // The geometry goes into a scene of its own, which is instanced into
+        // the RayTraceScene.  That way, moving the node only has to update the
+        // instance transform and the (small) top-level BVH, and changing the
+        // geometry only rebuilds or refits its own BVH.
+        _child_scene = rtcNewScene( RayTrace::get_device() );
+        rtcAttachGeometry( _child_scene, _geometry );
+
+        _instance = rtcNewGeometry( RayTrace::get_device(), RTC_GEOMETRY_TYPE_INSTANCE );
+        rtcSetGeometryInstancedScene( _instance, _child_scene );
+        rtcSetGeometryTimeStepCount( _instance, 1 );
+        rtcSetGeometryMask( _instance, _mask );
+
         _geom_id = 0;
         _rtscene = nullptr;
+        _dirty = 0;
         _last_trans = nullptr;
+        _normal_mat = LMatrix3::ident_mat();
 
         set_cull_callback();
 
@@ -39,37 +56,109 @@ RayTraceGeometry::~RayTraceGeometry()
 {
         if ( _rtscene )
                 _rtscene->remove_geometry( this );
+        if ( _instance )
+                rtcReleaseGeometry( _instance );
+        _instance = nullptr;
+        if ( _child_scene )
+                rtcReleaseScene( _child_scene );
+        _child_scene = nullptr;
         if ( _geometry )
                 rtcReleaseGeometry( _geometry );
         _geometry = nullptr;
 }
 
-void RayTraceGeometry::update_rtc_transform( const TransformState *ts )
+/**
+ * Updates the transform of the instance that places this geometry in the
+ * RayTraceScene.  Returns true if the transform changed, in which case the
+ * top-level scene must be recommitted, but this geometry's own BVH is
+ * untouched.
+ */
+bool RayTraceGeometry::update_rtc_transform( const TransformState *ts )
 {
-        if ( ts != _last_trans )
-        {
-                _last_trans = ts;
+        if ( ts == _last_trans )
+                return false;
+
+        _last_trans = ts;
+
+        // Embree wants the matrix that transforms column vectors, which is the
+        // transpose of ours; so our row-major data is its column-major.
+        LMatrix4f mat = LCAST( float, _last_trans->get_mat() );
 
-                const LMatrix4 &mat = _last_trans->get_mat();
+        rtcSetGeometryTransform( _instance, 0, RTC_FORMAT_FLOAT4X4_COLUMN_MAJOR, mat.get_data() );
+        rtcCommitGeometry( _instance );
 
-                rtcSetGeometryTransform( _geometry, 0, RTC_FORMAT_FLOAT4X4_ROW_MAJOR, mat.get_data() );
-                rtcCommitGeometry( _geometry );
-                if ( _rtscene )
-                        _rtscene->_scene_needs_rebuild = true;
+        // Embree reports the hit normals in the space of the instanced
+        // geometry, so the scene transforms them by the inverse transpose.
+        if ( _normal_mat.invert_from( _last_trans->get_mat().get_upper_3() ) )
+                _normal_mat.transpose_in_place();
+        else
+                _normal_mat = LMatrix3::ident_mat();
 
-                raytrace_cat.debug()
-                        << "Updated geometry transform\n";
+        raytrace_cat.debug()
+                << "Updated geometry transform\n";
+
+        return true;
+}
+
+/**
+ * Indicates that the geometry has changed and its BVH must be updated on the
+ * next RayTraceScene::update().  Pass DF_refit if only the vertex positions
+ * moved (and the topology is unchanged), which allows Embree to refit the
+ * existing BVH rather than building a new one.
+ */
+void RayTraceGeometry::mark_dirty( int flags )
+{
+        _dirty |= flags;
+        if ( _rtscene )
+                _rtscene->_scene_needs_rebuild = true;
+}
+
+/**
+ * Commits any pending changes to the geometry and its own scene.  Returns
+ * true if anything was committed, false if the geometry was not dirty.
+ */
+bool RayTraceGeometry::commit()
+{
+        if ( _dirty == 0 )
+                return false;
+
+        if ( _dirty & DF_build )
+        {
+                rtcSetGeometryBuildQuality( _geometry, (RTCBuildQuality)_build_quality );
         }
+        else
+        {
+                // The topology is unchanged; only refit the existing BVH.
+                rtcSetGeometryBuildQuality( _geometry, RTC_BUILD_QUALITY_REFIT );
+        }
+
+        rtcCommitGeometry( _geometry );
+        rtcCommitScene( _child_scene );
+
+        // The instance must be recommitted after its scene changed.
+        rtcCommitGeometry( _instance );
+
+        raytrace_cat.debug()
+                << ( ( _dirty & DF_build ) ? "Rebuilt" : "Refit" ) << " geometry BVH\n";
+
+        _dirty = 0;
+        return true;
 }
 
 void RayTraceGeometry::set_mask( unsigned int mask )
 {
-        nassertv( _geometry != nullptr );
-        rtcSetGeometryMask( _geometry, mask );
+        nassertv( _instance != nullptr );
+        // The mask is tested on the instance; the geometry inside it keeps
+        // all bits on, so its BVH doesn't have to be touched.
+        rtcSetGeometryMask( _instance, mask );
+        rtcCommitGeometry( _instance );
         _mask = mask;
+        if ( _rtscene )
+                _rtscene->_scene_needs_rebuild = true;
 }
 
 void RayTraceGeometry::set_build_quality( int quality )
 {
-        rtcSetGeometryBuildQuality( _geometry, (RTCBuildQuality)quality );
+        _build_quality = quality;
+        mark_dirty( DF_build );
 };
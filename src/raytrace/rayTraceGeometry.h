@@ -26,9 +26,14 @@ PUBLISHED:
         INLINE RayTraceGeometry( const std::string &name = "" ) :
                 PandaNode( name ),
                 _geometry( nullptr ),
+                _instance( nullptr ),
+                _child_scene( nullptr ),
                 _geom_id( 0 ),
                 _rtscene( nullptr ),
-                _last_trans( nullptr )
+                _dirty( 0 ),
+                _build_quality( 1 ),
+                _last_trans( nullptr ),
+                _normal_mat( LMatrix3::ident_mat() )
         {
         }
         virtual ~RayTraceGeometry();
@@ -53,23 +58,59 @@ PUBLISHED:
 
         virtual void build() = 0;
 
+        INLINE bool is_dirty() const
+        {
+                return _dirty != 0;
+        }
+
 public:
         RayTraceGeometry( int type, const std::string &name = "" );
 
+        // The geometry itself, which lives in a scene of its own.
         INLINE RTCGeometry get_geometry() const
         {
                 return _geometry;
         }
 
-        void update_rtc_transform( const TransformState *ts );
+        // The instance of that scene which is attached to the RayTraceScene.
+        INLINE RTCGeometry get_instance() const
+        {
+                return _instance;
+        }
+
+        enum DirtyFlags
+        {
+                // The buffers or topology changed; the BVH must be rebuilt.
+                DF_build = 0x1,
+                // Only vertex positions changed; the BVH may be refit.
+                DF_refit = 0x2,
+        };
+
+        void mark_dirty( int flags );
+        bool commit();
+
+        bool update_rtc_transform( const TransformState *ts );
+
+        // Transforms a hit normal, which Embree reports in the space of the
+        // geometry, into the space of the RayTraceScene.
+        INLINE const LMatrix3 &get_normal_mat() const
+        {
+                return _normal_mat;
+        }
 
 protected:
         RTCGeometry _geometry;
+        RTCGeometry _instance;
+        RTCScene _child_scene;
         unsigned int _geom_id;
         unsigned int _mask;
         RayTraceScene *_rtscene;
+        int _dirty;
+        int _build_quality;
 
         CPT(TransformState) _last_trans;
+        // The inverse transpose of the upper 3x3 of _last_trans.
+        LMatrix3 _normal_mat;
 
         friend class RayTraceScene;
 };
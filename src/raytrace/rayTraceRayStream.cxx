@@ -0,0 +1,94 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file rayTraceRayStream.cxx
+ * @author lachbr
+ * @date 2026-10-18
+ */
+
+#include "rayTraceRayStream.h"
+
+RayTraceRayStream::RayTraceRayStream( size_t num_rays )
+{
+        set_num_rays( num_rays );
+}
+
+/**
+ * Resizes the stream to hold the indicated number of rays.  Newly added rays
+ * have zero length and an all-on mask; existing rays are preserved.
+ */
+void RayTraceRayStream::set_num_rays( size_t num_rays )
+{
+        org_x.resize( num_rays, 0.0f );
+        org_y.resize( num_rays, 0.0f );
+        org_z.resize( num_rays, 0.0f );
+        dir_x.resize( num_rays, 0.0f );
+        dir_y.resize( num_rays, 0.0f );
+        dir_z.resize( num_rays, 1.0f );
+        mask.resize( num_rays, BitMask32::all_on().get_word() );
+        distance.resize( num_rays, 0.0f );
+        _results.resize( num_rays );
+}
+
+/**
+ * Removes all rays from the stream.  The memory is retained for reuse.
+ */
+void RayTraceRayStream::clear()
+{
+        set_num_rays( 0 );
+}
+
+void RayTraceRayStream::set_ray( size_t n, const LPoint3 &origin, const LVector3 &direction,
+        float dist, const BitMask32 &m )
+{
+        nassertv( n < distance.size() );
+        org_x[n] = origin[0];
+        org_y[n] = origin[1];
+        org_z[n] = origin[2];
+        dir_x[n] = direction[0];
+        dir_y[n] = direction[1];
+        dir_z[n] = direction[2];
+        mask[n] = m.get_word();
+        distance[n] = dist;
+}
+
+/**
+ * Appends a new ray to the end of the stream and returns its index.
+ */
+size_t RayTraceRayStream::add_ray( const LPoint3 &origin, const LVector3 &direction,
+        float dist, const BitMask32 &m )
+{
+        size_t n = distance.size();
+        set_num_rays( n + 1 );
+        set_ray( n, origin, direction, dist, m );
+        return n;
+}
+
+/**
+ * Makes sure the scratch arrays used by the trace can hold the indicated
+ * number of rays.
+ */
+void RayTraceRayStream::resize_scratch( size_t num_rays )
+{
+        if ( _tfar.size() == num_rays )
+                return;
+
+        _tnear.assign( num_rays, 0.0f );
+        _time.assign( num_rays, 0.0f );
+        _flags.assign( num_rays, 0u );
+        _tfar.resize( num_rays );
+        _id.resize( num_rays );
+        _ng_x.resize( num_rays );
+        _ng_y.resize( num_rays );
+        _ng_z.resize( num_rays );
+        _u.resize( num_rays );
+        _v.resize( num_rays );
+        _prim_id.resize( num_rays );
+        _geom_id.resize( num_rays );
+        _inst_id.resize( num_rays );
+}
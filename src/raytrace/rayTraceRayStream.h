@@ -0,0 +1,112 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file rayTraceRayStream.h
+ * @author lachbr
+ * @date 2026-10-18
+ */
+
+#ifndef RAYTRACERAYSTREAM_H
+#define RAYTRACERAYSTREAM_H
+
+#include "config_raytrace.h"
+#include "referenceCount.h"
+#include "luse.h"
+#include "bitMask.h"
+#include "pvector.h"
+#include "rayTraceHitResult.h"
+#include "bitArray.h"
+
+/**
+ * A batch of rays to be traced against a RayTraceScene in a single call to
+ * RayTraceScene::trace_stream().  The rays are stored in structure-of-arrays
+ * form, which is the layout Embree's stream interface consumes directly, so
+ * thousands of rays can be traced without the per-call overhead of
+ * trace_ray().
+ *
+ * The results of the last trace are stored in the stream as well, one per
+ * ray, and remain valid until the stream is modified.  An occlusion-only
+ * trace with RayTraceScene::trace_stream_occluded() instead stores one bit
+ * per ray in the occluded mask.  A stream may be reused
+ * from frame to frame to avoid reallocating its arrays.
+ */
+class EXPCL_PANDA_RAYTRACE RayTraceRayStream : public ReferenceCount
+{
+PUBLISHED:
+        RayTraceRayStream( size_t num_rays = 0 );
+
+        void set_num_rays( size_t num_rays );
+        INLINE size_t get_num_rays() const
+        {
+                return distance.size();
+        }
+        void clear();
+
+        void set_ray( size_t n, const LPoint3 &origin, const LVector3 &direction,
+                float distance, const BitMask32 &mask );
+        INLINE void set_line( size_t n, const LPoint3 &start, const LPoint3 &end,
+                const BitMask32 &mask )
+        {
+                LVector3 delta = end - start;
+                set_ray( n, start, delta.normalized(), delta.length(), mask );
+        }
+
+        size_t add_ray( const LPoint3 &origin, const LVector3 &direction,
+                float distance, const BitMask32 &mask );
+        INLINE size_t add_line( const LPoint3 &start, const LPoint3 &end,
+                const BitMask32 &mask )
+        {
+                LVector3 delta = end - start;
+                return add_ray( start, delta.normalized(), delta.length(), mask );
+        }
+
+        INLINE const RayTraceHitResult &get_result( size_t n ) const
+        {
+                static const RayTraceHitResult empty_result;
+                nassertr( n < _results.size(), empty_result );
+                return _results[n];
+        }
+        MAKE_SEQ( get_results, get_num_rays, get_result );
+
+        INLINE bool is_occluded( size_t n ) const
+        {
+                return _occluded.get_bit( (int)n );
+        }
+        INLINE const BitArray &get_occluded_mask() const
+        {
+                return _occluded;
+        }
+
+public:
+        // The input arrays.  These may be filled in directly after a call to
+        // set_num_rays(), which is the fastest way to build a large stream.
+        pvector<float> org_x, org_y, org_z;
+        pvector<float> dir_x, dir_y, dir_z;
+        pvector<float> distance;
+        pvector<unsigned int> mask;
+
+private:
+        void resize_scratch( size_t num_rays );
+
+private:
+        pvector<RayTraceHitResult> _results;
+        // The results of the last trace_stream_occluded(), one bit per ray.
+        BitArray _occluded;
+
+        // Scratch arrays that Embree reads from and writes the hits into.
+        // They are kept around so that a reused stream doesn't need to
+        // reallocate them on every trace.
+        pvector<float> _tnear, _tfar, _time;
+        pvector<unsigned int> _id, _flags;
+        pvector<float> _ng_x, _ng_y, _ng_z, _u, _v;
+        pvector<unsigned int> _prim_id, _geom_id, _inst_id;
+
+        friend class RayTraceScene;
+};
+
+#endif // RAYTRACERAYSTREAM_H
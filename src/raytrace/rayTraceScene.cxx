@@ -15,13 +15,71 @@
 #include "rayTraceGeometry.h"
 #include "embree3/rtcore.h"
 #include "nodePath.h"
+#include "asyncTaskManager.h"
+#include "atomicAdjust.h"
+#include "pStatCollector.h"
+#include "pStatTimer.h"
+
+#include <algorithm>
 
 static const ALIGN_16BYTE int32_t Four_NegativeOnes_NonSIMD[4] = { -1, -1, -1, -1 };
 
+static PStatCollector trace_stream_pcollector( "RayTrace:Stream" );
+static PStatCollector occluded_stream_pcollector( "RayTrace:Stream:Occluded" );
+static PStatCollector update_pcollector( "RayTrace:Update" );
+
+/**
+ * Hands out the chunks of a RayTraceRayStream to the threads taking part in
+ * RayTraceScene::trace_stream().
+ */
+class StreamTraceJob
+{
+public:
+        StreamTraceJob( RayTraceScene *scene, RayTraceRayStream *stream,
+                size_t chunk_size, bool occluded ) :
+                _scene( scene ),
+                _stream( stream ),
+                _chunk_size( chunk_size ),
+                _occluded( occluded ),
+                _next_chunk( 0 )
+        {
+                _num_chunks = ( stream->get_num_rays() + chunk_size - 1 ) / chunk_size;
+        }
+
+        void run()
+        {
+                size_t num_rays = _stream->get_num_rays();
+                AtomicAdjust::Integer chunk = AtomicAdjust::add( _next_chunk, 1 ) - 1;
+                while ( chunk < (AtomicAdjust::Integer)_num_chunks )
+                {
+                        size_t begin = (size_t)chunk * _chunk_size;
+                        size_t end = std::min( begin + _chunk_size, num_rays );
+                        if ( _occluded )
+                                _scene->trace_stream_range_occluded( _stream, begin, end );
+                        else
+                                _scene->trace_stream_range( _stream, begin, end );
+                        chunk = AtomicAdjust::add( _next_chunk, 1 ) - 1;
+                }
+        }
+
+        static void run_func( void *data )
+        {
+                ( (StreamTraceJob *)data )->run();
+        }
+
+        RayTraceScene *_scene;
+        RayTraceRayStream *_stream;
+        size_t _chunk_size;
+        size_t _num_chunks;
+        bool _occluded;
+        AtomicAdjust::Integer _next_chunk;
+};
+
 RayTraceScene::RayTraceScene()
 {
         nassertv( RayTrace::get_device() != nullptr );
         _scene = rtcNewScene( RayTrace::get_device() );
+        _scene_needs_rebuild = false;
         raytrace_cat.debug()
                 << "Made new raytrace scene\n";
 }
@@ -34,7 +92,9 @@ RayTraceScene::~RayTraceScene()
 
 void RayTraceScene::add_geometry( RayTraceGeometry *geom )
 {
-        unsigned int geom_id = rtcAttachGeometry( _scene, geom->get_geometry() );
+        // We attach the instance of the geometry's own scene, so that the
+        // geometry can be moved and updated without rebuilding our BVH.
+        unsigned int geom_id = rtcAttachGeometry( _scene, geom->get_instance() );
         RTCError err = rtcGetDeviceError( RayTrace::get_device() );
         raytrace_cat.debug()
                 << "add_geometry: rtcError: " << err << "\n";
@@ -49,43 +109,62 @@ void RayTraceScene::add_geometry( RayTraceGeometry *geom )
 void RayTraceScene::remove_geometry( RayTraceGeometry *geom )
 {
         rtcDetachGeometry( _scene, geom->_geom_id );
+        _geoms.remove( geom->_geom_id );
         geom->_geom_id = 0;
         geom->_rtscene = nullptr;
-        _geoms.remove( geom->_geom_id );
+        _scene_needs_rebuild = true;
 }
 
 void RayTraceScene::remove_all()
 {
         for ( size_t i = 0; i < _geoms.size(); i++ )
         {
-                RayTraceGeometry *geom = _geoms[i];
+                RayTraceGeometry *geom = _geoms.get_data( i );
                 rtcDetachGeometry( _scene, geom->_geom_id );
                 geom->_geom_id = 0;
                 geom->_rtscene = nullptr;
         }
 
         _geoms.clear();
+        _scene_needs_rebuild = true;
 }
 
 void RayTraceScene::set_build_quality( int quality )
 {
         rtcSetSceneBuildQuality( _scene, (RTCBuildQuality)quality );
+        _scene_needs_rebuild = true;
 }
 
+/**
+ * Brings the Embree scene up to date with the geometry.  Only the work that
+ * is actually needed is done: geometry that was changed is rebuilt (or only
+ * refit, if its topology is unchanged), geometry that merely moved gets a new
+ * instance transform, and the top-level BVH over the instances is rebuilt
+ * only if any of that happened.
+ */
 void RayTraceScene::update()
 {
         nassertv( _scene != nullptr );
 
+        PStatTimer timer( update_pcollector );
+
         size_t num_geoms = _geoms.size();
         for ( size_t i = 0; i < num_geoms; i++ )
         {
-                RayTraceGeometry *geom = _geoms[i];
-                geom->update_rtc_transform( NodePath( geom ).get_net_transform() );
+                RayTraceGeometry *geom = _geoms.get_data( i );
+                if ( geom->commit() )
+                {
+                        _scene_needs_rebuild = true;
+                }
+                if ( geom->update_rtc_transform( NodePath( geom ).get_net_transform() ) )
+                {
+                        _scene_needs_rebuild = true;
+                }
         }
 
         if ( _scene_needs_rebuild )
         {
-                raytrace_cat.info()
+                raytrace_cat.debug()
                         << "Committing scene\n";
                 rtcCommitScene( _scene );
                 _scene_needs_rebuild = false;
@@ -133,10 +212,12 @@ RayTraceHitResult RayTraceScene::trace_ray( const LPoint3 &start, const LVector3
 
         // Store the results
         result.hit_fraction = rhit.ray.tfar / distance;
-        result.hit_normal = LVector3( rhit.hit.Ng_x,
-                rhit.hit.Ng_y, rhit.hit.Ng_z );
+        result.hit_normal = get_scene_normal( rhit.hit.instID[0],
+                LVector3( rhit.hit.Ng_x, rhit.hit.Ng_y, rhit.hit.Ng_z ) );
         result.hit_uv = LVector2( rhit.hit.u, rhit.hit.v );
-        result.geom_id = rhit.hit.geomID;
+        // The geometry is always hit through its instance, whose ID is the one
+        // we handed out in add_geometry().
+        result.geom_id = rhit.hit.instID[0];
         result.prim_id = rhit.hit.primID;
         // If the ray/line didn't trace all the way to the end,
         // we have a hit.
@@ -180,9 +261,262 @@ void RayTraceScene::trace_four_rays(const FourVectors &start, const FourVectors
 
         rtcIntersect4( Four_NegativeOnes_NonSIMD, _scene, &ctx, &rhit4 );
 
-        res->geom_id = LoadAlignedIntSIMD( rhit4.hit.geomID );
+        res->geom_id = LoadAlignedIntSIMD( rhit4.hit.instID[0] );
+
+        for ( int i = 0; i < 4; i++ )
+        {
+                LVector3 normal = get_scene_normal( rhit4.hit.instID[0][i],
+                        LVector3( rhit4.hit.Ng_x[i], rhit4.hit.Ng_y[i], rhit4.hit.Ng_z[i] ) );
+                res->hit_normal.X( i ) = normal[0];
+                res->hit_normal.Y( i ) = normal[1];
+                res->hit_normal.Z( i ) = normal[2];
+        }
 
         fltx4 factor = ReciprocalSIMD( distance );
         res->hit_fraction = MulSIMD( LoadAlignedSIMD( rhit4.ray.tfar ), factor );
         //res->hit = CmpLtSIMD( res->hit_fraction, Four_Ones );
 }
+
+/**
+ * Returns true if anything in the scene lies along the indicated ray within
+ * the given distance.  This is much cheaper than trace_ray(), since the
+ * traversal stops at the first hit found and no hit attributes are computed;
+ * use it when only visibility matters.
+ */
+bool RayTraceScene::is_ray_occluded( const LPoint3 &start, const LVector3 &dir,
+        float distance, const BitMask32 &mask )
+{
+        RTCIntersectContext ctx;
+        rtcInitIntersectContext( &ctx );
+        ctx.flags = RTC_INTERSECT_CONTEXT_FLAG_COHERENT;
+
+        ALIGN_16BYTE RTCRay ray;
+        ray.mask = mask.get_word();
+        ray.org_x = start[0];
+        ray.org_y = start[1];
+        ray.org_z = start[2];
+        ray.dir_x = dir[0];
+        ray.dir_y = dir[1];
+        ray.dir_z = dir[2];
+        ray.tnear = 0;
+        ray.tfar = distance;
+        ray.time = 0;
+        ray.flags = 0;
+
+        rtcOccluded1( _scene, &ctx, &ray );
+
+        // Embree sets tfar to -inf if the ray was occluded.
+        return ray.tfar < 0.0f;
+}
+
+/**
+ * Tests four rays for occlusion at once.  Returns a bitmask in which bit n is
+ * set if the nth ray is occluded.
+ */
+int RayTraceScene::are_four_rays_occluded( const FourVectors &start, const FourVectors &direction,
+        const fltx4 &distance, const u32x4 &mask )
+{
+        RTCIntersectContext ctx;
+        rtcInitIntersectContext( &ctx );
+
+        ALIGN_16BYTE RTCRay4 ray4;
+        StoreAlignedSIMD( ray4.org_x, start.x );
+        StoreAlignedSIMD( ray4.org_y, start.y );
+        StoreAlignedSIMD( ray4.org_z, start.z );
+        StoreAlignedSIMD( ray4.dir_x, direction.x );
+        StoreAlignedSIMD( ray4.dir_y, direction.y );
+        StoreAlignedSIMD( ray4.dir_z, direction.z );
+        StoreAlignedUIntSIMD( ray4.mask, mask );
+        StoreAlignedSIMD( ray4.tnear, Four_Zeros );
+        StoreAlignedSIMD( ray4.time, Four_Zeros );
+        StoreAlignedSIMD( ray4.tfar, distance );
+        StoreAlignedUIntSIMD( ray4.flags, Four_Zeros );
+
+        rtcOccluded4( Four_NegativeOnes_NonSIMD, _scene, &ctx, &ray4 );
+
+        // Embree sets tfar to -inf for each occluded ray, so the sign bits
+        // are exactly the mask we want.
+        return TestSignSIMD( LoadAlignedSIMD( ray4.tfar ) );
+}
+
+/**
+ * Traces all of the rays in the indicated stream, storing one
+ * RayTraceHitResult per ray in the stream.  This is equivalent to calling
+ * trace_ray() once per ray, but the rays are handed to Embree's stream
+ * interface in large chunks, and the chunks may be spread across the
+ * threads of the "raytrace" task chain (see raytrace-num-threads).
+ */
+void RayTraceScene::trace_stream( RayTraceRayStream *stream )
+{
+        PStatTimer timer( trace_stream_pcollector );
+        do_trace_stream( stream, false );
+}
+
+/**
+ * Tests all of the rays in the indicated stream for occlusion only, which is
+ * the equivalent of calling is_ray_occluded() once per ray.  The results are
+ * stored in the stream's occluded mask rather than in its hit results, which
+ * are left untouched.
+ *
+ * This is considerably cheaper than trace_stream(), since Embree may stop
+ * traversing each ray at the first hit it finds.
+ */
+void RayTraceScene::trace_stream_occluded( RayTraceRayStream *stream )
+{
+        PStatTimer timer( occluded_stream_pcollector );
+        do_trace_stream( stream, true );
+
+        if ( stream != nullptr )
+        {
+                // Gather up the results now that all of the threads are done,
+                // since the BitArray cannot be written to concurrently.
+                size_t num_rays = stream->get_num_rays();
+                stream->_occluded.clear();
+                for ( size_t i = 0; i < num_rays; i++ )
+                {
+                        if ( stream->_tfar[i] < 0.0f )
+                                stream->_occluded.set_bit( (int)i );
+                }
+        }
+}
+
+/**
+ * The implementation of trace_stream() and trace_stream_occluded().
+ */
+void RayTraceScene::do_trace_stream( RayTraceRayStream *stream, bool occluded )
+{
+        nassertv( stream != nullptr );
+
+        size_t num_rays = stream->get_num_rays();
+        if ( num_rays == 0 )
+                return;
+
+        stream->resize_scratch( num_rays );
+
+        size_t chunk_size = (size_t)std::max( (int)raytrace_stream_chunk_size, 1 );
+        StreamTraceJob job( this, stream, chunk_size, occluded );
+
+        AsyncTaskManager::get_global_ptr()->run_parallel( "raytrace",
+                raytrace_num_threads, (int)job._num_chunks,
+                &StreamTraceJob::run_func, &job );
+}
+
+/**
+ * Traces the rays [begin, end) of the indicated stream, which must already
+ * have been prepared by trace_stream().  This is the unit of work that
+ * trace_stream() distributes among its threads.
+ */
+void RayTraceScene::trace_stream_range( RayTraceRayStream *stream, size_t begin, size_t end )
+{
+        nassertv( begin <= end && end <= stream->_tfar.size() );
+
+        unsigned int count = (unsigned int)( end - begin );
+        if ( count == 0 )
+                return;
+
+        for ( size_t i = begin; i < end; i++ )
+        {
+                stream->_tfar[i] = stream->distance[i];
+                stream->_id[i] = (unsigned int)i;
+                stream->_geom_id[i] = RTC_INVALID_GEOMETRY_ID;
+                stream->_inst_id[i] = RTC_INVALID_GEOMETRY_ID;
+        }
+
+        RTCIntersectContext ctx;
+        rtcInitIntersectContext( &ctx );
+        ctx.flags = RTC_INTERSECT_CONTEXT_FLAG_COHERENT;
+
+        RTCRayHitNp rhit;
+        rhit.ray.org_x = &stream->org_x[begin];
+        rhit.ray.org_y = &stream->org_y[begin];
+        rhit.ray.org_z = &stream->org_z[begin];
+        rhit.ray.tnear = &stream->_tnear[begin];
+        rhit.ray.dir_x = &stream->dir_x[begin];
+        rhit.ray.dir_y = &stream->dir_y[begin];
+        rhit.ray.dir_z = &stream->dir_z[begin];
+        rhit.ray.time = &stream->_time[begin];
+        rhit.ray.tfar = &stream->_tfar[begin];
+        rhit.ray.mask = &stream->mask[begin];
+        rhit.ray.id = &stream->_id[begin];
+        rhit.ray.flags = &stream->_flags[begin];
+        rhit.hit.Ng_x = &stream->_ng_x[begin];
+        rhit.hit.Ng_y = &stream->_ng_y[begin];
+        rhit.hit.Ng_z = &stream->_ng_z[begin];
+        rhit.hit.u = &stream->_u[begin];
+        rhit.hit.v = &stream->_v[begin];
+        rhit.hit.primID = &stream->_prim_id[begin];
+        rhit.hit.geomID = &stream->_geom_id[begin];
+        rhit.hit.instID[0] = &stream->_inst_id[begin];
+
+        rtcIntersectNp( _scene, &ctx, &rhit, count );
+
+        // Store the results, the same way trace_ray() does.
+        for ( size_t i = begin; i < end; i++ )
+        {
+                RayTraceHitResult &result = stream->_results[i];
+                result.hit_fraction = stream->_tfar[i] / stream->distance[i];
+                result.hit_normal = get_scene_normal( stream->_inst_id[i],
+                        LVector3( stream->_ng_x[i], stream->_ng_y[i], stream->_ng_z[i] ) );
+                result.hit_uv = LVector2( stream->_u[i], stream->_v[i] );
+                result.geom_id = stream->_inst_id[i];
+                result.prim_id = stream->_prim_id[i];
+                result.hit = result.hit_fraction < 1.0f;
+        }
+}
+
+/**
+ * Tests the rays [begin, end) of the indicated stream for occlusion.  This is
+ * the unit of work that trace_stream_occluded() distributes among its
+ * threads; it leaves tfar negative for each occluded ray.
+ */
+void RayTraceScene::trace_stream_range_occluded( RayTraceRayStream *stream, size_t begin, size_t end )
+{
+        nassertv( begin <= end && end <= stream->_tfar.size() );
+
+        unsigned int count = (unsigned int)( end - begin );
+        if ( count == 0 )
+                return;
+
+        for ( size_t i = begin; i < end; i++ )
+        {
+                stream->_tfar[i] = stream->distance[i];
+                stream->_id[i] = (unsigned int)i;
+        }
+
+        RTCIntersectContext ctx;
+        rtcInitIntersectContext( &ctx );
+        ctx.flags = RTC_INTERSECT_CONTEXT_FLAG_COHERENT;
+
+        RTCRayNp ray;
+        ray.org_x = &stream->org_x[begin];
+        ray.org_y = &stream->org_y[begin];
+        ray.org_z = &stream->org_z[begin];
+        ray.tnear = &stream->_tnear[begin];
+        ray.dir_x = &stream->dir_x[begin];
+        ray.dir_y = &stream->dir_y[begin];
+        ray.dir_z = &stream->dir_z[begin];
+        ray.time = &stream->_time[begin];
+        ray.tfar = &stream->_tfar[begin];
+        ray.mask = &stream->mask[begin];
+        ray.id = &stream->_id[begin];
+        ray.flags = &stream->_flags[begin];
+
+        rtcOccludedNp( _scene, &ctx, &ray, count );
+}
+
+/**
+ * Transforms a hit normal reported by Embree, which is in the space of the
+ * instanced geometry that was hit, into the space of the scene.  If nothing
+ * was hit, the normal is returned unchanged.
+ */
+LVector3 RayTraceScene::get_scene_normal( unsigned int inst_id, const LVector3 &normal ) const
+{
+        if ( inst_id == RTC_INVALID_GEOMETRY_ID )
+                return normal;
+
+        int index = _geoms.find( inst_id );
+        if ( index == -1 )
+                return normal;
+
+        return _geoms.get_data( index )->get_normal_mat().xform( normal );
+}
@@ -20,6 +20,7 @@
 #include "simpleHashMap.h"
 #include "rayTraceHitResult.h"
 #include "rayTraceHitResult4.h"
+#include "rayTraceRayStream.h"
 
 class RayTraceGeometry;
 
@@ -48,6 +49,17 @@ PUBLISHED:
         RayTraceHitResult trace_ray( const LPoint3 &origin, const LVector3 &direction,
                 float distance, const BitMask32 &mask );
 
+        INLINE bool is_line_occluded( const LPoint3 &start, const LPoint3 &end, const BitMask32 &mask )
+        {
+                LPoint3 delta = end - start;
+                return is_ray_occluded( start, delta.normalized(), delta.length(), mask );
+        }
+        bool is_ray_occluded( const LPoint3 &origin, const LVector3 &direction,
+                float distance, const BitMask32 &mask );
+
+        void trace_stream( RayTraceRayStream *stream );
+        void trace_stream_occluded( RayTraceRayStream *stream );
+
         void set_build_quality( int quality );
 
         void update();
@@ -76,8 +88,27 @@ public:
         }
         void trace_four_rays( const FourVectors &origin, const FourVectors &direction,
                 const fltx4 &distance, const u32x4 &mask, RayTraceHitResult4 *res );
+
+        INLINE int are_four_lines_occluded( const FourVectors &start, const FourVectors &end,
+                const u32x4 &mask )
+        {
+                FourVectors direction = end;
+                direction -= start;
+                fltx4 length4 = direction.length();
+                direction.VectorNormalize();
+                return are_four_rays_occluded( start, direction, length4, mask );
+        }
+        int are_four_rays_occluded( const FourVectors &origin, const FourVectors &direction,
+                const fltx4 &distance, const u32x4 &mask );
 #endif
 
+        void trace_stream_range( RayTraceRayStream *stream, size_t begin, size_t end );
+        void trace_stream_range_occluded( RayTraceRayStream *stream, size_t begin, size_t end );
+
+private:
+        void do_trace_stream( RayTraceRayStream *stream, bool occluded );
+        LVector3 get_scene_normal( unsigned int inst_id, const LVector3 &normal ) const;
+
 private:
         RTCScene _scene;
         bool _scene_needs_rebuild;
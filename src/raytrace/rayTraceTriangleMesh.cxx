@@ -18,7 +18,9 @@
 IMPLEMENT_CLASS( RayTraceTriangleMesh );
 
 RayTraceTriangleMesh::RayTraceTriangleMesh( const std::string &name) :
-        RayTraceGeometry( RTC_GEOMETRY_TYPE_TRIANGLE, name )
+        RayTraceGeometry( RTC_GEOMETRY_TYPE_TRIANGLE, name ),
+        _built_num_verts( 0 ),
+        _built_num_tris( 0 )
 {
 }
 
@@ -39,6 +41,20 @@ void RayTraceTriangleMesh::add_triangle( const LPoint3 &p1, const LPoint3 &p2, c
                 << "Added triangle [" << p1 << ", " << p2 << ", " << p3 << "]\n";
 }
 
+/**
+ * Moves the vertices of the nth triangle.  This does not change the topology
+ * of the mesh, so a following call to refit() can update the BVH in place
+ * instead of rebuilding it.
+ */
+void RayTraceTriangleMesh::set_triangle( int n, const LPoint3 &p1, const LPoint3 &p2, const LPoint3 &p3 )
+{
+        nassertv( n >= 0 && n < (int)_tris.size() );
+        const Triangle &tri = _tris[n];
+        _verts[tri.v1] = p1;
+        _verts[tri.v2] = p2;
+        _verts[tri.v3] = p3;
+}
+
 void RayTraceTriangleMesh::add_triangles_from_geom( const Geom *geom, const TransformState *ts )
 {
         if ( ts == nullptr )
@@ -96,8 +112,39 @@ void RayTraceTriangleMesh::build()
                 tris[i] = _tris[i];
         }
 
-        rtcCommitGeometry( _geometry );
+        _built_num_verts = _verts.size();
+        _built_num_tris = _tris.size();
+
+        // The BVH is built when the scene is next updated.
+        mark_dirty( DF_build );
 
         raytrace_cat.debug()
                 << "Built triangle mesh to embree\n";
 }
+
+/**
+ * Hands the current vertex positions to Embree without reallocating the
+ * buffers, so that the BVH is merely refit on the next
+ * RayTraceScene::update().  This is much cheaper than build(), and is
+ * appropriate for deforming geometry whose triangles were only moved with
+ * set_triangle().  If triangles were added since the last build(), this falls
+ * back to build().
+ */
+void RayTraceTriangleMesh::refit()
+{
+        if ( _verts.size() != _built_num_verts || _tris.size() != _built_num_tris )
+        {
+                build();
+                return;
+        }
+
+        LPoint4f *vertices = (LPoint4f *)rtcGetGeometryBufferData( _geometry, RTC_BUFFER_TYPE_VERTEX, 0 );
+        nassertv( vertices != nullptr );
+        for ( size_t i = 0; i < _verts.size(); i++ )
+        {
+                vertices[i] = LPoint4f( _verts[i], 0 );
+        }
+        rtcUpdateGeometryBuffer( _geometry, RTC_BUFFER_TYPE_VERTEX, 0 );
+
+        mark_dirty( DF_refit );
+}
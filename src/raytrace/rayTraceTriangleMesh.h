@@ -27,7 +27,14 @@ PUBLISHED:
         void add_triangle( const LPoint3 &p1, const LPoint3 &p2, const LPoint3 &p3 );
         void add_triangles_from_geom( const Geom *geom, const TransformState *ts = nullptr );
 
+        INLINE int get_num_triangles() const
+        {
+                return (int)_tris.size();
+        }
+        void set_triangle( int n, const LPoint3 &p1, const LPoint3 &p2, const LPoint3 &p3 );
+
         virtual void build();
+        void refit();
 
 private:
         struct Triangle
@@ -36,6 +43,11 @@ private:
         };
         pvector<LPoint3> _verts;
         pvector<Triangle> _tris;
+
+        // The number of vertices and triangles in the buffers that were last
+        // handed to Embree by build().
+        size_t _built_num_verts;
+        size_t _built_num_tris;
 };
 
 #endif // RAYTRACETRIANGLEMESH_H
@@ -0,0 +1,116 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file test_raytrace_normal.cxx
+ * @author lachbr
+ * @date 2026-10-18
+ */
+
+#include "rayTrace.h"
+#include "rayTraceScene.h"
+#include "rayTraceTriangleMesh.h"
+#include "rayTraceRayStream.h"
+#include "transformState.h"
+
+#include <math.h>
+
+using std::cerr;
+
+/**
+ * Returns true if the hit normal is parallel to the expected one.  Embree
+ * doesn't normalize its normals, and their sign depends on the winding, so
+ * only the direction is compared.
+ */
+static bool
+check_normal(const std::string &name, const LVector3 &normal,
+             const LVector3 &expected) {
+  LVector3 n = normal;
+  if (!n.normalize() || fabs(n.dot(expected)) < 0.999f) {
+    cerr << name << ": hit normal is " << normal << ", expected "
+         << expected << "\n";
+    return false;
+  }
+  cerr << name << ": hit normal " << normal << " matches\n";
+  return true;
+}
+
+/**
+ * Places a single large triangle under a rotated and non-uniformly scaled
+ * transform, and checks that each of the ways of tracing a ray reports its
+ * normal in the space of the scene rather than that of the mesh.
+ */
+int
+main(int argc, char *argv[]) {
+  RayTrace::initialize();
+
+  LPoint3 v0(-10, -10, 0), v1(10, -10, 0), v2(0, 10, 0);
+  PT(RayTraceTriangleMesh) mesh = new RayTraceTriangleMesh("mesh");
+  mesh->add_triangle(v0, v1, v2);
+  mesh->build();
+  mesh->set_transform(TransformState::make_pos_hpr_scale(
+    LVecBase3(1, 2, 3), LVecBase3(30, 45, 60), LVecBase3(1, 2, 0.5)));
+
+  PT(RayTraceScene) scene = new RayTraceScene;
+  scene->add_geometry(mesh);
+  scene->update();
+
+  // The expected normal comes straight from the triangle's world-space
+  // vertices.
+  LMatrix4 mat = mesh->get_transform()->get_mat();
+  LPoint3 w0 = mat.xform_point(v0);
+  LPoint3 w1 = mat.xform_point(v1);
+  LPoint3 w2 = mat.xform_point(v2);
+  LVector3 expected = (w1 - w0).cross(w2 - w0);
+  expected.normalize();
+
+  // Aim at the middle of the triangle from either side.
+  LPoint3 center = (w0 + w1 + w2) / 3.0f;
+  LPoint3 above = center + expected * 5.0f;
+  LPoint3 below = center - expected * 5.0f;
+
+  bool ok = true;
+
+  RayTraceHitResult result = scene->trace_line(above, center - expected, BitMask32::all_on());
+  if (!result.has_hit()) {
+    cerr << "trace_ray: missed the rotated mesh\n";
+    ok = false;
+  } else {
+    ok = check_normal("trace_ray", result.get_hit_normal(), expected) && ok;
+  }
+
+  PT(RayTraceRayStream) stream = new RayTraceRayStream;
+  stream->add_line(above, center - expected, BitMask32::all_on());
+  stream->add_line(below, center + expected, BitMask32::all_on());
+  scene->trace_stream(stream);
+  for (size_t i = 0; i < stream->get_num_rays(); ++i) {
+    const RayTraceHitResult &sresult = stream->get_result(i);
+    if (!sresult.has_hit()) {
+      cerr << "trace_stream: ray " << i << " missed the rotated mesh\n";
+      ok = false;
+    } else {
+      ok = check_normal("trace_stream", sresult.get_hit_normal(), expected) && ok;
+    }
+  }
+
+  FourVectors start, end;
+  start.LoadAndSwizzle(above, below, above, below);
+  end.LoadAndSwizzle(center - expected, center + expected,
+                     center - expected, center + expected);
+  RayTraceHitResult4 result4;
+  scene->trace_four_lines(start, end, ReplicateIX4(BitMask32::all_on().get_word()), &result4);
+  for (int i = 0; i < 4; ++i) {
+    ok = check_normal("trace_four_rays", result4.hit_normal.Vec(i), expected) && ok;
+  }
+
+  scene->remove_all();
+  scene = nullptr;
+  mesh = nullptr;
+  RayTrace::destruct();
+
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,132 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file test_raytrace_stream.cxx
+ * @author lachbr
+ * @date 2026-10-18
+ */
+
+#include "rayTrace.h"
+#include "rayTraceScene.h"
+#include "rayTraceTriangleMesh.h"
+#include "rayTraceRayStream.h"
+#include "clockObject.h"
+
+#include <stdlib.h>
+
+using std::cerr;
+
+static float
+random_float(float lo, float hi) {
+  return lo + (hi - lo) * ((float)rand() / (float)RAND_MAX);
+}
+
+/**
+ * Compares the cost of tracing a large number of rays one at a time with
+ * trace_ray() against tracing them in a single RayTraceRayStream, and the
+ * same for the occlusion-only queries.
+ *
+ * Usage: test_raytrace_stream [num_rays [num_triangles]]
+ */
+int
+main(int argc, char *argv[]) {
+  int num_rays = 100000;
+  int num_triangles = 20000;
+  if (argc > 1) {
+    num_rays = atoi(argv[1]);
+  }
+  if (argc > 2) {
+    num_triangles = atoi(argv[2]);
+  }
+
+  RayTrace::initialize();
+
+  // Scatter some random triangles through a 100-unit cube.
+  PT(RayTraceTriangleMesh) mesh = new RayTraceTriangleMesh("mesh");
+  for (int i = 0; i < num_triangles; ++i) {
+    LPoint3 center(random_float(-50, 50), random_float(-50, 50), random_float(-50, 50));
+    mesh->add_triangle(center + LVector3(random_float(-1, 1), random_float(-1, 1), random_float(-1, 1)),
+                       center + LVector3(random_float(-1, 1), random_float(-1, 1), random_float(-1, 1)),
+                       center + LVector3(random_float(-1, 1), random_float(-1, 1), random_float(-1, 1)));
+  }
+  mesh->build();
+
+  PT(RayTraceScene) scene = new RayTraceScene;
+  scene->add_geometry(mesh);
+  scene->update();
+
+  PT(RayTraceRayStream) stream = new RayTraceRayStream(num_rays);
+  for (int i = 0; i < num_rays; ++i) {
+    LPoint3 start(random_float(-50, 50), random_float(-50, 50), random_float(-50, 50));
+    LPoint3 end(random_float(-50, 50), random_float(-50, 50), random_float(-50, 50));
+    stream->set_line(i, start, end, BitMask32::all_on());
+  }
+
+  ClockObject *clock = ClockObject::get_global_clock();
+
+  double start_time = clock->get_real_time();
+  int num_single_hits = 0;
+  for (int i = 0; i < num_rays; ++i) {
+    LPoint3 origin(stream->org_x[i], stream->org_y[i], stream->org_z[i]);
+    LVector3 direction(stream->dir_x[i], stream->dir_y[i], stream->dir_z[i]);
+    RayTraceHitResult result =
+      scene->trace_ray(origin, direction, stream->distance[i], BitMask32::all_on());
+    if (result.has_hit()) {
+      ++num_single_hits;
+    }
+  }
+  double single_time = clock->get_real_time() - start_time;
+
+  start_time = clock->get_real_time();
+  scene->trace_stream(stream);
+  double stream_time = clock->get_real_time() - start_time;
+
+  int num_stream_hits = 0;
+  for (int i = 0; i < num_rays; ++i) {
+    if (stream->get_result(i).has_hit()) {
+      ++num_stream_hits;
+    }
+  }
+
+  start_time = clock->get_real_time();
+  int num_single_occluded = 0;
+  for (int i = 0; i < num_rays; ++i) {
+    LPoint3 origin(stream->org_x[i], stream->org_y[i], stream->org_z[i]);
+    LVector3 direction(stream->dir_x[i], stream->dir_y[i], stream->dir_z[i]);
+    if (scene->is_ray_occluded(origin, direction, stream->distance[i], BitMask32::all_on())) {
+      ++num_single_occluded;
+    }
+  }
+  double single_occluded_time = clock->get_real_time() - start_time;
+
+  start_time = clock->get_real_time();
+  scene->trace_stream_occluded(stream);
+  double stream_occluded_time = clock->get_real_time() - start_time;
+  int num_stream_occluded = stream->get_occluded_mask().get_num_on_bits();
+
+  cerr << num_rays << " rays against " << num_triangles << " triangles:\n"
+       << "  trace_ray:    " << single_time * 1000.0 << " ms, "
+       << num_single_hits << " hits\n"
+       << "  trace_stream: " << stream_time * 1000.0 << " ms, "
+       << num_stream_hits << " hits (raytrace-num-threads "
+       << raytrace_num_threads << ")\n"
+       << "  is_ray_occluded:       " << single_occluded_time * 1000.0 << " ms, "
+       << num_single_occluded << " occluded\n"
+       << "  trace_stream_occluded: " << stream_occluded_time * 1000.0 << " ms, "
+       << num_stream_occluded << " occluded\n";
+
+  scene->remove_all();
+  scene = nullptr;
+  mesh = nullptr;
+  RayTrace::destruct();
+
+  bool consistent = (num_single_hits == num_stream_hits &&
+                     num_single_hits == num_single_occluded &&
+                     num_single_occluded == num_stream_occluded);
+  return consistent ? 0 : 1;
+}
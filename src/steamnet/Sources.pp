@@ -6,30 +6,46 @@
   #define BUILDING_DLL BUILDING_PANDA_STEAMNET
 
   #define USE_PACKAGES valve_steamnet
-  #define LOCAL_LIBS express net putil
+  #define LOCAL_LIBS express net putil pipeline
 
   #define SOURCES \
     config_steamnet.h \
     steamnet_includes.h \
     steamNetworkConnectionInfo.h steamNetworkConnectionInfo.I \
+    steamNetworkDispatcher.h steamNetworkDispatcher.I \
     steamNetworkEnums.h \
     steamNetworkEvent.h steamNetworkEvent.I \
     steamNetworkMessage.h steamNetworkMessage.I \
+    steamNetworkMessageBatch.h steamNetworkMessageBatch.I \
     steamNetworkSystem.h steamNetworkSystem.I
 
   #define COMPOSITE_SOURCES \
     config_steamnet.cxx \
+    steamNetworkDispatcher.cxx \
+    steamNetworkMessageBatch.cxx \
     steamNetworkSystem.cxx
 
   #define INSTALL_HEADERS \
     config_steamnet.h \
     steamnet_includes.h \
     steamNetworkConnectionInfo.h steamNetworkConnectionInfo.I \
+    steamNetworkDispatcher.h steamNetworkDispatcher.I \
     steamNetworkEnums.h \
     steamNetworkEvent.h steamNetworkEvent.I \
     steamNetworkMessage.h steamNetworkMessage.I \
+    steamNetworkMessageBatch.h steamNetworkMessageBatch.I \
     steamNetworkSystem.h steamNetworkSystem.I
 
   #define IGATESCAN all
 
 #end lib_target
+
+#begin test_bin_target
+  #define TARGET test_steamnet_dispatch
+  #define USE_PACKAGES valve_steamnet
+  #define LOCAL_LIBS steamnet express net putil pipeline
+
+  #define SOURCES \
+    test_steamnet_dispatch.cxx
+
+#end test_bin_target
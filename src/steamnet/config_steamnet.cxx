@@ -17,6 +17,17 @@ NotifyCategoryDef(steamnet, "");
 
 ConfigureDef(config_steamnet);
 
+ConfigVariableInt steamnet_message_batch_size
+("steamnet-message-batch-size", 256,
+ PRC_DESC("The default number of messages that a SteamNetworkMessageBatch "
+          "can hold, which is the most that a single batch receive call "
+          "will return."));
+
+ConfigVariableDouble steamnet_dispatch_idle_wait
+("steamnet-dispatch-idle-wait", 0.001,
+ PRC_DESC("The number of seconds that a SteamNetworkDispatcher thread waits "
+          "before polling again, after a poll that returned no messages."));
+
 ConfigureFn(config_steamnet) {
   init_libsteamnet();
 }
@@ -17,11 +17,16 @@
 #include "dconfig.h"
 #include "pandabase.h"
 #include "notifyCategoryProxy.h"
+#include "configVariableInt.h"
+#include "configVariableDouble.h"
 
 ConfigureDecl(config_steamnet, EXPCL_PANDA_STEAMNET, EXPTP_PANDA_STEAMNET);
 
 NotifyCategoryDecl(steamnet, EXPCL_PANDA_STEAMNET, EXPTP_PANDA_STEAMNET);
 
+extern EXPCL_PANDA_STEAMNET ConfigVariableInt steamnet_message_batch_size;
+extern EXPCL_PANDA_STEAMNET ConfigVariableDouble steamnet_dispatch_idle_wait;
+
 extern EXPCL_PANDA_STEAMNET void init_libsteamnet();
 
 #endif // CONFIG_STEAMNET_H
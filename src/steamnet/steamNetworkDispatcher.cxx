@@ -0,0 +1,247 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file steamNetworkDispatcher.cxx
+ * @author lachbr
+ * @date 2026-10-18
+ */
+
+#include "steamNetworkDispatcher.h"
+#include "steamNetworkSystem.h"
+#include "mutexHolder.h"
+#include "lightMutexHolder.h"
+
+#include <algorithm>
+
+/**
+ *
+ */
+SteamNetworkDispatcher::
+SteamNetworkDispatcher(SteamNetworkSystem *system,
+                       SteamNetworkPollGroupHandle poll_group,
+                       int batch_size) :
+  _system(system),
+  _poll_group(poll_group),
+  _batch(batch_size),
+  _num_messages_dispatched(0),
+  _num_batches_dispatched(0)
+{
+  _order.reserve(_batch.get_max_messages());
+  _run.reserve(_batch.get_max_messages());
+}
+
+/**
+ *
+ */
+SteamNetworkDispatcher::
+~SteamNetworkDispatcher() {
+  stop();
+}
+
+/**
+ * Starts a thread that receives and dispatches the messages on the poll group
+ * until stop() is called.  Returns true if the thread is running, false if it
+ * could not be started (for instance, because threading is not available).
+ */
+bool SteamNetworkDispatcher::
+start(ThreadPriority priority) {
+  if (!Thread::is_threading_supported()) {
+    steamnet_cat.warning()
+      << "Threading is not available; call poll() to dispatch messages.\n";
+    return false;
+  }
+
+  MutexHolder holder(_thread_lock);
+  if (_thread == nullptr) {
+    _thread = new DispatchThread(this);
+    if (!_thread->start(priority, true)) {
+      _thread = nullptr;
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * Stops the thread started by start(), if it is running, and waits for it to
+ * exit.  Any messages it has not yet received are left for the next poll.
+ */
+void SteamNetworkDispatcher::
+stop() {
+  PT(DispatchThread) thread;
+  {
+    MutexHolder holder(_thread_lock);
+    thread = _thread;
+    _thread = nullptr;
+  }
+
+  if (thread != nullptr) {
+    thread->stop();
+  }
+}
+
+/**
+ * Returns true if the dispatcher is running its own thread, false if it must
+ * be polled.
+ */
+bool SteamNetworkDispatcher::
+is_threaded() const {
+  MutexHolder holder(_thread_lock);
+  return _thread != nullptr;
+}
+
+/**
+ * Receives one batch of messages on the poll group, and dispatches them to
+ * their handlers on the calling thread.  Returns the number of messages
+ * dispatched.  This should not be called while the dispatcher is running its
+ * own thread.
+ */
+int SteamNetworkDispatcher::
+poll() {
+  nassertr(!is_threaded(), 0);
+  return do_poll();
+}
+
+/**
+ * Registers the handler that will receive the messages that arrive on the
+ * indicated connection, replacing any previous handler for it.
+ */
+void SteamNetworkDispatcher::
+set_handler(SteamNetworkConnectionHandle connection, Handler *handler) {
+  LightMutexHolder holder(_handlers_lock);
+  _handlers[connection] = handler;
+}
+
+/**
+ * Removes the handler for the indicated connection.  Its messages go to the
+ * default handler from now on, if there is one.
+ */
+void SteamNetworkDispatcher::
+clear_handler(SteamNetworkConnectionHandle connection) {
+  LightMutexHolder holder(_handlers_lock);
+  _handlers.erase(connection);
+}
+
+/**
+ * Specifies the handler that will receive the messages of any connection that
+ * has no handler of its own, or nullptr to discard them.
+ */
+void SteamNetworkDispatcher::
+set_default_handler(Handler *handler) {
+  LightMutexHolder holder(_handlers_lock);
+  _default_handler = handler;
+}
+
+/**
+ * Receives one batch of messages and dispatches them.  Returns the number of
+ * messages received.
+ */
+int SteamNetworkDispatcher::
+do_poll() {
+  int num_messages = _system->receive_messages_on_poll_group(_poll_group, _batch);
+  if (num_messages == 0) {
+    return 0;
+  }
+
+  // Group the messages by connection.  Since each entry also carries the
+  // message's index, the messages from each connection stay in the order in
+  // which they arrived.
+  _order.clear();
+  for (int i = 0; i < num_messages; ++i) {
+    _order.push_back(OrderEntry(_batch.get_message(i).get_connection(), i));
+  }
+  std::sort(_order.begin(), _order.end());
+
+  size_t i = 0;
+  while (i < _order.size()) {
+    SteamNetworkConnectionHandle connection = _order[i].first;
+    _run.clear();
+    while (i < _order.size() && _order[i].first == connection) {
+      _run.push_back(&_batch.get_message(_order[i].second));
+      ++i;
+    }
+
+    PT(Handler) handler = get_handler(connection);
+    if (handler != nullptr) {
+      handler->handle_messages(connection, &_run[0], (int)_run.size());
+    } else if (steamnet_cat.is_debug()) {
+      steamnet_cat.debug()
+        << "Discarding " << _run.size() << " message(s) from connection "
+        << connection << ", which has no handler.\n";
+    }
+  }
+
+  AtomicAdjust::add(_num_messages_dispatched, num_messages);
+  AtomicAdjust::inc(_num_batches_dispatched);
+  return num_messages;
+}
+
+/**
+ * Returns the handler for the indicated connection, or the default handler if
+ * it has none.
+ */
+PT(SteamNetworkDispatcher::Handler) SteamNetworkDispatcher::
+get_handler(SteamNetworkConnectionHandle connection) {
+  LightMutexHolder holder(_handlers_lock);
+  Handlers::const_iterator hi = _handlers.find(connection);
+  if (hi != _handlers.end()) {
+    return (*hi).second;
+  }
+  return _default_handler;
+}
+
+/**
+ *
+ */
+SteamNetworkDispatcher::Handler::
+~Handler() {
+}
+
+/**
+ *
+ */
+SteamNetworkDispatcher::DispatchThread::
+DispatchThread(SteamNetworkDispatcher *dispatcher) :
+  Thread("SteamNetworkDispatcher", "SteamNetworkDispatcher"),
+  _dispatcher(dispatcher),
+  _cvar(_lock),
+  _stop(false)
+{
+}
+
+/**
+ * Signals the thread to exit, and waits for it to do so.
+ */
+void SteamNetworkDispatcher::DispatchThread::
+stop() {
+  {
+    MutexHolder holder(_lock);
+    _stop = true;
+    _cvar.notify();
+  }
+  join();
+}
+
+/**
+ * The main loop of the dispatch thread.
+ */
+void SteamNetworkDispatcher::DispatchThread::
+thread_main() {
+  while (true) {
+    int num_messages = _dispatcher->do_poll();
+
+    MutexHolder holder(_lock);
+    if (num_messages == 0 && !_stop) {
+      // There was nothing waiting; give the messages a moment to arrive.
+      _cvar.wait(steamnet_dispatch_idle_wait);
+    }
+    if (_stop) {
+      return;
+    }
+  }
+}
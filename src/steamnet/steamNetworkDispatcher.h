@@ -0,0 +1,134 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file steamNetworkDispatcher.h
+ * @author lachbr
+ * @date 2026-10-18
+ */
+
+#ifndef STEAMNETWORKDISPATCHER_H
+#define STEAMNETWORKDISPATCHER_H
+
+#include "config_steamnet.h"
+#include "referenceCount.h"
+#include "pointerTo.h"
+#include "pvector.h"
+#include "pmap.h"
+#include "thread.h"
+#include "threadPriority.h"
+#include "pmutex.h"
+#include "conditionVar.h"
+#include "lightMutex.h"
+#include "atomicAdjust.h"
+#include "steamnet_includes.h"
+#include "steamNetworkMessage.h"
+#include "steamNetworkMessageBatch.h"
+
+class SteamNetworkSystem;
+
+/**
+ * Drains the messages arriving on a poll group in batches, and hands the
+ * messages from each connection to the handler registered for that
+ * connection.  This may be done by an explicit call to poll(), or by a
+ * thread of its own, started with start().
+ *
+ * When the dispatcher runs its own thread, the handlers are called on that
+ * thread, and must take care of their own synchronization.
+ *
+ * Since the handlers are C++ objects, this class is not exposed to the
+ * scripting language; a script reads its messages with
+ * SteamNetworkSystem::receive_messages_on_poll_group() instead.
+ */
+class EXPCL_PANDA_STEAMNET SteamNetworkDispatcher : public ReferenceCount {
+public:
+  explicit SteamNetworkDispatcher(SteamNetworkSystem *system,
+                                  SteamNetworkPollGroupHandle poll_group,
+                                  int batch_size = steamnet_message_batch_size);
+  ~SteamNetworkDispatcher();
+
+  INLINE SteamNetworkSystem *get_system() const;
+  INLINE SteamNetworkPollGroupHandle get_poll_group() const;
+
+  bool start(ThreadPriority priority = TP_normal);
+  void stop();
+  bool is_threaded() const;
+
+  int poll();
+
+  INLINE size_t get_num_messages_dispatched() const;
+  INLINE size_t get_num_batches_dispatched() const;
+
+  /**
+   * The interface for receiving the messages of one or more connections.
+   * handle_messages() is called with each run of messages that arrived on the
+   * indicated connection, in order.  The messages are only valid for the
+   * duration of the call.
+   */
+  class EXPCL_PANDA_STEAMNET Handler : public ReferenceCount {
+  public:
+    virtual ~Handler();
+    virtual void handle_messages(SteamNetworkConnectionHandle connection,
+                                 SteamNetworkMessage *const *messages,
+                                 int num_messages)=0;
+  };
+
+  void set_handler(SteamNetworkConnectionHandle connection, Handler *handler);
+  void clear_handler(SteamNetworkConnectionHandle connection);
+  void set_default_handler(Handler *handler);
+
+private:
+  int do_poll();
+  PT(Handler) get_handler(SteamNetworkConnectionHandle connection);
+
+  // This thread calls do_poll() until it is stopped, waiting briefly
+  // whenever there is nothing to receive.
+  class DispatchThread : public Thread {
+  public:
+    DispatchThread(SteamNetworkDispatcher *dispatcher);
+
+    void stop();
+
+  protected:
+    virtual void thread_main();
+
+  private:
+    SteamNetworkDispatcher *_dispatcher;
+
+    Mutex _lock;
+    ConditionVar _cvar;
+    bool _stop;
+  };
+
+private:
+  SteamNetworkSystem *_system;
+  SteamNetworkPollGroupHandle _poll_group;
+
+  // These are only touched by whichever thread is polling, and are kept from
+  // one poll to the next so that dispatching doesn't allocate.
+  SteamNetworkMessageBatch _batch;
+  typedef std::pair<SteamNetworkConnectionHandle, int> OrderEntry;
+  pvector<OrderEntry> _order;
+  pvector<SteamNetworkMessage *> _run;
+
+  LightMutex _handlers_lock;
+  typedef pmap<SteamNetworkConnectionHandle, PT(Handler)> Handlers;
+  Handlers _handlers;
+  PT(Handler) _default_handler;
+
+  mutable Mutex _thread_lock;
+  PT(DispatchThread) _thread;
+
+  AtomicAdjust::Integer _num_messages_dispatched;
+  AtomicAdjust::Integer _num_batches_dispatched;
+
+  friend class DispatchThread;
+};
+
+#include "steamNetworkDispatcher.I"
+
+#endif // STEAMNETWORKDISPATCHER_H
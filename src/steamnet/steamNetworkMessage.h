@@ -37,6 +37,9 @@ PUBLISHED:
   INLINE DatagramIterator &get_datagram_iterator();
   MAKE_PROPERTY(dgi, get_datagram_iterator);
 
+public:
+  INLINE void set_data(const void *data, size_t size);
+
 private:
   Datagram _dg;
   DatagramIterator _dgi;
@@ -0,0 +1,65 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file steamNetworkMessageBatch.cxx
+ * @author lachbr
+ * @date 2026-10-18
+ */
+
+#include "steamNetworkMessageBatch.h"
+
+/**
+ *
+ */
+SteamNetworkMessageBatch::
+SteamNetworkMessageBatch(int max_messages) :
+  _num_messages(0)
+{
+  max_messages = std::max(max_messages, 1);
+
+  // The messages are never reallocated after this, since each one's
+  // DatagramIterator points at its own Datagram.
+  _messages.resize(max_messages);
+  _raw_messages.resize(max_messages, nullptr);
+}
+
+/**
+ *
+ */
+SteamNetworkMessageBatch::
+~SteamNetworkMessageBatch() {
+}
+
+/**
+ * Returns the array into which SteamNetworkingSockets should write up to
+ * get_max_messages() incoming messages.
+ */
+ISteamNetworkingMessage **SteamNetworkMessageBatch::
+get_raw_messages() {
+  return &_raw_messages[0];
+}
+
+/**
+ * Copies the first num_messages incoming messages from the raw array into the
+ * batch, and then releases them back to SteamNetworkingSockets.
+ */
+void SteamNetworkMessageBatch::
+fill(int num_messages) {
+  num_messages = std::min(std::max(num_messages, 0), get_max_messages());
+
+  for (int i = 0; i < num_messages; ++i) {
+    ISteamNetworkingMessage *in_msg = _raw_messages[i];
+    SteamNetworkMessage &msg = _messages[i];
+    msg.set_data(in_msg->m_pData, in_msg->m_cbSize);
+    msg.set_connection(in_msg->GetConnection());
+    in_msg->Release();
+    _raw_messages[i] = nullptr;
+  }
+
+  _num_messages = num_messages;
+}
@@ -0,0 +1,59 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file steamNetworkMessageBatch.h
+ * @author lachbr
+ * @date 2026-10-18
+ */
+
+#ifndef STEAMNETWORKMESSAGEBATCH_H
+#define STEAMNETWORKMESSAGEBATCH_H
+
+#include "config_steamnet.h"
+#include "referenceCount.h"
+#include "pvector.h"
+#include "steamnet_includes.h"
+#include "steamNetworkMessage.h"
+
+/**
+ * A reusable array of incoming messages, filled by the batch receive methods
+ * of SteamNetworkSystem.  The messages are kept from one receive to the next,
+ * so that draining many messages doesn't allocate a new message, or new
+ * datagram storage, for each one.
+ */
+class EXPCL_PANDA_STEAMNET SteamNetworkMessageBatch : public ReferenceCount {
+PUBLISHED:
+  explicit SteamNetworkMessageBatch(int max_messages = steamnet_message_batch_size);
+  ~SteamNetworkMessageBatch();
+
+  INLINE int get_max_messages() const;
+  MAKE_PROPERTY(max_messages, get_max_messages);
+
+  INLINE int get_num_messages() const;
+  INLINE SteamNetworkMessage &get_message(int n);
+  MAKE_SEQ(get_messages, get_num_messages, get_message);
+  INLINE size_t size() const;
+  INLINE SteamNetworkMessage &operator [] (int n);
+
+  INLINE void clear();
+
+public:
+  ISteamNetworkingMessage **get_raw_messages();
+  void fill(int num_messages);
+
+private:
+  typedef pvector<SteamNetworkMessage> Messages;
+  Messages _messages;
+  int _num_messages;
+
+  pvector<ISteamNetworkingMessage *> _raw_messages;
+};
+
+#include "steamNetworkMessageBatch.I"
+
+#endif // STEAMNETWORKMESSAGEBATCH_H
@@ -13,6 +13,7 @@
 
 #include "steamNetworkSystem.h"
 #include "steamNetworkMessage.h"
+#include "steamNetworkMessageBatch.h"
 #include "steamNetworkConnectionInfo.h"
 
 #ifndef CPPPARSER
@@ -166,6 +167,7 @@ receive_message_on_connection(SteamNetworkConnectionHandle conn, SteamNetworkMes
 
   msg.set_datagram(Datagram(in_msg->m_pData, in_msg->m_cbSize));
   msg.set_connection(in_msg->GetConnection());
+  in_msg->Release();
 
   return true;
 }
@@ -183,10 +185,40 @@ receive_message_on_poll_group(SteamNetworkPollGroupHandle poll_group, SteamNetwo
 
   msg.set_datagram(Datagram(in_msg->m_pData, in_msg->m_cbSize));
   msg.set_connection(in_msg->GetConnection());
+  in_msg->Release();
 
   return true;
 }
 
+/**
+ * Receives up to batch.get_max_messages() messages on the indicated
+ * connection, replacing the previous contents of the batch.  Returns the
+ * number of messages received.
+ */
+int SteamNetworkSystem::
+receive_messages_on_connection(SteamNetworkConnectionHandle conn, SteamNetworkMessageBatch &batch) {
+  int msg_count = _interface->ReceiveMessagesOnConnection(
+    conn, batch.get_raw_messages(), batch.get_max_messages());
+  batch.fill(msg_count);
+  return batch.get_num_messages();
+}
+
+/**
+ * Receives up to batch.get_max_messages() messages on the indicated poll
+ * group, replacing the previous contents of the batch.  Returns the number of
+ * messages received.
+ *
+ * This is much cheaper than calling receive_message_on_poll_group() once per
+ * message, since the messages in the batch are reused.
+ */
+int SteamNetworkSystem::
+receive_messages_on_poll_group(SteamNetworkPollGroupHandle poll_group, SteamNetworkMessageBatch &batch) {
+  int msg_count = _interface->ReceiveMessagesOnPollGroup(
+    poll_group, batch.get_raw_messages(), batch.get_max_messages());
+  batch.fill(msg_count);
+  return batch.get_num_messages();
+}
+
 /**
  *
  */
@@ -27,6 +27,7 @@
 
 class SteamNetworkConnectionInfo;
 class SteamNetworkMessage;
+class SteamNetworkMessageBatch;
 
 /**
  * Main interface to the SteamNetworkingSockets implementation.
@@ -48,6 +49,8 @@ PUBLISHED:
   bool set_connection_poll_group(SteamNetworkConnectionHandle conn, SteamNetworkPollGroupHandle poll_group);
   bool receive_message_on_connection(SteamNetworkConnectionHandle conn, SteamNetworkMessage &msg);
   bool receive_message_on_poll_group(SteamNetworkPollGroupHandle poll_group, SteamNetworkMessage &msg);
+  int receive_messages_on_connection(SteamNetworkConnectionHandle conn, SteamNetworkMessageBatch &batch);
+  int receive_messages_on_poll_group(SteamNetworkPollGroupHandle poll_group, SteamNetworkMessageBatch &batch);
   SteamNetworkPollGroupHandle create_poll_group();
   SteamNetworkListenSocketHandle create_listen_socket(int port);
 
@@ -19,6 +19,8 @@
 #include "steam/steamnetworkingtypes.h"
 #else
 class ISteamNetworkingSockets;
+struct SteamNetworkingMessage_t;
+typedef SteamNetworkingMessage_t ISteamNetworkingMessage;
 #endif // CPPPARSER
 
 typedef uint32_t SteamNetworkListenSocketHandle;
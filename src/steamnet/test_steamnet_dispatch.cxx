@@ -0,0 +1,245 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file test_steamnet_dispatch.cxx
+ * @author lachbr
+ * @date 2026-10-18
+ */
+
+#include "pandabase.h"
+#include "steamNetworkSystem.h"
+#include "steamNetworkMessage.h"
+#include "steamNetworkMessageBatch.h"
+#include "steamNetworkDispatcher.h"
+#include "netAddress.h"
+#include "datagram.h"
+#include "trueClock.h"
+#include "thread.h"
+#include "atomicAdjust.h"
+#include "pset.h"
+#include "pvector.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * Counts the messages handed to it by the dispatcher.
+ */
+class CountingHandler : public SteamNetworkDispatcher::Handler {
+public:
+  CountingHandler() : _count(0) {}
+
+  virtual void handle_messages(SteamNetworkConnectionHandle connection,
+                               SteamNetworkMessage *const *messages,
+                               int num_messages) {
+    AtomicAdjust::add(_count, num_messages);
+  }
+
+  AtomicAdjust::Integer _count;
+};
+
+typedef pvector<SteamNetworkConnectionHandle> Clients;
+
+/**
+ * Opens the indicated number of client connections to our own listen socket,
+ * and waits for them all to be accepted onto the poll group.  Returns true
+ * on success.
+ */
+static bool
+connect_clients(SteamNetworkSystem *system, int port, int num_clients,
+                SteamNetworkPollGroupHandle poll_group, Clients &clients) {
+  NetAddress addr;
+  if (!addr.set_host("127.0.0.1", port)) {
+    return false;
+  }
+
+  pset<SteamNetworkConnectionHandle> client_set;
+  for (int i = 0; i < num_clients; ++i) {
+    SteamNetworkConnectionHandle conn = system->connect_by_IP_address(addr);
+    clients.push_back(conn);
+    client_set.insert(conn);
+  }
+
+  TrueClock *clock = TrueClock::get_global_ptr();
+  double start = clock->get_short_time();
+  int num_connected = 0;
+  int num_accepted = 0;
+  while (num_connected < num_clients || num_accepted < num_clients) {
+    if (clock->get_short_time() - start > 30.0) {
+      nout << "Timed out with " << num_connected << " of " << num_clients
+           << " clients connected.\n";
+      return false;
+    }
+
+    system->run_callbacks();
+    PT(SteamNetworkEvent) event = system->get_next_event();
+    while (event != nullptr) {
+      SteamNetworkConnectionHandle conn = event->get_connection();
+      bool is_client = (client_set.find(conn) != client_set.end());
+      if (!is_client && event->get_state() == SteamNetworkSystem::NCS_connecting) {
+        if (system->accept_connection(conn) &&
+            system->set_connection_poll_group(conn, poll_group)) {
+          ++num_accepted;
+        }
+      } else if (is_client && event->get_state() == SteamNetworkSystem::NCS_connected) {
+        ++num_connected;
+      }
+      event = system->get_next_event();
+    }
+    Thread::sleep(0.001);
+  }
+
+  return true;
+}
+
+/**
+ * Sends the indicated number of messages from each client, interleaved.
+ */
+static void
+send_messages(SteamNetworkSystem *system, const Clients &clients,
+              int num_messages, int message_size) {
+  Datagram dg;
+  for (int n = 0; n < num_messages; ++n) {
+    dg.clear();
+    dg.add_uint32(n);
+    if (message_size > 4) {
+      dg.pad_bytes(message_size - 4);
+    }
+    for (SteamNetworkConnectionHandle conn : clients) {
+      system->send_datagram(conn, dg);
+    }
+  }
+}
+
+/**
+ * Reports the rate at which total messages were received in elapsed seconds.
+ */
+static void
+report(const std::string &name, int received, int total, double elapsed) {
+  nout << "  " << name << ": " << received << " of " << total
+       << " messages in " << elapsed * 1000.0 << " ms";
+  if (elapsed > 0.0) {
+    nout << ", " << (int)(received / elapsed) << " messages/sec";
+  }
+  nout << "\n";
+}
+
+int
+main(int argc, char *argv[]) {
+  int num_clients = 64;
+  int num_messages = 1000;
+  int message_size = 32;
+
+  int i = 1;
+  while (i + 1 < argc && argv[i][0] == '-') {
+    if (strcmp(argv[i], "-c") == 0) {
+      num_clients = std::max(atoi(argv[i + 1]), 1);
+    } else if (strcmp(argv[i], "-n") == 0) {
+      num_messages = std::max(atoi(argv[i + 1]), 1);
+    } else if (strcmp(argv[i], "-s") == 0) {
+      message_size = std::max(atoi(argv[i + 1]), 4);
+    } else {
+      break;
+    }
+    i += 2;
+  }
+
+  if (argc != i + 1) {
+    nout << "test_steamnet_dispatch [-c clients] [-n messages] [-s bytes] port\n";
+    exit(1);
+  }
+  int port = atoi(argv[i]);
+
+  SteamNetworkSystem *system = SteamNetworkSystem::get_global_ptr();
+  if (system->create_listen_socket(port) == INVALID_STEAM_NETWORK_LISTEN_SOCKET_HANDLE) {
+    nout << "Unable to listen on port " << port << "\n";
+    exit(1);
+  }
+  SteamNetworkPollGroupHandle poll_group = system->create_poll_group();
+
+  Clients clients;
+  if (!connect_clients(system, port, num_clients, poll_group, clients)) {
+    exit(1);
+  }
+
+  int total = num_clients * num_messages;
+  nout << num_clients << " clients, " << num_messages << " messages each of "
+       << message_size << " bytes:\n";
+
+  TrueClock *clock = TrueClock::get_global_ptr();
+  static const double timeout = 30.0;
+
+  // One message at a time, as the server did before batching.
+  {
+    double start = clock->get_short_time();
+    send_messages(system, clients, num_messages, message_size);
+    SteamNetworkMessage msg;
+    int received = 0;
+    while (received < total && clock->get_short_time() - start < timeout) {
+      if (system->receive_message_on_poll_group(poll_group, msg)) {
+        ++received;
+      } else {
+        Thread::sleep(0.0001);
+      }
+    }
+    report("single", received, total, clock->get_short_time() - start);
+  }
+
+  // Draining a reusable batch at a time.
+  {
+    double start = clock->get_short_time();
+    send_messages(system, clients, num_messages, message_size);
+    SteamNetworkMessageBatch batch;
+    int received = 0;
+    while (received < total && clock->get_short_time() - start < timeout) {
+      int num_received = system->receive_messages_on_poll_group(poll_group, batch);
+      if (num_received > 0) {
+        received += num_received;
+      } else {
+        Thread::sleep(0.0001);
+      }
+    }
+    report("batch", received, total, clock->get_short_time() - start);
+  }
+
+  // Handing per-connection batches to a handler on the dispatch thread.
+  {
+    PT(CountingHandler) handler = new CountingHandler;
+    PT(SteamNetworkDispatcher) dispatcher =
+      new SteamNetworkDispatcher(system, poll_group);
+    dispatcher->set_default_handler(handler);
+
+    double start = clock->get_short_time();
+    bool threaded = dispatcher->start();
+    send_messages(system, clients, num_messages, message_size);
+    while (AtomicAdjust::get(handler->_count) < total &&
+           clock->get_short_time() - start < timeout) {
+      if (threaded) {
+        Thread::sleep(0.0001);
+      } else if (dispatcher->poll() == 0) {
+        Thread::sleep(0.0001);
+      }
+    }
+    double elapsed = clock->get_short_time() - start;
+    dispatcher->stop();
+
+    report(threaded ? "dispatch thread" : "dispatch (polled)",
+           (int)AtomicAdjust::get(handler->_count), total, elapsed);
+    if (dispatcher->get_num_batches_dispatched() > 0) {
+      nout << "    average batch: "
+           << (double)dispatcher->get_num_messages_dispatched() /
+              dispatcher->get_num_batches_dispatched()
+           << " messages\n";
+    }
+  }
+
+  for (SteamNetworkConnectionHandle conn : clients) {
+    system->close_connection(conn);
+  }
+  return 0;
+}
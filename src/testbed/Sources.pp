@@ -38,3 +38,38 @@
   #define TARGET test_map
   #define SOURCES test_map.cxx
 #end test_bin_target
+
+#begin test_bin_target
+  #define TARGET test_bam_load
+  #define SOURCES test_bam_load.cxx
+#end test_bin_target
+
+#begin test_bin_target
+  #define TARGET test_pnm_filter
+  #define SOURCES test_pnm_filter.cxx
+#end test_bin_target
+
+#begin test_bin_target
+  #define TARGET test_collide_parallel
+  #define SOURCES test_collide_parallel.cxx
+#end test_bin_target
+
+#begin test_bin_target
+  #define TARGET test_cull_parallel
+  #define SOURCES test_cull_parallel.cxx
+#end test_bin_target
+
+#begin test_bin_target
+  #define TARGET test_anim_parallel
+  #define SOURCES test_anim_parallel.cxx
+#end test_bin_target
+
+#begin test_bin_target
+  #define TARGET test_anim_lod
+  #define SOURCES test_anim_lod.cxx
+#end test_bin_target
+
+#begin test_bin_target
+  #define TARGET test_skinning
+  #define SOURCES test_skinning.cxx
+#end test_bin_target
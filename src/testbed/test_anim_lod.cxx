@@ -0,0 +1,181 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file test_anim_lod.cxx
+ * @author lachbr
+ * @date 2026-10-18
+ */
+
+#include "pandabase.h"
+#include "partBundle.h"
+#include "partSubset.h"
+#include "movingPartMatrix.h"
+#include "animBundle.h"
+#include "animChannelMatrixXfmTable.h"
+#include "animControl.h"
+#include "pta_stdfloat.h"
+#include "string_utils.h"
+
+typedef pvector<LMatrix4> Values;
+
+static const int num_joints = 12;
+static const int num_frames = 30;
+
+/**
+ * Builds a PartBundle with a chain of joints, bound to an animation that
+ * moves every joint on every frame.  Calling this twice produces two
+ * identical bundles.
+ */
+static PT(AnimControl)
+make_bundle(PT(PartBundle) &bundle) {
+  static const char components[] = "xyzhpr";
+
+  bundle = new PartBundle("bundle");
+  PT(AnimBundle) anim = new AnimBundle("anim", 24.0f, num_frames);
+
+  PartGroup *part_parent = bundle;
+  AnimGroup *anim_parent = anim;
+  for (int j = 0; j < num_joints; ++j) {
+    std::string name = "joint" + format_string(j);
+    part_parent = new MovingPartMatrix(part_parent, name, LMatrix4::ident_mat());
+
+    AnimChannelMatrixXfmTable *channel =
+      new AnimChannelMatrixXfmTable(anim_parent, name);
+    for (int c = 0; c < 6; ++c) {
+      PTA_stdfloat table = PTA_stdfloat::empty_array(num_frames);
+      for (int f = 0; f < num_frames; ++f) {
+        table[f] = (PN_stdfloat)((j * 3 + c + f) % 23) * 0.25f;
+      }
+      channel->set_table(components[c], table);
+    }
+    anim_parent = channel;
+  }
+
+  return bundle->bind_anim(anim, PartGroup::HMF_ok_wrong_root_name);
+}
+
+/**
+ * Returns the value of each joint of the bundle, from the root down.
+ */
+static Values
+get_values(PartBundle *bundle) {
+  Values values;
+  PartGroup *part = bundle;
+  while (part->get_num_children() > 0) {
+    part = part->get_child(0);
+    values.push_back(DCAST(MovingPartMatrix, part)->get_value());
+  }
+  return values;
+}
+
+/**
+ * Checks that the first num_animated joints of the bundle match those of the
+ * full-detail bundle.  The rest are frozen at this level of detail, and are
+ * expected to be stale.
+ */
+static bool
+compare(const std::string &name, PartBundle *bundle, PartBundle *full,
+        int num_animated) {
+  Values values = get_values(bundle);
+  Values expected = get_values(full);
+  for (int j = 0; j < num_animated; ++j) {
+    if (values[j] != expected[j]) {
+      nout << name << ": joint" << j << " is " << values[j]
+           << ", expected " << expected[j] << "\n";
+      return false;
+    }
+  }
+  nout << name << ": " << num_animated << " joints match\n";
+  return true;
+}
+
+/**
+ * Poses both controls at the indicated frame, which leaves them paused there,
+ * and updates both bundles.
+ */
+static void
+pose(AnimControl *control, AnimControl *full_control, int frame, bool force) {
+  control->pose(frame);
+  full_control->pose(frame);
+  if (force) {
+    control->get_part()->force_update();
+    full_control->get_part()->force_update();
+  } else {
+    control->get_part()->update();
+    full_control->get_part()->update();
+  }
+}
+
+/**
+ * Steps a bundle through its levels of detail while its animation is paused,
+ * and checks that the joints that are unfrozen by each change catch up with
+ * a bundle that is always animated at full detail.
+ */
+static bool
+run_levels(const std::string &name, bool force) {
+  PT(PartBundle) bundle, full;
+  PT(AnimControl) control = make_bundle(bundle);
+  PT(AnimControl) full_control = make_bundle(full);
+
+  // Level 1 freezes joint8 and below; level 2 freezes joint4 and below.
+  PartSubset subset1, subset2;
+  subset1.add_exclude_joint(GlobPattern("joint8"));
+  subset2.add_exclude_joint(GlobPattern("joint4"));
+  bundle->add_lod_level(10.0f, subset1);
+  bundle->add_lod_level(20.0f, subset2);
+
+  bool ok = true;
+
+  bundle->set_lod_level(2);
+  pose(control, full_control, 5, force);
+  ok = compare(name + " level 2", bundle, full, 4) && ok;
+
+  // The control is still paused on frame 5, so nothing but the change in
+  // the level of detail tells the bundle that joints 4 through 7 are stale.
+  bundle->set_lod_level(1);
+  if (force) {
+    bundle->force_update();
+  } else if (!bundle->update()) {
+    nout << name << ": update() did nothing after set_lod_level(1)\n";
+    ok = false;
+  }
+  ok = compare(name + " level 2 to 1", bundle, full, 8) && ok;
+
+  pose(control, full_control, 12, force);
+  ok = compare(name + " level 1", bundle, full, 8) && ok;
+
+  bundle->set_lod_level(0);
+  if (force) {
+    bundle->force_update();
+  } else if (!bundle->update()) {
+    nout << name << ": update() did nothing after set_lod_level(0)\n";
+    ok = false;
+  }
+  ok = compare(name + " level 1 to 0", bundle, full, num_joints) && ok;
+
+  // Dropping straight from the lowest level back to full detail.
+  bundle->set_lod_level(2);
+  pose(control, full_control, 20, force);
+  bundle->set_lod_level(0);
+  if (force) {
+    bundle->force_update();
+  } else {
+    bundle->update();
+  }
+  ok = compare(name + " level 2 to 0", bundle, full, num_joints) && ok;
+
+  return ok;
+}
+
+int
+main(int argc, char *argv[]) {
+  bool ok = true;
+  ok = run_levels("update", false) && ok;
+  ok = run_levels("force_update", true) && ok;
+  return ok ? 0 : 1;
+}
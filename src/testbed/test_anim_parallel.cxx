@@ -0,0 +1,180 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file test_anim_parallel.cxx
+ * @author lachbr
+ * @date 2026-10-18
+ */
+
+#include "pandabase.h"
+#include "partBundle.h"
+#include "movingPartMatrix.h"
+#include "animBundle.h"
+#include "animChannelMatrixXfmTable.h"
+#include "animControl.h"
+#include "asyncTaskManager.h"
+#include "config_chan.h"
+#include "pta_stdfloat.h"
+#include "string_utils.h"
+
+#include <algorithm>
+
+typedef pvector<PT(PartBundle)> Bundles;
+typedef pvector<PT(AnimControl)> Controls;
+typedef pvector<LMatrix4> Values;
+
+static const int num_joints = 12;
+static const int num_frames = 30;
+
+/**
+ * Returns a table of num_frames values that differs for each bundle, joint
+ * and component.
+ */
+static CPTA_stdfloat
+make_table(int b, int j, int c) {
+  PTA_stdfloat table = PTA_stdfloat::empty_array(num_frames);
+  for (int f = 0; f < num_frames; ++f) {
+    table[f] = (PN_stdfloat)((b * 7 + j * 3 + c + f) % 23) * 0.25f;
+  }
+  return table;
+}
+
+/**
+ * Builds num_bundles PartBundles, each with a chain of joints, and binds each
+ * one to an animation of its own.  Calling this twice produces two identical
+ * sets of bundles.
+ */
+static void
+make_bundles(int num_bundles, Bundles &bundles, Controls &controls) {
+  static const char components[] = "xyzhpr";
+
+  for (int b = 0; b < num_bundles; ++b) {
+    PT(PartBundle) bundle = new PartBundle("bundle");
+    PT(AnimBundle) anim = new AnimBundle("anim", 24.0f, num_frames);
+
+    PartGroup *part_parent = bundle;
+    AnimGroup *anim_parent = anim;
+    for (int j = 0; j < num_joints; ++j) {
+      std::string name = "joint" + format_string(j);
+      part_parent = new MovingPartMatrix(part_parent, name, LMatrix4::ident_mat());
+
+      AnimChannelMatrixXfmTable *channel =
+        new AnimChannelMatrixXfmTable(anim_parent, name);
+      for (int c = 0; c < 6; ++c) {
+        channel->set_table(components[c], make_table(b, j, c));
+      }
+      anim_parent = channel;
+    }
+
+    PT(AnimControl) control =
+      bundle->bind_anim(anim, PartGroup::HMF_ok_wrong_root_name);
+    nassertv(control != nullptr);
+
+    bundles.push_back(bundle);
+    controls.push_back(control);
+  }
+}
+
+/**
+ * Appends the value of each joint of each bundle to the list.
+ */
+static void
+get_values(const Bundles &bundles, Values &values) {
+  values.clear();
+  for (PartBundle *bundle : bundles) {
+    PartGroup *part = bundle;
+    while (part->get_num_children() > 0) {
+      part = part->get_child(0);
+      values.push_back(DCAST(MovingPartMatrix, part)->get_value());
+    }
+  }
+}
+
+/**
+ * Reports the first difference between the serial and parallel results, and
+ * returns true if there was none.
+ */
+static bool
+compare(const std::string &name, int frame, const Values &serial,
+        const Values &parallel) {
+  if (serial.size() != parallel.size()) {
+    nout << name << ": " << parallel.size() << " joints, expected "
+         << serial.size() << "\n";
+    return false;
+  }
+  for (size_t i = 0; i < serial.size(); ++i) {
+    if (serial[i] != parallel[i]) {
+      nout << name << ": joint " << i << " at frame " << frame << " is "
+           << parallel[i] << ", expected " << serial[i] << "\n";
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * Poses both sets of bundles at each frame in turn, and evaluates one set with
+ * force_update() and the other with update_bundles().  Returns true if the
+ * joints came out the same.
+ */
+static bool
+run_frames(const std::string &name, const Bundles &serial_bundles,
+           const Controls &serial_controls, const Bundles &parallel_bundles,
+           const Controls &parallel_controls) {
+  Values serial, parallel;
+  for (int frame = 0; frame < num_frames; ++frame) {
+    for (AnimControl *control : serial_controls) {
+      control->pose(frame);
+    }
+    for (AnimControl *control : parallel_controls) {
+      control->pose(frame);
+    }
+
+    for (PartBundle *bundle : serial_bundles) {
+      bundle->force_update();
+    }
+    get_values(serial_bundles, serial);
+
+    pvector<PartBundle *> bundles(parallel_bundles.begin(), parallel_bundles.end());
+    PartBundle::update_bundles(&bundles[0], bundles.size(), true);
+    get_values(parallel_bundles, parallel);
+
+    if (!compare(name, frame, serial, parallel)) {
+      return false;
+    }
+  }
+  nout << name << ": " << serial.size() << " joints match over "
+       << num_frames << " frames\n";
+  return true;
+}
+
+int
+main(int argc, char *argv[]) {
+  int num_bundles = 64;
+
+  Bundles serial_bundles, parallel_bundles;
+  Controls serial_controls, parallel_controls;
+  make_bundles(num_bundles, serial_bundles, serial_controls);
+  make_bundles(num_bundles, parallel_bundles, parallel_controls);
+
+  bool ok = true;
+
+  // An "animation" chain without any threads must not hang the update; the
+  // calling thread does all of the work.
+  AsyncTaskManager *task_mgr = AsyncTaskManager::get_global_ptr();
+  AsyncTaskChain *chain = task_mgr->make_task_chain("animation");
+  chain->set_num_threads(0);
+  ok = run_frames("no threads", serial_bundles, serial_controls,
+                  parallel_bundles, parallel_controls) && ok;
+
+  chain->set_num_threads(std::max((int)anim_update_num_threads, 1));
+  ok = run_frames("parallel", serial_bundles, serial_controls,
+                  parallel_bundles, parallel_controls) && ok;
+
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,111 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file test_bam_load.cxx
+ * @author lachbr
+ * @date 2026-10-18
+ */
+
+#include "pandaFramework.h"
+#include "bamFile.h"
+#include "bamReader.h"
+#include "texturePool.h"
+#include "trueClock.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+PandaFramework framework;
+
+/**
+ * Loads the indicated bam file once, with the indicated read-ahead size, and
+ * returns the elapsed time in seconds, or -1 on failure.
+ */
+static double
+time_load(const Filename &filename, size_t read_ahead_size) {
+  // Make sure we are measuring the load, not the texture cache.
+  TexturePool::release_all_textures();
+
+  TrueClock *clock = TrueClock::get_global_ptr();
+  double start = clock->get_long_time();
+
+  BamFile bam_file;
+  if (!bam_file.open_read(filename)) {
+    return -1.0;
+  }
+  bam_file.get_reader()->set_read_ahead_size(read_ahead_size);
+
+  PT(PandaNode) node = bam_file.read_node();
+  double elapsed = clock->get_long_time() - start;
+  if (node == nullptr) {
+    return -1.0;
+  }
+  return elapsed;
+}
+
+int
+main(int argc, char *argv[]) {
+  framework.open_framework(argc, argv);
+
+  int num_iterations = 5;
+  size_t read_ahead_size = 16 * 1024 * 1024;
+
+  int i = 1;
+  while (i + 1 < argc && argv[i][0] == '-') {
+    if (strcmp(argv[i], "-n") == 0) {
+      num_iterations = std::max(atoi(argv[i + 1]), 1);
+    } else if (strcmp(argv[i], "-r") == 0) {
+      read_ahead_size = (size_t)std::max(atoi(argv[i + 1]), 1);
+    } else {
+      break;
+    }
+    i += 2;
+  }
+
+  if (i >= argc) {
+    std::cerr
+      << "Usage: test_bam_load [-n iterations] [-r read_ahead_bytes] "
+      << "file.bam [file.bam ...]\n";
+    return 1;
+  }
+
+  for (; i < argc; ++i) {
+    Filename filename = Filename::from_os_specific(argv[i]);
+
+    // Alternate between the two modes, so that both see the same state of
+    // the disk cache.
+    double serial_total = 0.0, serial_best = 0.0;
+    double read_ahead_total = 0.0, read_ahead_best = 0.0;
+    for (int n = 0; n < num_iterations; ++n) {
+      double serial = time_load(filename, 0);
+      double read_ahead = time_load(filename, read_ahead_size);
+      if (serial < 0.0 || read_ahead < 0.0) {
+        std::cerr << "Unable to load " << filename << "\n";
+        break;
+      }
+
+      serial_total += serial;
+      read_ahead_total += read_ahead;
+      if (n == 0 || serial < serial_best) {
+        serial_best = serial;
+      }
+      if (n == 0 || read_ahead < read_ahead_best) {
+        read_ahead_best = read_ahead;
+      }
+    }
+
+    nout << filename << ":\n"
+         << "  serial:     best " << serial_best * 1000.0 << " ms, avg "
+         << serial_total * 1000.0 / num_iterations << " ms\n"
+         << "  read-ahead: best " << read_ahead_best * 1000.0 << " ms, avg "
+         << read_ahead_total * 1000.0 / num_iterations << " ms\n";
+  }
+
+  framework.close_framework();
+  return 0;
+}
@@ -0,0 +1,141 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file test_collide_parallel.cxx
+ * @author lachbr
+ * @date 2026-10-18
+ */
+
+#include "pandabase.h"
+#include "collisionTraverser.h"
+#include "collisionHandlerQueue.h"
+#include "collisionNode.h"
+#include "collisionSphere.h"
+#include "collisionEntry.h"
+#include "asyncTaskManager.h"
+#include "config_collide.h"
+#include "nodePath.h"
+
+#include <algorithm>
+#include <sstream>
+
+/**
+ * Builds a scene graph a few levels deep, so that the parallel traversal has
+ * plenty of subtrees to hand out, with a CollisionSphere at each leaf.
+ */
+static NodePath
+make_scene(int num_groups, int num_leaves) {
+  NodePath root("root");
+  for (int g = 0; g < num_groups; ++g) {
+    NodePath group = root.attach_new_node("group");
+    group.set_pos((PN_stdfloat)(g % 8) * 4.0f, (PN_stdfloat)(g / 8) * 4.0f, 0.0f);
+    for (int s = 0; s < 4; ++s) {
+      NodePath subgroup = group.attach_new_node("subgroup");
+      subgroup.set_pos(0.0f, 0.0f, (PN_stdfloat)s);
+      for (int l = 0; l < num_leaves; ++l) {
+        PT(CollisionNode) cnode = new CollisionNode("leaf");
+        PN_stdfloat x = (PN_stdfloat)(l % 4) * 0.75f;
+        PN_stdfloat y = (PN_stdfloat)(l / 4) * 0.75f;
+        cnode->add_solid(new CollisionSphere(x, y, 0.0f, 0.5f));
+        subgroup.attach_new_node(cnode);
+      }
+    }
+  }
+  return root;
+}
+
+/**
+ * Traverses the scene once and returns a description of each entry the
+ * handler received, in the order it received them.
+ */
+static pvector<std::string>
+traverse(CollisionTraverser &trav, CollisionHandlerQueue *queue,
+         const NodePath &root) {
+  queue->clear_entries();
+  trav.traverse(root);
+
+  pvector<std::string> result;
+  int num_entries = queue->get_num_entries();
+  for (int i = 0; i < num_entries; ++i) {
+    CollisionEntry *entry = queue->get_entry(i);
+    std::ostringstream strm;
+    strm << entry->get_from_node_path() << " into "
+         << entry->get_into_node_path() << " at "
+         << entry->get_surface_point(root);
+    result.push_back(strm.str());
+  }
+  return result;
+}
+
+/**
+ * Reports the first difference between the serial and parallel results, and
+ * returns true if there was none.
+ */
+static bool
+compare(const std::string &name, const pvector<std::string> &serial,
+        const pvector<std::string> &parallel) {
+  if (serial.size() != parallel.size()) {
+    nout << name << ": " << parallel.size() << " entries, expected "
+         << serial.size() << "\n";
+    return false;
+  }
+  for (size_t i = 0; i < serial.size(); ++i) {
+    if (serial[i] != parallel[i]) {
+      nout << name << ": entry " << i << " is " << parallel[i]
+           << ", expected " << serial[i] << "\n";
+      return false;
+    }
+  }
+  nout << name << ": " << parallel.size() << " entries match\n";
+  return true;
+}
+
+int
+main(int argc, char *argv[]) {
+  int num_groups = 32;
+  int num_leaves = 16;
+  int num_colliders = 24;
+
+  NodePath root = make_scene(num_groups, num_leaves);
+
+  CollisionTraverser trav("test");
+  PT(CollisionHandlerQueue) queue = new CollisionHandlerQueue;
+  for (int i = 0; i < num_colliders; ++i) {
+    PT(CollisionNode) from = new CollisionNode("from");
+    from->add_solid(new CollisionSphere(0.0f, 0.0f, 0.0f, 1.5f));
+    from->set_into_collide_mask(CollideMask::all_off());
+    NodePath from_np = root.attach_new_node(from);
+    from_np.set_pos((PN_stdfloat)(i % 8) * 4.0f + 1.0f,
+                    (PN_stdfloat)(i / 8) * 4.0f + 1.0f, 1.0f);
+    trav.add_collider(from_np, queue);
+  }
+
+  trav.set_parallel(false);
+  pvector<std::string> serial = traverse(trav, queue, root);
+  if (serial.empty()) {
+    nout << "No collisions detected.\n";
+    return 1;
+  }
+
+  bool ok = true;
+  trav.set_parallel(true);
+
+  // A "collide" chain without any threads must not hang the traversal; the
+  // calling thread does all of the work.
+  AsyncTaskManager *task_mgr = AsyncTaskManager::get_global_ptr();
+  AsyncTaskChain *chain = task_mgr->make_task_chain("collide");
+  chain->set_num_threads(0);
+  ok = compare("no threads", serial, traverse(trav, queue, root)) && ok;
+
+  chain->set_num_threads(std::max((int)collide_num_threads, 1));
+  for (int i = 0; i < 10; ++i) {
+    ok = compare("parallel", serial, traverse(trav, queue, root)) && ok;
+  }
+
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,190 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file test_cull_parallel.cxx
+ * @author lachbr
+ * @date 2026-10-18
+ */
+
+#include "pandaFramework.h"
+#include "cullTraverser.h"
+#include "cullHandler.h"
+#include "cullableObject.h"
+#include "sceneSetup.h"
+#include "camera.h"
+#include "perspectiveLens.h"
+#include "geomNode.h"
+#include "geom.h"
+#include "geomTriangles.h"
+#include "geomVertexWriter.h"
+#include "colorAttrib.h"
+#include "asyncTaskManager.h"
+
+#include <sstream>
+
+PandaFramework framework;
+
+/**
+ * Remembers the objects passed to it, in the order in which they arrive.
+ */
+class RecordingHandler : public CullHandler {
+public:
+  virtual void record_object(CullableObject *object,
+                             const CullTraverser *traverser) {
+    std::ostringstream strm;
+    strm << object->_geom << " " << *object->_state << " at "
+         << object->_internal_transform->get_pos();
+    _objects.push_back(strm.str());
+    delete object;
+  }
+
+  pvector<std::string> _objects;
+};
+
+/**
+ * Returns a single triangle.
+ */
+static PT(Geom)
+make_triangle() {
+  PT(GeomVertexData) vdata = new GeomVertexData
+    ("triangle", GeomVertexFormat::get_v3(), Geom::UH_static);
+  GeomVertexWriter vertex(vdata, InternalName::get_vertex());
+  vertex.add_data3(0.0f, 0.0f, 0.0f);
+  vertex.add_data3(1.0f, 0.0f, 0.0f);
+  vertex.add_data3(0.0f, 0.0f, 1.0f);
+
+  PT(GeomTriangles) tris = new GeomTriangles(Geom::UH_static);
+  tris->add_vertices(0, 1, 2);
+
+  PT(Geom) geom = new Geom(vdata);
+  geom->add_primitive(tris);
+  return geom;
+}
+
+/**
+ * Builds a scene graph a few levels deep in front of the camera, so that the
+ * parallel traversal has plenty of subtrees to hand out.  Some of the leaves
+ * are out of view, and the states differ per group.
+ */
+static NodePath
+make_scene(int num_groups, int num_leaves) {
+  PT(Geom) triangle = make_triangle();
+
+  NodePath root("root");
+  for (int g = 0; g < num_groups; ++g) {
+    NodePath group = root.attach_new_node("group");
+    group.set_pos((PN_stdfloat)(g % 8) * 4.0f - 16.0f, 40.0f,
+                  (PN_stdfloat)(g / 8) * 4.0f - 8.0f);
+    group.set_color(LColor((PN_stdfloat)g / num_groups, 0.5f, 0.5f, 1.0f));
+    for (int s = 0; s < 4; ++s) {
+      NodePath subgroup = group.attach_new_node("subgroup");
+      subgroup.set_pos(0.0f, (PN_stdfloat)s * 10.0f, 0.0f);
+      for (int l = 0; l < num_leaves; ++l) {
+        PT(GeomNode) gnode = new GeomNode("leaf");
+        gnode->add_geom(triangle);
+        NodePath leaf = subgroup.attach_new_node(gnode);
+        leaf.set_pos((PN_stdfloat)(l % 4) * 1.5f, 0.0f, (PN_stdfloat)(l / 4) * 1.5f);
+      }
+    }
+  }
+  return root;
+}
+
+/**
+ * Culls the scene once and returns the objects the handler received, in the
+ * order it received them.
+ */
+static pvector<std::string>
+cull(SceneSetup *scene_setup, GraphicsStateGuardianBase *gsg, bool parallel) {
+  RecordingHandler handler;
+  PT(CullTraverser) trav = new CullTraverser;
+  trav->set_scene(scene_setup, gsg, true);
+  trav->set_cull_handler(&handler);
+  trav->set_parallel(parallel);
+  trav->traverse(scene_setup->get_scene_root());
+  trav->end_traverse();
+  return handler._objects;
+}
+
+/**
+ * Reports the first difference between the serial and parallel results, and
+ * returns true if there was none.
+ */
+static bool
+compare(const std::string &name, const pvector<std::string> &serial,
+        const pvector<std::string> &parallel) {
+  if (serial.size() != parallel.size()) {
+    nout << name << ": " << parallel.size() << " objects, expected "
+         << serial.size() << "\n";
+    return false;
+  }
+  for (size_t i = 0; i < serial.size(); ++i) {
+    if (serial[i] != parallel[i]) {
+      nout << name << ": object " << i << " is " << parallel[i]
+           << ", expected " << serial[i] << "\n";
+      return false;
+    }
+  }
+  nout << name << ": " << parallel.size() << " objects in matching order\n";
+  return true;
+}
+
+int
+main(int argc, char *argv[]) {
+  framework.open_framework(argc, argv);
+
+  WindowFramework *window = framework.open_window();
+  if (window == nullptr) {
+    nout << "Unable to open window.\n";
+    return 1;
+  }
+  GraphicsStateGuardianBase *gsg = window->get_graphics_output()->get_gsg();
+
+  NodePath root = make_scene(32, 16);
+
+  PT(PerspectiveLens) lens = new PerspectiveLens;
+  lens->set_fov(60.0f);
+  PT(Camera) camera = new Camera("camera", lens);
+  NodePath camera_np = root.attach_new_node(camera);
+
+  PT(SceneSetup) scene_setup = new SceneSetup;
+  scene_setup->set_scene_root(root);
+  scene_setup->set_camera_path(camera_np);
+  scene_setup->set_camera_node(camera);
+  scene_setup->set_lens(lens);
+  scene_setup->set_initial_state(RenderState::make_empty());
+  scene_setup->set_camera_transform(TransformState::make_identity());
+  scene_setup->set_world_transform(TransformState::make_identity());
+  scene_setup->set_cs_transform(TransformState::make_identity());
+  scene_setup->set_cs_world_transform(TransformState::make_identity());
+  PT(BoundingVolume) bv = lens->make_bounds();
+  scene_setup->set_view_frustum(DCAST(GeometricBoundingVolume, bv));
+
+  pvector<std::string> serial = cull(scene_setup, gsg, false);
+  if (serial.empty()) {
+    nout << "Nothing was culled into view.\n";
+    return 1;
+  }
+
+  bool ok = true;
+
+  // A "cull" chain without any threads must not hang the traversal; the
+  // calling thread does all of the work.
+  AsyncTaskManager *task_mgr = AsyncTaskManager::get_global_ptr();
+  AsyncTaskChain *chain = task_mgr->make_task_chain("cull");
+  chain->set_num_threads(0);
+  ok = compare("no threads", serial, cull(scene_setup, gsg, true)) && ok;
+
+  chain->set_num_threads(4);
+  for (int i = 0; i < 10; ++i) {
+    ok = compare("parallel", serial, cull(scene_setup, gsg, true)) && ok;
+  }
+
+  framework.close_framework();
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,595 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file test_pnm_filter.cxx
+ * @author lachbr
+ * @date 2026-10-18
+ */
+
+#include "pandabase.h"
+#include "pnmImage.h"
+#include "convert_srgb.h"
+#include "texture.h"
+#include "randomizer.h"
+#include "trueClock.h"
+#include "pvector.h"
+
+#include <math.h>
+#include <sstream>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * Fills the image with random noise, so that the filters have something to
+ * chew on.
+ */
+static void
+fill_noise(PNMImage &image) {
+  Randomizer random(1);
+  for (int y = 0; y < image.get_y_size(); ++y) {
+    for (int x = 0; x < image.get_x_size(); ++x) {
+      image.set_xel_val(x, y, random.random_int(image.get_maxval() + 1),
+                        random.random_int(image.get_maxval() + 1),
+                        random.random_int(image.get_maxval() + 1));
+      if (image.has_alpha()) {
+        image.set_alpha_val(x, y, random.random_int(image.get_maxval() + 1));
+      }
+    }
+  }
+}
+
+/**
+ * Reports the first pixel at which the two images differ by more than
+ * tolerance in any xelval, and returns true if there was none.
+ */
+static bool
+compare_images(const std::string &name, const PNMImage &got,
+               const PNMImage &want, int tolerance) {
+  for (int y = 0; y < want.get_y_size(); ++y) {
+    for (int x = 0; x < want.get_x_size(); ++x) {
+      int got_vals[4] = { (int)got.get_red_val(x, y), (int)got.get_green_val(x, y),
+                          (int)got.get_blue_val(x, y),
+                          got.has_alpha() ? (int)got.get_alpha_val(x, y) : 0 };
+      int want_vals[4] = { (int)want.get_red_val(x, y), (int)want.get_green_val(x, y),
+                           (int)want.get_blue_val(x, y),
+                           want.has_alpha() ? (int)want.get_alpha_val(x, y) : 0 };
+      for (int c = 0; c < 4; ++c) {
+        if (abs(got_vals[c] - want_vals[c]) > tolerance) {
+          nout << name << ": pixel " << x << ", " << y << " is "
+               << got.get_xel_a(x, y) << ", expected " << want.get_xel_a(x, y)
+               << "\n";
+          return false;
+        }
+      }
+    }
+  }
+  return true;
+}
+
+/**
+ * Checks get_xel_a_row() and set_xel_a_row() against get_xel_a() and
+ * set_xel_a() on each pixel.
+ */
+static bool
+check_rows(const std::string &name, const PNMImage &source) {
+  int x_size = source.get_x_size();
+  int num_channels = source.has_alpha() ? 4 : 3;
+  pvector<float> row(x_size * 4);
+
+  for (int y = 0; y < source.get_y_size(); ++y) {
+    source.get_xel_a_row(y, &row[0]);
+    for (int x = 0; x < x_size; ++x) {
+      LColorf want = source.get_xel_a(x, y);
+      for (int c = 0; c < num_channels; ++c) {
+        if (row[x * 4 + c] != want[c]) {
+          nout << name << ": get_xel_a_row() at " << x << ", " << y
+               << " gives " << row[x * 4 + c] << " in channel " << c
+               << ", expected " << want[c] << "\n";
+          return false;
+        }
+      }
+    }
+  }
+
+  // Include some values out of range, to check the clamping.
+  Randomizer random(2);
+  PNMImage got(source), want(source);
+  for (int y = 0; y < source.get_y_size(); ++y) {
+    for (int x = 0; x < x_size; ++x) {
+      LColorf color((float)random.random_real(1.2) - 0.1f,
+                    (float)random.random_real(1.2) - 0.1f,
+                    (float)random.random_real(1.2) - 0.1f,
+                    (float)random.random_real(1.2) - 0.1f);
+      memcpy(&row[x * 4], color.get_data(), sizeof(float) * 4);
+      want.set_xel_a(x, y, color);
+    }
+    got.set_xel_a_row(y, &row[0]);
+  }
+  if (!compare_images(name + " set_xel_a_row()", got, want, 0)) {
+    return false;
+  }
+
+  nout << name << ": row conversions match\n";
+  return true;
+}
+
+/**
+ * Returns the weights that the original filter_row() looked up, one sample
+ * at a time, for the indicated destination value, with the filter kernels
+ * built by box_filter_impl() and gaussian_filter_impl().  Sets left to the
+ * first source value that the weights apply to.
+ */
+static void
+reference_weights(pvector<float> &weights, int &left, int dest_x,
+                  int dest_len, int source_len, float width, bool gaussian) {
+  float scale = (float)dest_len / (float)source_len;
+  float fscale = (scale < 1.0) ? 1.0 / scale : scale;
+
+  float sigma = width / 2;
+  float filter_width = gaussian ? 3.0 * sigma : width;
+  float box_width = filter_width * fscale;
+  float div = 2 * sigma * sigma;
+
+  float iscale;
+  if (scale < 1.0f) {
+    iscale = 1.0f;
+    filter_width /= scale;
+  } else {
+    iscale = scale;
+  }
+
+  float center = (dest_x + 0.5f) / scale - 0.5f;
+  left = std::max((int)floorf(center - filter_width), 0);
+  int right = std::min((int)ceilf(center + filter_width), source_len - 1);
+
+  weights.clear();
+  for (int source_x = left; source_x <= right; ++source_x) {
+    int index = (int)floorf(iscale * fabsf(center - source_x) + 0.5f);
+    if (gaussian) {
+      float x = index / fscale;
+      weights.push_back((float)exp(-x * x / div));
+    } else {
+      weights.push_back((index <= box_width) ? 1.0f : 0.0f);
+    }
+  }
+}
+
+/**
+ * Resizes the source image into dest one pixel at a time, with get_xel_a()
+ * and set_xel_a(), the way box_filter_from() or gaussian_filter_from() should.
+ */
+static void
+reference_filter(PNMImage &dest, const PNMImage &source, float width,
+                 bool gaussian) {
+  int x_size = dest.get_x_size();
+  int y_size = dest.get_y_size();
+  int source_y_size = source.get_y_size();
+
+  pvector<float> weights;
+  int left;
+
+  // First along x, into a temporary matrix.
+  pvector<LColorf> temp(x_size * source_y_size);
+  for (int x = 0; x < x_size; ++x) {
+    reference_weights(weights, left, x, x_size, source.get_x_size(),
+                      width, gaussian);
+    for (int y = 0; y < source_y_size; ++y) {
+      LColorf sum = LColorf::zero();
+      float net_weight = 0.0f;
+      for (size_t i = 0; i < weights.size(); ++i) {
+        sum += source.get_xel_a(left + (int)i, y) * weights[i];
+        net_weight += weights[i];
+      }
+      temp[y * x_size + x] = (net_weight > 0.0f) ? sum / net_weight : LColorf::zero();
+    }
+  }
+
+  // Then along y.
+  for (int y = 0; y < y_size; ++y) {
+    reference_weights(weights, left, y, y_size, source_y_size, width, gaussian);
+    for (int x = 0; x < x_size; ++x) {
+      LColorf sum = LColorf::zero();
+      float net_weight = 0.0f;
+      for (size_t i = 0; i < weights.size(); ++i) {
+        sum += temp[(left + (int)i) * x_size + x] * weights[i];
+        net_weight += weights[i];
+      }
+      dest.set_xel_a(x, y, (net_weight > 0.0f) ? sum / net_weight : LColorf::zero());
+    }
+  }
+}
+
+/**
+ * Checks box_filter_from() and gaussian_filter_from() against the
+ * reference, for a destination of the indicated size.
+ */
+static bool
+check_filter(const std::string &name, const PNMImage &source,
+             int x_size, int y_size, float width) {
+  PNMImage got(x_size, y_size, source.get_num_channels(), source.get_maxval(),
+               nullptr, source.get_color_space());
+  PNMImage want(got);
+
+  got.box_filter_from(width, source);
+  reference_filter(want, source, width, false);
+  if (!compare_images(name + " box_filter_from()", got, want, 1)) {
+    return false;
+  }
+
+  got.gaussian_filter_from(width, source);
+  reference_filter(want, source, width, true);
+  if (!compare_images(name + " gaussian_filter_from()", got, want, 1)) {
+    return false;
+  }
+
+  nout << name << ": filters to " << x_size << " x " << y_size << " match\n";
+  return true;
+}
+
+// The following reproduce the original per-pixel quick_filter_from().
+
+static void
+reference_box_line(const PNMImage &image, float x0, int y, float x1,
+                   float y_contrib, LColorf &color, float &pixel_count) {
+  int x = (int)x0;
+  // Get the first (partial) xel
+  float contrib = ((float)(x+1)-x0) * y_contrib;
+  color += image.get_xel_a(x, y) * contrib;
+  pixel_count += contrib;
+
+  int x_last = (int)x1;
+  if (x < x_last) {
+    x++;
+    while (x < x_last) {
+      // Get each consecutive (complete) xel
+      color += image.get_xel_a(x, y) * y_contrib;
+      pixel_count += y_contrib;
+      x++;
+    }
+
+    // Get the final (partial) xel
+    float x_contrib = x1 - (float)x_last;
+    if (x_contrib > 0.0001f && x < image.get_x_size()) {
+      contrib = x_contrib * y_contrib;
+      color += image.get_xel_a(x, y) * contrib;
+      pixel_count += contrib;
+    }
+  }
+}
+
+static LColorf
+reference_box_region(const PNMImage &image,
+                     float x0, float y0, float x1, float y1) {
+  LColorf color = LColorf::zero();
+  float pixel_count = 0.0f;
+
+  int y = (int)y0;
+  // Get the first (partial) row
+  reference_box_line(image, x0, y, x1, (float)(y+1)-y0, color, pixel_count);
+
+  int y_last = (int)y1;
+  if (y < y_last) {
+    y++;
+    while (y < y_last) {
+      // Get each consecutive (complete) row
+      reference_box_line(image, x0, y, x1, 1.0f, color, pixel_count);
+      y++;
+    }
+
+    // Get the final (partial) row
+    float y_contrib = y1 - (float)y_last;
+    if (y_contrib > 0.0001f && y < image.get_y_size()) {
+      reference_box_line(image, x0, y, x1, y_contrib, color, pixel_count);
+    }
+  }
+
+  return color / pixel_count;
+}
+
+/**
+ * Checks quick_filter_from() against the original per-pixel box filter, for
+ * a destination of the indicated size and borders.
+ */
+static bool
+check_quick_filter(const std::string &name, const PNMImage &source,
+                   int x_size, int y_size, int xborder, int yborder) {
+  PNMImage got(x_size, y_size, source.get_num_channels(), source.get_maxval(),
+               nullptr, source.get_color_space());
+  got.fill(0.0f);
+  PNMImage want(got);
+
+  got.quick_filter_from(source, xborder, yborder);
+
+  int to_xs = x_size - xborder;
+  int to_ys = y_size - yborder;
+  int to_xoff = xborder / 2;
+  int to_yoff = yborder / 2;
+  float x_scale = (float)source.get_x_size() / (float)to_xs;
+  float y_scale = (float)source.get_y_size() / (float)to_ys;
+
+  for (int to_y = std::max(0, -to_yoff); to_y < std::min(to_ys, y_size - to_yoff); ++to_y) {
+    for (int to_x = std::max(0, -to_xoff); to_x < std::min(to_xs, x_size - to_xoff); ++to_x) {
+      LColorf color = reference_box_region(source, to_x * x_scale, to_y * y_scale,
+                                           (to_x+1) * x_scale, (to_y+1) * y_scale);
+      want.set_xel_a(to_xoff + to_x, to_yoff + to_y, color);
+    }
+  }
+
+  if (!compare_images(name + " quick_filter_from()", got, want, 1)) {
+    return false;
+  }
+  nout << name << ": quick_filter_from to " << x_size << " x " << y_size
+       << ", border " << xborder << ", " << yborder << " matches\n";
+  return true;
+}
+
+/**
+ * Runs each of the checks over a source image of the indicated size and
+ * format.
+ */
+static bool
+check_size(int x_size, int y_size, int num_channels, xelval maxval,
+           ColorSpace color_space) {
+  PNMImage source(x_size, y_size, num_channels, maxval, nullptr, color_space);
+  fill_noise(source);
+
+  std::ostringstream strm;
+  strm << x_size << " x " << y_size << ", " << num_channels << " channels, maxval "
+       << maxval << ", " << color_space;
+  std::string name = strm.str();
+
+  bool ok = check_rows(name, source);
+
+  ok = check_quick_filter(name, source, x_size / 2, y_size / 2, 0, 0) && ok;
+  ok = check_quick_filter(name, source, x_size / 3 + 4, y_size / 3 + 2, 4, 2) && ok;
+  ok = check_quick_filter(name, source, x_size * 2 + 1, y_size + 3, 0, 0) && ok;
+
+  // The filters read the channels directly, so they are only checked in the
+  // linear color space.
+  if (color_space == CS_linear) {
+    ok = check_filter(name, source, x_size / 2, y_size / 2, 0.5f) && ok;
+    ok = check_filter(name, source, x_size / 3, y_size * 2 / 3, 1.0f) && ok;
+    ok = check_filter(name, source, x_size * 2 - 1, y_size / 2, 1.5f) && ok;
+  }
+  return ok;
+}
+
+/**
+ * Checks the array sRGB conversions against the single-value ones, for every
+ * encoded value and for a spread of linear values, including some out of
+ * range.
+ */
+static bool
+check_srgb() {
+  // Use an odd count, so that there are leftovers after the vector loop.
+  static const int count = 4099;
+  pvector<unsigned char> encoded(count);
+  pvector<float> decoded(count);
+  for (int i = 0; i < count; ++i) {
+    encoded[i] = (unsigned char)(i & 0xff);
+  }
+
+  decode_sRGB_float(&encoded[0], &decoded[0], count);
+  for (int i = 0; i < count; ++i) {
+    if (decoded[i] != decode_sRGB_float(encoded[i])) {
+      nout << "decode_sRGB_float(): " << (int)encoded[i] << " decodes to "
+           << decoded[i] << ", expected " << decode_sRGB_float(encoded[i]) << "\n";
+      return false;
+    }
+  }
+
+  for (int i = 0; i < count; ++i) {
+    decoded[i] = (float)i / (float)(count - 200) - 0.01f;
+  }
+  encode_sRGB_uchar(&decoded[0], &encoded[0], count);
+  for (int i = 0; i < count; ++i) {
+    if (encoded[i] != encode_sRGB_uchar(decoded[i])) {
+      nout << "encode_sRGB_uchar(): " << decoded[i] << " encodes to "
+           << (int)encoded[i] << ", expected " << (int)encode_sRGB_uchar(decoded[i])
+           << "\n";
+      return false;
+    }
+  }
+
+  nout << "sRGB array conversions match\n";
+  return true;
+}
+
+/**
+ * Checks the sRGB mipmap levels that Texture generates a row at a time
+ * against averaging each 2x2 block with the single-value sRGB conversions.
+ * Alpha is averaged linearly.
+ */
+static bool
+check_srgb_mipmaps(Texture::Format format, int x_size, int y_size) {
+  PT(Texture) tex = new Texture("srgb");
+  tex->setup_2d_texture(x_size, y_size, Texture::T_unsigned_byte, format);
+  int num_components = tex->get_num_components();
+  bool alpha = (num_components == 4);
+
+  PTA_uchar image = tex->modify_ram_image();
+  Randomizer random(3);
+  for (size_t i = 0; i < image.size(); ++i) {
+    image[i] = (unsigned char)random.random_int(256);
+  }
+
+  tex->generate_ram_mipmap_images();
+
+  for (int n = 1; x_size > 1 && y_size > 1; ++n) {
+    CPTA_uchar from = tex->get_ram_mipmap_image(n - 1);
+    CPTA_uchar to = tex->get_ram_mipmap_image(n);
+    size_t pixel_size = num_components;
+    size_t row_size = x_size * pixel_size;
+    x_size >>= 1;
+    y_size >>= 1;
+
+    for (int y = 0; y < y_size; ++y) {
+      for (int x = 0; x < x_size; ++x) {
+        for (int c = 0; c < num_components; ++c) {
+          size_t i = y * 2 * row_size + x * 2 * pixel_size + c;
+          unsigned char want;
+          if (alpha && c == num_components - 1) {
+            want = (unsigned char)(((unsigned int)from[i] +
+                                    (unsigned int)from[i + pixel_size] +
+                                    (unsigned int)from[i + row_size] +
+                                    (unsigned int)from[i + pixel_size + row_size]) >> 2);
+          } else {
+            float result = (decode_sRGB_float(from[i]) +
+                            decode_sRGB_float(from[i + pixel_size]) +
+                            decode_sRGB_float(from[i + row_size]) +
+                            decode_sRGB_float(from[i + pixel_size + row_size]));
+            want = encode_sRGB_uchar(result * 0.25f);
+          }
+          unsigned char got = to[(y * x_size + x) * pixel_size + c];
+          if (got != want) {
+            nout << "sRGB mipmap level " << n << ": component " << c
+                 << " of pixel " << x << ", " << y << " is " << (int)got
+                 << ", expected " << (int)want << "\n";
+            return false;
+          }
+        }
+      }
+    }
+  }
+
+  nout << "sRGB mipmaps (" << format << ") match\n";
+  return true;
+}
+
+/**
+ * Reports the best time, over the indicated number of iterations, of the
+ * indicated operation.
+ */
+template<class Func>
+static void
+time_op(const std::string &name, int num_iterations, Func func) {
+  TrueClock *clock = TrueClock::get_global_ptr();
+  double best = 0.0;
+  for (int n = 0; n < num_iterations; ++n) {
+    double start = clock->get_short_time();
+    func();
+    double elapsed = clock->get_short_time() - start;
+    if (n == 0 || elapsed < best) {
+      best = elapsed;
+    }
+  }
+  nout << "  " << name << ": " << best * 1000.0 << " ms\n";
+}
+
+/**
+ * Runs each of the operations over an image of the indicated size and
+ * format.
+ */
+static void
+run_size(int size, int num_channels, xelval maxval, ColorSpace color_space,
+         int num_iterations) {
+  PNMImage source(size, size, num_channels, maxval, nullptr, color_space);
+  fill_noise(source);
+
+  nout << size << " x " << size << ", " << num_channels << " channels, maxval "
+       << maxval << ", " << color_space << ":\n";
+
+  PNMImage half(size / 2, size / 2, num_channels, maxval, nullptr, color_space);
+  time_op("quick_filter_from (1/2)", num_iterations, [&] {
+    half.quick_filter_from(source);
+  });
+  time_op("box_filter_from (1/2)", num_iterations, [&] {
+    half.box_filter_from(0.5f, source);
+  });
+  time_op("gaussian_filter_from (1/2)", num_iterations, [&] {
+    half.gaussian_filter_from(1.0f, source);
+  });
+
+  PNMImage same(size, size, num_channels, maxval, nullptr, color_space);
+  time_op("gaussian_filter_from (blur)", num_iterations, [&] {
+    same.gaussian_filter_from(2.0f, source);
+  });
+
+  pvector<float> row(size * 4);
+  time_op("get_xel_a", num_iterations, [&] {
+    for (int y = 0; y < size; ++y) {
+      for (int x = 0; x < size; ++x) {
+        LColorf color = source.get_xel_a(x, y);
+        memcpy(&row[x * 4], color.get_data(), sizeof(float) * 4);
+      }
+    }
+  });
+  time_op("get_xel_a_row", num_iterations, [&] {
+    for (int y = 0; y < size; ++y) {
+      source.get_xel_a_row(y, &row[0]);
+    }
+  });
+  time_op("set_xel_a_row", num_iterations, [&] {
+    for (int y = 0; y < size; ++y) {
+      same.set_xel_a_row(y, &row[0]);
+    }
+  });
+}
+
+/**
+ * Compares the single-value and the array sRGB conversions.
+ */
+static void
+run_srgb(int count, int num_iterations) {
+  pvector<unsigned char> encoded(count);
+  pvector<float> decoded(count);
+  for (int i = 0; i < count; ++i) {
+    encoded[i] = (unsigned char)(i & 0xff);
+  }
+
+  nout << "sRGB conversion of " << count << " values:\n";
+  time_op("decode_sRGB_float (single)", num_iterations, [&] {
+    for (int i = 0; i < count; ++i) {
+      decoded[i] = decode_sRGB_float(encoded[i]);
+    }
+  });
+  time_op("decode_sRGB_float (array)", num_iterations, [&] {
+    decode_sRGB_float(&encoded[0], &decoded[0], count);
+  });
+  time_op("encode_sRGB_uchar (single)", num_iterations, [&] {
+    for (int i = 0; i < count; ++i) {
+      encoded[i] = encode_sRGB_uchar(decoded[i]);
+    }
+  });
+  time_op("encode_sRGB_uchar (array)", num_iterations, [&] {
+    encode_sRGB_uchar(&decoded[0], &encoded[0], count);
+  });
+}
+
+int
+main(int argc, char *argv[]) {
+  int num_iterations = 5;
+  if (argc > 2 && strcmp(argv[1], "-n") == 0) {
+    num_iterations = std::max(atoi(argv[2]), 1);
+  }
+
+  // First make sure the fast paths produce the same results as the simple
+  // per-pixel ones.
+  bool ok = true;
+  ok = check_size(64, 48, 3, 255, CS_linear) && ok;
+  ok = check_size(97, 61, 4, 255, CS_linear) && ok;
+  ok = check_size(97, 61, 4, 255, CS_sRGB) && ok;
+  ok = check_size(50, 77, 4, 65535, CS_linear) && ok;
+  ok = check_srgb() && ok;
+  ok = check_srgb_mipmaps(Texture::F_srgb, 64, 32) && ok;
+  ok = check_srgb_mipmaps(Texture::F_srgb_alpha, 67, 45) && ok;
+  if (!ok) {
+    return 1;
+  }
+
+  static const int sizes[] = { 256, 1024, 2048 };
+  for (int size : sizes) {
+    run_size(size, 3, 255, CS_linear, num_iterations);
+    run_size(size, 4, 255, CS_linear, num_iterations);
+    run_size(size, 4, 255, CS_sRGB, num_iterations);
+    run_size(size, 4, 65535, CS_linear, num_iterations);
+  }
+
+  run_srgb(4096 * 4096, num_iterations);
+  return 0;
+}
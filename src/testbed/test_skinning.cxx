@@ -0,0 +1,232 @@
+/**
+ * PANDA 3D SOFTWARE
+ * Copyright (c) Carnegie Mellon University.  All rights reserved.
+ *
+ * All use of this software is subject to the terms of the revised BSD
+ * license.  You should have received a copy of this license along
+ * with this source code in a file named "LICENSE."
+ *
+ * @file test_skinning.cxx
+ * @author lachbr
+ * @date 2026-10-18
+ */
+
+#include "pandabase.h"
+#include "geomVertexData.h"
+#include "geomVertexFormat.h"
+#include "geomVertexArrayFormat.h"
+#include "geomVertexReader.h"
+#include "geomVertexWriter.h"
+#include "transformBlendTable.h"
+#include "userVertexTransform.h"
+#include "config_gobj.h"
+#include "asyncTaskManager.h"
+#include "thread.h"
+#include "compose_matrix.h"
+
+#include <algorithm>
+#include <stdlib.h>
+
+typedef pvector<PT(UserVertexTransform)> Transforms;
+
+static float
+random_float(float lo, float hi) {
+  return lo + (hi - lo) * ((float)rand() / (float)RAND_MAX);
+}
+
+/**
+ * Returns a matrix with a random rotation and translation.  If nonuniform is
+ * true, it also has a non-uniform scale, so that the normals must be
+ * transformed by the inverse transpose and renormalized.
+ */
+static LMatrix4
+random_matrix(bool nonuniform) {
+  LVecBase3 scale(1.0f, 1.0f, 1.0f);
+  if (nonuniform) {
+    // Keep the axes well apart, so the scale is never taken for uniform.
+    scale.set(random_float(0.5f, 0.8f), random_float(1.0f, 1.3f), random_float(1.5f, 2.0f));
+  }
+  LVecBase3 hpr(random_float(-180.0f, 180.0f), random_float(-90.0f, 90.0f),
+                random_float(-180.0f, 180.0f));
+  LVecBase3 pos(random_float(-10.0f, 10.0f), random_float(-10.0f, 10.0f),
+                random_float(-10.0f, 10.0f));
+  LMatrix4 mat;
+  compose_matrix(mat, scale, LVecBase3::zero(), hpr, pos);
+  return mat;
+}
+
+/**
+ * Returns a random unit-length vector.
+ */
+static LVector3
+random_unit_vector() {
+  LVector3 v;
+  do {
+    v.set(random_float(-1.0f, 1.0f), random_float(-1.0f, 1.0f), random_float(-1.0f, 1.0f));
+  } while (v.length_squared() < 0.01f);
+  v.normalize();
+  return v;
+}
+
+/**
+ * Builds an animated GeomVertexData with num_rows rows, each of which is
+ * assigned to one of the transforms.  Consecutive rows share a blend in runs
+ * of varying length, so that the SIMD kernels see both full groups of four
+ * rows and leftover rows.
+ */
+static PT(GeomVertexData)
+make_data(int num_rows, const Transforms &transforms) {
+  PT(GeomVertexArrayFormat) array_format = new GeomVertexArrayFormat
+    (InternalName::get_vertex(), 3, Geom::NT_float32, Geom::C_point,
+     InternalName::get_normal(), 3, Geom::NT_float32, Geom::C_normal,
+     InternalName::get_binormal(), 3, Geom::NT_float32, Geom::C_vector);
+  PT(GeomVertexArrayFormat) blend_format = new GeomVertexArrayFormat
+    (InternalName::get_transform_blend(), 1, Geom::NT_uint16, Geom::C_index);
+
+  PT(GeomVertexFormat) format = new GeomVertexFormat(array_format);
+  format->add_array(blend_format);
+  GeomVertexAnimationSpec animation;
+  animation.set_panda();
+  format->set_animation(animation);
+
+  PT(TransformBlendTable) table = new TransformBlendTable;
+  for (UserVertexTransform *transform : transforms) {
+    table->add_blend(TransformBlend(transform, 1.0f));
+  }
+  table->set_rows(SparseArray::lower_on(num_rows));
+
+  PT(GeomVertexData) vdata = new GeomVertexData
+    ("skinned", GeomVertexFormat::register_format(format), Geom::UH_static);
+  vdata->unclean_set_num_rows(num_rows);
+  vdata->set_transform_blend_table(table);
+
+  GeomVertexWriter vertex(vdata, InternalName::get_vertex());
+  GeomVertexWriter normal(vdata, InternalName::get_normal());
+  GeomVertexWriter binormal(vdata, InternalName::get_binormal());
+  GeomVertexWriter blend(vdata, InternalName::get_transform_blend());
+
+  int bi = 0;
+  int run_length = 0;
+  for (int i = 0; i < num_rows; ++i) {
+    if (run_length == 0) {
+      bi = rand() % (int)transforms.size();
+      run_length = (rand() % 4 == 0) ? rand() % 200 + 1 : rand() % 7 + 1;
+    }
+    --run_length;
+
+    vertex.set_data3(random_float(-5.0f, 5.0f), random_float(-5.0f, 5.0f), random_float(-5.0f, 5.0f));
+    normal.set_data3(random_unit_vector());
+    binormal.set_data3(random_unit_vector());
+    blend.set_data1i(bi);
+  }
+
+  return vdata;
+}
+
+/**
+ * Compares the animated vertices against the result of transforming each row
+ * of the original vertices one at a time, with the plain LMatrix4 operations.
+ * Returns true if they match.
+ */
+static bool
+check_vertices(const std::string &name, const GeomVertexData *orig,
+               const GeomVertexData *animated, const Transforms &transforms) {
+  GeomVertexReader vertex(orig, InternalName::get_vertex());
+  GeomVertexReader normal(orig, InternalName::get_normal());
+  GeomVertexReader binormal(orig, InternalName::get_binormal());
+  GeomVertexReader blend(orig, InternalName::get_transform_blend());
+
+  GeomVertexReader new_vertex(animated, InternalName::get_vertex());
+  GeomVertexReader new_normal(animated, InternalName::get_normal());
+  GeomVertexReader new_binormal(animated, InternalName::get_binormal());
+
+  static const PN_stdfloat threshold = 1.0e-4f;
+
+  int num_rows = orig->get_num_rows();
+  for (int i = 0; i < num_rows; ++i) {
+    LMatrix4 mat;
+    transforms[blend.get_data1i()]->get_matrix(mat);
+    LMatrix4 normal_mat = invert(mat);
+    normal_mat.transpose_in_place();
+
+    LPoint3 want_vertex = mat.xform_point(vertex.get_data3());
+    LVector3 want_normal = normal_mat.xform_vec(normal.get_data3());
+    want_normal.normalize();
+    LVector3 want_binormal = mat.xform_vec(binormal.get_data3());
+
+    LPoint3 got_vertex = new_vertex.get_data3();
+    LVector3 got_normal = new_normal.get_data3();
+    LVector3 got_binormal = new_binormal.get_data3();
+
+    if (!got_vertex.almost_equal(want_vertex, threshold) ||
+        !got_normal.almost_equal(want_normal, threshold) ||
+        !got_binormal.almost_equal(want_binormal, threshold)) {
+      nout << name << ": row " << i << " is " << got_vertex << " / "
+           << got_normal << " / " << got_binormal << ", expected "
+           << want_vertex << " / " << want_normal << " / " << want_binormal
+           << "\n";
+      return false;
+    }
+  }
+
+  nout << name << ": " << num_rows << " rows match\n";
+  return true;
+}
+
+/**
+ * Animates the vertices with the current configuration and checks the
+ * result.
+ */
+static bool
+run(const std::string &name, const GeomVertexData *vdata,
+    const Transforms &transforms) {
+  Thread *current_thread = Thread::get_current_thread();
+  CPT(GeomVertexData) animated = vdata->animate_vertices(true, current_thread);
+  return check_vertices(name, vdata, animated, transforms);
+}
+
+/**
+ * Checks the SIMD skinning kernels, serially and split across the threads of
+ * the "skinning" chain, against a scalar transform of each row.
+ */
+int
+main(int argc, char *argv[]) {
+  int num_rows = 20000;
+  int num_transforms = 24;
+  if (argc > 1) {
+    num_rows = std::max(atoi(argv[1]), 1);
+  }
+
+  Transforms transforms;
+  for (int i = 0; i < num_transforms; ++i) {
+    PT(UserVertexTransform) transform = new UserVertexTransform("joint");
+    transform->set_matrix(random_matrix(i % 2 == 0));
+    transforms.push_back(transform);
+  }
+
+  PT(GeomVertexData) vdata = make_data(num_rows, transforms);
+
+  bool ok = true;
+
+  animate_vertices_num_threads.set_value(0);
+  ok = run("serial", vdata, transforms) && ok;
+
+  // A "skinning" chain without any threads must not hang the update; the
+  // calling thread does all of the work.
+  animate_vertices_num_threads.set_value(4);
+  animate_vertices_thread_min_rows.set_value(1);
+  AsyncTaskManager *task_mgr = AsyncTaskManager::get_global_ptr();
+  AsyncTaskChain *chain = task_mgr->make_task_chain("skinning");
+  chain->set_num_threads(0);
+  ok = run("no threads", vdata, transforms) && ok;
+
+  chain->set_num_threads(4);
+  for (int i = 0; i < 10; ++i) {
+    for (UserVertexTransform *transform : transforms) {
+      transform->set_matrix(random_matrix(rand() % 2 == 0));
+    }
+    ok = run("parallel", vdata, transforms) && ok;
+  }
+
+  return ok ? 0 : 1;
+}